@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "string_routines.c"
 
 #define MAXLN 10000
 
@@ -173,43 +174,6 @@ void set_xfdf( FILE *outfile, char *label, char *value )
 }
 
 
-void next_word( char *line, char *word, char *delim )
-{
- int k=0, j=0, m=0, flag=1;
- while ((line[k] != '\0') && (line[k] != '"') && (flag))  /* Consume any leading delimiters */
-  {
-   j = 0;
-   while ((delim[j] != '\0') && (line[k] != delim[j])) j = j + 1;
-   if (line[k] != delim[j]) flag = 0; else { k++; }
-  }
- if (line[k] == '"')
-  { /*quoted*/
-    k++;
-    while ((line[k] != '\0') && (line[k] != '"'))
-      word[m++] = line[k++];		/* Copy chars until next quote. */
-    if (line[k] == '\0') printf("Warning: Missing end-quote\n");
-    else k++;
-  } /*quoted*/
- else
-  { /*normal*/
-   while ((line[k] != '\0') && (!flag))	 /* Copy chars until next delimiter. */
-    {
-     word[m++] = line[k++];
-     if (line[k] != '\0')
-      {
-       j = 0;
-       while ((delim[j] != '\0') && (line[k] != delim[j])) j = j + 1;
-       if (line[k] == delim[j]) flag = 1;
-      }
-    }
-  } /*normal*/
- j = 0;			/* Shorten line. */
- while (line[k] != '\0') line[j++] = line[k++];
- line[j] = '\0';	/* Terminate the char-strings. */
- word[m] = '\0';
-}
-
-
 void show_help()
 {
  printf("\nConvert_Results2Xfdf Version %g\n", version );
@@ -233,7 +197,7 @@ void show_help()
 /* ----------------------------------------------------------- */
 int main( int argc, char *argv[] )
 {
- char *fname[2]={0,0}, line[MAXLN], word[MAXLN], label[MAXLN], outfname[MAXLN],
+ char *fname[2]={0,0}, *pt, line[MAXLN], word[MAXLN], label[MAXLN], outfname[MAXLN],
       format[MAXLN], fieldname[MAXLN], centsfieldname[MAXLN], value[MAXLN];
  FILE *infile, *outfile;
  int k=1, m=0, linenum=0;
@@ -269,12 +233,12 @@ int main( int argc, char *argv[] )
  fgets( line, MAXLN, infile );  linenum++;
  while (!feof(infile))
   {
-   next_word( line, label, " \t\n\r," );
+   pt = scan_quoted_word( line, label, " \t\n\r," );
    if (label[0] != '\0')
     {
-     next_word( line, format, " \t\n\r," );
-     next_word( line, fieldname, " \t\n\r," );
-     next_word( line, centsfieldname, " \t\n\r," );
+     pt = scan_quoted_word( pt, format, " \t\n\r," );
+     pt = scan_quoted_word( pt, fieldname, " \t\n\r," );
+     pt = scan_quoted_word( pt, centsfieldname, " \t\n\r," );
      add_xref( label, format, fieldname, centsfieldname, linenum );
     }
    fgets( line, MAXLN, infile );  linenum++;
@@ -300,10 +264,10 @@ int main( int argc, char *argv[] )
  fgets( line, MAXLN, infile );  linenum++;
  while (!feof(infile))
   {
-   next_word( line, label, " \t\n\r=" );
+   pt = scan_quoted_word( line, label, " \t\n\r=" );
    if (label[0] != '\0')
     {
-     next_word( line, value, " \t\n\r=" );
+     pt = scan_quoted_word( pt, value, " \t\n\r=" );
      if (strcmp( label, "Status" ) != 0)
       set_xfdf( outfile, label, value );
      else
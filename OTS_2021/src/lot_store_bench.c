@@ -0,0 +1,248 @@
+/************************************************************************/
+/* lot_store_bench.c - Checks and times the capital-gain lot store as	*/
+/*  the number of lots grows, from a thousand to a million.		*/
+/*   - Appending lots:  new_capgain into a lot_store, against the	*/
+/*     linked list it replaced, which walked to the tail for each	*/
+/*     lot.  (The list is only timed up to a limit, since it grows as	*/
+/*     the square of the lots.)  The totals must agree.			*/
+/*   - Whole returns:  the 1040 template, with the lots entered under	*/
+/*     CapGains-A/D, computed by run_return.  The results are discarded	*/
+/*     (as for what-if runs), so the time is that of reading, storing	*/
+/*     and summing the lots.  Schedule D line 1b must hold their gain.	*/
+/*  Build and run with "make bench", or:				*/
+/*	lot_store_bench  [max_lots  [list_limit  [tax_form_files dir]]]	*/
+/************************************************************************/
+
+#include <time.h>
+
+#define main solver_main
+#include "taxsolve_US_1040_2021.c"
+#undef main
+
+char *bench_file="lot_store_bench_input.txt";
+
+
+double now()
+{
+ struct timespec ts;
+ clock_gettime( CLOCK_MONOTONIC, &ts );
+ return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+/* The lot list as it was, before the lot_store. */
+struct old_capgain_record
+ {
+  char *comment, *buy_date, *sell_date, *adj_code;
+  double buy_amnt, sell_amnt, adj_amnt;
+  struct old_capgain_record *nxt;
+ };
+
+void old_new_capgain( struct old_capgain_record **list, char *comment, double buy_amnt,
+		char *buy_date, double sell_amnt, char *sell_date, char *adj_code, double adj_amnt )
+{ /* Add a new entry to a list. */
+  struct old_capgain_record *new_item, *prev;
+
+  new_item = (struct old_capgain_record *)malloc( sizeof(struct old_capgain_record) );
+  new_item->comment = strdup( comment );	/* Make new list item and fill-in its fields. */
+  if (strlen( new_item->comment ) > 31)
+   new_item->comment[31] = '\0'; /* Limit comment length to avoid over-running column boundary. */
+  new_item->buy_amnt = buy_amnt;
+  new_item->buy_date = strdup( buy_date );
+  new_item->sell_amnt = sell_amnt;
+  new_item->sell_date = strdup( sell_date );
+  new_item->adj_code = strdup( adj_code );
+  new_item->adj_amnt = adj_amnt;
+  new_item->nxt = 0;
+  prev = *list;		/* Insert onto end of list. */
+  if (prev == 0)
+   *list = new_item;
+  else
+   {
+    while (prev->nxt != 0) prev = prev->nxt;
+    prev->nxt = new_item;
+   }
+}
+
+void old_free_capgain_list( struct old_capgain_record *list )
+{
+ struct old_capgain_record *old;
+ while (list != 0)
+  {
+   old = list;
+   list = list->nxt;
+   free( old->comment );
+   free( old->buy_date );
+   free( old->sell_date );
+   free( old->adj_code );
+   free( old );
+  }
+}
+
+
+/* The j'th synthetic lot:  a short-term gain, as day-trading accounts list them. */
+struct bench_lot
+ {
+  char comment[64], buy_date[16], sell_date[16];
+  money buy, sell;
+ };
+
+void make_lot( int j, struct bench_lot *lot )
+{
+ int month = 1 + j % 6;
+ sprintf( lot->comment, "%d Shares SYM%03d", 1 + j % 500, j % 997 );
+ sprintf( lot->buy_date, "%d-%d-2021", month, 1 + j % 28 );
+ sprintf( lot->sell_date, "%d-%d-2021", month + 1 + j % 5, 1 + (j / 7) % 28 );
+ lot->buy = 10000 + (j % 90000) * 100 + j % 100;	/* Cents. */
+ lot->sell = lot->buy + 1 + (j * 37) % 50000;
+}
+
+
+double time_list( int nlots, money *sales )
+{
+ struct old_capgain_record *list=0, *item;
+ struct bench_lot lot;
+ double t;
+ int j;
+
+ t = now();
+ for (j=0; j < nlots; j++)
+  {
+   make_lot( j, &lot );
+   old_new_capgain( &list, lot.comment, -money_to_dollars( lot.buy ), lot.buy_date,
+		    money_to_dollars( lot.sell ), lot.sell_date, "~", 0.0 );
+  }
+ *sales = 0;
+ for (item=list; item != 0; item = item->nxt)
+  *sales = *sales + to_money( item->sell_amnt );
+ t = now() - t;
+ old_free_capgain_list( list );
+ return t;
+}
+
+
+double time_store( int nlots, money *sales )
+{
+ struct lot_store lots;
+ struct bench_lot lot;
+ double t;
+ int j;
+
+ memset( &lots, 0, sizeof(lots) );
+ memset( &lot_strings, 0, sizeof(lot_strings) );
+ t = now();
+ for (j=0; j < nlots; j++)
+  {
+   make_lot( j, &lot );
+   new_capgain( &lots, lot.comment, -money_to_dollars( lot.buy ), lot.buy_date, 0,
+		money_to_dollars( lot.sell ), lot.sell_date, 0, "~", 0.0 );
+  }
+ *sales = 0;
+ for (j=0; j < lots.n; j++)
+  *sales = *sales + to_money( lots.sell_amnt[j] );
+ t = now() - t;
+ memset( &lot_strings, 0, sizeof(lot_strings) );
+ pool_release( &return_pool );
+ return t;
+}
+
+
+/* Writes the template with the lots under CapGains-A/D.  Returns their sums. */
+void write_return( char *template, int nlots, money *sales, money *costs )
+{
+ struct bench_lot lot;
+ FILE *fp;
+ char *pt;
+ int j;
+
+ pt = strstr( template, "CapGains-A/D" );
+ if ((pt == 0) || ((pt = strchr( pt, ';' )) == 0))
+  { console_printf("Error: No CapGains-A/D section in the 1040 template.\n");  exit(1); }
+ fp = taxsolve_fopen( bench_file, "w" );
+ if (fp == 0)
+  { console_printf("Error: Could not write '%s'.\n", bench_file);  exit(1); }
+ fwrite( template, 1, pt - template, fp );
+ *sales = 0;
+ *costs = 0;
+ for (j=0; j < nlots; j++)
+  {
+   make_lot( j, &lot );
+   fprintf( fp, "\t-%.2f\t%s\t{ %s }\n\t%.2f\t%s\n\t~\t~\n", money_to_dollars( lot.buy ), lot.buy_date,
+	    lot.comment, money_to_dollars( lot.sell ), lot.sell_date );
+   *sales = *sales + lot.sell;
+   *costs = *costs - lot.buy;
+  }
+ fputs( pt, fp );
+ fclose( fp );
+}
+
+
+double time_return( int nlots, char *template, int *ok )
+{
+ money sales, costs;
+ char *argv[4];
+ double t;
+ int result;
+
+ write_return( template, nlots, &sales, &costs );
+ argv[0] = "taxsolve_US_1040_2021";
+ argv[1] = "-quiet";
+ argv[2] = bench_file;
+ argv[3] = 0;
+ discard_results = 1;
+ t = now();
+ result = run_return( taxsolve_US_1040, 3, argv );
+ t = now() - t;
+ discard_results = 0;
+ *ok = (result == 0) && (to_money( SchedD[1] ) == sales + costs);
+ remove( bench_file );
+ return t;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ int max_lots=1000000, list_limit=10000, nlots, ok, bad=0;
+ char *forms_dir="../tax_form_files", fname[4096], *template;
+ money list_sales, store_sales;
+ double t_list, t_store, t_return;
+ long len;
+
+ if (argc > 1) max_lots = atoi( argv[1] );
+ if (argc > 2) list_limit = atoi( argv[2] );
+ if (argc > 3) forms_dir = argv[3];
+ if (max_lots < 1000)
+  { console_printf("Usage:  lot_store_bench  [max_lots  [list_limit  [tax_form_files dir]]]\n");  exit(1); }
+ sprintf( fname, "%s/US_1040/US_1040_template.txt", forms_dir );
+ template = read_whole_file( fname, &len );
+ if (template == 0)
+  { console_printf("Error: Could not read '%s'.\n", fname);  exit(1); }
+ template = (char *)realloc( template, len + 1 );
+ template[len] = '\0';
+ reset_solver_state = reset_US_1040_state;
+ quiet = 1;
+
+ fprintf( stdout, "%9s   %17s %17s   %19s\n", "lots", "list append (ms)", "store append (ms)", "whole return (ms)");
+ for (nlots=1000; nlots <= max_lots; nlots = (nlots % 3000 == 0) ? 10 * nlots / 3 : 3 * nlots)	/* 1k, 3k, 10k, ... */
+  {
+   t_store = time_store( nlots, &store_sales );
+   if (nlots <= list_limit)
+    {
+     t_list = time_list( nlots, &list_sales );
+     if (list_sales != store_sales)
+      { fprintf( stdout, "   The list and the store sum %d lots differently.\n", nlots );  bad++; }
+    }
+   t_return = time_return( nlots, template, &ok );
+   if (!ok)
+    { fprintf( stdout, "   The return with %d lots does not carry their gain to Schedule D.\n", nlots );  bad++; }
+   if (nlots <= list_limit)
+    fprintf( stdout, "%9d   %17.1f %17.1f   %19.1f\n", nlots, 1e3 * t_list, 1e3 * t_store, 1e3 * t_return );
+   else
+    fprintf( stdout, "%9d   %17s %17.1f   %19.1f\n", nlots, "-", 1e3 * t_store, 1e3 * t_return );
+  }
+ if (bad)
+  fprintf( stdout, "\n%d checks failed.\n", bad );
+ else
+  fprintf( stdout, "\nThe lots are summed the same every way.\n" );
+ return bad != 0;
+}
@@ -0,0 +1,286 @@
+/************************************************************************/
+/* make_label_hash.c - Generates the perfect hash of an importer's	*/
+/*  label table (see "Label Tables" in taxsolve_routines.c).  Reads the	*/
+/*  table's initializer from the importer's source, taking the string	*/
+/*  that starts each entry as its label, and writes the slots and	*/
+/*  displacements that find_label uses.  Run by the Makefile:		*/
+/*	make_label_hash  source.c  table_name  output_file		*/
+/*  For a table named xxx, the output declares xxx_slots, xxx_disp,	*/
+/*  the sizes XXX_NFIELDS, XXX_NSLOTS and XXX_NBUCKETS, and a check	*/
+/*  that the table still has XXX_NFIELDS entries.			*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "string_routines.c"
+
+#define MAX_KEYS	4096
+
+char *keys[MAX_KEYS];
+int key_field[MAX_KEYS], key_index[MAX_KEYS], nkeys=0;
+
+
+void add_key( char *key, int field, int index )
+{
+ int j;
+
+ for (j=0; j < nkeys; j++)
+  if (strcmp( keys[j], key ) == 0)
+   { fprintf(stderr,"Error: Label '%s' is in the table twice.\n", key);  exit(1); }
+ if (nkeys == MAX_KEYS)
+  { fprintf(stderr,"Error: More than %d labels.\n", MAX_KEYS);  exit(1); }
+ keys[nkeys] = strdup( key );
+ key_field[nkeys] = field;
+ key_index[nkeys] = index;
+ nkeys++;
+}
+
+
+/* Skip white space and comments.  A preprocessor line within the table is an error, */
+/* since the entries it would select cannot be known here.			      */
+char *skip_space( char *pt, char *table )
+{
+ for (;;)
+  {
+   while (isspace( *pt )) pt++;
+   if ((pt[0] == '/') && (pt[1] == '*'))
+    {
+     pt = strstr( pt + 2, "*/" );
+     if (pt == 0)
+      { fprintf(stderr,"Error: Unterminated comment in table '%s'.\n", table);  exit(1); }
+     pt = pt + 2;
+    }
+   else
+   if ((pt[0] == '/') && (pt[1] == '/'))
+    {
+     while ((*pt != '\n') && (*pt != '\0')) pt++;
+    }
+   else
+   if (*pt == '#')
+    { fprintf(stderr,"Error: Preprocessor line in table '%s'.\n", table);  exit(1); }
+   else
+    return pt;
+  }
+}
+
+
+/* Skip a string or character literal starting at pt. */
+char *skip_literal( char *pt, char *table )
+{
+ char quote=*pt++;
+
+ while (*pt != quote)
+  {
+   if ((*pt == '\0') || (*pt == '\n'))
+    { fprintf(stderr,"Error: Unterminated literal in table '%s'.\n", table);  exit(1); }
+   if ((pt[0] == '\\') && (pt[1] != '\0'))
+    pt++;
+   pt++;
+  }
+ return pt + 1;
+}
+
+
+/* Collect the labels of the table, expanding each "%c" to 'a' through 'z'.  The	*/
+/* table's initializer is read as C:  each entry must be a braced initializer whose	*/
+/* first field is its label's string.  Anything else stops the build, rather than	*/
+/* hashing labels that do not line-up with the table's entries.  Returns the number	*/
+/* of entries, which the generated header checks against the table's size.		*/
+int read_table( char *srcname, char *table )
+{
+ FILE *src;
+ char *text, *pt, *end, name[1024], label[1024];
+ long size;
+ int field=0, depth, n, j;
+
+ src = fopen( srcname, "rb" );
+ if (src == 0)
+  { fprintf(stderr,"Error: Could not open '%s'.\n", srcname);  exit(1); }
+ fseek( src, 0, SEEK_END );
+ size = ftell( src );
+ rewind( src );
+ text = (char *)malloc( size + 1 );
+ if ((text == 0) || (fread( text, 1, size, src ) != (size_t)size))
+  { fprintf(stderr,"Error: Could not read '%s'.\n", srcname);  exit(1); }
+ text[size] = '\0';
+ fclose( src );
+
+ /* Find "table[] =", as a whole word, then the opening brace. */
+ sprintf( name, "%s[]", table );
+ pt = text;
+ while (((pt = strstr( pt, name )) != 0) && (((pt > text) && (isalnum( pt[-1] ) || (pt[-1] == '_')))
+	|| (*skip_space( pt + strlen( name ), table ) != '=')))
+  pt++;
+ if (pt == 0)
+  { fprintf(stderr,"Error: No table '%s' in '%s'.\n", table, srcname);  exit(1); }
+ pt = skip_space( strchr( pt, '=' ) + 1, table );
+ if (*pt != '{')
+  { fprintf(stderr,"Error: Table '%s' is not a braced list.\n", table);  exit(1); }
+ pt = skip_space( pt + 1, table );
+
+ while (*pt != '}')
+  {
+   if (*pt != '{')
+    { fprintf(stderr,"Error: Entry %d of table '%s' is not a braced initializer.\n", field + 1, table);  exit(1); }
+   pt = skip_space( pt + 1, table );
+   if (*pt != '"')
+    { fprintf(stderr,"Error: Entry %d of table '%s' does not start with its label.\n", field + 1, table);  exit(1); }
+   end = skip_literal( pt, table );
+   n = end - pt - 2;
+   if ((n == 0) || (n > 1000) || (memchr( pt + 1, '\\', n ) != 0))
+    { fprintf(stderr,"Error: Bad label in entry %d of table '%s'.\n", field + 1, table);  exit(1); }
+   memcpy( label, pt + 1, n );
+   label[n] = '\0';
+   if ((n > 2) && (strcmp( &(label[n-2]), "%c" ) == 0))
+    {
+     for (j=0; j < 26; j++)
+      {
+       label[n-2] = 'a' + j;
+       label[n-1] = '\0';
+       add_key( label, field, j );
+      }
+    }
+   else
+    add_key( label, field, 0 );
+   field++;
+
+   /* Skip the rest of the entry, then its comma. */
+   pt = end;
+   depth = 1;
+   while (depth > 0)
+    {
+     pt = skip_space( pt, table );
+     if (*pt == '\0')
+      { fprintf(stderr,"Error: Table '%s' is not terminated.\n", table);  exit(1); }
+     if ((*pt == '"') || (*pt == '\''))
+      pt = skip_literal( pt, table );
+     else
+      {
+       if (*pt == '{') depth++;
+       else
+       if (*pt == '}') depth--;
+       pt++;
+      }
+    }
+   pt = skip_space( pt, table );
+   if (*pt == ',')
+    pt = skip_space( pt + 1, table );
+   else
+   if (*pt != '}')
+    { fprintf(stderr,"Error: Expected ',' after entry %d of table '%s'.\n", field, table);  exit(1); }
+  }
+ free( text );
+ if (nkeys == 0)
+  { fprintf(stderr,"Error: Table '%s' has no labels.\n", table);  exit(1); }
+ return field;
+}
+
+
+int slot_of[MAX_KEYS * 4];		/* Key in each slot, or -1. */
+int bucket_keys[MAX_KEYS], bucket_start[MAX_KEYS + 1], order[MAX_KEYS];
+unsigned short disp[MAX_KEYS];
+
+int by_bucket_size( const void *a, const void *b )
+{
+ int na=bucket_start[*(int *)a + 1] - bucket_start[*(int *)a], nb=bucket_start[*(int *)b + 1] - bucket_start[*(int *)b];
+ if (na != nb) return nb - na;
+ return *(int *)a - *(int *)b;
+}
+
+
+/* Hash and displace:  place the largest buckets first, each with the first displacement that fits. */
+int place_keys( int nslots, int nbuckets )
+{
+ unsigned long long h;
+ int count[MAX_KEYS + 1], tried[32], b, j, k, d, s;
+
+ for (b=0; b <= nbuckets; b++) count[b] = 0;
+ for (k=0; k < nkeys; k++) count[LABEL_BUCKET( fnv_hash( FNV_BASIS, keys[k], strlen( keys[k] ) ), nbuckets ) + 1]++;
+ bucket_start[0] = 0;
+ for (b=0; b < nbuckets; b++) bucket_start[b+1] = bucket_start[b] + count[b+1];
+ for (b=0; b < nbuckets; b++) count[b] = bucket_start[b];
+ for (k=0; k < nkeys; k++)
+  {
+   b = LABEL_BUCKET( fnv_hash( FNV_BASIS, keys[k], strlen( keys[k] ) ), nbuckets );
+   bucket_keys[count[b]++] = k;
+  }
+ for (b=0; b < nbuckets; b++) { order[b] = b;  disp[b] = 0; }
+ qsort( order, nbuckets, sizeof(int), by_bucket_size );
+ for (s=0; s < nslots; s++) slot_of[s] = -1;
+
+ for (j=0; j < nbuckets; j++)
+  {
+   b = order[j];
+   if (bucket_start[b+1] - bucket_start[b] > 32)
+    return 0;
+   for (d=0; d < 65536; d++)
+    {
+     for (k=bucket_start[b]; k < bucket_start[b+1]; k++)
+      {
+       h = fnv_hash( FNV_BASIS, keys[bucket_keys[k]], strlen( keys[bucket_keys[k]] ) );
+       s = LABEL_SLOT( h, (unsigned int)d, nslots );
+       if (slot_of[s] != -1) break;
+       slot_of[s] = bucket_keys[k];
+       tried[k - bucket_start[b]] = s;
+      }
+     if (k == bucket_start[b+1])
+      break;
+     while (--k >= bucket_start[b])	/* Undo this bucket's partial placement. */
+      slot_of[tried[k - bucket_start[b]]] = -1;
+    }
+   if (d == 65536)
+    return 0;
+   disp[b] = d;
+  }
+ return 1;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ FILE *out;
+ char upper[1024];
+ int nfields, nslots, nbuckets, s, b, j;
+
+ if (argc != 4)
+  { fprintf(stderr,"Usage:  make_label_hash  source.c  table_name  output_file\n");  exit(1); }
+ if (strlen( argv[2] ) > 1000)
+  { fprintf(stderr,"Error: Table name too long.\n");  exit(1); }
+ nfields = read_table( argv[1], argv[2] );
+
+ nbuckets = nkeys / 2 + 1;
+ for (nslots = nkeys + nkeys / 4 + 1; nslots <= 4 * nkeys; nslots = nslots + nkeys / 8 + 1)
+  if (place_keys( nslots, nbuckets ))
+   break;
+ if (nslots > 4 * nkeys)
+  { fprintf(stderr,"Error: Could not find a perfect hash for the %d labels of '%s'.\n", nkeys, argv[2]);  exit(1); }
+
+ for (j=0; argv[2][j] != '\0'; j++) upper[j] = toupper( argv[2][j] );
+ upper[j] = '\0';
+ out = fopen( argv[3], "w" );
+ if (out == 0)
+  { fprintf(stderr,"Error: Could not open '%s' for writing.\n", argv[3]);  exit(1); }
+ fprintf(out,"/* Generated by make_label_hash from %s[] in %s.  Do not edit. */\n\n", argv[2], argv[1]);
+ fprintf(out,"#define %s_NFIELDS\t%d\n", upper, nfields);
+ fprintf(out,"#define %s_NSLOTS\t%d\n", upper, nslots);
+ fprintf(out,"#define %s_NBUCKETS\t%d\n\n", upper, nbuckets);
+ fprintf(out,"struct label_slot %s_slots[%s_NSLOTS]={\n", argv[2], upper);
+ for (s=0; s < nslots; s++)
+  if (slot_of[s] == -1)
+   fprintf(out,"\t{ 0, 0, 0 },\n");
+  else
+   fprintf(out,"\t{ \"%s\", %d, %d },\n", keys[slot_of[s]], key_field[slot_of[s]], key_index[slot_of[s]]);
+ fprintf(out,"};\n\n");
+ fprintf(out,"unsigned short %s_disp[%s_NBUCKETS]={", argv[2], upper);
+ for (b=0; b < nbuckets; b++)
+  fprintf(out,"%s%s%u", b > 0 ? "," : "", b % 16 == 0 ? "\n\t" : " ", disp[b]);
+ fprintf(out,"\n};\n");
+ fprintf(out,"\n/* Fails to compile if %s[] no longer has the entries hashed here. */\n", argv[2]);
+ fprintf(out,"typedef char %s_entries_hashed[ (sizeof(%s) / sizeof(%s[0]) == %s_NFIELDS) ? 1 : -1 ];\n", argv[2], argv[2], argv[2], upper);
+ if (fclose( out ) != 0)
+  { fprintf(stderr,"Error: Could not write '%s'.\n", argv[3]);  exit(1); }
+ return 0;
+}
@@ -0,0 +1,67 @@
+/************************************************************************/
+/* make_tax_tables.c - Generates taxsolve_tax_tables_2021.h, the	*/
+/*  federal and California tax tables, from the rate schedules in	*/
+/*  taxsolve_tax_schedules_2021.c.  Run by the Makefile at build time:	*/
+/*	make_tax_tables  taxsolve_tax_tables_2021.h			*/
+/*  Each row carries its income range in a comment, so the output can	*/
+/*  be checked line by line against the published tables.		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+#include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+
+
+int main( int argc, char *argv[] )
+{
+ FILE *tables;
+ double lo, hi;
+ int row, j;
+
+ if (argc != 2)
+  { results_fprintf(stderr,"Usage:  make_tax_tables  output_file\n");  exit(1); }
+ tables = taxsolve_fopen( argv[1], "w" );
+ if (tables == 0)
+  { results_fprintf(stderr,"Error: Could not open '%s' for writing.\n", argv[1]);  exit(1); }
+
+ results_fprintf(tables,"/* Generated by make_tax_tables from taxsolve_tax_schedules_2021.c.  Do not edit. */\n\n");
+
+ results_fprintf(tables,"const int fed_tax_table[FED_TAX_TABLE_ROWS][4]={\n");
+ results_fprintf(tables,"\t/*  Single  Married/joint  Married/sep  Head/household       At least -  But less than */\n");
+ for (row = 0; row < FED_TAX_TABLE_ROWS; row++)
+  {
+   fed_tax_table_bounds( row, &lo, &hi );
+   if (fed_tax_table_row( lo ) != row)
+    { results_fprintf(stderr,"Error: Federal table row %d does not start at %g.\n", row, lo);  exit(1); }
+   results_fprintf(tables,"\t{");
+   for (j = 0; j < 4; j++)
+    results_fprintf(tables," %6d%s", (int)(scheduled_tax( &(fed_tax_schedules[j]), 0.5 * (lo + hi), TAX_CENTS, 0 ) + 0.5),
+	    j < 3 ? ",      " : " ");
+   results_fprintf(tables,"},\t/* %9.0f - %9.0f */\n", lo, hi );
+  }
+ results_fprintf(tables,"};\n\n");
+
+ results_fprintf(tables,"const int ca_tax_table[CA_TAX_TABLE_ROWS][3]={\n");
+ results_fprintf(tables,"\t/*  Single/sep  Joint/widow  Head/household       At least -  But not over */\n");
+ for (row = 0; row < CA_TAX_TABLE_ROWS; row++)
+  {
+   ca_tax_table_bounds( row, &lo, &hi );
+   if (ca_tax_table_row( lo ) != row)
+    { results_fprintf(stderr,"Error: California table row %d does not start at %g.\n", row, lo);  exit(1); }
+   results_fprintf(tables,"\t{");
+   for (j = 0; j < 3; j++)
+    results_fprintf(tables," %6d%s", (int)scheduled_tax( &(ca_tax_schedules[j]), ca_tax_table_midpoint( row ), TAX_DOLLARS, 0 ),
+	    j < 2 ? ",      " : " ");
+   results_fprintf(tables,"},\t/* %9.0f - %9.0f */\n", lo, hi - 1.0 );
+  }
+ results_fprintf(tables,"};\n");
+
+ if (fclose( tables ) != 0)
+  { results_fprintf(stderr,"Error: Could not write '%s'.\n", argv[1]);  exit(1); }
+ return 0;
+}
@@ -0,0 +1,267 @@
+/************************************************************************/
+/* numeric_bench.c - Checks and times the single-pass numeric scanner.	*/
+/*  Makes a few million numeric words, mostly money amounts as they	*/
+/*  appear in returns, plus integers, exponents, long digit strings	*/
+/*  and malformed entries.  Each word is checked by scan_float (and	*/
+/*  scan_int) and by the two passes they replaced:  the valid_float	*/
+/*  (valid_int) state machine, then sscanf.  Accept/reject decisions	*/
+/*  and values must agree, to the bit, except that a sign may now come	*/
+/*  before a leading point, as in -.50, which sscanf alone decides.	*/
+/*  Build and run with "make bench",					*/
+/*  or:									*/
+/*	numeric_bench  [words  [runs]]					*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+#include "taxsolve_routines.c"
+
+
+double now()
+{
+ struct timespec ts;
+ clock_gettime( CLOCK_MONOTONIC, &ts );
+ return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+/* The state machines as they were, ahead of sscanf.  (Valid_int and valid_float are now scan_int and scan_float.) */
+int old_valid_int( char *word )
+{
+ int j=0, state=0;
+ while (word[j] != '\0')
+  {
+   switch( state )
+    {
+     case 0: if ((word[j] == '-') || (word[j] == '+'))
+		state = 1;
+	     else
+	     if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 2;
+	     else
+		return 0;
+	break;
+      case 1: if ((word[j] >= '0') && (word[j] <= '9'))
+                state = 2;
+             else
+		return 0;
+	break;
+      case 2: if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 2;
+	      else
+	      if (word[j] == '.')
+		state = 3;
+	      else
+		return 0;
+	break;
+      case 3:  return 0;
+	break;
+      default:  return 0;
+    }
+   j++;
+  }
+ if (j != 0)
+  return 1;
+ else
+  return 0;
+}
+
+int old_valid_float( char *word )
+{
+ int j=0, state=0;
+ while (word[j] != '\0')
+  {
+   switch( state )
+    {
+     case 0: if ((word[j] == '-') || (word[j] == '+'))
+		state = 1;
+	     else
+	     if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 2;
+	     else
+	     if (word[j] == '.')
+		state = 3;
+	     else
+		return 0;
+	break;
+      case 1: if ((word[j] >= '0') && (word[j] <= '9'))
+                state = 2;
+             else
+		return 0;
+	break;
+      case 2: if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 2;
+	      else
+	      if (word[j] == '.')
+		state = 3;
+	      else
+	      if ((word[j] == 'e') || (word[j] == 'E'))
+		state = 4;
+	      else
+		return 0;
+	break;
+      case 3: if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 3;
+	      else
+	      if ((word[j] == 'e') || (word[j] == 'E'))
+		state = 4;
+	      else
+		return 0;
+	break;
+      case 4: if ((word[j] >= '0') && (word[j] <= '9'))
+		state = 5;
+	      else
+      	      if ((word[j] == '-') || (word[j] == '+'))
+		state = 5;
+	      else
+		return 0;
+        break;
+      case 5:  if ((word[j] >= '0') && (word[j] <= '9'))
+                state = 5;
+              else
+		return 0;
+	break;
+      default:  return 0;
+    }
+   j++;
+  }
+ if (j != 0)
+  return 1;
+ else
+  return 0;
+}
+
+
+/* The old checks, but taking a sign before a leading point (as scan_float now does). */
+int reference_float( char *word, double *value )
+{
+ int ok;
+ if (((word[0] == '-') || (word[0] == '+')) && (word[1] == '.') && (word[2] >= '0') && (word[2] <= '9'))
+  ok = old_valid_float( word + 1 );
+ else
+  ok = old_valid_float( word );
+ return ok && (sscanf( word, "%lf", value ) == 1);
+}
+
+
+/* Words are stored end to end, each one null-terminated. */
+char **words;
+int nwords;
+
+char *malformed[]={ "", "-", "+", ".", "-.", "12a", "1.2.3", "$5.00", "1,000", "--5", "5-", "e5", "1e", "1e-",
+		    "1e+7", ".5", "+.5", "-.50", "+.25", "-.5e2", "+.", "-.e1", "-..5", "0x1A", "1 2", "12.", "-0",
+		    "-0.00", "007", "NaN", "inf" };
+
+void make_words( int n )
+{
+ char *text, *pt;
+ int j, k;
+
+ words = (char **)malloc( n * sizeof(char *) );
+ text = (char *)malloc( (long)n * 48 );
+ pt = text;
+ for (j=0; j < n; j++)
+  {
+   words[j] = pt;
+   k = rand() % 100;
+   if (k < 70)		/* Money, such as 12345.67 or -800.99. */
+    sprintf( pt, "%s%d.%02d", (rand() % 4 == 0) ? "-" : "", rand() % 200000, rand() % 100 );
+   else
+   if (k < 82)		/* Whole dollars, counts and years. */
+    sprintf( pt, "%d", rand() % ((k < 76) ? 100000 : 2100) );
+   else
+   if (k < 88)		/* Exponents. */
+    sprintf( pt, "%d.%de%s%d", rand() % 1000, rand() % 1000, (rand() % 2) ? "-" : "", rand() % 40 );
+   else
+   if (k < 92)		/* More digits than the fast path takes. */
+    sprintf( pt, "%d%09d%09d.%d", 1 + rand() % 999, rand() % 1000000000, rand() % 1000000000, rand() % 100 );
+   else
+    strcpy( pt, malformed[rand() % (sizeof(malformed) / sizeof(char *))] );
+   pt = pt + strlen( pt ) + 1;
+  }
+ nwords = n;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ struct numeric_scan ns;
+ int n=4000000, runs=3, j, r, ok_old, ok_new, iv_old, bad=0;
+ long accepted;
+ double *v_old, *v_new, t, t_old=1e30, t_new=1e30, ti_old=1e30, ti_new=1e30;
+
+ if (argc > 1) n = atoi( argv[1] );
+ if (argc > 2) runs = atoi( argv[2] );
+ if ((n < 1) || (runs < 1))
+  { console_printf("Usage:  numeric_bench  [words  [runs]]\n");  exit(1); }
+ srand( 2021 );
+ make_words( n );
+ v_old = (double *)malloc( n * sizeof(double) );
+ v_new = (double *)malloc( n * sizeof(double) );
+
+ for (j=0; j < n; j++)	/* Check every word. */
+  {
+   ok_old = reference_float( words[j], &(v_old[j]) );
+   ok_new = scan_float( words[j], &ns );
+   if ((ok_old != ok_new) || (ok_old && (memcmp( &(v_old[j]), &(ns.value), sizeof(double) ) != 0)))
+    {
+     if (bad < 5)
+      console_printf("   Float mismatch on '%s':  %d %.17g, scan_float %d %.17g\n", words[j], ok_old, v_old[j], ok_new, ns.value );
+     bad++;
+    }
+   if (strlen( words[j] ) < 10)		/* (Longer ones are out of int range, which sscanf does not catch.) */
+    {
+     ok_old = old_valid_int( words[j] ) && (sscanf( words[j], "%d", &iv_old ) == 1);
+     ok_new = scan_int( words[j], &ns );
+     if ((ok_old != ok_new) || (ok_old && (iv_old != ns.ivalue)))
+      {
+       if (bad < 5)
+        console_printf("   Int mismatch on '%s':  %d %d, scan_int %d %d\n", words[j], ok_old, iv_old, ok_new, ns.ivalue );
+       bad++;
+      }
+    }
+  }
+
+ for (r=0; r < runs; r++)	/* Then time each way, best of the runs. */
+  {
+   t = now();
+   for (j=0; j < n; j++)
+    if (!(old_valid_float( words[j] ) && (sscanf( words[j], "%lf", &(v_old[j]) ) == 1)))
+     v_old[j] = 0.0;
+   t = now() - t;
+   if (t < t_old) t_old = t;
+   t = now();
+   accepted = 0;
+   for (j=0; j < n; j++)
+    if (scan_float( words[j], &ns ))
+     { v_new[j] = ns.value;  accepted++; }
+    else
+     v_new[j] = 0.0;
+   t = now() - t;
+   if (t < t_new) t_new = t;
+   t = now();
+   for (j=0; j < n; j++)
+    if (!(old_valid_int( words[j] ) && (sscanf( words[j], "%d", &iv_old ) == 1)))
+     iv_old = 0;
+   t = now() - t;
+   if (t < ti_old) ti_old = t;
+   t = now();
+   for (j=0; j < n; j++)
+    scan_int( words[j], &ns );
+   t = now() - t;
+   if (t < ti_new) ti_new = t;
+  }
+
+ console_printf("%d words, %ld valid decimal values.  Best of %d runs.\n\n", n, accepted, runs );
+ console_printf("valid_float + sscanf:  %7.1f ms    scan_float:  %7.1f ms   %5.1fx\n", 1e3 * t_old, 1e3 * t_new, t_old / t_new );
+ console_printf("valid_int + sscanf:    %7.1f ms    scan_int:    %7.1f ms   %5.1fx\n", 1e3 * ti_old, 1e3 * ti_new, ti_old / ti_new );
+ if (bad)
+  console_printf("\n%d words are scanned differently.\n", bad);
+ else
+  console_printf("\nEvery word is scanned the same both ways.\n");
+ return bad != 0;
+}
@@ -0,0 +1,179 @@
+/************************************************************************/
+/* Ots_Compile.c - Converts a tax-input file into a compiled return	*/
+/*  (".otsb"), which the tax programs read without re-tokenizing or	*/
+/*  re-converting its values, or converts a compiled return back into	*/
+/*  its original text.  The format is described with the Compiled	*/
+/*  Returns section of taxsolve_routines.c.				*/
+/*									*/
+/* Usage:								*/
+/*  ots_compile  return.txt   [-o return.otsb]				*/
+/*  ots_compile  return.otsb  [-o return.txt]				*/
+/*									*/
+/* Compile:								*/
+/*  cc ots_compile.c -o ../bin/ots_compile				*/
+/*									*/
+/* Documentation & Updates:						*/
+/*        http://opentaxsolver.sourceforge.net/				*/
+/*									*/
+/* GNU Public License - GPL:						*/
+/* This program is free software; you can redistribute it and/or	*/
+/* modify it under the terms of the GNU General Public License as	*/
+/* published by the Free Software Foundation; either version 2 of the	*/
+/* License, or (at your option) any later version.			*/
+/* 									*/
+/* This program is distributed in the hope that it will be useful,	*/
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of	*/
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU	*/
+/* General Public License for more details.				*/
+/* 									*/
+/* You should have received a copy of the GNU General Public License	*/
+/* along with this program; if not, write to the Free Software		*/
+/* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA		*/
+/* 02111-1307 USA							*/
+/************************************************************************/
+
+float thisversion=1.00;
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "taxsolve_routines.c"
+
+
+void write_section( FILE *outf, void *data, unsigned long len, unsigned long offset )
+{
+ static char zeros[16];
+ while ((unsigned long)ftell( outf ) < offset)	/* Pad for alignment. */
+  fwrite( zeros, 1, 1, outf );
+ if ((len > 0) && (fwrite( data, 1, len, outf ) != len))
+  { console_printf("Error: Could not write compiled return.\n");  exit(1); }
+}
+
+
+int compile_return( char *infname, char *outfname )
+{
+ FILE *fp, *outf;
+ struct input_buffer *ib, unbuffered;
+ struct otsb_header *hdr;
+ char *image;
+ long len;
+
+ fp = taxsolve_fopen( infname, "r" );
+ if (fp == 0)
+  { console_printf("Error: Cannot open '%s' for reading.\n", infname );  return 1; }
+ ib = get_input_buffer( fp, &unbuffered );
+ if (ib == &unbuffered)
+  { console_printf("Error: '%s' is empty, or is not a regular file.\n", infname );  return 1; }
+ image = compile_input( fp, &len );
+ if (image == 0)
+  { console_printf("Error: '%s' is too large to compile.\n", infname );  return 1; }
+ hdr = (struct otsb_header *)image;
+
+ outf = taxsolve_fopen( outfname, "wb" );
+ if (outf == 0)
+  { console_printf("Error: Cannot open '%s' for writing.\n", outfname );  return 1; }
+ write_section( outf, image, len, 0 );
+ if (fclose( outf ) != 0)
+  { console_printf("Error: Could not write '%s'.\n", outfname );  return 1; }
+ console_printf("Compiled '%s' to '%s': %d tokens, %d markups.\n", infname, outfname, hdr->ntokens, hdr->nmarkups );
+ fclose( fp );
+ free( image );
+ return 0;
+}
+
+
+int decompile_return( char *infname, char *outfname )
+{
+ FILE *fp, *outf;
+ struct input_buffer *ib, unbuffered;
+
+ fp = taxsolve_fopen( infname, "rb" );
+ if (fp == 0)
+  { console_printf("Error: Cannot open '%s' for reading.\n", infname );  return 1; }
+ ib = get_input_buffer( fp, &unbuffered );	/* Checks the header. */
+ outf = taxsolve_fopen( outfname, "wb" );
+ if (outf == 0)
+  { console_printf("Error: Cannot open '%s' for writing.\n", outfname );  return 1; }
+ write_section( outf, ib->data, ib->len, 0 );
+ if (fclose( outf ) != 0)
+  { console_printf("Error: Could not write '%s'.\n", outfname );  return 1; }
+ console_printf("Decompiled '%s' to '%s'.\n", infname, outfname );
+ fclose( fp );
+ return 0;
+}
+
+
+/* True when the file starts with the compiled-return magic. */
+int is_compiled_return( char *fname )
+{
+ FILE *fp;
+ char magic[OTSB_MAGIC_LEN];
+ int n;
+ fp = taxsolve_fopen( fname, "rb" );
+ if (fp == 0) return 0;
+ n = fread( magic, 1, OTSB_MAGIC_LEN, fp );
+ fclose( fp );
+ return (n == OTSB_MAGIC_LEN) && (memcmp( magic, OTSB_MAGIC, OTSB_MAGIC_LEN ) == 0);
+}
+
+
+int main( int argc, char *argv[] )
+{
+ char *infname=0, outfname[4096]="";
+ int i=1, j, compiled;
+ FILE *fp;
+
+ console_printf("Ots_Compile v%3.2f\n", thisversion);
+ while (i < argc)
+  {
+   if ((strcmp( argv[i], "-o" ) == 0) && (i + 1 < argc))
+    {
+     i++;
+     if (strlen( argv[i] ) >= sizeof(outfname))
+      { console_printf("Error: Output file-name too long.\n");  exit(1); }
+     strcpy( outfname, argv[i] );
+    }
+   else
+   if ((infname == 0) && (argv[i][0] != '-'))
+    infname = argv[i];
+   else
+    { console_printf("Unknown command-line parameter '%s'\n", argv[i]);  exit(1); }
+   i++;
+  }
+ if (infname == 0)
+  {
+   console_printf("Usage:  ots_compile  return.txt   [-o return.otsb]	(compile)\n");
+   console_printf("        ots_compile  return.otsb  [-o return.txt]	(decompile)\n");
+   exit(1);
+  }
+ if (strlen( infname ) + 6 >= sizeof(outfname))
+  { console_printf("Error: Input file-name too long.\n");  exit(1); }
+
+ compiled = is_compiled_return( infname );
+ if (outfname[0] == '\0')
+  { /* Replace the extension, if any. */
+   strcpy( outfname, infname );
+   j = strlen( outfname ) - 1;
+   while ((j >= 0) && (outfname[j] != '.') && (outfname[j] != '/') && (outfname[j] != '\\')) j--;
+   if ((j < 0) || (outfname[j] != '.')) j = strlen( outfname );
+   strcpy( &(outfname[j]), compiled ? ".txt" : ".otsb" );
+   if (compiled)
+    { /* Do not silently replace the template the return was compiled from. */
+     fp = taxsolve_fopen( outfname, "r" );
+     if (fp != 0)
+      {
+       fclose( fp );
+       console_printf("Error: '%s' already exists.  Name the output with -o.\n", outfname );
+       exit(1);
+      }
+    }
+  }
+ if (strcmp( infname, outfname ) == 0)
+  { console_printf("Error: Output file would replace the input file.\n");  exit(1); }
+
+ if (compiled)
+  return decompile_return( infname, outfname );
+ else
+  return compile_return( infname, outfname );
+}
@@ -0,0 +1,658 @@
+/************************************************************************/
+/* Ots_Household.c - Computes all the returns of a household, and	*/
+/*  fills-out their PDF forms, from a short manifest.  Each manifest	*/
+/*  line names a form and its input file, such as:			*/
+/*	US_1040   tax_form_files/US_1040/US_1040_example.txt		*/
+/*	CA_540    tax_form_files/CA_540/CA_540_2021_example.txt		*/
+/*  A return whose input names another return's output file (as the	*/
+/*  states' FileName or FedReturn lines name the federal results)	*/
+/*  waits for that return.  Returns that do not wait on one another,	*/
+/*  and the PDFs, are computed at the same time, on a pool of worker	*/
+/*  threads.  The signature of each job's inputs is kept in a state	*/
+/*  file beside the manifest (household.txt -> household_state.txt),	*/
+/*  so that a later run re-does only jobs whose inputs changed.		*/
+/*  Paths are taken as relative to the current directory, as with	*/
+/*  the tax programs themselves.  The tax programs and the PDF tool	*/
+/*  are run from the directory holding this program.			*/
+/*									*/
+/* Usage:								*/
+/*  ots_household  [-j threads]  [-nopdf]  [-force]  household.txt	*/
+/*									*/
+/* Compile:								*/
+/*  cc ots_household.c -o ../bin/ots_household -lpthread		*/
+/*									*/
+/* Documentation & Updates:						*/
+/*        http://opentaxsolver.sourceforge.net/				*/
+/*									*/
+/* GNU Public License - GPL:						*/
+/* This program is free software; you can redistribute it and/or	*/
+/* modify it under the terms of the GNU General Public License as	*/
+/* published by the Free Software Foundation; either version 2 of the	*/
+/* License, or (at your option) any later version.			*/
+/* 									*/
+/* This program is distributed in the hope that it will be useful,	*/
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of	*/
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU	*/
+/* General Public License for more details.				*/
+/* 									*/
+/* You should have received a copy of the GNU General Public License	*/
+/* along with this program; if not, write to the Free Software		*/
+/* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA		*/
+/* 02111-1307 USA							*/
+/************************************************************************/
+
+float thisversion=1.00;
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef __MINGW32__
+ #include <process.h>
+ #define NULL_DEVICE "NUL"
+#else
+ #include <sys/wait.h>
+ #define NULL_DEVICE "/dev/null"
+#endif
+
+#include "string_routines.c"
+
+#define MAX_JOBS	256
+#define MAX_THREADS	64
+
+
+/* The forms a manifest may name:  tax-form directory, program, and PDF form-data. */
+struct household_form
+ {
+  char *name, *program, *pdfdata;
+ } household_forms[]=
+ {
+  { "US_1040",		"taxsolve_US_1040_2021",	"f1040" },
+  { "US_1040_Sched_C",	"taxsolve_US_1040_Sched_C_2021", "f1040sc" },
+  { "US_1040_Sched_SE",	"taxsolve_US_1040_Sched_SE_2021", "f1040sse" },
+  { "HSA_Form_8889",	"taxsolve_HSA_f8889",		"f8889" },
+  { "Form_8606",	"taxsolve_f8606",		"f8606" },
+  { "Form_8959",	"taxsolve_f8959_2021",		"f8959" },
+  { "Form_8960",	"taxsolve_f8960_2021",		"f8960" },
+  { "Form_2210",	"taxsolve_f2210_2021",		"f2210" },
+  { "CA_540",		"taxsolve_CA_540_2021",		"CA_540" },
+  { "Form_CA_5805",	"taxsolve_CA_5805_2021",	"CA_5805" },
+  { "MA_1",		"taxsolve_MA_1_2021",		"MA_1" },
+  { "NC_D400",		"taxsolve_NC_D400_2021",	"NC" },
+  { "NJ_1040",		"taxsolve_NJ_1040_2021",	"NJ_1040" },
+  { "NY_IT201",		"taxsolve_NY_IT201_2021",	"NY_it201" },
+  { "OH_IT1040",	"taxsolve_OH_IT1040_2021",	"OH_PIT_IT1040" },
+  { "PA_40",		"taxsolve_PA_40_2021",		"PA_40" },
+  { "VA_760",		"taxsolve_VA_760_2021",		"VA_760" },
+  { 0, 0, 0 }
+ };
+
+
+#define JOB_RETURN	0
+#define JOB_PDF		1
+
+#define JOB_WAITING	0
+#define JOB_READY	1
+#define JOB_RUNNING	2
+#define JOB_DONE	3	/* Ran, and succeeded. */
+#define JOB_CURRENT	4	/* Its inputs had not changed, so it was not run. */
+#define JOB_FAILED	5
+#define JOB_BLOCKED	6	/* Not run, because a job it waits on failed. */
+
+struct job
+ {
+  int kind, form;
+  char *name;			/* As shown, and as kept in the state file. */
+  char *input, *output;
+  int ndeps, deps[MAX_JOBS];	/* The jobs whose outputs this one reads. */
+  int nwaiting, blocked;	/* Deps not yet finished, and whether any failed. */
+  int status;
+  unsigned long long signature, last_signature;
+  int had_last_signature;
+ } jobs[MAX_JOBS];
+int njobs=0;
+
+char *bindir, *formdatadir;
+int force=0;
+
+pthread_mutex_t job_lock=PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t job_change=PTHREAD_COND_INITIALIZER;
+#ifdef __MINGW32__
+ pthread_mutex_t spawn_lock=PTHREAD_MUTEX_INITIALIZER;
+#endif
+int nfinished=0;
+
+
+void convert_slashes( char *fname )
+{ /* Convert slashes in file name based on machine type. */
+  char *ptr;
+ #ifdef __MINGW32__
+  char slash_sreach='/', slash_replace='\\';
+ #else
+  char slash_sreach='\\', slash_replace='/';
+ #endif
+  ptr = strchr( fname, slash_sreach );
+  while (ptr)
+   {
+    ptr[0] = slash_replace;
+    ptr = strchr( fname, slash_sreach );
+   }
+}
+
+
+char *join_path( char *dir, char *name, char *suffix )
+{
+ char *path;
+ path = (char *)malloc( strlen( dir ) + strlen( name ) + strlen( suffix ) + 1 );
+ strcpy( path, dir );
+ strcat( path, name );
+ strcat( path, suffix );
+ return path;
+}
+
+
+/* Output file-name, as the tax programs form it:  xxx.txt -> xxx_out.txt */
+char *with_suffix( char *fname, char *suffix )
+{
+ char *newname;
+ int j;
+
+ newname = join_path( fname, "", suffix );
+ j = strlen( fname ) - 1;
+ while ((j >= 0) && (fname[j] != '.')) j--;
+ if (j >= 0)
+  strcpy( &(newname[j]), suffix );
+ return newname;
+}
+
+
+/* Fold a file's size and time (or its absence) into a signature. */
+unsigned long long hash_stat( unsigned long long h, char *fname )
+{
+ struct stat st;
+ long long v[2]={ -1, -1 };
+
+ if (stat( fname, &st ) == 0)
+  { v[0] = st.st_size;  v[1] = st.st_mtime; }
+ return fnv_hash( h, v, sizeof(v) );
+}
+
+
+/* Fold a file's contents (or its absence) into a signature. */
+unsigned long long hash_contents( unsigned long long h, char *fname )
+{
+ FILE *fp;
+ unsigned char buf[65536], absent=0xff;
+ int n;
+
+ fp = fopen( fname, "rb" );
+ if (fp == 0)
+  return fnv_hash( h, &absent, 1 );
+ while ((n = fread( buf, 1, sizeof(buf), fp )) > 0)
+  h = fnv_hash( h, buf, n );
+ fclose( fp );
+ return h;
+}
+
+
+/* Fold a return's results into a signature, leaving out its Title line, which	*/
+/* carries the time it was computed.  So a return re-computed to the same results	*/
+/* does not make those waiting on it run again.  (The Title is near the top.)	*/
+unsigned long long hash_results( unsigned long long h, char *fname )
+{
+ FILE *fp;
+ unsigned char buf[65536], absent=0xff;
+ int n, j, k, first=1;
+
+ fp = fopen( fname, "rb" );
+ if (fp == 0)
+  return fnv_hash( h, &absent, 1 );
+ while ((n = fread( buf, 1, sizeof(buf), fp )) > 0)
+  {
+   j = k = 0;
+   if (first)
+    { /* Hash around the first line starting "Title:". */
+     while ((j + 6 <= n) && (((j > 0) && (buf[j-1] != '\n')) || (strncmp( (char *)buf + j, "Title:", 6 ) != 0)))
+      j++;
+     if (j + 6 > n)
+      j = n;
+     for (k=j; (k < n) && (buf[k] != '\n'); k++);
+     h = fnv_hash( h, buf, j );
+     first = 0;
+    }
+   h = fnv_hash( h, buf + k, n - k );
+  }
+ fclose( fp );
+ return h;
+}
+
+
+unsigned long long job_signature( struct job *jb )
+{
+ unsigned long long h=fnv_hash( FNV_BASIS, jb->name, strlen( jb->name ) );
+ char *path[3];
+ int j;
+
+ if (jb->kind == JOB_RETURN)
+  {
+   path[0] = join_path( bindir, household_forms[jb->form].program, "" );
+   path[1] = path[2] = 0;
+   h = hash_stat( h, path[0] );
+   h = hash_contents( h, jb->input );
+   for (j=0; j < jb->ndeps; j++)
+    h = hash_results( h, jobs[jb->deps[j]].output );
+  }
+ else
+  {
+   path[0] = join_path( bindir, "universal_pdf_file_modifier", "" );
+   path[1] = join_path( formdatadir, household_forms[jb->form].pdfdata, "_meta.dat" );
+   path[2] = join_path( formdatadir, household_forms[jb->form].pdfdata, "_pdf.dat" );
+   for (j=0; j < 3; j++)
+    h = hash_stat( h, path[j] );
+   h = hash_contents( h, jb->input );
+  }
+ for (j=0; j < 3; j++)
+  free( path[j] );
+ return h;
+}
+
+
+/* Run a program with the given arguments (argv[0] being the program), with its	*/
+/* messages discarded.  Returns its exit status, or -1 if it could not be run.	*/
+int run_command( char *argv[] )
+{
+ #ifdef __MINGW32__
+  char *quoted[16];	/* Spawnv joins the arguments into one command line, so quote them. */
+  int saved_out, saved_err, devnull, status, j;
+
+  for (j=0; argv[j] != 0; j++)
+   quoted[j] = join_path( "\"", argv[j], "\"" );
+  quoted[j] = 0;
+  pthread_mutex_lock( &spawn_lock );	/* The redirection is process-wide. */
+  fflush( stdout );
+  saved_out = dup( 1 );
+  saved_err = dup( 2 );
+  devnull = open( NULL_DEVICE, O_WRONLY );
+  dup2( devnull, 1 );
+  dup2( devnull, 2 );
+  status = _spawnv( _P_WAIT, argv[0], (const char * const *)quoted );
+  dup2( saved_out, 1 );
+  dup2( saved_err, 2 );
+  close( devnull );  close( saved_out );  close( saved_err );
+  pthread_mutex_unlock( &spawn_lock );
+  for (j=0; quoted[j] != 0; j++)
+   free( quoted[j] );
+  return status;
+ #else
+  pid_t pid;
+  int status, devnull;
+
+  pid = fork();
+  if (pid == 0)
+   { /* Child:  only async-signal-safe calls, since other threads may hold locks. */
+    devnull = open( NULL_DEVICE, O_WRONLY );
+    if (devnull >= 0)
+     { dup2( devnull, 1 );  dup2( devnull, 2 ); }
+    execv( argv[0], argv );
+    _exit( 127 );		/* As the shell reports a program it could not run. */
+   }
+  if (pid < 0)
+   return -1;
+  while (waitpid( pid, &status, 0 ) < 0)
+   if (errno != EINTR)
+    return -1;
+  if (WIFEXITED( status ))
+   return WEXITSTATUS( status );
+  return 128 + WTERMSIG( status );	/* As the shell reports a signal. */
+ #endif
+}
+
+
+void run_job( struct job *jb )
+{
+ char *argv[8], *metafile=0, *pdffile=0;
+ FILE *fp;
+ int status;
+
+ jb->signature = job_signature( jb );
+ fp = fopen( jb->output, "rb" );
+ if (fp != 0) fclose( fp );
+ if ((!force) && (fp != 0) && jb->had_last_signature && (jb->signature == jb->last_signature))
+  {
+   jb->status = JOB_CURRENT;
+   printf(" Current:   %s\n", jb->name );
+   return;
+  }
+ printf(" Running:   %s\n", jb->name );
+ if (jb->kind == JOB_RETURN)
+  {
+   argv[0] = join_path( bindir, household_forms[jb->form].program, "" );
+   argv[1] = "-quiet";
+   argv[2] = jb->input;
+   argv[3] = 0;
+  }
+ else
+  {
+   metafile = join_path( formdatadir, household_forms[jb->form].pdfdata, "_meta.dat" );
+   pdffile = join_path( formdatadir, household_forms[jb->form].pdfdata, "_pdf.dat" );
+   argv[0] = join_path( bindir, "universal_pdf_file_modifier", "" );
+   argv[1] = metafile;
+   argv[2] = jb->input;
+   argv[3] = pdffile;
+   argv[4] = "-o";
+   argv[5] = jb->output;
+   argv[6] = 0;
+  }
+ status = run_command( argv );
+ fp = fopen( jb->output, "rb" );
+ if (fp != 0) fclose( fp );
+ if ((status != 0) || (fp == 0))
+  {
+   jb->status = JOB_FAILED;
+   printf(" FAILED:    %s  (exit status %d)\n", jb->name, status );
+  }
+ else
+  jb->status = JOB_DONE;
+ free( argv[0] );
+ free( metafile );
+ free( pdffile );
+}
+
+
+/* With job_lock held:  Release the jobs waiting on a finished one. */
+void finish_job( int k )
+{
+ int j, d;
+
+ nfinished++;
+ for (j=0; j < njobs; j++)
+  for (d=0; d < jobs[j].ndeps; d++)
+   if (jobs[j].deps[d] == k)
+    {
+     if ((jobs[k].status == JOB_FAILED) || (jobs[k].status == JOB_BLOCKED))
+      jobs[j].blocked = 1;
+     jobs[j].nwaiting--;
+     if (jobs[j].nwaiting == 0)
+      {
+       if (jobs[j].blocked)
+	{
+	 jobs[j].status = JOB_BLOCKED;
+	 printf(" Skipped:   %s  (an input failed)\n", jobs[j].name );
+	 finish_job( j );
+	}
+       else
+	jobs[j].status = JOB_READY;
+      }
+    }
+}
+
+
+void *worker( void *arg )
+{
+ int k;
+
+ pthread_mutex_lock( &job_lock );
+ while (nfinished < njobs)
+  {
+   for (k=0; (k < njobs) && (jobs[k].status != JOB_READY); k++);
+   if (k == njobs)
+    {
+     pthread_cond_wait( &job_change, &job_lock );
+     continue;
+    }
+   jobs[k].status = JOB_RUNNING;
+   pthread_mutex_unlock( &job_lock );
+   run_job( &(jobs[k]) );
+   pthread_mutex_lock( &job_lock );
+   finish_job( k );
+   pthread_cond_broadcast( &job_change );
+  }
+ pthread_mutex_unlock( &job_lock );
+ return 0;
+}
+
+
+int add_job( int kind, int form, char *input, char *output )
+{
+ char *name;
+
+ if (njobs == MAX_JOBS)
+  { printf("Error: More than %d jobs in the household.\n", MAX_JOBS);  exit(1); }
+ name = (char *)malloc( strlen( household_forms[form].name ) + strlen( input ) + 16 );
+ sprintf( name, "%s %s %s", kind == JOB_RETURN ? "Return" : "PDF", household_forms[form].name, input );
+ memset( &(jobs[njobs]), 0, sizeof(struct job) );
+ jobs[njobs].kind = kind;
+ jobs[njobs].form = form;
+ jobs[njobs].name = name;
+ jobs[njobs].input = input;
+ jobs[njobs].output = output;
+ return njobs++;
+}
+
+
+void add_dep( int k, int dep )
+{
+ int d;
+ for (d=0; d < jobs[k].ndeps; d++)
+  if (jobs[k].deps[d] == dep) return;
+ jobs[k].deps[ jobs[k].ndeps++ ] = dep;
+}
+
+
+/* A return waits on each other return whose output file its input names (outside of comments). */
+void find_return_deps( int k )
+{
+ FILE *fp;
+ char word[4096], *name;
+ int c, n, incomment=0, j;
+
+ fp = fopen( jobs[k].input, "r" );
+ if (fp == 0)
+  return;	/* Reported when it runs. */
+ do
+  {
+   n = 0;
+   c = getc( fp );
+   while ((c != EOF) && (incomment || (c == '{') || isspace( c )))
+    {
+     if (c == '{') incomment = 1;  else  if (c == '}') incomment = 0;
+     c = getc( fp );
+    }
+   while ((c != EOF) && (c != '{') && !isspace( c ))
+    {
+     if (n < (int)sizeof(word) - 1) word[n++] = c;
+     c = getc( fp );
+    }
+   if (c == '{') incomment = 1;
+   word[n] = '\0';
+   name = word;
+   while (strncmp( name, "./", 2 ) == 0) name = name + 2;
+   convert_slashes( name );
+   for (j=0; j < njobs; j++)
+    if ((j != k) && (jobs[j].kind == JOB_RETURN) && (n > 0) && (strcmp( name, jobs[j].output ) == 0))
+     add_dep( k, j );
+  }
+ while (c != EOF);
+ fclose( fp );
+}
+
+
+void read_manifest( char *fname, int nopdf )
+{
+ FILE *fp;
+ char line[8192], formname[4096], input[4096], *pt;
+ int form, j, k, nreturns;
+
+ fp = fopen( fname, "r" );
+ if (fp == 0)
+  { printf("Error: Could not open household manifest '%s'.\n", fname);  exit(1); }
+ while (fgets( line, sizeof(line), fp ) != 0)
+  {
+   pt = strchr( line, '{' );	/* Comments, on one line. */
+   if (pt != 0) *pt = '\0';
+   pt = scan_word( line, formname, " \t\r\n" );
+   if (formname[0] == '\0') continue;
+   scan_quoted_word( pt, input, " \t\r\n" );
+   if (input[0] == '\0')
+    { printf("Error: No input file for '%s' in '%s'.\n", formname, fname);  exit(1); }
+   for (form=0; (household_forms[form].name != 0) && (strcmp( household_forms[form].name, formname ) != 0); form++);
+   if (household_forms[form].name == 0)
+    { printf("Error: Unknown form '%s' in '%s'.\n", formname, fname);  exit(1); }
+   pt = input;
+   while (strncmp( pt, "./", 2 ) == 0) pt = pt + 2;
+   convert_slashes( pt );
+   add_job( JOB_RETURN, form, strdup( pt ), with_suffix( pt, "_out.txt" ) );
+  }
+ fclose( fp );
+ if (njobs == 0)
+  { printf("Error: No returns in '%s'.\n", fname);  exit(1); }
+
+ nreturns = njobs;
+ for (k=0; k < nreturns; k++)
+  for (j=0; j < k; j++)
+   if (strcmp( jobs[j].output, jobs[k].output ) == 0)
+    { printf("Error: '%s' is in '%s' twice.\n", jobs[k].input, fname);  exit(1); }
+ for (k=0; k < nreturns; k++)
+  find_return_deps( k );
+ if (!nopdf)
+  for (k=0; k < nreturns; k++)
+   {
+    j = add_job( JOB_PDF, jobs[k].form, jobs[k].output, with_suffix( jobs[k].output, ".pdf" ) );
+    add_dep( j, k );
+   }
+}
+
+
+/* Fail on returns that wait on one another in a loop, which would never start. */
+void check_for_cycles()
+{
+ int waiting[MAX_JOBS], done[MAX_JOBS], j, d, k, progress;
+
+ for (k=0; k < njobs; k++) { waiting[k] = jobs[k].ndeps;  done[k] = 0; }
+ do
+  {
+   progress = 0;
+   for (k=0; k < njobs; k++)
+    if ((!done[k]) && (waiting[k] == 0))
+     {
+      done[k] = 1;  progress = 1;
+      for (j=0; j < njobs; j++)
+       for (d=0; d < jobs[j].ndeps; d++)
+	if (jobs[j].deps[d] == k) waiting[j]--;
+     }
+  }
+ while (progress);
+ for (k=0; k < njobs; k++)
+  if (!done[k])
+   { printf("Error: '%s' waits on itself, through the files its input names.\n", jobs[k].name);  exit(1); }
+}
+
+
+void read_state( char *statename )
+{
+ FILE *fp;
+ char line[16384], name[16384], *pt;
+ unsigned long long sig;
+ int k;
+
+ fp = fopen( statename, "r" );
+ if (fp == 0)
+  return;	/* First run. */
+ while (fgets( line, sizeof(line), fp ) != 0)
+  {
+   if (sscanf( line, "%llx", &sig ) != 1) continue;
+   pt = strchr( line, ' ' );
+   if (pt == 0) continue;
+   strcpy( name, pt + 1 );
+   pt = strchr( name, '\n' );
+   if (pt != 0) *pt = '\0';
+   for (k=0; k < njobs; k++)
+    if (strcmp( jobs[k].name, name ) == 0)
+     { jobs[k].last_signature = sig;  jobs[k].had_last_signature = 1; }
+  }
+ fclose( fp );
+}
+
+
+/* Keep the signatures of the jobs now up to date.  Failed or skipped ones will run again. */
+void write_state( char *statename )
+{
+ FILE *fp;
+ int k;
+
+ fp = fopen( statename, "w" );
+ if (fp == 0)
+  { printf("Warning: Could not write '%s'.\n", statename);  return; }
+ for (k=0; k < njobs; k++)
+  if ((jobs[k].status == JOB_DONE) || (jobs[k].status == JOB_CURRENT))
+   fprintf(fp,"%016llx %s\n", jobs[k].signature, jobs[k].name );
+ fclose( fp );
+}
+
+
+int main( int argc, char *argv[] )
+{
+ pthread_t threads[MAX_THREADS];
+ char *manifest=0, *statename, *pt;
+ int nthreads=0, nopdf=0, argk, k, counts[7]={ 0, 0, 0, 0, 0, 0, 0 };
+
+ for (argk=1; argk < argc; argk++)
+  if ((strcmp( argv[argk], "-j" ) == 0) && (argk + 1 < argc))
+   nthreads = atoi( argv[++argk] );
+  else
+  if (strcmp( argv[argk], "-nopdf" ) == 0)
+   nopdf = 1;
+  else
+  if (strcmp( argv[argk], "-force" ) == 0)
+   force = 1;
+  else
+  if ((argv[argk][0] != '-') && (manifest == 0))
+   manifest = argv[argk];
+  else
+   { printf("Error: Unexpected argument '%s'.\n", argv[argk]);  manifest = 0;  break; }
+ if (manifest == 0)
+  { printf("Usage:  ots_household  [-j threads]  [-nopdf]  [-force]  household.txt\n");  exit(1); }
+
+ /* The tax programs are beside this one, and the form-data in ../src/formdata from there. */
+ bindir = strdup( argv[0] );
+ convert_slashes( bindir );
+ pt = strrchr( bindir, '/' );
+ if (pt == 0) pt = strrchr( bindir, '\\' );
+ if (pt != 0) pt[1] = '\0';  else  bindir[0] = '\0';
+ formdatadir = join_path( bindir, "", "../src/formdata/" );
+ convert_slashes( formdatadir );
+
+ read_manifest( manifest, nopdf );
+ check_for_cycles();
+ statename = with_suffix( manifest, "_state.txt" );
+ read_state( statename );
+
+ #ifdef _SC_NPROCESSORS_ONLN
+  if (nthreads < 1) nthreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+ #endif
+ if (nthreads < 1) nthreads = 1;
+ if (nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+ for (k=0; k < njobs; k++)
+  {
+   jobs[k].nwaiting = jobs[k].ndeps;
+   if (jobs[k].ndeps == 0) jobs[k].status = JOB_READY;
+  }
+ printf("Household '%s':  %d jobs, on %d threads.\n", manifest, njobs, nthreads );
+ for (k=0; k < nthreads; k++)
+  if (pthread_create( &(threads[k]), 0, worker, 0 ) != 0)
+   { printf("Error: Could not start thread %d.\n", k);  exit(1); }
+ for (k=0; k < nthreads; k++)
+  pthread_join( threads[k], 0 );
+
+ write_state( statename );
+ for (k=0; k < njobs; k++)
+  counts[ jobs[k].status ]++;
+ printf("Done:  %d run, %d current, %d failed, %d skipped.\n",
+	counts[JOB_DONE], counts[JOB_CURRENT], counts[JOB_FAILED], counts[JOB_BLOCKED] );
+ return (counts[JOB_FAILED] + counts[JOB_BLOCKED]) != 0;
+}
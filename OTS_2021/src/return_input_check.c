@@ -0,0 +1,400 @@
+/************************************************************************/
+/* return_input_check.c - Checks that the 1040 computes the same return	*/
+/*  however its input is given:						*/
+/*   - A -sensitivity point, against the return with its line edited	*/
+/*     by the same shift.  The return holds a Form 8960 section, which	*/
+/*     takes the 1040's AGI, so must be re-computed at each point.	*/
+/*   - A compiled return holding sub-form sections, against its text.	*/
+/*   - A 1099-B file read by -1099b, against its lots typed into the	*/
+/*     return.  The file has quoted fields, one across two lines,	*/
+/*     amounts as "$1,234.50" and "(12.00)", year-first dates, and a	*/
+/*     lot for each 8949 box.						*/
+/*  Built from the 1040 example and the sub-forms' examples.  Run by	*/
+/*  "make check", or:							*/
+/*	return_input_check  [tax_form_files directory]			*/
+/************************************************************************/
+
+#define main solver_main
+#include "taxsolve_US_1040_2021.c"
+#undef main
+
+char work_dir[]="/tmp/ots_input_checkXXXXXX";
+char *forms_dir="../tax_form_files";
+int nchecked=0, bad=0;
+
+
+char *read_text( char *fname )	/* Caller frees.  Returns zero if fname cannot be read. */
+{
+ long len;
+ char *data, *text;
+
+ data = read_whole_file( fname, &len );
+ if (data == 0)
+  return 0;
+ text = (char *)malloc( len + 1 );
+ memcpy( text, data, len );
+ text[len] = '\0';
+ free( data );
+ return text;
+}
+
+
+char *read_form_file( char *form, char *name )	/* A file of tax_form_files/form.  Exits if missing. */
+{
+ char fname[4096], *text;
+
+ sprintf( fname, "%.2000s/%.100s/%.100s", forms_dir, form, name );
+ text = read_text( fname );
+ if (text == 0)
+  { results_fprintf(stdout,"Error: Could not read '%s'.\n", fname );  exit(1); }
+ return text;
+}
+
+
+void write_text( char *fname, char *text )
+{
+ FILE *fp;
+
+ fp = taxsolve_fopen( fname, "w" );
+ if ((fp == 0) || (fputs( text, fp ) < 0) || (fclose( fp ) != 0))
+  { results_fprintf(stdout,"Error: Could not write '%s'.\n", fname );  exit(1); }
+}
+
+
+/* Compute the return in infname, with any options before it.  Returns its status. */
+int compute( char *option1, char *option2, char *option3, char *infname )
+{
+ char *argv[8];
+ int argc=0;
+
+ argv[argc++] = "taxsolve_US_1040_2021";
+ argv[argc++] = "-quiet";
+ if (option1 != 0) argv[argc++] = option1;
+ if (option2 != 0) argv[argc++] = option2;
+ if (option3 != 0) argv[argc++] = option3;
+ argv[argc++] = infname;
+ argv[argc] = 0;
+ return run_return( taxsolve_US_1040, argc, argv );
+}
+
+
+/* A line's amount, from a results file, or -1e30 if it is not there. */
+double result_line( char *outfname, char *label )
+{
+ char *text, *pt, key[100];
+ double amount=-1e30;
+
+ text = read_text( outfname );
+ if (text == 0)
+  return amount;
+ sprintf( key, "\n%.90s = ", label );
+ pt = strstr( text, key );
+ if (pt != 0)
+  amount = strtod( pt + strlen( key ), 0 );
+ free( text );
+ return amount;
+}
+
+
+/* The text, with the first amount on the line for label shifted by delta. */
+char *with_line_shifted( char *text, char *label, double delta )
+{
+ char key[100], *pt, *end, *newtext;
+ double amount;
+
+ sprintf( key, "\n%.90s", label );
+ pt = strstr( text, key );
+ while ((pt != 0) && !isspace( pt[ strlen( key ) ] ))
+  pt = strstr( pt + 1, key );
+ if (pt == 0)
+  { results_fprintf(stdout,"Error: No '%s' line to shift.\n", label );  exit(1); }
+ pt = pt + strlen( key );
+ while ((*pt == ' ') || (*pt == '\t')) pt++;
+ amount = strtod( pt, &end );
+ if (end == pt)
+  { results_fprintf(stdout,"Error: No amount on the '%s' line.\n", label );  exit(1); }
+ newtext = (char *)malloc( strlen( text ) + 100 );
+ sprintf( newtext, "%.*s%.2f%s", (int)(pt - text), text, amount + delta, end );
+ return newtext;
+}
+
+
+/* The text after a results file's Title line (which is dated), or zero.  Caller frees. */
+char *results_after_title( char *outfname )
+{
+ char *text, *pt, *rest;
+
+ text = read_text( outfname );
+ if (text == 0)
+  return 0;
+ pt = strchr( text, '\n' );
+ rest = strdup( (pt == 0) ? "" : pt + 1 );
+ free( text );
+ return rest;
+}
+
+
+void compile_file( char *fname, char *otsbname )
+{
+ FILE *fp;
+ char *image;
+ long len;
+
+ fp = taxsolve_fopen( fname, "r" );
+ image = (fp == 0) ? 0 : compile_input( fp, &len );
+ if (image == 0)
+  { results_fprintf(stdout,"Error: Could not compile '%s'.\n", fname );  exit(1); }
+ release_input_file( fp );
+ fclose( fp );
+ fp = taxsolve_fopen( otsbname, "wb" );
+ if ((fp == 0) || (fwrite( image, 1, len, fp ) != len) || (fclose( fp ) != 0))
+  { results_fprintf(stdout,"Error: Could not write '%s'.\n", otsbname );  exit(1); }
+ free( image );
+}
+
+
+void check( int ok, char *what )
+{
+ nchecked++;
+ if (!ok)
+  {
+   results_fprintf(stdout,"   %s\n", what );
+   bad++;
+  }
+}
+
+
+/* Each -sensitivity point's tax, against the return with its L1 edited by the shift. */
+void check_sensitivity()
+{
+ char *text, *shifted, fname[4096], outfname[4096], csvname[4096], mssg[4096], *csv, *row, *fed, *f8960;
+ double shift, tax, edited_tax;
+ int npoints=0;
+
+ fed = read_form_file( "US_1040", "US_1040_example.txt" );
+ f8960 = read_form_file( "Form_8960", "Form_8960_example.txt" );
+ text = (char *)malloc( strlen( fed ) + strlen( f8960 ) + 100 );
+ sprintf( text, "%s\nForm:  Form_8960\n%s", fed, f8960 );
+ free( fed );
+ free( f8960 );
+ sprintf( fname, "%s/sensitivity.txt", work_dir );
+ sprintf( outfname, "%s/sensitivity_out.txt", work_dir );
+ sprintf( csvname, "%s/sensitivity_sensitivity.csv", work_dir );
+ write_text( fname, text );
+ if (compute( "-sensitivity", "L1", "0:400000:100000", fname ) != 0)
+  { results_fprintf(stdout,"Error: -sensitivity failed on '%s'.\n", fname );  exit(1); }
+ csv = read_text( csvname );
+ if (csv == 0)
+  { results_fprintf(stdout,"Error: No '%s'.\n", csvname );  exit(1); }
+
+ for (row = strchr( csv, '\n' ); (row != 0) && (row[1] != '\0'); row = strchr( row + 1, '\n' ))
+  {
+   if (sscanf( row + 1, "%lf,%*f,%*f,%lf", &shift, &tax ) != 2)
+    { results_fprintf(stdout,"Error: Bad row in '%s'.\n", csvname );  exit(1); }
+   shifted = with_line_shifted( text, "L1", shift );
+   write_text( fname, shifted );
+   free( shifted );
+   if (compute( 0, 0, 0, fname ) != 0)
+    { results_fprintf(stdout,"Error: Could not compute '%s' with L1 shifted by %.2f.\n", fname, shift );  exit(1); }
+   edited_tax = result_line( outfname, "L24" );
+   sprintf( mssg, "-sensitivity L1 at %.2f gives a tax of %.2f, but the return edited by it gives %.2f.", shift, tax, edited_tax );
+   check( fabs( tax - edited_tax ) < 0.005, mssg );
+   npoints++;
+  }
+ check( npoints == 5, "-sensitivity wrote the wrong number of points." );
+ results_fprintf(stdout,"Sensitivity:  %d points, each against the return edited by its shift.\n", npoints );
+ free( csv );
+ free( text );
+ remove( fname );
+ remove( outfname );
+ remove( csvname );
+ sprintf( fname, "%s/sensitivity_Form_8960_out.txt", work_dir );
+ remove( fname );
+}
+
+
+/* A return with sub-form sections, computed from its text and compiled. */
+void check_compiled_sections()
+{
+ char *outnames[]={ "sections_out.txt", "sections_US_1040_Sched_C_out.txt",
+			"sections_US_1040_Sched_SE_out.txt", "sections_Form_8960_out.txt", 0 };
+ char *text, *fed, *schc, *schse, *f8960, *from_text[4], *from_compiled, fname[4096], otsbname[4096], outfname[4096], mssg[4096];
+ int j;
+
+ fed = read_form_file( "US_1040", "US_1040_example.txt" );
+ schc = read_form_file( "US_1040_Sched_C", "US_1040Sched_C_2021_example.txt" );
+ schse = read_form_file( "US_1040_Sched_SE", "US_1040_Sched_SE_example.txt" );
+ f8960 = read_form_file( "Form_8960", "Form_8960_example.txt" );
+ text = (char *)malloc( strlen( fed ) + strlen( schc ) + strlen( schse ) + strlen( f8960 ) + 200 );
+ sprintf( text, "%s\nForm:  US_1040_Sched_C\n%s\nForm:  US_1040_Sched_SE\n%s\nForm:  Form_8960\n%s", fed, schc, schse, f8960 );
+ sprintf( fname, "%s/sections.txt", work_dir );
+ sprintf( otsbname, "%s/sections.otsb", work_dir );
+ write_text( fname, text );
+ compile_file( fname, otsbname );
+
+ if (compute( 0, 0, 0, fname ) != 0)
+  { results_fprintf(stdout,"Error: Could not compute '%s'.\n", fname );  exit(1); }
+ for (j=0; outnames[j] != 0; j++)
+  {
+   sprintf( outfname, "%s/%s", work_dir, outnames[j] );
+   from_text[j] = results_after_title( outfname );
+   remove( outfname );
+  }
+ sprintf( mssg, "The compiled return '%s' could not be computed.", otsbname );
+ check( compute( 0, 0, 0, otsbname ) == 0, mssg );
+ for (j=0; outnames[j] != 0; j++)
+  {
+   sprintf( outfname, "%s/%s", work_dir, outnames[j] );
+   from_compiled = results_after_title( outfname );
+   sprintf( mssg, "The compiled return's %s differs from its text's.", outnames[j] );
+   check( (from_text[j] != 0) && (from_compiled != 0) && (strcmp( from_text[j], from_compiled ) == 0), mssg );
+   free( from_text[j] );
+   free( from_compiled );
+   remove( outfname );
+  }
+ results_fprintf(stdout,"Compiled sections:  %d results files, each against the text's.\n", j );
+ free( text );
+ free( fed );
+ free( schc );
+ free( schse );
+ free( f8960 );
+ remove( fname );
+ remove( otsbname );
+ sprintf( fname, "%s/sections_out.otsf", work_dir );
+ remove( fname );
+}
+
+
+/* The 1099-B fixture, and the same lots as typed, by section. */
+char fixture_1099b[]=
+ "Description,Date Acquired,Date Sold,Proceeds,Cost,Code,Adjustment,Box\n"
+ "\"25 SH ACME, INC.\nCOMMON\",2021-02-03,2021-08-09,\"$1,234.50\",1000.00,,,A\n"
+ "50 SH GLOBEX,2020-01-15,2021-11-30,2500.00,\"$3,100.25\",B,(12.00),D\n"
+ "\n"
+ "30 SH HOOLI,Various,2021-05-05,800.00,(650.00),,,B\n"
+ "\"10 SH INITECH\",Various,3-1-2021,\"$1,000.00\",400,,,E\n"
+ "\"100 SH \"\"STARK\"\" IND\",2021-06-01,2021-07-01,\"$10,000.00\",\"9,500.00\",,,C\n"
+ "5 SH WAYNE,2019-12-31,2021-12-31,300,$50.00,,,f\n";
+
+char *typed_1099b[][2]={
+ { "CapGains-A/D",
+   "\t-1000.00\t2-3-2021\t{25 SH ACME, INC. COMMON}\n\t1234.50\t8-9-2021\n\t~\t~\n"
+   "\t-3100.25\t1-15-2020\t{50 SH GLOBEX}\n\t2500.00\t11-30-2021\n\tB\t-12.00\n" },
+ { "CapGains-B/E",
+   "\t-650.00\tvarious-short\t{30 SH HOOLI}\n\t800.00\t5-5-2021\n\t~\t~\n"
+   "\t-400\tvarious-long\t{10 SH INITECH}\n\t1000.00\t3-1-2021\n\t~\t~\n" },
+ { "CapGains-C/F",
+   "\t-9500.00\t6-1-2021\t{100 SH \"STARK\" IND}\n\t10000.00\t7-1-2021\n\t~\t~\n"
+   "\t-50.00\t12-31-2019\t{5 SH WAYNE}\n\t300\t12-31-2021\n\t~\t~\n" },
+ { 0, 0 } };
+
+
+/* The text, with lots put first in the section for label (where -1099b puts its own). */
+char *with_lots_inserted( char *text, char *label, char *lots )
+{
+ char key[100], *pt, *newtext;
+
+ sprintf( key, "\n%.90s", label );
+ pt = strstr( text, key );
+ if ((pt == 0) || ((pt = strchr( pt + 1, '\n' )) == 0))
+  { results_fprintf(stdout,"Error: No '%s' section for the lots.\n", label );  exit(1); }
+ pt++;
+ newtext = (char *)malloc( strlen( text ) + strlen( lots ) + 1 );
+ sprintf( newtext, "%.*s%s%s", (int)(pt - text), text, lots, pt );
+ return newtext;
+}
+
+
+/* The amount lines ("label = amount") of a results file, or zero.  Caller frees. */
+char *result_amounts( char *outfname )
+{
+ char *text, *line, *end, *amounts;
+ int k=0;
+
+ text = read_text( outfname );
+ if (text == 0)
+  return 0;
+ amounts = (char *)malloc( strlen( text ) + 1 );
+ for (line = text; *line != '\0'; line = end)
+  {
+   end = strchr( line, '\n' );
+   end = (end == 0) ? line + strlen( line ) : end + 1;
+   if (strstr( line, " = " ) < end)
+    {
+     memcpy( amounts + k, line, end - line );
+     k = k + end - line;
+    }
+  }
+ amounts[k] = '\0';
+ free( text );
+ return amounts;
+}
+
+
+/* The 1040 example with the fixture read by -1099b, against the example with its lots typed in. */
+void check_1099b_import()
+{
+ char *text, *typed, fname[4096], csvname[4096], outfname[4096], mssg[4096], *imported, *entered, *results;
+ int j;
+
+ text = read_form_file( "US_1040", "US_1040_example.txt" );
+ sprintf( fname, "%s/import.txt", work_dir );
+ sprintf( csvname, "%s/import_1099b.csv", work_dir );
+ sprintf( outfname, "%s/import_out.txt", work_dir );
+ write_text( fname, text );
+ write_text( csvname, fixture_1099b );
+ sprintf( mssg, "-1099b could not read '%s'.", csvname );
+ check( compute( "-1099b", csvname, 0, fname ) == 0, mssg );
+ imported = result_amounts( outfname );
+ results = read_text( outfname );
+ check( (results != 0) && (strstr( results, " Imported 6 lots from 1099-B file" ) != 0), "-1099b did not import the fixture's 6 lots." );
+ free( results );
+ remove( outfname );
+
+ for (j=0; typed_1099b[j][0] != 0; j++)
+  {
+   typed = with_lots_inserted( text, typed_1099b[j][0], typed_1099b[j][1] );
+   free( text );
+   text = typed;
+  }
+ write_text( fname, text );
+ if (compute( 0, 0, 0, fname ) != 0)
+  { results_fprintf(stdout,"Error: Could not compute '%s'.\n", fname );  exit(1); }
+ entered = result_amounts( outfname );
+ check( (imported != 0) && (entered != 0) && (strcmp( imported, entered ) == 0),
+	"The lots read by -1099b give different amounts from the same lots typed in." );
+ results_fprintf(stdout,"1099-B import:  %d lots, against the same lots typed in.\n", 6 );
+ free( imported );
+ free( entered );
+ free( text );
+ remove( fname );
+ remove( csvname );
+ remove( outfname );
+ sprintf( fname, "%s/import_out.otsf", work_dir );
+ remove( fname );
+}
+
+
+int main( int argc, char *argv[] )
+{
+ char fname[4096];
+
+ if (argc > 1) forms_dir = argv[1];
+ reset_solver_state = reset_US_1040_state;
+ quiet = 1;	/* (So this program's messages go straight to stdout, past quiet.) */
+ if (mkdtemp( work_dir ) == 0)
+  { results_fprintf(stdout,"Error: Could not make a working directory.\n");  exit(1); }
+
+ check_sensitivity();
+ check_compiled_sections();
+ check_1099b_import();
+
+ sprintf( fname, "%s/sensitivity_out.otsf", work_dir );	/* (The federal snapshot.) */
+ remove( fname );
+ rmdir( work_dir );
+ if (bad)
+  results_fprintf(stdout,"Return inputs:  %d of %d checks failed.\n", bad, nchecked );
+ else
+  results_fprintf(stdout,"Return inputs:  All %d checks pass.\n", nchecked );
+ return bad != 0;
+}
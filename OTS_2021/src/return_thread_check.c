@@ -0,0 +1,214 @@
+/************************************************************************/
+/* return_thread_check.c - Checks that the 1040's returns come out the	*/
+/*  same, byte for byte, however they are run through run_return:	*/
+/*   - each alone, in a process of its own (the reference);		*/
+/*   - one after another, on one thread;				*/
+/*   - several at once, on parallel threads, each thread running	*/
+/*     several returns in turn.						*/
+/*  The returns are the 1040 example and template, and the example	*/
+/*  under other filing statuses, so that each one follows returns	*/
+/*  that differ from it.  (The title line, which holds the time of the	*/
+/*  run, is not compared.)  Run by "make check", or:			*/
+/*	return_thread_check  [tax_form_files directory]			*/
+/************************************************************************/
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define main solver_main
+#include "taxsolve_US_1040_2021.c"
+#undef main
+
+#define NUM_VARIANTS	5
+#define NUM_THREADS	4
+#define RUNS_PER_THREAD	(2 * NUM_VARIANTS)
+
+char *variant_status[NUM_VARIANTS]={ 0, "Single", "Head_of_House", "Married/Sep", 0 };	/* (The last is the template.) */
+char *variant_text[NUM_VARIANTS];
+char work_dir[]="/tmp/ots_return_checkXXXXXX";
+
+struct check_run
+ {
+  int variant;
+  char infname[4096];
+  int result;
+ };
+
+struct check_thread
+ {
+  struct check_run runs[RUNS_PER_THREAD];
+  int nruns;
+  pthread_t thread;
+ };
+
+
+char *read_text( char *fname )	/* Caller frees.  Returns zero if fname cannot be read. */
+{
+ long len;
+ char *data, *text;
+
+ data = read_whole_file( fname, &len );
+ if (data == 0)
+  return 0;
+ text = (char *)malloc( len + 1 );
+ memcpy( text, data, len );
+ text[len] = '\0';
+ free( data );
+ return text;
+}
+
+
+/* The example, with its Status line changed to status. */
+char *with_status( char *example, char *status )
+{
+ char *text, *line, *eol;
+
+ line = strstr( example, "\nStatus" );
+ if (line == 0)
+  { console_printf("Error: No Status line in the 1040 example.\n");  exit(1); }
+ line++;
+ eol = strchr( line, '\n' );
+ text = (char *)malloc( strlen( example ) + strlen( status ) + 100 );
+ sprintf( text, "%.*sStatus\t%s%s", (int)(line - example), example, status, eol );
+ return text;
+}
+
+
+void prepare_run( struct check_run *run, char *mode, int variant )
+{
+ FILE *fp;
+
+ run->variant = variant;
+ sprintf( run->infname, "%s/%s_%d.txt", work_dir, mode, variant );
+ fp = taxsolve_fopen( run->infname, "w" );
+ if ((fp == 0) || (fputs( variant_text[variant], fp ) < 0))
+  { console_printf("Error: Could not write '%s'.\n", run->infname);  exit(1); }
+ fclose( fp );
+}
+
+
+void compute_run( struct check_run *run )
+{
+ char *argv[4];
+
+ argv[0] = "taxsolve_US_1040_2021";
+ argv[1] = "-quiet";
+ argv[2] = run->infname;
+ argv[3] = 0;
+ run->result = run_return( taxsolve_US_1040, 3, argv );
+}
+
+
+void *compute_thread_runs( void *arg )
+{
+ struct check_thread *t = (struct check_thread *)arg;
+ int j;
+
+ quiet = 1;
+ for (j=0; j < t->nruns; j++)
+  compute_run( &(t->runs[j]) );
+ return 0;
+}
+
+
+char *results_of( struct check_run *run )	/* The results file's text, less its title line. */
+{
+ static char *text=0;
+ char outfname[4096], *pt;
+
+ strcpy( outfname, run->infname );
+ strcpy( &(outfname[ strlen( outfname ) - 4 ]), "_out.txt" );
+ free( text );
+ text = read_text( outfname );
+ remove( outfname );
+ remove( run->infname );
+ if (text == 0)
+  return "";
+ pt = strstr( text, "\nTitle:" );
+ if (pt != 0)
+  pt = strchr( pt + 1, '\n' );
+ return (pt != 0) ? pt : text;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ struct check_run alone[NUM_VARIANTS], serial[RUNS_PER_THREAD];
+ struct check_thread threads[NUM_THREADS];
+ struct check_run *run;
+ char *expected[NUM_VARIANTS], *forms_dir="../tax_form_files", fname[4096], mode[100], *got;
+ int j, k, status, bad=0, nchecked=0;
+ pid_t pid;
+
+ if (argc > 1) forms_dir = argv[1];
+ reset_solver_state = reset_US_1040_state;
+ quiet = 1;
+ sprintf( fname, "%s/US_1040/US_1040_example.txt", forms_dir );
+ variant_text[0] = read_text( fname );
+ sprintf( fname, "%s/US_1040/US_1040_template.txt", forms_dir );
+ variant_text[NUM_VARIANTS-1] = read_text( fname );
+ if ((variant_text[0] == 0) || (variant_text[NUM_VARIANTS-1] == 0))
+  { console_printf("Error: Could not read the 1040 example and template from '%s/US_1040'.\n", forms_dir);  exit(1); }
+ for (k=1; k < NUM_VARIANTS-1; k++)
+  variant_text[k] = with_status( variant_text[0], variant_status[k] );
+ if (mkdtemp( work_dir ) == 0)
+  { console_printf("Error: Could not make a working directory.\n");  exit(1); }
+
+ for (k=0; k < NUM_VARIANTS; k++)	/* Each alone, in a new process. */
+  {
+   prepare_run( &(alone[k]), "alone", k );
+   fflush( 0 );
+   pid = fork();
+   if (pid == 0)
+    {
+     compute_run( &(alone[k]) );
+     fflush( 0 );
+     _exit( alone[k].result );
+    }
+   if ((pid < 0) || (waitpid( pid, &status, 0 ) != pid) || !WIFEXITED( status ))
+    { console_printf("Error: Could not compute '%s' in a process of its own.\n", alone[k].infname);  exit(1); }
+   alone[k].result = WEXITSTATUS( status );
+   expected[k] = strdup( results_of( &(alone[k]) ) );
+  }
+
+ for (j=0; j < RUNS_PER_THREAD; j++)	/* One after another, on this thread. */
+  {
+   sprintf( mode, "serial_%d", j );
+   prepare_run( &(serial[j]), mode, (j < NUM_VARIANTS) ? j : RUNS_PER_THREAD - 1 - j );
+   compute_run( &(serial[j]) );
+  }
+ for (j=0; j < NUM_THREADS; j++)	/* Several at once, each thread taking the returns in another order. */
+  {
+   for (k=0; k < RUNS_PER_THREAD; k++)
+    {
+     sprintf( mode, "thread%d_%d", j, k );
+     prepare_run( &(threads[j].runs[k]), mode, (j + k * (j + 1)) % NUM_VARIANTS );
+    }
+   threads[j].nruns = RUNS_PER_THREAD;
+   if (pthread_create( &(threads[j].thread), 0, compute_thread_runs, &(threads[j]) ) != 0)
+    { console_printf("Error: Could not start thread %d.\n", j);  exit(1); }
+  }
+ for (j=0; j < NUM_THREADS; j++)
+  pthread_join( threads[j].thread, 0 );
+
+ for (j=0; j < (NUM_THREADS + 1) * RUNS_PER_THREAD; j++)
+  {
+   run = (j < RUNS_PER_THREAD) ? &(serial[j]) : &(threads[j / RUNS_PER_THREAD - 1].runs[j % RUNS_PER_THREAD]);
+   got = results_of( run );
+   nchecked++;
+   if ((run->result != alone[run->variant].result) || (strcmp( got, expected[run->variant] ) != 0))
+    {
+     console_printf("   '%s' differs from the same return computed alone.\n", run->infname );
+     bad++;
+    }
+  }
+ rmdir( work_dir );
+
+ quiet = 0;
+ console_printf("Run_return:  %d returns, run one after another and on %d threads at once.\n", nchecked, NUM_THREADS );
+ if (bad)
+  console_printf("  %d differ from the same returns computed alone.\n", bad);
+ else
+  console_printf("  All match the same returns computed alone, byte for byte.\n");
+ return bad != 0;
+}
@@ -0,0 +1,329 @@
+/************************************************************************/
+/* string_bench.c - Checks and times the cursor-based string routines.	*/
+/*  Reads the largest example returns, then parses every line of them	*/
+/*  the way the readers of return and results files do:  trim it,	*/
+/*  split it into words, strip "$" and "," from each word, and look	*/
+/*  for "N/A" and "various" in it.  This is done once with the routines	*/
+/*  as they were (next_word shifting the rest of the line after each	*/
+/*  word, a strdup'ing mystrcasestr, and so on), and once with		*/
+/*  string_routines.c.  The words must come out the same both ways.	*/
+/*  Build and run with "make bench", or:				*/
+/*	string_bench  [passes  [files ...]]				*/
+/*  Without files, the largest examples under ../tax_form_files are	*/
+/*  used.								*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "string_routines.c"
+
+#define MAX_FILES	8
+#define WORD_DELIMS	" \t="
+
+
+double now()
+{
+ struct timespec ts;
+ clock_gettime( CLOCK_MONOTONIC, &ts );
+ return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+/* The routines as they were, before string_routines.c. */
+char *old_mystrcasestr( char *haystack, char *needle )
+{
+ int j=0;
+ char *hs, *ndl, *pt;
+ hs = strdup( haystack );
+ while (hs[j] != '\0') { hs[j] = toupper( hs[j] );  j++; }
+ ndl = strdup( needle );
+ j = 0;
+ while (ndl[j] != '\0') { ndl[j] = toupper( ndl[j] );  j++; }
+ pt = strstr( hs, ndl );
+ if (pt != 0)
+  {
+   j = 0;
+   while (pt != &(hs[j])) j++;
+   pt = &(haystack[j]);
+  }
+ free( ndl );
+ free( hs );
+ return pt;
+}
+
+void old_next_word( char *line, char *word, char *delim )
+{
+ int i=0, j=0, m=0, flag=1;
+
+ /* Eat away preceding garbage */
+ while ((line[i] !='\0') && (flag))
+  {
+   j = 0;
+   while ((delim[j] != '\0') && (line[i] != delim[j])) j = j + 1;
+   if (line[i] == delim[j]) i++;
+   else  flag = 0;
+  }
+ while ((line[i] != '\0') && (!flag))
+  {
+   word[m++] = line[i++];
+   if (line[i] != '\0')
+    {
+     j = 0;
+     while ((delim[j] != '\0') && (line[i] != delim[j])) j = j + 1;
+     if (line[i] == delim[j]) flag = 1;
+    }
+  }
+ /* Shorten line. */
+ j = 0;
+ while (line[i]!='\0') { line[j++] = line[i++]; }
+ /* Terminate the char-strings. */
+ line[j] = '\0';
+ word[m] = '\0';
+}
+
+void old_consume_leading_trailing_whitespace( char *line )
+{ int j, k;
+  while (isspace( line[0] ))
+   {
+    j = 0;
+    do { line[j] = line[j+1];  j++; }
+    while (line[j-1] != '\0');
+   }
+ k = strlen( line ) - 1;
+ while ((k >= 0) && (isspace( line[k] )))
+  {
+   line[k] = '\0';
+   k--;
+  }
+}
+
+void old_remove_certain_chars( char *line, char *badchars )
+{
+  int j=0, k, m=0;
+  while (line[j] != '\0')
+   {
+    k = 0;
+    while ((badchars[k] != '\0') && (line[j] != badchars[k]))
+     k++;
+    if (badchars[k] == '\0')
+     line[m++] = line[j];
+    j++;
+   }
+  line[m] = '\0';
+}
+
+
+/* Folds a word into the running checksum. */
+unsigned long long add_word( unsigned long long h, char *word, int flags )
+{
+ unsigned char sep=' ' + flags;
+
+ h = fnv_hash( h, word, strlen( word ) );
+ return fnv_hash( h, &sep, 1 );
+}
+
+
+/* Parses one line with the old routines, which shorten it as they go. */
+unsigned long long parse_line_old( char *line, unsigned long long h, long *nwords )
+{
+ char word[4096];
+ int flags;
+
+ old_consume_leading_trailing_whitespace( line );
+ while (line[0] != '\0')
+  {
+   old_next_word( line, word, WORD_DELIMS );
+   if (word[0] == '\0')
+    break;
+   old_remove_certain_chars( word, "$," );
+   flags = (old_mystrcasestr( word, "N/A" ) != 0) + 2 * (old_mystrcasestr( word, "various" ) != 0);
+   h = add_word( h, word, flags );
+   (*nwords)++;
+  }
+ return h;
+}
+
+/* The same, with a cursor over the line. */
+unsigned long long parse_line_new( char *line, unsigned long long h, long *nwords )
+{
+ char word[4096], *pt;
+ int flags;
+
+ pt = trim_whitespace( line );
+ while (*pt != '\0')
+  {
+   pt = scan_word( pt, word, WORD_DELIMS );
+   if (word[0] == '\0')
+    break;
+   remove_certain_chars( word, "$," );
+   flags = (mystrcasestr( word, "N/A" ) != 0) + 2 * (mystrcasestr( word, "various" ) != 0);
+   h = add_word( h, word, flags );
+   (*nwords)++;
+  }
+ return h;
+}
+
+
+/* An example return, split into lines. */
+struct bench_file
+ {
+  char *name, *text, **lines, *scratch;
+  int nlines;
+  long size;
+ } files[MAX_FILES];
+int nfiles=0;
+
+void load_file( char *fname )
+{
+ struct bench_file *f=&(files[nfiles]);
+ FILE *fp;
+ char *pt;
+ int j;
+
+ fp = fopen( fname, "rb" );
+ if (fp == 0)
+  { printf("Error: Could not read '%s'.\n", fname);  exit(1); }
+ fseek( fp, 0, SEEK_END );
+ f->size = ftell( fp );
+ rewind( fp );
+ f->text = (char *)malloc( f->size + 1 );
+ if (fread( f->text, 1, f->size, fp ) != (size_t)f->size)
+  { printf("Error: Could not read '%s'.\n", fname);  exit(1); }
+ fclose( fp );
+ f->text[f->size] = '\0';
+ f->name = strdup( fname );
+ f->nlines = 1;
+ for (pt=f->text; *pt != '\0'; pt++)
+  if (*pt == '\n') f->nlines++;
+ f->lines = (char **)malloc( f->nlines * sizeof(char *) );
+ f->lines[0] = f->text;
+ for (pt=f->text, j=1; *pt != '\0'; pt++)
+  if (*pt == '\n')
+   { *pt = '\0';  f->lines[j++] = pt + 1; }
+ f->scratch = (char *)malloc( f->size + 1 );
+ nfiles++;
+}
+
+
+/* Finds the largest example returns, "*example*.txt", taking the largest of each of dir's sub-directories (forms). */
+void find_largest_examples( char *dir )
+{
+ char *names[MAX_FILES], path[4096], best[4096];
+ long sizes[MAX_FILES], size;
+ DIR *d, *sub;
+ struct dirent *de, *se;
+ struct stat st;
+ int n=0, j, k;
+
+ d = opendir( dir );
+ if (d == 0)
+  { printf("Error: Could not list '%s'.\n", dir);  exit(1); }
+ while ((de = readdir( d )) != 0)
+  {
+   if (de->d_name[0] == '.')
+    continue;
+   sprintf( path, "%s/%s", dir, de->d_name );
+   sub = opendir( path );
+   if (sub == 0)
+    continue;
+   size = -1;
+   while ((se = readdir( sub )) != 0)
+    {
+     if ((strstr( se->d_name, "example" ) == 0) || (strstr( se->d_name, ".txt" ) == 0))
+      continue;
+     sprintf( path, "%s/%s/%s", dir, de->d_name, se->d_name );
+     if ((stat( path, &st ) == 0) && (st.st_size > size))
+      { size = st.st_size;  strcpy( best, path ); }
+    }
+   closedir( sub );
+   if (size < 0)
+    continue;
+   for (j=0; (j < n) && (sizes[j] >= size); j++);
+   if (j == MAX_FILES)
+    continue;
+   if (n < MAX_FILES) n++;
+   else free( names[n-1] );
+   for (k=n-1; k > j; k--)
+    { names[k] = names[k-1];  sizes[k] = sizes[k-1]; }
+   names[j] = strdup( best );
+   sizes[j] = size;
+  }
+ closedir( d );
+ for (j=0; j < n; j++)
+  load_file( names[j] );
+}
+
+
+/* Parses every line of a file, passes times over, on a fresh copy each time. */
+double time_parse( struct bench_file *f, int old, int passes, long *nwords, unsigned long long *sum )
+{
+ unsigned long long h=FNV_BASIS;
+ char *line;
+ double t;
+ int p, j;
+
+ *nwords = 0;
+ t = now();
+ for (p=0; p < passes; p++)
+  {
+   memcpy( f->scratch, f->text, f->size + 1 );
+   for (j=0; j < f->nlines; j++)
+    {
+     line = f->scratch + (f->lines[j] - f->text);
+     if (old)
+      h = parse_line_old( line, h, nwords );
+     else
+      h = parse_line_new( line, h, nwords );
+    }
+  }
+ *sum = h;
+ return now() - t;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ int passes=500, j, bad=0;
+ long n_old, n_new;
+ unsigned long long sum_old, sum_new;
+ double t_old, t_new, tot_old=0.0, tot_new=0.0;
+
+ if (argc > 1) passes = atoi( argv[1] );
+ if (passes < 1)
+  { printf("Usage:  string_bench  [passes  [files ...]]\n");  exit(1); }
+ for (j=2; (j < argc) && (nfiles < MAX_FILES); j++)
+  load_file( argv[j] );
+ if (nfiles == 0)
+  find_largest_examples( "../tax_form_files" );
+ if (nfiles == 0)
+  { printf("Error: No example returns found.\n");  exit(1); }
+
+ printf("Parsing each line of %d example returns, %d passes each.\n\n", nfiles, passes );
+ printf("%-64s %6s %6s   %10s %10s\n", "", "bytes", "lines", "old (ms)", "new (ms)");
+ for (j=0; j < nfiles; j++)
+  {
+   t_old = time_parse( &(files[j]), 1, passes, &n_old, &sum_old );
+   t_new = time_parse( &(files[j]), 0, passes, &n_new, &sum_new );
+   printf("%-64s %6ld %6d   %10.1f %10.1f   %5.1fx\n", files[j].name, files[j].size, files[j].nlines,
+	  1e3 * t_old, 1e3 * t_new, t_old / t_new );
+   if ((n_old != n_new) || (sum_old != sum_new))
+    {
+     printf("   Words differ:  %ld the old way, %ld the new.\n", n_old / passes, n_new / passes );
+     bad++;
+    }
+   tot_old += t_old;
+   tot_new += t_new;
+  }
+ printf("%-64s %6s %6s   %10.1f %10.1f   %5.1fx\n", "Total", "", "", 1e3 * tot_old, 1e3 * tot_new, tot_old / tot_new );
+ if (bad)
+  printf("\n%d files are parsed differently.\n", bad);
+ else
+  printf("\nEvery file is parsed into the same words both ways.\n");
+ return bad != 0;
+}
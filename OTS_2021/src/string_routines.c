@@ -0,0 +1,363 @@
+/************************************************************************/
+/* String_Routines.c - Small string-scanning routines shared by the	*/
+/*  tax programs and the form-filling utilities.  They work on a	*/
+/*  cursor (a char pointer into a line) instead of re-shifting the	*/
+/*  line after each word, and they never allocate.  Also a simple	*/
+/*  memory pool for the many small records these programs build, and	*/
+/*  a table for sharing repeated strings.				*/
+/*  This file is included-in taxsolve_routines.c,			*/
+/*  universal_pdf_file_modifier.c, convert_results2xfdf.c, and		*/
+/*  make_label_hash.c.							*/
+/* 									*/
+/* GNU Library General Public License - LGPL:			*/
+/* This library is free software; you can redistribute it and/or	*/
+/* modify it under the terms of the GNU Library General Public	*/
+/* License as published by the Free Software Foundation; either	*/
+/* version 2 of the License, or (at your option) any later version.	*/
+/* 									*/
+/* This library is distributed in the hope that it will be useful,	*/
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of	*/
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU	*/
+/* Library General Public License for more details.			*/
+/************************************************************************/
+
+#ifndef STRING_ROUTINES_INCLUDED
+#define STRING_ROUTINES_INCLUDED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+/* A set of delimiter characters, as a 256-bit membership mask, so that	*/
+/* testing a character costs one lookup regardless of how many		*/
+/* delimiters were given.  The '\0' terminator is never a member.	*/
+struct char_set
+ {
+  unsigned char member[32];
+ };
+
+void make_char_set( char *chars, struct char_set *set )
+{
+ memset( set->member, 0, sizeof(set->member) );
+ while (*chars != '\0')
+  {
+   set->member[(unsigned char)*chars >> 3] |= 1 << (*chars & 7);
+   chars++;
+  }
+}
+
+#define IN_CHAR_SET( set, c )  ((set)->member[(unsigned char)(c) >> 3] & (1 << ((c) & 7)))
+
+
+/* Skip over any characters in the set.  Returns pointer to first non-member. */
+char *skip_chars( char *pt, struct char_set *set )
+{
+ while ((*pt != '\0') && IN_CHAR_SET( set, *pt )) pt++;
+ return pt;
+}
+
+/* Advance to the next character in the set, or to the end of the string. */
+char *find_chars( char *pt, struct char_set *set )
+{
+ while ((*pt != '\0') && !IN_CHAR_SET( set, *pt )) pt++;
+ return pt;
+}
+
+
+/*.......................................................................
+  . SCAN_WORD - Cursor version of next_word.  Skips any delimiters at	.
+  . pt, copies the following word into 'word', and returns a pointer to	.
+  . the character after the word, from which the next call may resume.	.
+  . The input line is not modified.					.
+  .......................................................................*/
+char *scan_word( char *pt, char *word, char *delim )
+{
+ struct char_set set;
+ char *end;
+ int n;
+
+ make_char_set( delim, &set );
+ pt = skip_chars( pt, &set );
+ end = find_chars( pt, &set );
+ n = end - pt;
+ memmove( word, pt, n );
+ word[n] = '\0';
+ return end;
+}
+
+
+/* Like scan_word, but a word beginning with a double-quote extends to the	*/
+/* closing quote (and may contain delimiters).  The quotes are not copied.	*/
+char *scan_quoted_word( char *pt, char *word, char *delim )
+{
+ struct char_set set;
+ char *end;
+ int n;
+
+ make_char_set( delim, &set );
+ while ((*pt != '\0') && (*pt != '"') && IN_CHAR_SET( &set, *pt )) pt++;
+ if (*pt != '"')
+  return scan_word( pt, word, delim );
+ pt++;
+ end = strchr( pt, '"' );
+ if (end == 0)
+  {
+   printf("Warning: Missing end-quote\n");
+   end = pt + strlen( pt );
+  }
+ n = end - pt;
+ memmove( word, pt, n );
+ word[n] = '\0';
+ if (*end == '"') end++;
+ return end;
+}
+
+
+/*.......................................................................
+  .     NEXT_WORD - accepts a line of text, and returns with the        .
+  . next word in that text in the second parameter, the original line   .
+  . is shortened from the beginning so that the word is removed.        .
+  . If the line encountered is empty, then the word returned will be    .
+  . empty.                                                              .
+  . NEXTWORD can parse on an arbitrary number of delimiters.		.
+  . Parameters:								.
+  .   line - input character string, on output shortened by word.	.
+  .   word - output of this routine, single word, without delimiters.   .
+  .   delim - list of delimiters, whitepace chars, etc..		.
+  . Loops taking several words from one line should rather advance a	.
+  . cursor with scan_word, which does not move the rest of the line.	.
+  .......................................................................*/
+void next_word( char *line, char *word, char *delim )
+{
+ char *rest;
+ rest = scan_word( line, word, delim );
+ memmove( line, rest, strlen( rest ) + 1 );
+}
+
+
+/* Return pointer to first non-whitespace char, and trim trailing whitespace in place. */
+char *trim_whitespace( char *line )
+{
+ char *end;
+ while (isspace( (unsigned char)*line )) line++;
+ end = line + strlen( line );
+ while ((end > line) && isspace( (unsigned char)end[-1] )) end--;
+ *end = '\0';
+ return line;
+}
+
+
+void consume_leading_trailing_whitespace( char *line )
+{
+ char *pt;
+ pt = trim_whitespace( line );
+ if (pt != line)
+  memmove( line, pt, strlen( pt ) + 1 );
+}
+
+
+/* Case-insensitive strstr.  Returns pointer into haystack, or 0. */
+char *mystrcasestr( char *haystack, char *needle )
+{
+ int first, j;
+
+ if (needle[0] == '\0') return haystack;
+ first = toupper( (unsigned char)needle[0] );
+ for ( ; *haystack != '\0'; haystack++)
+  {
+   if (toupper( (unsigned char)*haystack ) != first)
+    continue;
+   j = 1;
+   while ((needle[j] != '\0') && (toupper( (unsigned char)haystack[j] ) == toupper( (unsigned char)needle[j] )))
+    j++;
+   if (needle[j] == '\0')
+    return haystack;
+  }
+ return 0;
+}
+
+
+void remove_certain_chars( char *line, char *badchars )
+{ /* Removes any specified characters from a string, so as to uniformly format dates, ID numbers, etc.. */
+  struct char_set set;
+  char *out=line;
+  make_char_set( badchars, &set );
+  for ( ; *line != '\0'; line++)
+   if (!IN_CHAR_SET( &set, *line ))
+    *out++ = *line;
+  *out = '\0';
+}
+
+
+void substitute_chars( char *line, char *badchars, char replace_char )
+{ /* Replaces any specified characters from a string, so as to uniformly format dates, ID numbers, etc.. */
+  struct char_set set;
+  make_char_set( badchars, &set );
+  for ( ; *line != '\0'; line++)
+   if (IN_CHAR_SET( &set, *line ))
+    *line = replace_char;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Memory Pools - Records and strings that live until a whole return (or form)	*/
+/*  is finished are carved from large blocks, instead of being malloc'd and	*/
+/*  strdup'd one at a time.  Nothing is freed individually; pool_release()	*/
+/*  gives back every block at once.  Pool memory is zero-filled.		*/
+/*------------------------------------------------------------------------------*/
+#define POOL_BLOCK_SIZE  65536
+#define POOL_ALIGN	 16
+
+struct pool_block
+ {
+  struct pool_block *prev;
+  size_t size;
+ };
+
+struct mem_pool
+ {
+  struct pool_block *blocks;
+  char *next;		/* Next free byte in the newest block. */
+  size_t left;		/* Bytes remaining in the newest block. */
+ };
+
+#define POOL_HEADER_SIZE  ((sizeof(struct pool_block) + POOL_ALIGN - 1) & ~(size_t)(POOL_ALIGN - 1))
+
+
+void *pool_alloc( struct mem_pool *pool, size_t size )
+{
+ struct pool_block *blk;
+ size_t blksz;
+ char *pt;
+
+ size = (size + POOL_ALIGN - 1) & ~(size_t)(POOL_ALIGN - 1);
+ if (size > pool->left)
+  {
+   blksz = POOL_BLOCK_SIZE;
+   if (size > (blksz - POOL_HEADER_SIZE) / 4)
+    blksz = size + POOL_HEADER_SIZE;	/* Large requests get a block of their own. */
+   blk = (struct pool_block *)calloc( 1, blksz );
+   if (blk == 0)
+    {
+     printf("Error: Out of memory.\n");
+     exit(1);
+    }
+   blk->size = blksz;
+   if ((blksz != POOL_BLOCK_SIZE) && (pool->blocks != 0))
+    { /* Keep filling the current block; file this one behind it. */
+     blk->prev = pool->blocks->prev;
+     pool->blocks->prev = blk;
+     return (char *)blk + POOL_HEADER_SIZE;
+    }
+   blk->prev = pool->blocks;
+   pool->blocks = blk;
+   pool->next = (char *)blk + POOL_HEADER_SIZE;
+   pool->left = blksz - POOL_HEADER_SIZE;
+  }
+ pt = pool->next;
+ pool->next += size;
+ pool->left -= size;
+ return pt;
+}
+
+
+char *pool_strdup( struct mem_pool *pool, const char *str )
+{
+ size_t n;
+ char *pt;
+ n = strlen( str ) + 1;
+ pt = (char *)pool_alloc( pool, n );
+ memcpy( pt, str, n );
+ return pt;
+}
+
+
+void pool_release( struct mem_pool *pool )
+{
+ struct pool_block *blk;
+ while (pool->blocks != 0)
+  {
+   blk = pool->blocks;
+   pool->blocks = blk->prev;
+   free( blk );
+  }
+ pool->next = 0;
+ pool->left = 0;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* FNV_Hash - The 64-bit FNV-1a hash of len bytes of data, continuing from h.	*/
+/*  Start from FNV_BASIS, or from the hash of what came before, so that a	*/
+/*  long text may be hashed in pieces as it goes by.				*/
+/*------------------------------------------------------------------------------*/
+#define FNV_BASIS	14695981039346656037ULL
+
+unsigned long long fnv_hash( unsigned long long h, const void *data, size_t len )
+{
+ const unsigned char *pt=(const unsigned char *)data;
+ while (len-- > 0)
+  h = (h ^ *pt++) * 1099511628211ULL;
+ return h;
+}
+
+/* The label tables' perfect hash (see "Label Tables" in taxsolve_routines.c),	*/
+/* shared with make_label_hash, which builds it.  The high half of a label's	*/
+/* hash picks a bucket, whose displacement then picks the slot.			*/
+struct label_slot
+ {
+  char *key;		/* The label, or 0 for an empty slot. */
+  short field, index;	/* Its entry in the table, and its element for "%c". */
+ };
+
+#define LABEL_BUCKET( h, nbuckets )	((unsigned int)((h) >> 32) % (nbuckets))
+#define LABEL_SLOT( h, d, nslots )	(((unsigned int)(h) + (d) * ((unsigned int)((h) >> 32) | 1)) % (nslots))
+
+
+/*------------------------------------------------------------------------------*/
+/* String Tables - Intern_string returns one shared copy of each distinct	*/
+/*  string, kept in the table's memory pool, so that records repeating the	*/
+/*  same descriptions or dates (such as thousands of day-trade lots) share	*/
+/*  their text.  Interned strings must not be modified.			*/
+/*------------------------------------------------------------------------------*/
+struct string_table
+ {
+  char **slots;		/* Open-addressed hash table, size a power of two. */
+  unsigned int size, count;
+  struct mem_pool *pool;
+ };
+
+char *intern_string( struct string_table *tbl, char *str )
+{
+ char **old;
+ unsigned int j, k, oldsize;
+
+ if (2 * (tbl->count + 1) > tbl->size)
+  { /* Grow, and re-hash.  (The old slots stay in the pool until it is released.) */
+   old = tbl->slots;
+   oldsize = tbl->size;
+   tbl->size = (oldsize == 0) ? 1024 : 2 * oldsize;
+   tbl->slots = (char **)pool_alloc( tbl->pool, tbl->size * sizeof(char *) );
+   for (j=0; j < oldsize; j++)
+    if (old[j] != 0)
+     {
+      k = fnv_hash( FNV_BASIS, old[j], strlen( old[j] ) ) & (tbl->size - 1);
+      while (tbl->slots[k] != 0) k = (k + 1) & (tbl->size - 1);
+      tbl->slots[k] = old[j];
+     }
+  }
+ k = fnv_hash( FNV_BASIS, str, strlen( str ) ) & (tbl->size - 1);
+ while (tbl->slots[k] != 0)
+  {
+   if (strcmp( tbl->slots[k], str ) == 0)
+    return tbl->slots[k];
+   k = (k + 1) & (tbl->size - 1);
+  }
+ tbl->slots[k] = pool_strdup( tbl->pool, str );
+ tbl->count++;
+ return tbl->slots[k];
+}
+
+#endif
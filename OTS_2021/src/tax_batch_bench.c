@@ -0,0 +1,252 @@
+/************************************************************************/
+/* tax_batch_bench.c - Checks and times scheduled_tax_batch.		*/
+/*  Taxes a set of random (income, status) pairs on the federal and	*/
+/*  California schedules with each kernel, checks every result against	*/
+/*  scheduled_tax, then reports evaluations per second on one core and	*/
+/*  on all cores.  Also checks more schedules than the kernels take at	*/
+/*  once, and incomes whose schedule number is out of range, which must	*/
+/*  be taxed at zero and counted.  Build and run with "make bench", or:	*/
+/*	tax_batch_bench  [incomes  [threads  [seconds]]]		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+
+char *kernel_names[]={ "auto", "scalar", "SSE2", "AVX" };
+
+struct bench_set
+ {
+  char *name;
+  int nschedules, rounding;
+  int n;
+  double *income, *tax, *rate;
+  int *which;
+ } sets[2];
+
+double seconds_per_run=1.0;
+
+
+double now()
+{
+ struct timespec ts;
+ clock_gettime( CLOCK_MONOTONIC, &ts );
+ return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+void schedules_of( struct bench_set *set, struct tax_schedule *schedules[] )	/* This thread's copies. */
+{
+ int j;
+ for (j=0; j < set->nschedules; j++)
+  schedules[j] = (set->rounding == TAX_DOLLARS) ? &(ca_tax_schedules[j]) : &(fed_tax_schedules[j]);
+}
+
+
+/* Incomes mostly from $0 to $2M, with cents, plus a few the kernels hand back to scheduled_tax. */
+void make_set( struct bench_set *set, char *name, int nschedules, int rounding, int n )
+{
+ int i;
+
+ set->name = name;
+ set->nschedules = nschedules;
+ set->rounding = rounding;
+ set->n = n;
+ set->income = (double *)malloc( n * sizeof(double) );
+ set->tax = (double *)malloc( n * sizeof(double) );
+ set->rate = (double *)malloc( n * sizeof(double) );
+ set->which = (int *)malloc( n * sizeof(int) );
+ for (i=0; i < n; i++)
+  {
+   switch (rand() % 100)
+    {
+     case 0:  set->income[i] = -(double)(rand() % 100000) / 100.0;  break;
+     case 1:  set->income[i] = 21474836.48 + (double)(rand() % 100000000);  break;
+     default: set->income[i] = (double)((long long)rand() * rand() % 200000000LL) / 100.0;
+		if (rand() % 4 == 0) set->income[i] = (double)(long long)set->income[i];
+    }
+   set->which[i] = rand() % nschedules;
+  }
+}
+
+
+int check_set( struct bench_set *set )	/* Number of results differing from scheduled_tax. */
+{
+ struct tax_schedule *schedules[MAX_BATCH_SCHEDULES];
+ double tx, rt;
+ int i, bad=0;
+
+ schedules_of( set, schedules );
+ for (i=0; i < set->n; i++)
+  { set->tax[i] = -1.0;  set->rate[i] = -1.0; }
+ scheduled_tax_batch( schedules, set->nschedules, set->income, set->which, set->n, set->rounding, set->tax, set->rate );
+ for (i=0; i < set->n; i++)
+  {
+   tx = scheduled_tax( schedules[set->which[i]], set->income[i], set->rounding, &rt );
+   if ((tx != set->tax[i]) || (rt != set->rate[i]))
+    {
+     if (bad < 5)
+      console_printf("   Mismatch: income %.2f schedule %d: %.2f %g, batch %.2f %g\n",
+		set->income[i], set->which[i], tx, rt, set->tax[i], set->rate[i] );
+     bad++;
+    }
+  }
+ return bad;
+}
+
+
+/* More schedules than MAX_BATCH_SCHEDULES (the federal ones, repeated), and out-of-range schedule numbers. */
+#define EDGE_SCHEDULES	(MAX_BATCH_SCHEDULES + 4)
+
+int check_edge_cases( int n )	/* Number of failures. */
+{
+ struct tax_schedule *schedules[EDGE_SCHEDULES];
+ double *income, *tax, *rate, tx, rt;
+ int *which, i, j, nbad_which=0, counted, bad=0;
+ int bad_which[]={ -1, EDGE_SCHEDULES, 1000, -1000 };
+
+ for (j=0; j < EDGE_SCHEDULES; j++)
+  schedules[j] = &(fed_tax_schedules[j % 4]);
+ income = (double *)calloc( n, sizeof(double) );
+ tax = (double *)calloc( n, sizeof(double) );
+ rate = (double *)calloc( n, sizeof(double) );
+ which = (int *)calloc( n, sizeof(int) );
+ for (i=0; i < n; i++)
+  {
+   income[i] = (double)((long long)rand() * rand() % 200000000LL) / 100.0;
+   which[i] = rand() % EDGE_SCHEDULES;
+   if (rand() % 50 == 0)
+    { which[i] = bad_which[rand() % 4];  nbad_which++; }
+   tax[i] = -1.0;
+   rate[i] = -1.0;
+  }
+ counted = scheduled_tax_batch( schedules, EDGE_SCHEDULES, income, which, n, TAX_CENTS, tax, rate );
+ if (counted != nbad_which)
+  {
+   console_printf("   %d out-of-range schedule numbers, but %d counted.\n", nbad_which, counted );
+   bad++;
+  }
+ for (i=0; i < n; i++)
+  {
+   if ((which[i] < 0) || (which[i] >= EDGE_SCHEDULES))
+    { tx = 0.0;  rt = 0.0; }
+   else
+    tx = scheduled_tax( schedules[which[i]], income[i], TAX_CENTS, &rt );
+   if ((tx != tax[i]) || (rt != rate[i]))
+    {
+     if (bad < 5)
+      console_printf("   Mismatch: income %.2f schedule %d of %d: %.2f %g, batch %.2f %g\n",
+		income[i], which[i], EDGE_SCHEDULES, tx, rt, tax[i], rate[i] );
+     bad++;
+    }
+  }
+ free( income );
+ free( tax );
+ free( rate );
+ free( which );
+ return bad;
+}
+
+
+struct bench_work
+ {
+  struct bench_set *set;
+  int from, to;
+  long long evaluations;
+  pthread_t thread;
+ };
+
+void *run_batches( void *arg )	/* Taxes the work's slice over and over for seconds_per_run. */
+{
+ struct bench_work *w = (struct bench_work *)arg;
+ struct bench_set *set = w->set;
+ struct tax_schedule *schedules[MAX_BATCH_SCHEDULES];
+ double start;
+
+ schedules_of( set, schedules );
+ w->evaluations = 0;
+ start = now();
+ do
+  {
+   scheduled_tax_batch( schedules, set->nschedules, set->income + w->from, set->which + w->from, w->to - w->from,
+			set->rounding, set->tax + w->from, 0 );
+   w->evaluations += w->to - w->from;
+  }
+ while (now() - start < seconds_per_run);
+ return 0;
+}
+
+
+double evaluations_per_second( struct bench_set *set, int nthreads )
+{
+ struct bench_work work[256];
+ double start, evals=0.0;
+ int t;
+
+ start = now();
+ for (t=0; t < nthreads; t++)
+  {
+   work[t].set = set;
+   work[t].from = (int)((long long)set->n * t / nthreads);
+   work[t].to = (int)((long long)set->n * (t + 1) / nthreads);
+   if (pthread_create( &(work[t].thread), 0, run_batches, &(work[t]) ) != 0)
+    { results_fprintf(stderr,"Error: Could not start thread %d.\n", t);  exit(1); }
+  }
+ for (t=0; t < nthreads; t++)
+  {
+   pthread_join( work[t].thread, 0 );
+   evals = evals + (double)work[t].evaluations;
+  }
+ return evals / (now() - start);
+}
+
+
+int main( int argc, char *argv[] )
+{
+ int n=1000000, nthreads, kernel, k, bad=0;
+ double one_core;
+
+ nthreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+ if (argc > 1) n = atoi( argv[1] );
+ if (argc > 2) nthreads = atoi( argv[2] );
+ if (argc > 3) seconds_per_run = atof( argv[3] );
+ if ((n < 1) || (nthreads < 1) || (nthreads > 256) || (seconds_per_run <= 0.0))
+  { results_fprintf(stderr,"Usage:  tax_batch_bench  [incomes  [threads  [seconds]]]\n");  exit(1); }
+
+ srand( 2021 );
+ make_set( &(sets[0]), "federal, to the cent", 4, TAX_CENTS, n );
+ make_set( &(sets[1]), "California, to the dollar", 3, TAX_DOLLARS, n );
+ console_printf("%d incomes per schedule set, %d threads for all cores.  Best kernel here: %s.\n\n",
+	n, nthreads, kernel_names[tax_batch_kernel_in_use()] );
+
+ for (kernel = TAX_BATCH_SCALAR; kernel <= TAX_BATCH_AVX; kernel++)
+  {
+   tax_batch_kernel = kernel;
+   if (tax_batch_kernel_in_use() != kernel)
+    { console_printf("%-7s not supported on this CPU.\n\n", kernel_names[kernel]);  continue; }
+   for (k=0; k < 2; k++)
+    {
+     bad = bad + check_set( &(sets[k]) );
+     one_core = evaluations_per_second( &(sets[k]), 1 );
+     console_printf("%-7s %-26s  1 core: %7.1f M/s   %d cores: %7.1f M/s\n", kernel_names[kernel], sets[k].name,
+	    1e-6 * one_core, nthreads, 1e-6 * evaluations_per_second( &(sets[k]), nthreads ) );
+    }
+   k = check_edge_cases( n / 10 + 1 );
+   console_printf("%-7s %d schedules, and bad schedule numbers:  %s\n", kernel_names[kernel], EDGE_SCHEDULES,
+	  (k == 0) ? "checked" : "FAILED" );
+   bad = bad + k;
+   console_printf("\n");
+  }
+ if (bad)
+  console_printf("%d results differ from scheduled_tax.\n", bad);
+ else
+  console_printf("All results match scheduled_tax.\n");
+ return bad != 0;
+}
@@ -0,0 +1,926 @@
+/************************************************************************/
+/* tax_schedule_check.c - Cross-checks the tax-schedule engine against	*/
+/*  the bracket ladders it replaced.  Each solver's functions from	*/
+/*  before the schedules are kept below, renamed old_*, and compared	*/
+/*  with the solver's own, for every filing status, over a dense grid:	*/
+/*  every dollar (and a cent and fifty cents past it) to $700,000, then	*/
+/*  steps of $97.31 to $3M (and of $9,973.31 to $30M where brackets go	*/
+/*  that high), plus each bracket start and a cent either side.  Taxes	*/
+/*  must agree to half a cent, and the bracket reports (the text of	*/
+/*  Report_bracket_info, at every $10 and at each start) exactly.	*/
+/*  The known differences are listed for each solver, with the reason.	*/
+/*  One that no longer shows up fails the check as well.		*/
+/*  Built once per solver, with -DCHECK_<solver>, by "make check".	*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#define main solver_main	/* The solver's own. */
+
+struct tax_check
+ {
+  char *name;
+  double (*old_tax)( double income, int status );
+  double (*new_tax)( double income, int status );
+  double largest;		/* Largest difference, outside the known ones. */
+ };
+
+struct known_difference
+ {
+  char *check;		/* Name of the tax_check, "report", or 0 for any. */
+  int status;		/* 0 for any. */
+  double from, to;	/* Incomes, inclusive. */
+  char *why;
+  long seen;
+ };
+
+
+#if defined(CHECK_US_1040)
+
+#include "taxsolve_US_1040_2021.c"
+
+money old_brkpt[4][9]={
+		{ DOLLARS(0), DOLLARS(9950), DOLLARS(40525), DOLLARS(86375), DOLLARS(164925), DOLLARS(209425), DOLLARS(523600), MONEY_MAX },  /* Single */
+		{ DOLLARS(0), DOLLARS(19900), DOLLARS(81050), DOLLARS(172750), DOLLARS(329850), DOLLARS(418850), DOLLARS(628300), MONEY_MAX },  /* Married, filing jointly. */
+		{ DOLLARS(0), DOLLARS(9950), DOLLARS(40525), DOLLARS(86375), DOLLARS(164925), DOLLARS(209425), DOLLARS(314150), MONEY_MAX },  /* Married, filing separate. */
+		{ DOLLARS(0), DOLLARS(14200), DOLLARS(54200), DOLLARS(86350), DOLLARS(164900), DOLLARS(209400), DOLLARS(523600), MONEY_MAX },  /* Head of Household. */
+		     };
+long long old_txrt[4][9] ={
+		{ RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) },	/* Single */
+		{ RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) },	/* Married, filing jointly. */
+		{ RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) },	/* Married, filing separate. */
+		{ RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) },	/* Head of Household. */
+		     };
+
+double old_TaxRateFormula( double x, int status )  /* Returns tax due.  Computed in exact cents. */
+{
+  money income=to_money( x ), sum=0;
+  int   bracket=0;
+  if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
+  status = status - 1;  /* Arrays start at zero; not one. */
+  while (old_brkpt[status][bracket+1] < income)
+   {
+    sum = sum + money_times_rate( old_brkpt[status][bracket+1] - old_brkpt[status][bracket], old_txrt[status][bracket] );
+    bracket = bracket + 1;
+   }
+  return money_to_dollars( money_times_rate( income - old_brkpt[status][bracket], old_txrt[status][bracket] ) + sum );
+}
+
+void old_Report_bracket_info( double income, double addedtx, int status )
+{
+  double tx;
+  int  bracket=0;
+  tx = old_TaxRateFormula( income, status );
+  if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
+  status = status - 1;  /* Arrays start at zero; not one. */
+  while (old_brkpt[status][bracket+1] < to_money( income )) bracket++;
+  console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
+          old_txrt[status][bracket] / 10000.0, 100.0 * (tx + addedtx) / (income + 1e-9) );
+  results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
+          old_txrt[status][bracket] / 10000.0, 100.0 * (tx + addedtx) / (income + 1e-9) );
+}
+
+double old_TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
+{
+ double x, dx, tx;
+ int k;
+ if (income < 100000.0)	/* Quantize to match tax-table exactly. */
+  {
+   if (income < 25.0) x = 5.0; else
+   if (income < 3000.0) x = 25.0; else x = 50.0;
+   dx = 0.5 * x;
+   k = income / x;
+   x = x * (double)k + dx;
+   tx = (int)(old_TaxRateFormula( x, status ) + 0.5);
+  }
+ else
+  tx = old_TaxRateFormula( income, status );
+ return tx;
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, 0.0, status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, 0.0, status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+char *solver="US 1040";
+int nstatus=5;
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFormula", old_TaxRateFormula, TaxRateFormula },
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ int j;
+ for (j=0; j < 4; j++)
+  s[j] = &(fed_tax_schedules[j]);
+ return 4;
+}
+
+
+#elif defined(CHECK_f2210)
+
+#include "taxsolve_f2210_2021.c"
+
+double old_brkpt[4][9]={
+		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 523600.0, 9e19 },  /* Single */
+		{ 0.0,  19900.0,  81050.0, 172750.0, 329850.0, 418850.0, 628300.0, 9e19 },  /* Married, filing jointly. */
+		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 314150.0, 9e19 },  /* Married, filing separate. */
+		{ 0.0,  14200.0,  54200.0,  86350.0, 164900.0, 209400.0, 523600.0, 9e19 },  /* Head of Household. */
+		     };
+double old_txrt[4][9] ={
+		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Single */
+		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing jointly. */
+		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing separate. */
+		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Head of Household. */
+		     };
+
+double old_TaxRateFormula( double x, int status )  /* Returns tax due. */
+{
+  double sum=0.0;
+  int   bracket=0;
+  if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
+  status = status - 1;  /* Arrays start at zero; not one. */
+  while (old_brkpt[status][bracket+1] < x)
+   {
+    sum = sum + (old_brkpt[status][bracket+1] - old_brkpt[status][bracket]) * old_txrt[status][bracket];
+    bracket = bracket + 1;
+   }
+  return (x - old_brkpt[status][bracket]) * old_txrt[status][bracket] + sum;
+}
+
+double old_TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
+{
+ double x, dx, tx;
+ int k;
+ if (income < 100000.0)	/* Quantize to match tax-table exactly. */
+  {
+   if (income < 25.0) x = 5.0; else
+   if (income < 3000.0) x = 25.0; else x = 50.0;
+   dx = 0.5 * x;
+   k = income / x;
+   x = x * (double)k + dx;
+   tx = (int)(old_TaxRateFormula( x, status ) + 0.5);
+  }
+ else
+  tx = old_TaxRateFormula( income, status );
+ return tx;
+}
+
+void (*old_report)( double income, int status )=0;
+void (*new_report)( double income, int status )=0;
+
+char *solver="f2210";
+int nstatus=5;
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFormula", old_TaxRateFormula, TaxRateFormula },
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ int j;
+ for (j=0; j < 4; j++)
+  s[j] = &(fed_tax_schedules[j]);
+ return 4;
+}
+
+
+#elif defined(CHECK_CA_540)
+
+#include "taxsolve_CA_540_2021.c"
+
+double old_TaxRateFormula( double x, int status )	/* Exact, rounded once to whole dollars. */
+{											/* Updated for 2021. */
+ money income=to_money( x ), tax;
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
+  {
+   if (income < DOLLARS(9325))  tax = money_rated_dollars( 0, income, RATE(0.01) );                else
+   if (income < DOLLARS(22107))  tax = money_rated_dollars( MONEY(93.25), income - DOLLARS(9325), RATE(0.02) );  else
+   if (income < DOLLARS(34892))  tax = money_rated_dollars( MONEY(348.89), income - DOLLARS(22107), RATE(0.04) );  else
+   if (income < DOLLARS(48435))  tax = money_rated_dollars( MONEY(860.29), income - DOLLARS(34892), RATE(0.06) );  else
+   if (income < DOLLARS(61214))  tax = money_rated_dollars( MONEY(1672.87), income - DOLLARS(48435), RATE(0.08) );  else
+   if (income < DOLLARS(312686))  tax = money_rated_dollars( MONEY(2695.19), income - DOLLARS(61214), RATE(0.093) );  else
+   if (income < DOLLARS(375221))  tax = money_rated_dollars( MONEY(26082.09), income - DOLLARS(312686), RATE(0.103) );  else
+   if (income < DOLLARS(625369))  tax = money_rated_dollars( MONEY(32523.20), income - DOLLARS(375221), RATE(0.113) );
+   else                     tax = money_rated_dollars( MONEY(60789.92), income - DOLLARS(625369), RATE(0.123) );
+  }
+ else
+ if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
+  {
+   if (income < DOLLARS(18650))  tax = money_rated_dollars( 0, income, RATE(0.01) );                 else
+   if (income < DOLLARS(44214))  tax = money_rated_dollars( MONEY(186.50), income - DOLLARS(18650), RATE(0.02) );  else
+   if (income < DOLLARS(69784))  tax = money_rated_dollars( MONEY(697.78), income - DOLLARS(44214), RATE(0.04) );  else
+   if (income < DOLLARS(96870))  tax = money_rated_dollars( MONEY(1720.58), income - DOLLARS(69784), RATE(0.06) );  else
+   if (income < DOLLARS(122428))  tax = money_rated_dollars( MONEY(3345.74), income - DOLLARS(96870), RATE(0.08) );  else
+   if (income < DOLLARS(625372))  tax = money_rated_dollars( MONEY(5390.38), income - DOLLARS(122428), RATE(0.093) );  else
+   if (income < DOLLARS(750442))  tax = money_rated_dollars( MONEY(52164.17), income - DOLLARS(625372), RATE(0.103) );  else
+   if (income < DOLLARS(1250738))  tax = money_rated_dollars( MONEY(65046.38), income - DOLLARS(750442), RATE(0.113) );
+   else                      tax = money_rated_dollars( MONEY(121579.83), income - DOLLARS(1250738), RATE(0.123) );
+  }
+ else
+  {
+   if (income < DOLLARS(18663))  tax = money_rated_dollars( 0, income, RATE(0.01) );                else
+   if (income < DOLLARS(44217))  tax = money_rated_dollars( MONEY(186.63), income - DOLLARS(18663), RATE(0.02) );  else
+   if (income < DOLLARS(56999))  tax = money_rated_dollars( MONEY(697.71), income - DOLLARS(44217), RATE(0.04) );  else
+   if (income < DOLLARS(70542))  tax = money_rated_dollars( MONEY(1208.99), income - DOLLARS(56999), RATE(0.06) );  else
+   if (income < DOLLARS(83324))  tax = money_rated_dollars( MONEY(2021.57), income - DOLLARS(70542), RATE(0.08) );  else
+   if (income < DOLLARS(425251))  tax = money_rated_dollars( MONEY(3044.13), income - DOLLARS(83324), RATE(0.093) );  else
+   if (income < DOLLARS(510303))  tax = money_rated_dollars( MONEY(34843.34), income - DOLLARS(425251), RATE(0.103) );  else
+   if (income < DOLLARS(850503))  tax = money_rated_dollars( MONEY(43603.70), income - DOLLARS(510303), RATE(0.113) );
+   else                     tax = money_rated_dollars( MONEY(82046.30), income - DOLLARS(850503), RATE(0.123) );
+  }
+ return money_to_dollars( tax );
+}
+
+void old_Report_bracket_info( double income, int status )
+{
+ double tx, rate;
+ tx = old_TaxRateFormula( income, status );
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
+  {
+   if (income <    9325.00)  rate = 0.01;  else
+   if (income <   22107.00)  rate = 0.02;  else
+   if (income <   34892.00)  rate = 0.04;  else
+   if (income <   48435.00)  rate = 0.06;  else
+   if (income <   61214.00)  rate = 0.08;  else
+   if (income <  312686.00)  rate = 0.093;  else
+   if (income <  375221.00)  rate = 0.103;  else
+   if (income <  625369.00)  rate = 0.113;  else  rate = 0.123;
+  }
+ else
+ if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
+  {
+   if (income <   18650.00)  rate = 0.01;  else
+   if (income <   44214.00)  rate = 0.02;  else
+   if (income <   69784.00)  rate = 0.04;  else
+   if (income <   96870.00)  rate = 0.06;  else
+   if (income <  122428.00)  rate = 0.08;  else
+   if (income <  625372.00)  rate = 0.093;  else
+   if (income <  750442.00)  rate = 0.103;  else
+   if (income < 1250738.00)  rate = 0.113;  else  rate = 0.123;
+  }
+ else
+  {
+   if (income <  18663.00)  rate = 0.01;  else
+   if (income <  44217.00)  rate = 0.02;  else
+   if (income <  56999.00)  rate = 0.04;  else
+   if (income <  70542.00)  rate = 0.06;  else
+   if (income <  83324.00)  rate = 0.08;  else
+   if (income < 425251.00)  rate = 0.093;  else
+   if (income < 510303.00)  rate = 0.103;  else
+   if (income < 850503.00)  rate = 0.113;  else  rate = 0.123;
+  }
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+}
+
+double old_TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
+{
+ double x, tx;
+ int k;
+
+ if (income < 100000.0)   /* Quantize to match tax-table exactly. */
+  {
+   if (income < 99951.0)
+    {
+     k = (income + 49) / 100;
+     x = 100 * (double)k;
+    }
+   else x = 99975.0;
+   tx = (int)(old_TaxRateFormula( x, status ));
+  }
+ else
+  tx = old_TaxRateFormula( income, status );
+ return tx;
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+char *solver="CA 540";
+int nstatus=5;
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFormula", old_TaxRateFormula, TaxRateFormula },
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ s[0] = tax_schedule_for( SINGLE );
+ s[1] = tax_schedule_for( MARRIED_FILING_JOINTLY );
+ s[2] = tax_schedule_for( HEAD_OF_HOUSEHOLD );
+ return 3;
+}
+
+
+#elif defined(CHECK_CA_5805)
+
+#include "taxsolve_CA_5805_2021.c"
+
+double old_TaxRateFormula( double income, int status )
+{									/* Updated for 2021. */
+ double tax;
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
+  {
+   if (income <   9325.00)  tax =             0.01 * income;                else
+   if (income <  22107.00)  tax =    93.25 +  0.02 * (income -   9325.00);  else
+   if (income <  34892.00)  tax =   348.89 +  0.04 * (income -  22107.00);  else
+   if (income <  48435.00)  tax =   860.29 +  0.06 * (income -  34892.00);  else
+   if (income <  61214.00)  tax =  1672.87 +  0.08 * (income -  48435.00);  else
+   if (income < 312686.00)  tax =  2695.19 + 0.093 * (income -  61214.00);  else
+   if (income < 375221.00)  tax = 26082.09 + 0.103 * (income - 312686.00);  else
+   if (income < 625369.00)  tax = 32523.20 + 0.113 * (income - 375221.00);
+   else                     tax = 60789.92 + 0.123 * (income - 625369.00);
+  }
+ else
+ if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
+  {
+   if (income <   18650.00)  tax =              0.01 * income;                 else
+   if (income <   44214.00)  tax =    186.50 +  0.02 * (income -   18650.00);  else
+   if (income <   69784.00)  tax =    697.78 +  0.04 * (income -   44214.00);  else
+   if (income <   96870.00)  tax =   1720.58 +  0.06 * (income -   69784.00);  else
+   if (income <  122428.00)  tax =   3345.74 +  0.08 * (income -   96870.00);  else
+   if (income <  625372.00)  tax =   5390.38 + 0.093 * (income -  122428.00);  else
+   if (income <  750442.00)  tax =  52164.17 + 0.103 * (income -  625372.00);  else
+   if (income < 1250738.00)  tax =  65046.38 + 0.113 * (income -  750442.00);
+   else                      tax = 121579.83 + 0.123 * (income - 1250738.00);
+  }
+ else
+  {
+   if (income <  18663.00)  tax =             0.01 * income;                else
+   if (income <  44217.00)  tax =   186.63 +  0.02 * (income -  18663.00);  else
+   if (income <  56999.00)  tax =   697.71 +  0.04 * (income -  44217.00);  else
+   if (income <  70542.00)  tax =  1208.99 +  0.06 * (income -  56999.00);  else
+   if (income <  83324.00)  tax =  2021.57 +  0.08 * (income -  70542.00);  else
+   if (income < 425251.00)  tax =  3044.13 + 0.093 * (income -  83324.00);  else
+   if (income < 510303.00)  tax = 34843.34 + 0.103 * (income - 425251.00);  else
+   if (income < 850503.00)  tax = 43603.70 + 0.113 * (income - 510303.00);
+   else                     tax = 82046.30 + 0.123 * (income - 850503.00);
+  }
+ return (int)(tax+0.5);
+}
+
+double old_TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
+{
+ double x, tx;
+ int k;
+
+ if (income < 100000.0)   /* Quantize to match tax-table exactly. */
+  {
+   if (income < 99951.0)
+    {
+     k = (income + 49) / 100;
+     x = 100 * (double)k;
+    }
+   else x = 99975.0;
+   tx = (int)(old_TaxRateFormula( x, status ));
+  }
+ else
+  tx = old_TaxRateFormula( income, status );
+ return tx;
+}
+
+void (*old_report)( double income, int status )=0;
+void (*new_report)( double income, int status )=0;
+
+char *solver="CA 5805";
+int nstatus=5;
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFormula", old_TaxRateFormula, TaxRateFormula },
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ s[0] = tax_schedule_for( SINGLE );
+ s[1] = tax_schedule_for( MARRIED_FILING_JOINTLY );
+ s[2] = tax_schedule_for( HEAD_OF_HOUSEHOLD );
+ return 3;
+}
+
+
+#elif defined(CHECK_NJ)
+
+#include "taxsolve_NJ_1040_2021.c"
+
+double old_TaxRateFormula( double x, int status )
+{
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))	/* Single, Married/sep */
+  {
+   if (x < 20000.0)   return x * 0.014;               else
+   if (x < 35000.0)   return x * 0.0175  -     70.0;  else
+   if (x < 40000.0)   return x * 0.035   -    682.5;  else
+   if (x < 75000.0)   return x * 0.05525 -   1492.5;  else
+   if (x < 500000.0)  return x * 0.0637  -   2126.25; else
+   if (x < 1000000.0) return x * 0.0897  -  15126.25;
+   else		      return x * 0.1075  -  32926.25;
+  }
+ else
+ if ((status==MARRIED_FILING_JOINTLY) || (status==HEAD_OF_HOUSEHOLD) || (status==WIDOW))
+  {								/* Married/Joint, HouseHead, widower. */
+   if (x < 20000.0)   return x * 0.014;              else
+   if (x < 50000.0)   return x * 0.0175  -     70.0; else
+   if (x < 70000.0)   return x * 0.0245  -    420.0; else
+   if (x < 80000.0)   return x * 0.035   -   1154.5; else
+   if (x < 150000.0)  return x * 0.05525 -   2775.0; else
+   if (x < 500000.0)  return x * 0.0637  -   4042.5; else
+   if (x < 1000000.0) return x * 0.0897  -  17042.5;
+   else		      return x * 0.1075  -  34842.5;
+  }
+ else { console_printf("Status not covered.\n"); exit(1); }
+}
+
+void old_Report_bracket_info( double x, int status )
+{
+ double tx, rate;
+ tx = old_TaxRateFormula( x, status );
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))	/* Single, Married/sep */
+  {
+   if (x < 20000.0)   rate = 0.014;	else
+   if (x < 35000.0)   rate = 0.0175;	else
+   if (x < 40000.0)   rate = 0.035;	else
+   if (x < 75000.0)   rate = 0.05525;	else
+   if (x < 500000.0)  rate = 0.0637;    else
+   if (x < 1000000.0) rate = 0.0897;
+   else		      rate = 0.1075;
+  }
+ else
+  {								/* Married/Joint, HouseHead, widower. */
+   if (x < 20000.0)   rate = 0.014;	else
+   if (x < 50000.0)   rate = 0.0175;	else
+   if (x < 70000.0)   rate = 0.0245;	else
+   if (x < 80000.0)   rate = 0.035;	else
+   if (x < 150000.0)  rate = 0.05525;	else
+   if (x < 500000.0)  rate = 0.0637;    else
+   if (x < 100000.0)  rate = 0.0897;
+   else		      rate = 0.1075;
+  }
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / x );
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / x );
+}
+
+double old_TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
+{
+ double x, dx, tx;
+ int k;
+
+ if (income < 100000.0)  /* Quantize to match tax-table exactly. */
+  {
+   x = 50.0;
+   dx = 0.5 * x;
+   k = (income - 0.000001) / x;
+   x = x * (double)k + dx;
+   tx = (int)(old_TaxRateFormula( x, status ) + 0.5);
+  }
+ else
+  tx = old_TaxRateFormula( income, status );
+ return tx;
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+char *solver="NJ 1040";
+int nstatus=5;
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFormula", old_TaxRateFormula, TaxRateFormula },
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={
+ { "report", 0, 306250.0, 306250.0, "An effective rate of exactly 5.05%.  The old formula's rounding error picked which way it printed." },
+ { "report", MARRIED_FILING_JOINTLY, 500000.0, 999999.99, "The old rate ladder tested 100,000 for 1,000,000, so reported 10.75%, not 8.97%." },
+ { "report", HEAD_OF_HOUSEHOLD, 500000.0, 999999.99, "The old rate ladder tested 100,000 for 1,000,000, so reported 10.75%, not 8.97%." },
+ { "report", WIDOW, 500000.0, 999999.99, "The old rate ladder tested 100,000 for 1,000,000, so reported 10.75%, not 8.97%." },
+ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ s[0] = tax_schedule_for( SINGLE );
+ s[1] = tax_schedule_for( MARRIED_FILING_JOINTLY );
+ return 2;
+}
+
+
+#elif defined(CHECK_NY)
+
+#include "taxsolve_NY_IT201_2021.c"
+
+double old_TaxRateFunction( double income, int status )
+{
+ double tax;
+ switch (status)
+  {
+   case MARRIED_FILING_JOINTLY: case WIDOW:					/* Updated for 2021. */
+	if (income <=    17150.0) tax =             0.04 * income; else		/* Data from pg 51. */
+	if (income <=    23600.0) tax =     686.0 + 0.045  * (income - 17150.0); else
+	if (income <=    27900.0) tax =     976.0 + 0.0525 * (income - 23600.0); else
+	if (income <=    43000.0) tax =    1202.0 + 0.059  * (income - 27900.0); else
+	if (income <=   161550.0) tax =    2093.0 + 0.0597 * (income - 43000.0); else
+	if (income <=   323200.0) tax =    9170.0 + 0.0633 * (income - 161550.0); else
+	if (income <=  2155350.0) tax =   19403.0 + 0.0685 * (income - 323200.0); else
+	if (income <=  5000000.0) tax =  144905.0 + 0.0965 * (income - 2155350.0); else
+	if (income <= 25000000.0) tax =  419414.0 + 0.103 * (income - 5000000.0); else
+				  tax = 2479414.0 + 0.109 * (income - 25000000.0);
+      break;
+   case SINGLE: case MARRIED_FILING_SEPARAT:
+	if (income <=     8500.0) tax =  	    0.04   * income; else
+	if (income <=    11700.0) tax =     340.0 + 0.045  * (income - 8500.0); else
+	if (income <=    13900.0) tax =     484.0 + 0.0525 * (income - 11700.0); else
+	if (income <=    21400.0) tax =     600.0 + 0.059  * (income - 13900.0); else
+	if (income <=    80650.0) tax =    1042.0 + 0.0597 * (income - 21400.0); else
+	if (income <=   215400.0) tax =    4579.0 + 0.0633 * (income - 80650.0); else
+	if (income <=  1077550.0) tax =   13109.0 + 0.0685 * (income - 215400.0); else
+	if (income <=  5000000.0) tax =   72166.0 + 0.0965 * (income - 1077550.0); else
+	if (income <= 25000000.0) tax =  450683.0 + 0.103 * (income - 5000000.0); else
+			 	  tax = 2510683.0 + 0.109 * (income - 25000000.0);
+      break;
+   case HEAD_OF_HOUSEHOLD:
+	if (income <=    12080.0) tax =             0.04 * income; else
+	if (income <=    17650.0) tax =     512.0 + 0.045  * (income - 12800.0); else
+	if (income <=    20900.0) tax =     730.0 + 0.0525 * (income - 17650.0); else
+	if (income <=    32200.0) tax =     901.0 + 0.059  * (income - 20900.0); else
+	if (income <=   107650.0) tax =    1568.0 + 0.0597 * (income - 32200.0); else
+	if (income <=   269300.0) tax =    6072.0 + 0.0633 * (income - 107650.0); else
+	if (income <=  1616450.0) tax =   16304.0 + 0.0685 * (income - 269300.0); else
+	if (income <=  5000000.0) tax =  108584.0 + 0.0965 * (income - 1616450.0); else
+	if (income <= 25000000.0) tax =  435097.0 + 0.103 * (income - 5000000.0); else
+				  tax = 2495097.0 + 0.109 * (income - 25000000.0);
+      break;
+   default: console_printf("Error: Unhandled status\n"); exit(0); break;
+  }
+ return tax;
+}
+
+void old_Report_bracket_info( double income, double tx, int status )
+{
+ double rate;
+ switch (status)
+  {
+   case MARRIED_FILING_JOINTLY: case WIDOW:				/* Updated for 2021. */
+	if (income <=    17150.0) rate = 0.04;  else
+	if (income <=    23600.0) rate = 0.045;  else
+	if (income <=    27900.0) rate = 0.0525;  else
+	if (income <=    43000.0) rate = 0.059;  else
+	if (income <=   161550.0) rate = 0.0597;  else
+	if (income <=   323200.0) rate = 0.0633;  else
+	if (income <=  2155350.0) rate = 0.0685;  else
+	if (income <=  5000000.0) rate = 0.0965; else
+	if (income <= 25000000.0) rate = 0.103; else rate = 0.109;
+      break;
+   case SINGLE: case MARRIED_FILING_SEPARAT:
+	if (income <=     8500.0) rate = 0.04;  else
+	if (income <=    11700.0) rate = 0.045;  else
+	if (income <=    13900.0) rate = 0.0525;  else
+	if (income <=    21400.0) rate = 0.059;  else
+	if (income <=    80650.0) rate = 0.0597;  else
+	if (income <=   215400.0) rate = 0.0633;  else
+	if (income <=  1077550.0) rate = 0.0685;  else
+	if (income <=  5000000.0) rate = 0.0965;  else
+	if (income <= 25000000.0) rate = 0.103;  else rate = 0.109;
+      break;
+   case HEAD_OF_HOUSEHOLD:
+	if (income <=    12800.0) rate = 0.04;  else
+	if (income <=    17650.0) rate = 0.045;  else
+	if (income <=    20900.0) rate = 0.0525;  else
+	if (income <=    32200.0) rate = 0.059;  else
+	if (income <=   107650.0) rate = 0.0597;  else
+	if (income <=   269300.0) rate = 0.0633;  else
+	if (income <=  1616450.0) rate = 0.0685;  else
+	if (income <=  5000000.0) rate = 0.0965;  else
+	if (income <= 25000000.0) rate = 0.103;  else rate = 0.109;
+      break;
+   default: console_printf("Error: Unhandled status\n"); exit(0); break;
+  }
+ console_printf("tx = %g, income = %g\n", tx, income );
+ if (income == 0.0) income = 0.0001;	/* Prevent divide by zero. */
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+}
+
+double old_TaxRateLookup( double income, int status )
+{
+ double tax, dx;
+ int m;
+
+ if (income < 25.0)  dx = 12.5;  else
+ if (income < 50.0)  dx = 25.0;  else  dx = 50.0;
+
+ /* Round and truncate results from tax-function to approximate table lookup. */
+ m = income / dx;             /* Round income to nearest $50. */
+ income = (double)m * dx + 0.5 * dx;      /* Place into center of a $50 bracket. */
+ tax = old_TaxRateFunction( income, status );
+
+ return (int)(tax + 0.5);
+}
+
+double old_NYcityTaxRateFunction( double income, int status )	/* From page 67. */
+{
+ double tax, dx;
+ int m;
+
+ if (income < 25.0) dx = 12.5; else
+ if (income < 50.0) dx = 25.0; else dx = 50.0;
+
+ m = income / dx;             /* Round income to nearest $50. */
+ if (income < 65000.0)
+  income = m * dx + 0.5 * dx;      /* Place into center of a $50 bracket. */
+
+ if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))		/* Updated for 2021. */
+  {
+   if (income < 21600.0)  tax = income * 0.03078; else
+   if (income < 45000.0)  tax = (income - 21600.00) * 0.03762 + 665.00; else
+   if (income < 90000.0)  tax = (income - 45000.00) * 0.03819 + 1545.0; else
+			  tax = (income - 90000.00) * 0.03876 + 3264.0;
+  }
+ else
+ if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
+  {
+   if (income < 12000.0)  tax = income * 0.03078; else
+   if (income < 25000.0)  tax = (income - 12000.00) * 0.03762 + 369.0;  else
+   if (income < 50000.0)  tax = (income - 25000.00) * 0.03819 + 858.0;  else
+			  tax = (income - 50000.00) * 0.03876 + 1813.00;
+  }
+ else
+ if (status==HEAD_OF_HOUSEHOLD)
+  {
+   if (income < 14400.00) tax = income * 0.03078; else
+   if (income < 30000.00) tax = (income - 14400.00) * 0.03762 +  443.0;  else
+   if (income < 60000.00) tax = (income - 30000.00) * 0.03819 + 1030.0;  else
+			  tax = (income - 60000.00) * 0.03876 + 2176.0;
+ }
+ else {console_printf("Status not covered.\n");  exit(1);}
+
+ if (income < 65000.0) tax = (int)(tax + 0.5);   /* Round result to whole dollar. */
+ return tax;
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, old_TaxRateFunction( income, status ), status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, TaxRateFunction( income, status ), status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+char *solver="NY IT201";
+int nstatus=5;
+double max_income=3e7;
+struct tax_check tax_checks[]={
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { "TaxRateLookup", old_TaxRateLookup, TaxRateLookup },
+ { "NYcityTaxRateFunction", old_NYcityTaxRateFunction, NYcityTaxRateFunction },
+ { 0 } };
+struct known_difference known[]={
+ { "report", 0, 547240.0, 547240.0, "An effective rate of exactly 6.35%.  The old formula's rounding error picked which way it printed." },
+ { 0, HEAD_OF_HOUSEHOLD, 12080.01, 12800.0, "The old formula ended the first bracket at 12,080, a typo for the 12,800 used elsewhere." },
+ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ int j;
+ for (j=0; j < 3; j++)
+  {
+   s[j] = &(tax_schedules[j]);
+   s[3 + j] = &(nyc_tax_schedules[j]);
+  }
+ return 6;
+}
+
+
+#elif defined(CHECK_OH)
+
+#include "taxsolve_OH_IT1040_2021.c"
+
+double old_TaxRateFunction( double x, int status )
+{							/* Updated for 2021. */
+ if (x <= 25000.0) return    0.0; else
+ if (x <  44250.0) return  346.16 + (x-25000.0)  * 0.02765; else
+ if (x <  88450.0) return  878.42 + (x-44250.0)  * 0.03226; else
+ if (x < 110650.0) return 2204.31 + (x-88450.0)  * 0.03688; else
+ 		   return 3123.05 + (x-110650.0) * 0.03990;
+}
+
+void old_Report_bracket_info( double income, double tx, int status )
+{							/* Updated for 2021. */
+ double rate;
+ if (income <= 25000.0) rate = 0.0; else
+ if (income <  44250.0) rate = 0.02765; else
+ if (income <  88450.0) rate = 0.03226; else
+ if (income < 110650.0) rate = 0.03688;
+ else 		   	rate = 0.03990;
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, old_TaxRateFunction( income, status ), status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, TaxRateFunction( income, status ), status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+#define OH_AT_START "The old ladder taxed exactly 25,000 in the lower bracket, but each later start in the upper one;\n\
+     a schedule puts every start in the lower."
+
+char *solver="OH IT1040";
+int nstatus=1;		/* The tax does not depend on it. */
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={
+ { 0, 0, 44250.0, 44250.0, OH_AT_START },
+ { 0, 0, 88450.0, 88450.0, OH_AT_START },
+ { 0, 0, 110650.0, 110650.0, OH_AT_START },
+ { 0, 0, 88450.01, 110649.99, "The old 88,450 bracket base was 2204.31, $100 short of the 2304.31 the brackets carry to." },
+ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ s[0] = &tax_schedule;
+ return 1;
+}
+
+
+#elif defined(CHECK_VA)
+
+#include "taxsolve_VA_760_2021.c"
+
+double old_TaxRateFunction( double income, int status )
+{
+ if (income < 3000.0) return income * 0.02; else
+ if (income < 5000.0) return  60.0 + (income - 3000.0) * 0.03; else
+ if (income < 17000.0) return 120.0 + (income - 5000.0) * 0.05; else
+ return 720.0 + (income - 17000.0) * 0.0575;
+}
+
+void old_Report_bracket_info( double income, double tx, int status )
+{
+ double rate;
+ if (income < 3000.0) rate = 0.02;  else
+ if (income < 5000.0) rate = 0.03;  else
+ if (income < 17000.0) rate = 0.05; else  rate = 0.0575;
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+	  100.0 * rate, 100.0 * tx / income );
+}
+
+void report_old( double income, int status ) { old_Report_bracket_info( income, old_TaxRateFunction( income, status ), status ); }
+void report_new( double income, int status ) { Report_bracket_info( income, TaxRateFunction( income, status ), status ); }
+void (*old_report)( double income, int status )=report_old;
+void (*new_report)( double income, int status )=report_new;
+
+char *solver="VA 760";
+int nstatus=1;		/* The tax does not depend on it. */
+double max_income=3e6;
+struct tax_check tax_checks[]={
+ { "TaxRateFunction", old_TaxRateFunction, TaxRateFunction },
+ { 0 } };
+struct known_difference known[]={ { 0 } };
+
+int solver_schedules( struct tax_schedule *s[] )
+{
+ s[0] = &tax_schedule;
+ return 1;
+}
+
+
+#else
+ #error "Build with one of -DCHECK_US_1040, -DCHECK_f2210, -DCHECK_CA_540, -DCHECK_CA_5805, -DCHECK_NJ, -DCHECK_NY, -DCHECK_OH, -DCHECK_VA."
+#endif
+
+#undef main
+
+
+long npoints=0, nmismatches=0;
+
+
+void difference( char *check, double income, int status, char *old_result, char *new_result )
+{
+ struct known_difference *k;
+
+ for (k=known; k->why != 0; k++)
+  if (((k->check == 0) || (strcmp( k->check, check ) == 0)) && ((k->status == 0) || (k->status == status))
+	&& (income >= k->from) && (income <= k->to))
+   { k->seen++;  return; }
+ if (nmismatches++ < 20)
+  console_printf("  MISMATCH %s, status %d, income %1.2f:  old %s, new %s\n", check, status, income, old_result, new_result );
+}
+
+
+char *report_text( void (*report)( double income, int status ), double income, int status, char *text, int sz )
+{
+ long n;
+
+ rewind( outfile );
+ quiet = 1;
+ report( income, status );
+ quiet = 0;
+ fflush( outfile );
+ n = ftell( outfile );
+ if (n > sz - 1) n = sz - 1;
+ rewind( outfile );
+ n = fread( text, 1, n, outfile );
+ text[n] = '\0';
+ return text;
+}
+
+
+void compare( double income, int status, int with_report )
+{
+ struct tax_check *c;
+ char old_text[1024], new_text[1024];
+ double old_tax, new_tax;
+
+ npoints++;
+ for (c=tax_checks; c->name != 0; c++)
+  {
+   old_tax = c->old_tax( income, status );
+   new_tax = c->new_tax( income, status );
+   if (fabs( new_tax - old_tax ) > 0.005)
+    {
+     sprintf( old_text, "%1.4f", old_tax );
+     sprintf( new_text, "%1.4f", new_tax );
+     difference( c->name, income, status, old_text, new_text );
+    }
+   else
+   if (fabs( new_tax - old_tax ) > c->largest)
+    c->largest = fabs( new_tax - old_tax );
+  }
+ if ((with_report) && (new_report != 0))
+  {
+   report_text( old_report, income, status, old_text, sizeof(old_text) );
+   report_text( new_report, income, status, new_text, sizeof(new_text) );
+   if (strcmp( old_text, new_text ) != 0)
+    difference( "report", income, status, old_text, new_text );
+  }
+}
+
+
+int main( int argc, char *argv[] )
+{
+ struct tax_schedule *schedules[MAX_TAX_BRACKETS];
+ struct tax_check *c;
+ struct known_difference *k;
+ char status_text[32];
+ int status, nschedules, j, b, failed=0;
+ double income, cents;
+ long dollar;
+
+ outfile = tmpfile();
+ nschedules = solver_schedules( schedules );
+ for (status=1; status <= nstatus; status++)
+  {
+   for (dollar=0; dollar <= 700000; dollar++)
+    for (cents=0.0; cents < 0.6; cents = cents + ((cents == 0.0) ? 0.01 : 0.49))
+     compare( (double)dollar + cents, status, (dollar % 10 == 0) && (cents == 0.0) );
+   for (income=700000.0; income <= 3e6; income = income + 97.31)
+    compare( income, status, 1 );
+   for (income=3e6; income <= max_income; income = income + 9973.31)
+    compare( income, status, 1 );
+   for (j=0; j < nschedules; j++)
+    for (b=0; b < schedules[j]->nbrackets; b++)
+     for (cents=-0.01; cents < 0.015; cents = cents + 0.01)
+      compare( money_to_dollars( schedules[j]->start[b] ) + cents, status, 1 );
+  }
+
+ console_printf("%s:  %ld points, in %d filing statuses.\n", solver, npoints, nstatus );
+ for (c=tax_checks; c->name != 0; c++)
+  console_printf("  %-22s largest other difference %1.6f\n", c->name, c->largest );
+ for (k=known; k->why != 0; k++)
+  {
+   if (k->status == 0)
+    strcpy( status_text, "any status" );
+   else
+    sprintf( status_text, "status %d", k->status );
+   console_printf("  Known difference in %s, %s, %1.2f to %1.2f:  %ld points.\n     %s\n",
+	  (k->check != 0) ? k->check : "all results", status_text, k->from, k->to, k->seen, k->why );
+   if (k->seen == 0)
+    { console_printf("  ... but it was not found.\n");  failed = 1; }
+  }
+ if (nmismatches > 0)
+  { console_printf("  %ld points differ.\n", nmismatches);  failed = 1; }
+ else
+  console_printf("  No other differences.\n");
+ return failed;
+}
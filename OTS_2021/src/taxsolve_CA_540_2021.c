@@ -31,8 +31,11 @@ float thisversion=19.01;
 #include <string.h>
 #include <strings.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 #include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+#include "taxsolve_tax_tables_2021.h"
 
 #define SINGLE 		        1
 #define MARRIED_FILING_JOINTLY  2
@@ -50,113 +53,43 @@ double 	sched540part2[MAX_LINES], sched540part2_sub[MAX_LINES], sched540part2_ad
 	*street_address="", *apartment="", *town="", *zipcode="";
 
 
-double TaxRateFormula( double income, int status )
-{											/* Updated for 2021. */
- double tax;
+
+struct tax_schedule *tax_schedule_for( int status )
+{
  if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
-  {
-   if (income <   9325.00)  tax =             0.01 * income;                else
-   if (income <  22107.00)  tax =    93.25 +  0.02 * (income -   9325.00);  else
-   if (income <  34892.00)  tax =   348.89 +  0.04 * (income -  22107.00);  else
-   if (income <  48435.00)  tax =   860.29 +  0.06 * (income -  34892.00);  else
-   if (income <  61214.00)  tax =  1672.87 +  0.08 * (income -  48435.00);  else
-   if (income < 312686.00)  tax =  2695.19 + 0.093 * (income -  61214.00);  else
-   if (income < 375221.00)  tax = 26082.09 + 0.103 * (income - 312686.00);  else
-   if (income < 625369.00)  tax = 32523.20 + 0.113 * (income - 375221.00);
-   else                     tax = 60789.92 + 0.123 * (income - 625369.00);
-  }
+  return &(ca_tax_schedules[0]);
  else
  if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
-  {
-   if (income <   18650.00)  tax =              0.01 * income;                 else
-   if (income <   44214.00)  tax =    186.50 +  0.02 * (income -   18650.00);  else
-   if (income <   69784.00)  tax =    697.78 +  0.04 * (income -   44214.00);  else
-   if (income <   96870.00)  tax =   1720.58 +  0.06 * (income -   69784.00);  else
-   if (income <  122428.00)  tax =   3345.74 +  0.08 * (income -   96870.00);  else
-   if (income <  625372.00)  tax =   5390.38 + 0.093 * (income -  122428.00);  else
-   if (income <  750442.00)  tax =  52164.17 + 0.103 * (income -  625372.00);  else
-   if (income < 1250738.00)  tax =  65046.38 + 0.113 * (income -  750442.00);
-   else                      tax = 121579.83 + 0.123 * (income - 1250738.00);
-  }
+  return &(ca_tax_schedules[1]);
  else
-  {
-   if (income <  18663.00)  tax =             0.01 * income;                else
-   if (income <  44217.00)  tax =   186.63 +  0.02 * (income -  18663.00);  else
-   if (income <  56999.00)  tax =   697.71 +  0.04 * (income -  44217.00);  else
-   if (income <  70542.00)  tax =  1208.99 +  0.06 * (income -  56999.00);  else
-   if (income <  83324.00)  tax =  2021.57 +  0.08 * (income -  70542.00);  else
-   if (income < 425251.00)  tax =  3044.13 + 0.093 * (income -  83324.00);  else
-   if (income < 510303.00)  tax = 34843.34 + 0.103 * (income - 425251.00);  else
-   if (income < 850503.00)  tax = 43603.70 + 0.113 * (income - 510303.00); 
-   else                     tax = 82046.30 + 0.123 * (income - 850503.00);
-  }
- return (int)(tax+0.5);
+  return &(ca_tax_schedules[2]);
+}
+
+
+double TaxRateFormula( double x, int status )	/* Exact, rounded once to whole dollars. */
+{
+ return scheduled_tax( tax_schedule_for( status ), x, TAX_DOLLARS, 0 );
 }
 
 
 void Report_bracket_info( double income, int status )
 {
  double tx, rate;
- tx = TaxRateFormula( income, status );
- if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
-  {
-   if (income <    9325.00)  rate = 0.01;  else
-   if (income <   22107.00)  rate = 0.02;  else
-   if (income <   34892.00)  rate = 0.04;  else
-   if (income <   48435.00)  rate = 0.06;  else
-   if (income <   61214.00)  rate = 0.08;  else
-   if (income <  312686.00)  rate = 0.093;  else
-   if (income <  375221.00)  rate = 0.103;  else
-   if (income <  625369.00)  rate = 0.113;  else  rate = 0.123;
-  }
- else
- if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
-  {
-   if (income <   18650.00)  rate = 0.01;  else
-   if (income <   44214.00)  rate = 0.02;  else
-   if (income <   69784.00)  rate = 0.04;  else
-   if (income <   96870.00)  rate = 0.06;  else
-   if (income <  122428.00)  rate = 0.08;  else
-   if (income <  625372.00)  rate = 0.093;  else
-   if (income <  750442.00)  rate = 0.103;  else
-   if (income < 1250738.00)  rate = 0.113;  else  rate = 0.123;
-  }
- else
-  {
-   if (income <  18663.00)  rate = 0.01;  else
-   if (income <  44217.00)  rate = 0.02;  else
-   if (income <  56999.00)  rate = 0.04;  else
-   if (income <  70542.00)  rate = 0.06;  else
-   if (income <  83324.00)  rate = 0.08;  else
-   if (income < 425251.00)  rate = 0.093;  else
-   if (income < 510303.00)  rate = 0.103;  else
-   if (income < 850503.00)  rate = 0.113;  else  rate = 0.123;
-  }
- printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ tx = scheduled_tax( tax_schedule_for( status ), income, TAX_DOLLARS, &rate );
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
- fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
 }
 
 
 double TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
 {
- double x, tx;
- int k;
-
- if (income < 100000.0)   /* Quantize to match tax-table exactly. */
-  {
-   if (income < 99951.0) 
-    {
-     k = (income + 49) / 100;
-     x = 100 * (double)k;
-    }
-   else x = 99975.0;
-   tx = (int)(TaxRateFormula( x, status ));
-  }
- else
-  tx = TaxRateFormula( income, status );
- return tx;
+ int row;
+ row = ca_tax_table_row( income );
+ if (row < 0)
+  return TaxRateFormula( income, status );
+ return ca_tax_table[row][tax_schedule_for( status ) - ca_tax_schedules];
 }
 
 
@@ -164,7 +97,7 @@ void test_tax_function()
 {
  double income;
  for (income=50.0; income < 100000.0; income = income + 100.0)
-  printf("%g: %8g %8g %8g\n", income,
+  console_printf("%g: %8g %8g %8g\n", income,
 		TaxRateFunction( income, SINGLE ),
 		TaxRateFunction( income, MARRIED_FILING_JOINTLY ), 
 		TaxRateFunction( income, HEAD_OF_HOUSEHOLD ) );
@@ -214,8 +147,8 @@ void grab_line_value( char *label, char *fline, double *value )
  next_word(fline, twrd, " \t=;");
  if ((twrd[0] != '\0') && (sscanf(twrd,"%lf", value) != 1))
   {
-   printf("Error: Reading Fed %s '%s%s'\n", label, twrd, fline);
-   fprintf(outfile,"Error: Reading Fed %s '%s%s'\n", label, twrd, fline);
+   console_printf("Error: Reading Fed %s '%s%s'\n", label, twrd, fline);
+   results_fprintf(outfile,"Error: Reading Fed %s '%s%s'\n", label, twrd, fline);
   }
 }
 
@@ -239,15 +172,81 @@ void grab_line_alloc( char *fline, char **strng )
  char twrd[4096];
  grab_line_string( fline, twrd );
  if (twrd[0] != '\0')
-  *strng = strdup( twrd );
+  *strng = return_strdup( twrd );
 }
 
 
+/* Where each federal line goes.  Lines not listed here are handled below, by the form of their label. */
+struct label_field ca_fed_labels[]={
+ { "L2a",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L2a ) },
+ { "L3a",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L3a ) },
+ { "L4a",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L4a ) },
+ { "L4b",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L4b ) },
+ { "L5a",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L5a ) },
+ { "L5b",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L5b ) },
+ { "L6a",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L6a ) },
+ { "L6b",             LABEL_VALUE,  offsetof( struct FedReturnData, fed_L6b ) },
+ { "L8a",             LABEL_VALUE,  offsetof( struct FedReturnData, fedline[8] ) },
+ { "L8b",             LABEL_VALUE,  offsetof( struct FedReturnData, fedl8b ) },
+ { "L9a",             LABEL_VALUE,  offsetof( struct FedReturnData, fedline[9] ) },
+ { "L9b",             LABEL_VALUE,  offsetof( struct FedReturnData, fedl9b ) },
+ { "L15a",            LABEL_VALUE,  offsetof( struct FedReturnData, fedl15a ) },
+ { "L15b",            LABEL_VALUE,  offsetof( struct FedReturnData, fedline[15] ) },
+ { "L16a",            LABEL_VALUE,  offsetof( struct FedReturnData, fedl16a ) },
+ { "L16b",            LABEL_VALUE,  offsetof( struct FedReturnData, fedline[16] ) },
+ { "L20a",            LABEL_VALUE,  offsetof( struct FedReturnData, fedl20a ) },
+ { "L20b",            LABEL_VALUE,  offsetof( struct FedReturnData, fedline[20] ) },
+ { "A5a",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA5a ) },
+ { "A5b",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA5b ) },
+ { "A5c",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA5c ) },
+ { "A8a",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA8a ) },
+ { "A8b",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA8b ) },
+ { "A8c",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA8c ) },
+ { "A8d",             LABEL_VALUE,  offsetof( struct FedReturnData, schedA8d ) },
+ { "S1_8%c",          LABEL_LETTER, offsetof( struct FedReturnData, s1_8 ) },
+ { "S1_24%c",         LABEL_LETTER, offsetof( struct FedReturnData, s1_24 ) },
+ { "S2_17%c",         LABEL_LETTER, offsetof( struct FedReturnData, s2_17 ) },
+ { "S3_6%c",          LABEL_LETTER, offsetof( struct FedReturnData, s3_6 ) },
+ { "S3_13%c",         LABEL_LETTER, offsetof( struct FedReturnData, s3_13 ) },
+ { "Your1stName:",    LABEL_ALLOC,  0, &Your1stName },
+ { "YourLastName:",   LABEL_ALLOC,  0, &YourLastName },
+ { "YourSocSec#:",    LABEL_ALLOC,  0, &your_socsec },
+ { "Spouse1stName:",  LABEL_ALLOC,  0, &Spouse1stName },
+ { "SpouseLastName:", LABEL_ALLOC,  0, &SpouseLastName },
+ { "SpouseSocSec#:",  LABEL_ALLOC,  0, &spouse_socsec },
+ { "Number&Street:",  LABEL_ALLOC,  0, &street_address },
+ { "Apt#:",           LABEL_ALLOC,  0, &apartment },
+ { "Town/City:",      LABEL_ALLOC,  0, &town },
+ { "ZipCode:",        LABEL_ALLOC,  0, &zipcode },
+ { "AlimRecipSSN:",   LABEL_STRING, offsetof( struct FedReturnData, AlimRecipSSN ) },
+ { "S1_8z_Type:",     LABEL_STRING, offsetof( struct FedReturnData, OtherIncomeType ) },
+ { "S1_24z_Type:",    LABEL_STRING, offsetof( struct FedReturnData, OtherAdjustmentsType ) },
+ { "S2_17z_Type:",    LABEL_STRING, offsetof( struct FedReturnData, OtherTaxesType ) },
+ { "Dep1_FirstName:", LABEL_STRING, offsetof( struct FedReturnData, Dep1stName[1] ) },
+ { "Dep1_LastName:",  LABEL_STRING, offsetof( struct FedReturnData, DepLastName[1] ) },
+ { "Dep1_SocSec#:",   LABEL_STRING, offsetof( struct FedReturnData, DepSocSec[1] ) },
+ { "Dep1_Relation:",  LABEL_STRING, offsetof( struct FedReturnData, DepRelation[1] ) },
+ { "Dep2_FirstName:", LABEL_STRING, offsetof( struct FedReturnData, Dep1stName[2] ) },
+ { "Dep2_LastName:",  LABEL_STRING, offsetof( struct FedReturnData, DepLastName[2] ) },
+ { "Dep2_SocSec#:",   LABEL_STRING, offsetof( struct FedReturnData, DepSocSec[2] ) },
+ { "Dep2_Relation:",  LABEL_STRING, offsetof( struct FedReturnData, DepRelation[2] ) },
+ { "Dep3_FirstName:", LABEL_STRING, offsetof( struct FedReturnData, Dep1stName[3] ) },
+ { "Dep3_LastName:",  LABEL_STRING, offsetof( struct FedReturnData, DepLastName[3] ) },
+ { "Dep3_SocSec#:",   LABEL_STRING, offsetof( struct FedReturnData, DepSocSec[3] ) },
+ { "Dep3_Relation:",  LABEL_STRING, offsetof( struct FedReturnData, DepRelation[3] ) },
+};
+
+#include "taxsolve_CA_540_fed_labels_2021.h"
+
+
 int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 {
- FILE *infile;
+ struct fed_snapshot snap;
  char fline[2000], word[2000], tword[2000];
- int linenum, j;
+ struct label_slot *slot;
+ struct label_field *field=0;
+ double *value;
+ int linenum, j, k;
 
  for (linenum=0; linenum<MAX_LINES; linenum++) 
   { 
@@ -285,7 +284,7 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
    fed_data->s3_13[j] = 0.0;
   }
  strcpy( fed_data->AlimRecipSSN, "" );
- fed_data->AlimRecipName = strdup( "" );
+ fed_data->AlimRecipName = return_strdup( "" );
  strcpy( fed_data->OtherIncomeType, "" );
  strcpy( fed_data->OtherAdjustmentsType, "" );
  strcpy( fed_data->OtherTaxesType, "" );
@@ -297,329 +296,94 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
    strcpy( fed_data->DepRelation[j], "" );
   }
  convert_slashes( fedlogfile );
- infile = fopen(fedlogfile, "r");
- if (infile==0)
+ if (!load_fed_snapshot( fedlogfile, &snap ))
   {
-   printf("Error: Could not open Federal return '%s'\n", fedlogfile);
-   fprintf(outfile,"Error: Could not open Federal return '%s'\n", fedlogfile);
+   console_printf("Error: Could not open Federal return '%s'\n", fedlogfile);
+   results_fprintf(outfile,"Error: Could not open Federal return '%s'\n", fedlogfile);
    exit( 1 ); 
   }
  fed_data->Itemized = 1; /* Set initial default values. */
- read_line(infile,fline);  linenum = 0;
- while (!feof(infile))
+ linenum = 0;
+ for (k=0; k < snap.nrecords; k++)
   {
-   if (strstr(fline,"Use standard deduction.")!=0) fed_data->Itemized = 0;
-   next_word(fline, word, " \t=");
+   if (snap.records[k].flags & FED_STD_DEDUCTION) fed_data->Itemized = 0;
+   strncpy( word, fed_label( &snap, &(snap.records[k]) ), sizeof(word) - 1 );
+   word[sizeof(word) - 1] = '\0';
+   fed_rest( &snap, &(snap.records[k]), fline, sizeof(fline) );
+   slot = find_label( word, ca_fed_labels_slots, CA_FED_LABELS_NSLOTS, ca_fed_labels_disp, CA_FED_LABELS_NBUCKETS );
+   if (slot != 0)
+    field = &(ca_fed_labels[slot->field]);
+   if ((slot != 0) && ((field->kind == LABEL_STRING) || (field->kind == LABEL_ALLOC) || (snap.records[k].flags & FED_HAS_EQUALS)))
+    { /* Table */
+     value = (double *)((char *)fed_data + field->offset);
+     switch (field->kind)
+      {
+       case LABEL_VALUE:  grab_line_value( word, fline, value );  break;
+       case LABEL_LETTER:
+	next_word(fline, tword, " \t=");
+	if (sscanf( tword, "%lf", &(value[slot->index]) ) != 1)
+	 {
+	  console_printf("Error: Reading Fed %s '%s%s'\n", word, tword, fline);
+	  results_fprintf(outfile, "Error: Reading Fed %s '%s%s'\n", word, tword, fline);
+	 }
+	if (verbose) console_printf("FedLin.%s = %2.2f\n", word, value[slot->index] );
+	break;
+       case LABEL_STRING: grab_line_string( fline, (char *)fed_data + field->offset );  break;
+       case LABEL_ALLOC:  grab_line_alloc( fline, field->string );  break;
+      }
+    } /* Table */
+   else
    if ((word[0] == 'L') && (strstr(fline," = ")!=0))
     { /*L*/
-     if (strcmp(word,"L2a") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L2a) );
-     else
-     if (strcmp(word,"L3a") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L3a) );
-     else
-     if (strcmp(word,"L4a") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L4a) );
-     else
-     if (strcmp(word,"L4b") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L4b) );
-     else
-     if (strcmp(word,"L5a") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L5a) );
-     else
-     if (strcmp(word,"L5b") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L5b) );
-     else
-     if (strcmp(word,"L6a") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L6a) );
-     else
-     if (strcmp(word,"L6b") == 0)
-      grab_line_value( word, fline, &(fed_data->fed_L6b) );
-     else
-     if (strcmp(word,"L8a") == 0)
-      grab_line_value( word, fline, &(fed_data->fedline[8]) );
-     else
-     if (strcmp(word,"L8b") == 0)
-      grab_line_value( word, fline, &(fed_data->fedl8b) );
-     else
-     if (strcmp(word,"L9a") == 0)
-      grab_line_value( word, fline, &(fed_data->fedline[9]) );
-     else
-     if (strcmp(word,"L9b") == 0)
-      grab_line_value( word, fline, &(fed_data->fedl9b) );
-     else
-     if (strcmp(word,"L15a") == 0)
-      grab_line_value( word, fline, &(fed_data->fedl15a) );
-     else
-     if (strcmp(word,"L15b") == 0)
-      grab_line_value( word, fline, &(fed_data->fedline[15]) );
-     else
-     if (strcmp(word,"L16a") == 0)
-      grab_line_value( word, fline, &(fed_data->fedl16a) );
-     else
-     if (strcmp(word,"L16b") == 0)
-      grab_line_value( word, fline, &(fed_data->fedline[16]) );
-     else
-     if (strcmp(word,"L20a") == 0)
-      grab_line_value( word, fline, &(fed_data->fedl20a) );
-     else
-     if (strcmp(word,"L20b") == 0)
-      grab_line_value( word, fline, &(fed_data->fedline[20]) );
-     else
+     if (sscanf(&word[1],"%d",&linenum)!=1)
+      {
+       console_printf("Error: Reading Fed line number '%s%s'\n",word,fline);
+       results_fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
+      }
+     next_word(fline, word, " \t=");
+     if (sscanf(word,"%lf", &fed_data->fedline[linenum])!=1)
       {
-       if (sscanf(&word[1],"%d",&linenum)!=1)
-	{
-	 printf("Error: Reading Fed line number '%s%s'\n",word,fline);
-	 fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
-	}
-       next_word(fline, word, " \t=");
-       if (sscanf(word,"%lf", &fed_data->fedline[linenum])!=1)
-	{
-	 printf("Error: Reading Fed line %d '%s%s'\n",linenum,word,fline);
-	 fprintf(outfile,"Error: Reading Fed line %d '%s%s'\n",linenum,word,fline);
-	}
-       if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
+       console_printf("Error: Reading Fed line %d '%s%s'\n",linenum,word,fline);
+       results_fprintf(outfile,"Error: Reading Fed line %d '%s%s'\n",linenum,word,fline);
       }
+     if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
     } /*L*/
    else
-
-   if (strcmp(word, "Your1stName:" ) == 0)
-    grab_line_alloc( fline, &Your1stName );
-   else
-   if (strcmp(word, "YourLastName:" ) == 0)
-    grab_line_alloc( fline, &YourLastName );
-   else
-   if (strcmp(word, "YourSocSec#:" ) == 0)
-    grab_line_alloc( fline, &your_socsec );
-   else
-   if (strcmp(word, "Spouse1stName:" ) == 0)
-    grab_line_alloc( fline, &Spouse1stName );
-   else
-   if (strcmp(word, "SpouseLastName:" ) == 0)
-    grab_line_alloc( fline, &SpouseLastName );
-   else
-   if (strcmp(word, "SpouseSocSec#:" ) == 0)
-    grab_line_alloc( fline, &spouse_socsec );
-   else
-   if (strcmp(word, "Number&Street:" ) == 0)
-    grab_line_alloc( fline, &street_address );
-   else
-   if (strcmp(word, "Apt#:" ) == 0)
-    grab_line_alloc( fline, &apartment );
-   else
-   if (strcmp(word, "Town/City:" ) == 0)
-    grab_line_alloc( fline, &town );
-   else
-   if (strcmp(word, "ZipCode:" ) == 0)
-    grab_line_alloc( fline, &zipcode );
-   else
-
    if (strncmp(word, "AlimRecipSSN", 12) == 0)
     grab_line_string( fline, fed_data->AlimRecipSSN );
    else
-   if (strcmp( word, "S1_8z_Type:" ) == 0)
-    grab_line_string( fline, fed_data->OtherIncomeType );
-   else
-   if (strcmp( word, "S1_24z_Type:" ) == 0)
-    grab_line_string( fline, fed_data->OtherAdjustmentsType );
-   else
-   if (strcmp( word, "S2_17z_Type:" ) == 0)
-    grab_line_string( fline, fed_data->OtherTaxesType );
-   else
-
-   if (strcmp(word, "Dep1_FirstName:") == 0)
-    grab_line_string( fline, fed_data->Dep1stName[1] );
-   else
-   if (strcmp(word, "Dep1_LastName:") == 0)
-    grab_line_string( fline, fed_data->DepLastName[1] );
-   else
-   if (strcmp(word, "Dep1_SocSec#:") == 0)
-    grab_line_string( fline, fed_data->DepSocSec[1] );
-   else
-   if (strcmp(word, "Dep1_Relation:") == 0)
-    grab_line_string( fline, fed_data->DepRelation[1] );
-   else
-
-   if (strcmp(word, "Dep2_FirstName:") == 0)
-    grab_line_string( fline, fed_data->Dep1stName[2] );
-   else
-   if (strcmp(word, "Dep2_LastName:") == 0)
-    grab_line_string( fline, fed_data->DepLastName[2] );
-   else
-   if (strcmp(word, "Dep2_SocSec#:") == 0)
-    grab_line_string( fline, fed_data->DepSocSec[2] );
-   else
-   if (strcmp(word, "Dep2_Relation:") == 0)
-    grab_line_string( fline, fed_data->DepRelation[2] );
-   else
-
-   if (strcmp(word, "Dep3_FirstName:") == 0)
-    grab_line_string( fline, fed_data->Dep1stName[3] );
-   else
-   if (strcmp(word, "Dep3_LastName:") == 0)
-    grab_line_string( fline, fed_data->DepLastName[3] );
-   else
-   if (strcmp(word, "Dep3_SocSec#:") == 0)
-    grab_line_string( fline, fed_data->DepSocSec[3] );
-   else
-   if (strcmp(word, "Dep3_Relation:") == 0)
-    grab_line_string( fline, fed_data->DepRelation[3] );
-   else
-
    if ((word[0] == 'A') && (strstr(word,"AMT")!=word) && (strstr(fline," = ")!=0))
     {
-     if (strcmp(word,"A5a") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA5a) );
-     else
-     if (strcmp(word,"A5b") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA5b) );
-     else
-     if (strcmp(word,"A5c") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA5c) );
-     else
-     if (strcmp(word,"A8a") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA8a) );
-     else
-     if (strcmp(word,"A8b") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA8b) );
-     else
-     if (strcmp(word,"A8c") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA8c) );
-     else
-     if (strcmp(word,"A8d") == 0)
-      grab_line_value( word, fline, &(fed_data->schedA8d) );
-     else
+     if (sscanf(&word[1],"%d",&linenum)!=1)
+      {
+       console_printf("Error: Reading Fed line number '%s%s'\n",word,fline);
+       results_fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
+      }
+     next_word(fline, word, " \t=");
+     if (sscanf(word,"%lf", &fed_data->schedA[linenum])!=1) 
       {
-       if (sscanf(&word[1],"%d",&linenum)!=1)
-        {
-	 printf("Error: Reading Fed line number '%s%s'\n",word,fline);
-	 fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
-        }
-       next_word(fline, word, " \t=");
-       if (sscanf(word,"%lf", &fed_data->schedA[linenum])!=1) 
-        {
- 	 printf("Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
-	 fprintf(outfile, "Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
-        }
-       if (verbose) printf("FedLin.A[%d] = %2.2f\n", linenum, fed_data->schedA[linenum]);
+       console_printf("Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
+       results_fprintf(outfile, "Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
       }
+     if (verbose) console_printf("FedLin.A[%d] = %2.2f\n", linenum, fed_data->schedA[linenum]);
     }
    else
    if ((strncmp( word, "S1_", 3 ) == 0) && (strstr(fline," = ")!=0))
     {
-       next_word( &(word[3]), tword, " \t: =" );
-       if ((tword[0] == '8') && (tword[1] >= 'a') && (tword[1] <= 'z'))
-	{ int j;
-	  if ((tword[1] >= 'a') && (tword[1] <= 'z'))
-	   {
-	    j = tword[1] - 'a';
-	    next_word(fline, word, " \t=");
-	    if (sscanf( word, "%lf", &fed_data->s1_8[j] ) != 1)
-	     {
-	      printf("Error: Reading Fed s1_8%c '%s%s'\n", 'a' + j, word, fline);
-	      fprintf(outfile, "Error: Reading Fed s1_8%c '%s%s'\n", 'a' + j, word, fline);
-	     }
-	   }
-	  else
-	   printf("Error: Unexpected line '%s'\n", word );
-         if (verbose) printf("FedLin.S1_8%c] = %2.2f\n", 'a' + j, fed_data->s1_8[j] );
-	}
-       else
-       if ((strncmp( tword, "24", 2 ) == 0) && (tword[2] >= 'a') && (tword[2] <= 'z'))
-	{ int j;
-	  if ((tword[2] >= 'a') && (tword[2] <= 'z'))
-	   {
-	    j = tword[2] - 'a';
-	    next_word(fline, word, " \t=");
-	    if (sscanf( word, "%lf", &fed_data->s1_24[j] ) != 1)
-	     {
-	      printf("Error: Reading Fed s1_24%c '%s%s'\n", 'a' + j, word, fline);
-	      fprintf(outfile, "Error: Reading Fed s1_24%c '%s%s'\n", 'a' + j, word, fline);
-	     }
-	   }
-	  else
-	   printf("Error: Unexpected line '%s'\n", word );
-         if (verbose) printf("FedLin.S1_24%c = %2.2f\n", 'a' + j, fed_data->s1_24[j] );
-	}
-       else
-	{
-         if (sscanf( tword, "%d", &linenum ) != 1)
-          {
-  	   printf("Error: Reading Fed line number 'S1_%s %s'\n", tword, fline);
-	   fprintf(outfile,"Error: Reading Fed line number 'S1_%s %s'\n", tword, fline);
-           }
-         next_word(fline, word, " \t=");
-         if (sscanf(word,"%lf", &fed_data->sched1[linenum])!=1) 
-          {
-    	   printf("Error: Reading Fed sched1 %d '%s%s'\n", linenum, word, fline);
-	   fprintf(outfile, "Error: Reading Fed sched1 %d '%s%s'\n", linenum, word, fline);
-          }
-         if (verbose) printf("FedLin.S1[%d] = %2.2f\n", linenum, fed_data->sched1[linenum]);
-        }
-    }
-   else
-
-   if ((strncmp( word, "S2_", 3 ) == 0) && (strstr(fline," = ")!=0))
-    {
-       next_word( &(word[3]), tword, " \t: =" );
-       if ((strncmp( tword, "17", 2 ) == 0) && (tword[2] >= 'a') && (tword[2] <= 'z'))
-	{ int j;
-	  if ((tword[2] >= 'a') && (tword[2] <= 'z'))
-	   {
-	    j = tword[2] - 'a';
-	    next_word(fline, word, " \t=");
-	    if (sscanf( word, "%lf", &fed_data->s2_17[j] ) != 1)
-	     {
-	      printf("Error: Reading Fed s2_17%c '%s%s'\n", 'a' + j, word, fline);
-	      fprintf(outfile, "Error: Reading Fed s2_17%c '%s%s'\n", 'a' + j, word, fline);
-	     }
-	   }
-	  else
-	   printf("Error: Unexpected line '%s'\n", word );
-         if (verbose) printf("FedLin.S2_17%c = %2.2f\n", 'a' + j, fed_data->s2_17[j] );
-	}
-    }
-   else
-
-   if ((strncmp( word, "S3_", 3 ) == 0) && (strstr(fline," = ")!=0))
-    {
-       next_word( &(word[3]), tword, " \t: =" );
-       if ((strncmp( tword, "6", 1 ) == 0) && (tword[1] >= 'a') && (tword[1] <= 'z'))
-	{ int j;
-	  if ((tword[1] >= 'a') && (tword[1] <= 'z'))
-	   {
-	    j = tword[1] - 'a';
-	    next_word(fline, word, " \t=");
-	    if (sscanf( word, "%lf", &fed_data->s3_6[j] ) != 1)
-	     {
-	      printf("Error: Reading Fed s3_6%c '%s%s'\n", 'a' + j, word, fline);
-	      fprintf(outfile, "Error: Reading Fed s3_6%c '%s%s'\n", 'a' + j, word, fline);
-	     }
-	   }
-	  else
-	   printf("Error: Unexpected line '%s'\n", word );
-         if (verbose) printf("FedLin.S3_6%c = %2.2f\n", 'a' + j, fed_data->s3_6[j] );
-	}
-       else
-       if ((strncmp( tword, "13", 2 ) == 0) && (tword[2] >= 'a') && (tword[2] <= 'z'))
-	{ int j;
-	  if ((tword[2] >= 'a') && (tword[2] <= 'z'))
-	   {
-	    j = tword[2] - 'a';
-	    next_word(fline, word, " \t=");
-	    if (sscanf( word, "%lf", &fed_data->s3_13[j] ) != 1)
-	     {
-	      printf("Error: Reading Fed s3_13%c '%s%s'\n", 'a' + j, word, fline);
-	      fprintf(outfile, "Error: Reading Fed s3_13%c '%s%s'\n", 'a' + j, word, fline);
-	     }
-	   }
-	  else
-	   printf("Error: Unexpected line '%s'\n", word );
-         if (verbose) printf("FedLin.S3_13%c = %2.2f\n", 'a' + j, fed_data->s3_13[j] );
-	}
+     next_word( &(word[3]), tword, " \t: =" );
+     if (sscanf( tword, "%d", &linenum ) != 1)
+      {
+       console_printf("Error: Reading Fed line number 'S1_%s %s'\n", tword, fline);
+       results_fprintf(outfile,"Error: Reading Fed line number 'S1_%s %s'\n", tword, fline);
+      }
+     next_word(fline, word, " \t=");
+     if (sscanf(word,"%lf", &fed_data->sched1[linenum])!=1) 
+      {
+       console_printf("Error: Reading Fed sched1 %d '%s%s'\n", linenum, word, fline);
+       results_fprintf(outfile, "Error: Reading Fed sched1 %d '%s%s'\n", linenum, word, fline);
+      }
+     if (verbose) console_printf("FedLin.S1[%d] = %2.2f\n", linenum, fed_data->sched1[linenum]);
     }
-
-
    else
    if (strcmp(word,"Status") == 0)
     {
@@ -631,14 +395,14 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
      if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
      else 
       { 
-       printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-       fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word);
+       console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+       results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word);
+       release_fed_snapshot( &snap );
        return 0; 
       }
     }
-   read_line(infile,fline);
   }
- fclose(infile);
+ release_fed_snapshot( &snap );
  return 1;
 }
 
@@ -659,7 +423,7 @@ char *pull_initial( char *name )
    }
   else
    strcpy( midinitial, "" );
-  return strdup( midinitial );
+  return return_strdup( midinitial );
 }
 
 void display_part2column( int j, int col )
@@ -668,21 +432,21 @@ void display_part2column( int j, int col )
   {
    case 0: 
 	if (sched540part2[j] != 0.0)
-	 fprintf(outfile," SchedCA540_Part2_%d = %6.2f\n", j, sched540part2[j] );
+	 results_fprintf(outfile," SchedCA540_Part2_%d = %6.2f\n", j, sched540part2[j] );
 	break;
    case 'a':
 	if (sched540part2[j] != 0.0)
-	 fprintf(outfile," SchedCA540_Part2_%da = %6.2f\n", j, sched540part2[j] );
+	 results_fprintf(outfile," SchedCA540_Part2_%da = %6.2f\n", j, sched540part2[j] );
 	break;
    case 'b':
 	if (sched540part2_sub[j] != 0.0)
-	 fprintf(outfile," SchedCA540_Part2_%db = %6.2f\n", j, sched540part2_sub[j] );
+	 results_fprintf(outfile," SchedCA540_Part2_%db = %6.2f\n", j, sched540part2_sub[j] );
 	break;
    case 'c':
 	if (sched540part2_add[j] != 0.0)
-	 fprintf(outfile," SchedCA540_Part2_%dc = %6.2f\n", j, sched540part2_add[j] );
+	 results_fprintf(outfile," SchedCA540_Part2_%dc = %6.2f\n", j, sched540part2_add[j] );
 	break;
-   default:  fprintf(outfile," Bad Case\n");
+   default:  results_fprintf(outfile," Bad Case\n");
   }
 }
 
@@ -698,7 +462,7 @@ void display_part2( int j )
 /*----------------------------------------------------------------------------*/
 /* ---				Main					  --- */
 /*----------------------------------------------------------------------------*/
-int main( int argc, char *argv[] )
+int taxsolve_CA_540( int argc, char *argv[] )
 {
  int argk, j, k, iline7, iline8, iline9, iline10;
  double min2file=0.0, sched540A[MAX_LINES], sched540B[MAX_LINES], sched540C[MAX_LINES],
@@ -724,30 +488,36 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[argk],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[argk],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[argk],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[argk],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[argk],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
   if (k==1)
    {
-    infname = strdup(argv[argk]);
-    infile = fopen(argv[argk],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[argk]); exit(1);}
+    infname = return_strdup(argv[argk]);
+    infile = taxsolve_fopen(argv[argk],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[argk]); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[argk]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[argk]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[argk]); exit(1);}
   argk = argk + 1;
  }
  // test_tax_function();
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (j=0; j<MAX_LINES; j++) 
@@ -773,7 +543,7 @@ int main( int argc, char *argv[] )
 	L12	34900.0  {Wages}
  */
 
- printf("CA-540 2021 - v%3.2f\n", thisversion);
+ console_printf("CA-540 2021 - v%3.2f\n", thisversion);
 
  // MarkupPDF( 1, 240, 40, 17, 1.0, 0, 0 ) NotReady "This program is NOT updated for 2021."
  // add_pdf_markup( "NotReady", 1, 240, 40, 17, 1, 1.0, 0, 0, "\"This program is NOT ready for 2021.\"" );
@@ -787,7 +557,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  get_parameter( infile, 's', word, "FileName" );      /* Preliminary Fed Return Output File-name. */
  get_word(infile, prelim_1040_outfilename );
@@ -796,22 +566,22 @@ int main( int argc, char *argv[] )
  /* Filing Status. */
  switch (status)
  {
-  case SINGLE: 			fprintf(outfile,"Status = Single (%d)\nCkSingle: X\nL7a = 1\n", status); break;
-  case MARRIED_FILING_JOINTLY: fprintf(outfile,"Status = Married/Joint (%d)\nCkMFJ: X\nL7a = 2\n", status); break;
-  case MARRIED_FILING_SEPARAT: fprintf(outfile,"Status = Married/Sep (%d)\nCkMFS: X\nL7a = 1\n", status); break;
-  case HEAD_OF_HOUSEHOLD: 	fprintf(outfile,"Status = Head_of_Household (%d)\nCkHH: X\nL7a = 1\n", status); break;
-  case WIDOW: 		  	fprintf(outfile,"Status = Widow(er) (%d)\nCkQW: X\nL7a = 1\n", status); break;
+  case SINGLE: 			results_fprintf(outfile,"Status = Single (%d)\nCkSingle: X\nL7a = 1\n", status); break;
+  case MARRIED_FILING_JOINTLY: results_fprintf(outfile,"Status = Married/Joint (%d)\nCkMFJ: X\nL7a = 2\n", status); break;
+  case MARRIED_FILING_SEPARAT: results_fprintf(outfile,"Status = Married/Sep (%d)\nCkMFS: X\nL7a = 1\n", status); break;
+  case HEAD_OF_HOUSEHOLD: 	results_fprintf(outfile,"Status = Head_of_Household (%d)\nCkHH: X\nL7a = 1\n", status); break;
+  case WIDOW: 		  	results_fprintf(outfile,"Status = Widow(er) (%d)\nCkQW: X\nL7a = 1\n", status); break;
  }
- fprintf(outfile,"\nStep-2 fill-in box %d\n", status );
+ results_fprintf(outfile,"\nStep-2 fill-in box %d\n", status );
 
  /* Exemptions. */
  get_parameter( infile, 's', word, "L6" );	/* Are you a dependent? (yes/No). */
  get_parameter( infile, 'b', &j, "L6");
  L[6] = j;
  if (L[6] == 0)
-  fprintf(outfile," L6 = no\n");
+  results_fprintf(outfile," L6 = no\n");
  else
-  fprintf(outfile," L6 = yes, (check box on line 6).\n  CkDep: X\n");
+  results_fprintf(outfile," L6 = yes, (check box on line 6).\n  CkDep: X\n");
 
  if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT) || (status==HEAD_OF_HOUSEHOLD))
   iline7 = 1;  else  iline7 = 2;
@@ -823,19 +593,19 @@ int main( int argc, char *argv[] )
  get_parameter( infile, 'i', &iline8, "L8" );
  L[8] = iline8 * 129.0;							/* Updated for 2021. */
  showline(8);
- if (iline8 > 0) fprintf(outfile,"  L8a = %d\n", iline8 );
+ if (iline8 > 0) results_fprintf(outfile,"  L8a = %d\n", iline8 );
 
  get_parameter( infile, 's', word, "L9" );	/* Senior?, 1 if you or spouse, 2 if both. */
  get_parameter( infile, 'i', &iline9, "L9" );
  L[9] = iline9 * 129.0;							/* Updated for 2021. */
  showline(9);
- if (iline9 > 0) fprintf(outfile,"  L9a = %d\n", iline9 );
+ if (iline9 > 0) results_fprintf(outfile,"  L9a = %d\n", iline9 );
 
  get_parameter( infile, 's', word, "L10" );  /* Number of Dependents. */
  get_parameter( infile, 'i', &iline10, "L10"); 
  L[10] = iline10 * 400.0;						/* Updated for 2021. */
  showline(10);
- if (iline10 > 0) fprintf(outfile,"  L10a = %d\n", iline10 );
+ if (iline10 > 0) results_fprintf(outfile,"  L10a = %d\n", iline10 );
 
  L[11] = L[7] + L[8] + L[9] + L[10];
  showline_wmsg(11, "Exemption amount");
@@ -999,25 +769,25 @@ int main( int argc, char *argv[] )
    sched540B[j] = PrelimFedReturn.sched1[j];
    sched540B[10] = sched540B[10] + sched540B[j];
    if (sched540B[j] != 0.0)
-    fprintf(outfile," SchedCA540_B%d = %6.2f\n", j, sched540B[j] );
+    results_fprintf(outfile," SchedCA540_B%d = %6.2f\n", j, sched540B[j] );
 
    sched540Bb[10] = sched540Bb[10] + sched540Bb[j];
    if (sched540Bb[j] != 0.0)
-    fprintf(outfile," SchedCA540_B%db = %6.2f\n", j, sched540Bb[j] );
+    results_fprintf(outfile," SchedCA540_B%db = %6.2f\n", j, sched540Bb[j] );
 
    sched540Bc[10] = sched540Bc[10] + sched540Bc[j];
    if (sched540Bc[j] != 0.0)
-    fprintf(outfile," SchedCA540_B%dc = %6.2f\n", j, sched540Bc[j] );
+    results_fprintf(outfile," SchedCA540_B%dc = %6.2f\n", j, sched540Bc[j] );
   }
 
  for (j=0; j < 30; j++)
   {
    if (PrelimFedReturn.s1_8[j] != 0.0)
-    fprintf(outfile," SchedCA540_B8%c = %6.2f\n", 'A' + j, PrelimFedReturn.s1_8[j] );
+    results_fprintf(outfile," SchedCA540_B8%c = %6.2f\n", 'A' + j, PrelimFedReturn.s1_8[j] );
   }
 
   if (PrelimFedReturn.OtherIncomeType[0] != '\0')
-   fprintf(outfile," SchedCA540_B8Za: %s\n", PrelimFedReturn.OtherIncomeType );
+   results_fprintf(outfile," SchedCA540_B8Za: %s\n", PrelimFedReturn.OtherIncomeType );
 
   sched540Bc[9] = sched540Bc[9] + sched540Bc8a;
   showline_wlabelnz( " SchedCA540_B8Ac",  sched540Bc8a );
@@ -1068,26 +838,26 @@ int main( int argc, char *argv[] )
     sched540C[j] = PrelimFedReturn.sched1[j];
     sched540C[26] = sched540C[26] + sched540C[j];
     if (sched540C[j] != 0.0)
-     fprintf(outfile," SchedCA540_C%d = %6.2f\n", j, sched540C[j] );
+     results_fprintf(outfile," SchedCA540_C%d = %6.2f\n", j, sched540C[j] );
 
     sched540Cb[26] = sched540Cb[26] + sched540Cb[j];
     if (sched540Cb[j] != 0.0)
-     fprintf(outfile," SchedCA540_C%db = %6.2f\n", j, sched540Cb[j] );
+     results_fprintf(outfile," SchedCA540_C%db = %6.2f\n", j, sched540Cb[j] );
 
     sched540Cc[26] = sched540Cc[26] + sched540Cc[j];
     if (sched540Cc[j] != 0.0)
-     fprintf(outfile," SchedCA540_C%dc = %6.2f\n", j, sched540Cc[j] );
+     results_fprintf(outfile," SchedCA540_C%dc = %6.2f\n", j, sched540Cc[j] );
    }
 
   if (PrelimFedReturn.AlimRecipSSN[0] != '\0')
-   fprintf(outfile," AlimRecipSSN: %s\n", PrelimFedReturn.AlimRecipSSN );
+   results_fprintf(outfile," AlimRecipSSN: %s\n", PrelimFedReturn.AlimRecipSSN );
   if (PrelimFedReturn.AlimRecipName[0] != '\0')
-   fprintf(outfile," AlimRecipName: %s\n", PrelimFedReturn.AlimRecipName );
+   results_fprintf(outfile," AlimRecipName: %s\n", PrelimFedReturn.AlimRecipName );
 
  for (j=0; j < 30; j++)
   {
    if (PrelimFedReturn.s1_24[j] != 0.0)
-    fprintf(outfile," SchedCA540_C24%c = %6.2f\n", 'A' + j, PrelimFedReturn.s1_24[j] );
+    results_fprintf(outfile," SchedCA540_C24%c = %6.2f\n", 'A' + j, PrelimFedReturn.s1_24[j] );
   }
 
   sched540Cb[25] = sched540Cb[25] + sched540Cb24b;
@@ -1130,7 +900,7 @@ int main( int argc, char *argv[] )
   showline_wlabelnz( " SchedCA540_C24Zc", sched540Cc24z );
 
   if (PrelimFedReturn.OtherAdjustmentsType[0] != '\0')
-   fprintf(outfile," SchedCA540_C24Ztype: %s\n", PrelimFedReturn.OtherAdjustmentsType );
+   results_fprintf(outfile," SchedCA540_C24Ztype: %s\n", PrelimFedReturn.OtherAdjustmentsType );
 
   sched540C[25] = PrelimFedReturn.sched1[25];
   showline_wlabelnz( " SchedCA540_C25", sched540C[25] );
@@ -1181,7 +951,7 @@ int main( int argc, char *argv[] )
  GetLine("CA540_P2_Add_6", &(sched540part2_add[6]) );
 
  if (PrelimFedReturn.OtherTaxesType[0] != '\0')
-   fprintf(outfile," SchedCA540_Part2_6type: %s\n", PrelimFedReturn.OtherTaxesType );
+   results_fprintf(outfile," SchedCA540_Part2_6type: %s\n", PrelimFedReturn.OtherTaxesType );
 
  sched540part2[7] = sched540part2[5] + sched540part2[6];
  sched540part2_sub[7] = sched540part2_sub[5] + sched540part2_sub[6];
@@ -1277,7 +1047,7 @@ int main( int argc, char *argv[] )
        }
      }
     for (j=1; j <= 10; j++)
-     if (ws[j] != 0.0) fprintf(outfile,"  ItemizedDedWS%d = %6.2f\n", j, ws[j] );
+     if (ws[j] != 0.0) results_fprintf(outfile,"  ItemizedDedWS%d = %6.2f\n", j, ws[j] );
   } /*Itemized Deductions Worksheet*/
  else
   {
@@ -1290,50 +1060,50 @@ int main( int argc, char *argv[] )
  display_part2column( 1, 0 );
  display_part2column( 2, 0 );
  display_part2column( 3, 0 );
- fprintf(outfile," SchedCA540_Part2_%da = %6.2f\n", 4, sched540part2[4] );
- fprintf(outfile," SchedCA540_Part2_%dc = %6.2f\n", 4, sched540part2_add[4] );
+ results_fprintf(outfile," SchedCA540_Part2_%da = %6.2f\n", 4, sched540part2[4] );
+ results_fprintf(outfile," SchedCA540_Part2_%dc = %6.2f\n", 4, sched540part2_add[4] );
  if (sched540part2_5a != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5aa = %6.2f\n", sched540part2_5a );
+  results_fprintf(outfile," SchedCA540_Part2_5aa = %6.2f\n", sched540part2_5a );
  if (sched540part2_sub[5] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5ab = %6.2f\n", sched540part2_sub[5] );
+  results_fprintf(outfile," SchedCA540_Part2_5ab = %6.2f\n", sched540part2_sub[5] );
  if (sched540part2_5b != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5ba = %6.2f\n", sched540part2_5b );
+  results_fprintf(outfile," SchedCA540_Part2_5ba = %6.2f\n", sched540part2_5b );
  if (sched540part2_5c != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5ca = %6.2f\n", sched540part2_5c );
+  results_fprintf(outfile," SchedCA540_Part2_5ca = %6.2f\n", sched540part2_5c );
  if (sched540part2_5d != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5da = %6.2f\n", sched540part2_5d );
+  results_fprintf(outfile," SchedCA540_Part2_5da = %6.2f\n", sched540part2_5d );
  if (sched540part2[5] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5ea = %6.2f\n", sched540part2[5] );
+  results_fprintf(outfile," SchedCA540_Part2_5ea = %6.2f\n", sched540part2[5] );
  if (sched540part2_sub[5] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5eb = %6.2f\n", sched540part2_sub[5] );
+  results_fprintf(outfile," SchedCA540_Part2_5eb = %6.2f\n", sched540part2_sub[5] );
  if (sched540part2_add[5] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_5ec = %6.2f\n", sched540part2_add[5] );
+  results_fprintf(outfile," SchedCA540_Part2_5ec = %6.2f\n", sched540part2_add[5] );
 
  display_part2( 6 );
  display_part2( 7 );
 
  if (sched540part2_8a != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8aa = %6.2f\n", sched540part2_8a );
+  results_fprintf(outfile," SchedCA540_Part2_8aa = %6.2f\n", sched540part2_8a );
  if (sched540part2_add8a != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8ac = %6.2f\n", sched540part2_add8a );
+  results_fprintf(outfile," SchedCA540_Part2_8ac = %6.2f\n", sched540part2_add8a );
  if (sched540part2_8b != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8ba = %6.2f\n", sched540part2_8b );
+  results_fprintf(outfile," SchedCA540_Part2_8ba = %6.2f\n", sched540part2_8b );
  if (sched540part2_add8b != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8bc = %6.2f\n", sched540part2_add8b );
+  results_fprintf(outfile," SchedCA540_Part2_8bc = %6.2f\n", sched540part2_add8b );
  if (sched540part2_8c != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8ca = %6.2f\n", sched540part2_8c );
+  results_fprintf(outfile," SchedCA540_Part2_8ca = %6.2f\n", sched540part2_8c );
  if (sched540part2_add8c != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8cc = %6.2f\n", sched540part2_add8c );
+  results_fprintf(outfile," SchedCA540_Part2_8cc = %6.2f\n", sched540part2_add8c );
  if (sched540part2_8d != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8da = %6.2f\n", sched540part2_8d );
+  results_fprintf(outfile," SchedCA540_Part2_8da = %6.2f\n", sched540part2_8d );
  if (sched540part2_sub8d != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8db = %6.2f\n", sched540part2_sub8d );
+  results_fprintf(outfile," SchedCA540_Part2_8db = %6.2f\n", sched540part2_sub8d );
  if (sched540part2[8] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8ea = %6.2f\n", sched540part2[8] );
+  results_fprintf(outfile," SchedCA540_Part2_8ea = %6.2f\n", sched540part2[8] );
  if (sched540part2_sub[8] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8eb = %6.2f\n", sched540part2_sub[8] );
+  results_fprintf(outfile," SchedCA540_Part2_8eb = %6.2f\n", sched540part2_sub[8] );
  if (sched540part2_add[8] != 0.0)
-  fprintf(outfile," SchedCA540_Part2_8ec = %6.2f\n", sched540part2_add[8] );
+  results_fprintf(outfile," SchedCA540_Part2_8ec = %6.2f\n", sched540part2_add[8] );
  
  for (j=9; j <= 17; j++)
    display_part2( j );
@@ -1351,7 +1121,7 @@ int main( int argc, char *argv[] )
  showline(14);
 
  L[15] = L[13] - L[14];
- if (L[15] < 0.0) fprintf(outfile,"L15 = (%f6.2)\n", -L[15] );
+ if (L[15] < 0.0) results_fprintf(outfile,"L15 = (%f6.2)\n", -L[15] );
  else showline(15);
 
  L[16] = sched540Cc[27];	/* CA Adjustments, Schedule CA 540 line 37 column C. */
@@ -1392,7 +1162,7 @@ int main( int argc, char *argv[] )
    default:	min2file = 5.0;
   }
  if (L[17] <= min2file)
-  fprintf(outfile,"You may not need to file CA Taxes, due to your California Adjusted Gross Income (%6.2f <= %6.2f).\n", 
+  results_fprintf(outfile,"You may not need to file CA Taxes, due to your California Adjusted Gross Income (%6.2f <= %6.2f).\n", 
 	L[17], min2file );
 
  showline(18);	/* Computed above. */
@@ -1402,9 +1172,9 @@ int main( int argc, char *argv[] )
 
  /* Tax. */
  if (L[19] < 100000.00)
-  fprintf(outfile,"Check box from: Tax Table.\nCkTxTable: X\n");
+  results_fprintf(outfile,"Check box from: Tax Table.\nCkTxTable: X\n");
  else
-  fprintf(outfile,"Check box from: Tax Rate Schedule.\nCkTxRateSchd: X\n");
+  results_fprintf(outfile,"Check box from: Tax Rate Schedule.\nCkTxRateSchd: X\n");
  L[31] = TaxRateFunction( L[19], status );
  showline( 31 );
  Report_bracket_info( L[19], status );
@@ -1412,7 +1182,7 @@ int main( int argc, char *argv[] )
  if (L[13] > threshA)
   { /*Line32-Exemption-credits-worksheet*/
     double ws_a, ws_b, ws_c, ws_d, ws_e, ws_f, ws_g, ws_h, ws_i, ws_j, ws_k, ws_l, ws_m, ws_n;
-    printf(" Doing AGI Limitations worksheet.\n"); 
+    console_printf(" Doing AGI Limitations worksheet.\n"); 
     ws_a = L[13];
     ws_b = threshA;
     ws_c = ws_a - ws_b;
@@ -1430,22 +1200,22 @@ int main( int argc, char *argv[] )
     ws_l = L[10];
     ws_m = NotLessThanZero( ws_l - ws_k );
     ws_n = ws_i + ws_m;
-    fprintf(outfile," AGI Worksheet:\n   a: %6.2f\n", ws_a);
-    fprintf(outfile,"  b: %6.2f\n", ws_b);
-    fprintf(outfile,"  c: %6.2f\n", ws_c);
-    fprintf(outfile,"  d: %6.2f\n", ws_d);
-    fprintf(outfile,"  e: %6.2f\n", ws_e);
-    fprintf(outfile,"  f: %6.2f\n", ws_f);
-    fprintf(outfile,"  g: %6.2f\n", ws_g);
-    fprintf(outfile,"  h: %6.2f\n", ws_h);
-    fprintf(outfile,"  i: %6.2f\n", ws_i);
-    fprintf(outfile,"  j: %6.2f\n", ws_j);
-    fprintf(outfile,"  k: %6.2f\n", ws_k);
-    fprintf(outfile,"  l: %6.2f\n", ws_l);
-    fprintf(outfile,"  m: %6.2f\n", ws_m);
-    fprintf(outfile,"  n: %6.2f\n", ws_n);
-    fprintf(outfile," Your exemptions may be limited. Used Exemptions-Credits-Worksheet for Line 21.\n");
-    fprintf(outfile,"   WorkSheet[n]=%6.2f (vs. L11=%6.2f)\n", ws_n, L[11] );
+    results_fprintf(outfile," AGI Worksheet:\n   a: %6.2f\n", ws_a);
+    results_fprintf(outfile,"  b: %6.2f\n", ws_b);
+    results_fprintf(outfile,"  c: %6.2f\n", ws_c);
+    results_fprintf(outfile,"  d: %6.2f\n", ws_d);
+    results_fprintf(outfile,"  e: %6.2f\n", ws_e);
+    results_fprintf(outfile,"  f: %6.2f\n", ws_f);
+    results_fprintf(outfile,"  g: %6.2f\n", ws_g);
+    results_fprintf(outfile,"  h: %6.2f\n", ws_h);
+    results_fprintf(outfile,"  i: %6.2f\n", ws_i);
+    results_fprintf(outfile,"  j: %6.2f\n", ws_j);
+    results_fprintf(outfile,"  k: %6.2f\n", ws_k);
+    results_fprintf(outfile,"  l: %6.2f\n", ws_l);
+    results_fprintf(outfile,"  m: %6.2f\n", ws_m);
+    results_fprintf(outfile,"  n: %6.2f\n", ws_n);
+    results_fprintf(outfile," Your exemptions may be limited. Used Exemptions-Credits-Worksheet for Line 21.\n");
+    results_fprintf(outfile,"   WorkSheet[n]=%6.2f (vs. L11=%6.2f)\n", ws_n, L[11] );
     L[32] = ws_n;
   }
  else  L[32] = L[11];
@@ -1462,7 +1232,7 @@ int main( int argc, char *argv[] )
 
  /* Special Credits. */
  GetLineF( "L40", &L[40] );	/* Nonrefundable Child + Dependent Care Expenses Credit (pg 11). */
- fprintf(outfile," "); /* Indent next entry. */
+ results_fprintf(outfile," "); /* Indent next entry. */
  GetLineF( "L43", &L[43] );	/* Special credit 1 */
  GetLineF( "L44", &L[44] );	/* Special credit 2 */
  GetLineF( "L45", &L[45] );	/* Special credit 3+ */
@@ -1539,7 +1309,7 @@ int main( int argc, char *argv[] )
  if (L[95] > L[65])
   {
    L[97] = L[95] - L[65];
-   fprintf(outfile,"L97 = %6.2f  REFUND!!!\n", L[97] );
+   results_fprintf(outfile,"L97 = %6.2f  REFUND!!!\n", L[97] );
    showline(98);
    L[99] = L[97]  - L[98];
    showline(99);
@@ -1551,8 +1321,8 @@ int main( int argc, char *argv[] )
  else
   {
    L[100] = L[65] - L[95];
-   fprintf(outfile,"L100 = %6.2f  DUE !!!\n", L[100] );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[100] / (L[65] + 1e-9) );
+   results_fprintf(outfile,"L100 = %6.2f  DUE !!!\n", L[100] );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[100] / (L[65] + 1e-9) );
    L[111] = L[94] + L[96] + L[100] + L[110];
    showline(111);
    showline(112);
@@ -1561,33 +1331,33 @@ int main( int argc, char *argv[] )
    showline(114);
   }
  
- fprintf(outfile,"\nSelect any charity contributions and complete\n form accordingly.\n");
+ results_fprintf(outfile,"\nSelect any charity contributions and complete\n form accordingly.\n");
 
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  writeout_line = 0;
  // Your1stName = GetTextLineF( "Your1stName:" );
  YourMidInitial = pull_initial( Your1stName );
  Your1stName[11] = '\0';
- fprintf(outfile,"Your1stName: %s\n", Your1stName );
- fprintf(outfile,"YourMidInit: %s\n", YourMidInitial );
+ results_fprintf(outfile,"Your1stName: %s\n", Your1stName );
+ results_fprintf(outfile,"YourMidInit: %s\n", YourMidInitial );
  // YourLastName   = GetTextLineF( "YourLastName:" );
  YourLastName[15] = '\0';
- fprintf(outfile,"YourLastName: %s\n", YourLastName );
+ results_fprintf(outfile,"YourLastName: %s\n", YourLastName );
  // your_socsec = GetTextLineF( "YourSocSec#:" );
  format_socsec( your_socsec, 1 );
- fprintf(outfile,"YourSocSec#: %s\n", your_socsec );
+ results_fprintf(outfile,"YourSocSec#: %s\n", your_socsec );
 
  // Spouse1stName = GetTextLineF( "Spouse1stName:" );
  SpouseMidInitial = pull_initial( Spouse1stName );
  Spouse1stName[11] = '\0';
- fprintf(outfile,"Spouse1stName: %s\n", Spouse1stName );
- fprintf(outfile,"SpouseMidInit: %s\n", SpouseMidInitial );
+ results_fprintf(outfile,"Spouse1stName: %s\n", Spouse1stName );
+ results_fprintf(outfile,"SpouseMidInit: %s\n", SpouseMidInitial );
  // SpouseLastName = GetTextLineF( "SpouseLastName:" );
  SpouseLastName[15] = '\0';
- fprintf(outfile,"SpouseLastName: %s\n", SpouseLastName );
+ results_fprintf(outfile,"SpouseLastName: %s\n", SpouseLastName );
  // spouse_socsec = GetTextLineF( "SpouseSocSec#:" );
  format_socsec( spouse_socsec, 1 );
- fprintf(outfile,"SpouseSocSec#: %s\n", spouse_socsec );
+ results_fprintf(outfile,"SpouseSocSec#: %s\n", spouse_socsec );
  writeout_line = 1;
 
  if (strlen( YourLastName ) > 0)
@@ -1596,7 +1366,7 @@ int main( int argc, char *argv[] )
    strcat( YourName, " " );
    strcat( YourName, YourLastName );
    YourName[15] = '\0';		/* Limit name to 15 characters. */
-   fprintf(outfile,"YourName: %s\n", YourName );
+   results_fprintf(outfile,"YourName: %s\n", YourName );
 
    if (strcmp( YourLastName, SpouseLastName ) == 0)
     sprintf(YourNames,"%s & %s, %s", Your1stName, Spouse1stName, YourLastName );
@@ -1606,7 +1376,7 @@ int main( int argc, char *argv[] )
    else
     sprintf(YourNames,"%s %s", Your1stName, YourLastName );
    YourNames[33] = '\0';
-   fprintf(outfile,"YourNames: %s\n", YourNames );
+   results_fprintf(outfile,"YourNames: %s\n", YourNames );
   }
  // GetTextLineF( "Number&Street:" );
  Show_String_wLabel( "Number&Street:", street_address );
@@ -1614,7 +1384,7 @@ int main( int argc, char *argv[] )
  Show_String_wLabel( "Apt#:", apartment );
  // GetTextLineF( "Town:" );
  Show_String_wLabel( "Town:", town );
- fprintf(outfile,"State: CA\n");
+ results_fprintf(outfile,"State: CA\n");
  // GetTextLineF( "Zipcode:" );
  Show_String_wLabel( "ZipCode:", zipcode );
  GetTextLineF( "YourDOB:" );
@@ -1623,10 +1393,10 @@ int main( int argc, char *argv[] )
  for (j=1; j <=3; j++)
   if (strlen(PrelimFedReturn.Dep1stName[j]) > 0)
    {
-    fprintf(outfile,"L10Dep%dFrstName: %s\n", j, PrelimFedReturn.Dep1stName[1] );
-    fprintf(outfile,"L10Dep%dLastName: %s\n", j, PrelimFedReturn.DepLastName[1] );
-    fprintf(outfile,"L10Dep%dSSN: %s\n", j, PrelimFedReturn.DepSocSec[1] );
-    fprintf(outfile,"L10Dep%dRelation: %s\n", j, PrelimFedReturn.DepRelation[1] );
+    results_fprintf(outfile,"L10Dep%dFrstName: %s\n", j, PrelimFedReturn.Dep1stName[1] );
+    results_fprintf(outfile,"L10Dep%dLastName: %s\n", j, PrelimFedReturn.DepLastName[1] );
+    results_fprintf(outfile,"L10Dep%dSSN: %s\n", j, PrelimFedReturn.DepSocSec[1] );
+    results_fprintf(outfile,"L10Dep%dRelation: %s\n", j, PrelimFedReturn.DepRelation[1] );
    }
 
  fclose(infile);
@@ -1635,3 +1405,9 @@ int main( int argc, char *argv[] )
  Display_File( outfname );
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_CA_540, argc, argv );
+}
@@ -12,6 +12,8 @@ float thisversion=3.00;
 #include <stdlib.h>
 
 #include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+#include "taxsolve_tax_tables_2021.h"
 
 #define SINGLE 		        1
 #define MARRIED_FILING_JOINTLY 2
@@ -24,70 +26,33 @@ float thisversion=3.00;
 #define Short 1
 #define Annualized 2
 
-/* The following two tax functions copied from taxsolve_CA_540_2021.c. */
+/* The following functions copied from taxsolve_CA_540_2021.c. */
 
-double TaxRateFormula( double income, int status )
-{									/* Updated for 2021. */
- double tax;
+struct tax_schedule *tax_schedule_for( int status )
+{
  if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
-  {
-   if (income <   9325.00)  tax =             0.01 * income;                else
-   if (income <  22107.00)  tax =    93.25 +  0.02 * (income -   9325.00);  else
-   if (income <  34892.00)  tax =   348.89 +  0.04 * (income -  22107.00);  else
-   if (income <  48435.00)  tax =   860.29 +  0.06 * (income -  34892.00);  else
-   if (income <  61214.00)  tax =  1672.87 +  0.08 * (income -  48435.00);  else
-   if (income < 312686.00)  tax =  2695.19 + 0.093 * (income -  61214.00);  else
-   if (income < 375221.00)  tax = 26082.09 + 0.103 * (income - 312686.00);  else
-   if (income < 625369.00)  tax = 32523.20 + 0.113 * (income - 375221.00);
-   else                     tax = 60789.92 + 0.123 * (income - 625369.00);
-  }
+  return &(ca_tax_schedules[0]);
  else
  if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))
-  {
-   if (income <   18650.00)  tax =              0.01 * income;                 else
-   if (income <   44214.00)  tax =    186.50 +  0.02 * (income -   18650.00);  else
-   if (income <   69784.00)  tax =    697.78 +  0.04 * (income -   44214.00);  else
-   if (income <   96870.00)  tax =   1720.58 +  0.06 * (income -   69784.00);  else
-   if (income <  122428.00)  tax =   3345.74 +  0.08 * (income -   96870.00);  else
-   if (income <  625372.00)  tax =   5390.38 + 0.093 * (income -  122428.00);  else
-   if (income <  750442.00)  tax =  52164.17 + 0.103 * (income -  625372.00);  else
-   if (income < 1250738.00)  tax =  65046.38 + 0.113 * (income -  750442.00);
-   else                      tax = 121579.83 + 0.123 * (income - 1250738.00);
-  }
+  return &(ca_tax_schedules[1]);
  else
-  {
-   if (income <  18663.00)  tax =             0.01 * income;                else
-   if (income <  44217.00)  tax =   186.63 +  0.02 * (income -  18663.00);  else
-   if (income <  56999.00)  tax =   697.71 +  0.04 * (income -  44217.00);  else
-   if (income <  70542.00)  tax =  1208.99 +  0.06 * (income -  56999.00);  else
-   if (income <  83324.00)  tax =  2021.57 +  0.08 * (income -  70542.00);  else
-   if (income < 425251.00)  tax =  3044.13 + 0.093 * (income -  83324.00);  else
-   if (income < 510303.00)  tax = 34843.34 + 0.103 * (income - 425251.00);  else
-   if (income < 850503.00)  tax = 43603.70 + 0.113 * (income - 510303.00); 
-   else                     tax = 82046.30 + 0.123 * (income - 850503.00);
-  }
- return (int)(tax+0.5);
+  return &(ca_tax_schedules[2]);
+}
+
+
+double TaxRateFormula( double x, int status )	/* Exact, rounded once to whole dollars. */
+{
+ return scheduled_tax( tax_schedule_for( status ), x, TAX_DOLLARS, 0 );
 }
 
 
 double TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
 {
- double x, tx;
- int k;
-
- if (income < 100000.0)   /* Quantize to match tax-table exactly. */
-  {
-   if (income < 99951.0) 
-    {
-     k = (income + 49) / 100;
-     x = 100 * (double)k;
-    }
-   else x = 99975.0;
-   tx = (int)(TaxRateFormula( x, status ));
-  }
- else
-  tx = TaxRateFormula( income, status );
- return tx;
+ int row;
+ row = ca_tax_table_row( income );
+ if (row < 0)
+  return TaxRateFormula( income, status );
+ return ca_tax_table[row][tax_schedule_for( status ) - ca_tax_schedules];
 }
 
 
@@ -102,9 +67,9 @@ double L6WS(int column, double IIIL4, double ScdA, double IIIL5, double FAIWSL3,
 	L[4] = IIIL5;
 	L[5] = L[1] * L[4];
 	if(L[3] == 0){
-		fprintf(outfile, " Line 6 Worksheet - Column (%c),\n", column);
+		results_fprintf(outfile, " Line 6 Worksheet - Column (%c),\n", column);
 		for(i = 1; i <= 5; i++)
-			fprintf(outfile, "L6WS_%d%c %0.2lf\n", i, column, L[i]);
+			results_fprintf(outfile, "L6WS_%d%c %0.2lf\n", i, column, L[i]);
 		return(L[5]);
 	}
 	L[6] = L[3] * L[4];
@@ -121,15 +86,15 @@ double L6WS(int column, double IIIL4, double ScdA, double IIIL5, double FAIWSL3,
 	L[12] = SmallerOf(L[7], L[11]);
 	L[13] = Round(L[5] - L[12]);
 	
-	fprintf(outfile, " Line 6 Worksheet - Column (%c),\n", column);
+	results_fprintf(outfile, " Line 6 Worksheet - Column (%c),\n", column);
 	for(i = 1; i <= 13; i++)
-		fprintf(outfile, "L6WS_%d%c %0.2lf\n", i, column, L[i]);
+		results_fprintf(outfile, "L6WS_%d%c %0.2lf\n", i, column, L[i]);
 	return(L[13]);
 }
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_CA_5805( int argc, char *argv[] )
 {
   int i, j, k, status, individual = Yes;
  char word[4000], outfname[4000], *infname=0;
@@ -158,7 +123,7 @@ int main( int argc, char *argv[] )
  double A[15], B[15], C[15], D[15];	/* cells in grid of Worksheet II */
 					/* e.g., cell 1(a) will be in variable A[1] */
 
-  printf("Form 5805, 2021 - v%3.2f\n", thisversion);
+  console_printf("Form 5805, 2021 - v%3.2f\n", thisversion);
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -166,26 +131,32 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
 
@@ -234,13 +205,13 @@ for(i = 0; i <= 13; i++){
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  // add_pdf_markup( "NotReady", 1, 240, 40, 17, 1, 1.0, 0, 0, "\"This program is NOT ready for 20xx.\"" );
 
- fprintf(outfile, "%s\n", "==================================================");
- fprintf(outfile, "%s\n", "                                                            CAUTION\nThis program fills out Form 5805 to determine WHETHER OR NOT you owe a penalty\nfor underpayment of estimated tax.  It calculates the AMOUNT of any penalty you\nmay owe for the MOST LIKELY CASE in which up to four estimated tax payments have\n been made.  You should carefully review the instructions for Form 5805 to see if the\ncalculations are correct for your particular tax situation.  DO NOT INTERPRET a\ndefault zero value for the penalty on the filled PDF to indicate that you do not owe\na penalty, especially if you have not input all required information, including the\nactual dates on which you made your payments. Scroll down to the end of this\nresults file to see if you had an underpayment for any period.  If so, you may owe\na penalty.\n\nItemized deductions are limited for high-income taxpayers.  When you are\nchecking calculations, values on line 6 of Part III may appear to be in error due to\nthese limitations.  See this results file and the last page of the output PDF for the\nlimitation calculations.  Also note that the annualization factor values on lines 4\nof the last page of the output PDF round by default to the nearest integer.  Use\nthe values in this results file for lines L6WS_4a, L6WS_4b, L6WS_4c, and L6WS_4d,\n which for most individual taxpayers will be 4.0, 2.4, 1.5, and 1.0, respectively.\n\nThis program does not calculate the phase-out of exemption credits for high-income\ntaxpayers as collection of the necessary information for each period would\nunnecessarily complicate this program for most users and the impact of exemption\nlimitations on the tax estimates would be negligible.  See instructions for line 11.");
- fprintf(outfile, "%s\n\n", "==================================================");
+ results_fprintf(outfile, "%s\n", "==================================================");
+ results_fprintf(outfile, "%s\n", "                                                            CAUTION\nThis program fills out Form 5805 to determine WHETHER OR NOT you owe a penalty\nfor underpayment of estimated tax.  It calculates the AMOUNT of any penalty you\nmay owe for the MOST LIKELY CASE in which up to four estimated tax payments have\n been made.  You should carefully review the instructions for Form 5805 to see if the\ncalculations are correct for your particular tax situation.  DO NOT INTERPRET a\ndefault zero value for the penalty on the filled PDF to indicate that you do not owe\na penalty, especially if you have not input all required information, including the\nactual dates on which you made your payments. Scroll down to the end of this\nresults file to see if you had an underpayment for any period.  If so, you may owe\na penalty.\n\nItemized deductions are limited for high-income taxpayers.  When you are\nchecking calculations, values on line 6 of Part III may appear to be in error due to\nthese limitations.  See this results file and the last page of the output PDF for the\nlimitation calculations.  Also note that the annualization factor values on lines 4\nof the last page of the output PDF round by default to the nearest integer.  Use\nthe values in this results file for lines L6WS_4a, L6WS_4b, L6WS_4c, and L6WS_4d,\n which for most individual taxpayers will be 4.0, 2.4, 1.5, and 1.0, respectively.\n\nThis program does not calculate the phase-out of exemption credits for high-income\ntaxpayers as collection of the necessary information for each period would\nunnecessarily complicate this program for most users and the impact of exemption\nlimitations on the tax estimates would be negligible.  See instructions for line 11.");
+ results_fprintf(outfile, "%s\n\n", "==================================================");
  
  /* ----- Place all your form-specific code below here .... ------ */
 
@@ -256,7 +227,7 @@ for(i = 0; i <= 13; i++){
  get_parameter( infile, 's', word, "Entity" );
  get_parameter( infile, 'w', word, "Entity?");
  if (strncasecmp(word,"Individual",3)==0) individual = Yes;
- fprintf(outfile,"Entity = %s (%d)\n", word, individual);
+ results_fprintf(outfile,"Entity = %s (%d)\n", word, individual);
 
 get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/sep, Head house, Widow(er) */
  get_parameter( infile, 'l', word, "Status?");
@@ -267,46 +238,46 @@ get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
    exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  get_parameter( infile, 's', word, "Quest1" );
  get_parameter( infile, 'w', word, "Quest1?");
  if (strncasecmp(word,"Yes",1)==0){
 	// Quest1 = Yes;
-	fprintf(outfile,"CkQuest1Yes X\n");
+	results_fprintf(outfile,"CkQuest1Yes X\n");
 }
 else {
-		fprintf(outfile,"CkQuest1No X\n");
+		results_fprintf(outfile,"CkQuest1No X\n");
 }
 
  get_parameter( infile, 's', word, "Quest2" );
  get_parameter( infile, 'w', word, "Quest2?");
  if (strncasecmp(word,"Yes",1)==0){
 	 Quest2 = Yes;
-	fprintf(outfile,"CkQuest2Yes X\n");
+	results_fprintf(outfile,"CkQuest2Yes X\n");
 }
 else {
 	Quest2 = No;
-	fprintf(outfile,"CkQuest2No X\n");
+	results_fprintf(outfile,"CkQuest2No X\n");
 }
 
  get_parameter( infile, 's', word, "Quest3" );
  get_parameter( infile, 'w', word, "Quest3?");
  if (strncasecmp(word,"Yes",1)==0){
 	Quest3 = Yes;
-	fprintf(outfile,"CkQuest3Yes X\n");
+	results_fprintf(outfile,"CkQuest3Yes X\n");
 }
 else if (strncasecmp(word,"No",2)==0){
 	Quest3 = No;
-	fprintf(outfile,"CkQuest3No X\n");
+	results_fprintf(outfile,"CkQuest3No X\n");
 }
 else {
 	// Quest3 = NotApplicable;
-	fprintf(outfile,"CkQuest3NA X\n");
+	results_fprintf(outfile,"CkQuest3NA X\n");
 }
 
  GetLineF( "Wthd_Per_1", &Wthd_Per_1 );
@@ -318,11 +289,11 @@ else {
  get_parameter( infile, 'w', word, "Quest4?");
  if (strncasecmp(word,"Yes",1)==0){
 	 // Quest4 = Yes;
-	fprintf(outfile,"CkQuest4Yes X\n");
+	results_fprintf(outfile,"CkQuest4Yes X\n");
 }
 else if (strncasecmp(word,"No",2)==0){
 	// Quest4 = No;
-	fprintf(outfile,"CkQuest4No X\n");
+	results_fprintf(outfile,"CkQuest4No X\n");
 }
 
 /* Part II - Required Annual Payment */
@@ -338,11 +309,11 @@ else if (strncasecmp(word,"No",2)==0){
  L[4] = L[1]  -  L[3];
  showline( 4 );
  if((L[4] < 250.00) && (status == MARRIED_FILING_SEPARAT)){
-		fprintf(outfile, "Status is \"Married Filing Separately\" and line 4 is less than $250.  Stop here.\nYou do not owe the penalty. Do not file form FTB 5805.\n");
+		results_fprintf(outfile, "Status is \"Married Filing Separately\" and line 4 is less than $250.  Stop here.\nYou do not owe the penalty. Do not file form FTB 5805.\n");
 		exit(0);
  }
  else if((L[4] < 500.00) && (status != MARRIED_FILING_SEPARAT)){
-		fprintf(outfile, "Status is not \"Married Filing Separately\" and line 4 is less than $500.  Stop here.\nYou do not owe the penalty. Do not file form FTB 5805.\n");
+		results_fprintf(outfile, "Status is not \"Married Filing Separately\" and line 4 is less than $500.  Stop here.\nYou do not owe the penalty. Do not file form FTB 5805.\n");
 		exit(0);
  }
   GetLineF( "L5", &L[5] );
@@ -374,7 +345,7 @@ showline( 6 );
 			showline( i );
 
 		if(L[10] <= 0){
-			fprintf(outfile, "Line 10 is zero or less.  Stop here.  You do not owe the penalty.\nDo not file form FTB 5805.\n");
+			results_fprintf(outfile, "Line 10 is zero or less.  Stop here.  You do not owe the penalty.\nDo not file form FTB 5805.\n");
 			exit(0);
 		}
 
@@ -484,9 +455,9 @@ showline( 6 );
 	d[6] = d[4] * d[5];
 
 	FAIWS_a[3] = FAIWS_a[1] * a[5];
-	fprintf(outfile, "FAIWS_1a\t%0.2lf\n", FAIWS_a[1]);
-	fprintf(outfile, "FAIWS_2a\t%0.2lf\n", a[5]);
-	fprintf(outfile, "FAIWS_3a\t%0.2lf\n", FAIWS_a[3]);
+	results_fprintf(outfile, "FAIWS_1a\t%0.2lf\n", FAIWS_a[1]);
+	results_fprintf(outfile, "FAIWS_2a\t%0.2lf\n", a[5]);
+	results_fprintf(outfile, "FAIWS_3a\t%0.2lf\n", FAIWS_a[3]);
 
 	if(a[4] > 0){
 		if((((status == MARRIED_FILING_JOINTLY) || (status == WIDOW)) && (FAIWS_a[3] > 424581.00)) || \
@@ -497,9 +468,9 @@ showline( 6 );
 	}
 	
 	FAIWS_b[3] = FAIWS_b[1] * b[5];
-	fprintf(outfile, "FAIWS_1b\t%0.2lf\n", FAIWS_b[1]);
-	fprintf(outfile, "FAIWS_2b\t%0.2lf\n", b[5]);
-	fprintf(outfile, "FAIWS_3b\t%0.2lf\n", FAIWS_b[3]);
+	results_fprintf(outfile, "FAIWS_1b\t%0.2lf\n", FAIWS_b[1]);
+	results_fprintf(outfile, "FAIWS_2b\t%0.2lf\n", b[5]);
+	results_fprintf(outfile, "FAIWS_3b\t%0.2lf\n", FAIWS_b[3]);
 
 	if(b[4] > 0){
 		if((((status == MARRIED_FILING_JOINTLY) || (status == WIDOW)) && (FAIWS_b[3] > 424581.00)) || \
@@ -510,9 +481,9 @@ showline( 6 );
 	}
 
 	FAIWS_c[3] = FAIWS_c[1] * c[5];
-	fprintf(outfile, "FAIWS_1c\t%0.2lf\n", FAIWS_c[1]);
-	fprintf(outfile, "FAIWS_2c\t%0.2lf\n", c[5]);
-	fprintf(outfile, "FAIWS_3c\t%0.2lf\n", FAIWS_c[3]);
+	results_fprintf(outfile, "FAIWS_1c\t%0.2lf\n", FAIWS_c[1]);
+	results_fprintf(outfile, "FAIWS_2c\t%0.2lf\n", c[5]);
+	results_fprintf(outfile, "FAIWS_3c\t%0.2lf\n", FAIWS_c[3]);
 
 	if(c[4] > 0){
 		if((((status == MARRIED_FILING_JOINTLY) || (status == WIDOW)) && (FAIWS_c[3] > 424581.00)) || \
@@ -523,9 +494,9 @@ showline( 6 );
 	}
 
 	FAIWS_d[3] = FAIWS_d[1] * d[5];
- 	fprintf(outfile, "FAIWS_1d\t%0.2lf\n", FAIWS_d[1]);
-	fprintf(outfile, "FAIWS_2d\t%0.2lf\n", d[5]);
-	fprintf(outfile, "FAIWS_3d\t%0.2lf\n", FAIWS_d[3]);
+ 	results_fprintf(outfile, "FAIWS_1d\t%0.2lf\n", FAIWS_d[1]);
+	results_fprintf(outfile, "FAIWS_2d\t%0.2lf\n", d[5]);
+	results_fprintf(outfile, "FAIWS_3d\t%0.2lf\n", FAIWS_d[3]);
 
 	if(d[4] > 0){
 		if((((status == MARRIED_FILING_JOINTLY) || (status == WIDOW)) && (FAIWS_d[3] > 424581.00)) || \
@@ -686,61 +657,61 @@ showline( 6 );
 	if(Quest2 == Yes){
 	
 		for(i = 18; i <= 14; i++){
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "a", A[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "b", B[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "c", C[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "d", D[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "a", A[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "b", B[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "c", C[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "d", D[i]);
 		}
 
 		for(i = 1; i <= 13; i++){
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
 		}
 		
-		fprintf(outfile, "%s %0.2lf\n", "L14aa", L14aa);
-		fprintf(outfile, "%s %0.2lf\n", "L14ab", L14ab);
-		fprintf(outfile, "%s %0.2lf\n", "L14ac", L14ac);
-		fprintf(outfile, "%s %0.2lf\n", "L14ad", L14ad);
-		fprintf(outfile, "%s %0.2lf\n", "L14ba", L14ba);
-		fprintf(outfile, "%s %0.2lf\n", "L14bb", L14bb);
-		fprintf(outfile, "%s %0.2lf\n", "L14bc", L14bc);
-		fprintf(outfile, "%s %0.2lf\n", "L14bd", L14bd);
-		fprintf(outfile, "%s %0.2lf\n", "L14ca", L14ca);
-		fprintf(outfile, "%s %0.2lf\n", "L14cb", L14cb);
-		fprintf(outfile, "%s %0.2lf\n", "L14cc", L14cc);
-		fprintf(outfile, "%s %0.2lf\n", "L14cd", L14cd);
-		fprintf(outfile, "%s %0.2lf\n", "L14da", L14da);
-		fprintf(outfile, "%s %0.2lf\n", "L14db", L14db);
-		fprintf(outfile, "%s %0.2lf\n", "L14dc", L14dc);
-		fprintf(outfile, "%s %0.2lf\n", "L14dd", L14dd);
-		fprintf(outfile, "%s %0.2lf\n", "L14ea", L14ea);
-		fprintf(outfile, "%s %0.2lf\n", "L14eb", L14eb);
-		fprintf(outfile, "%s %0.2lf\n", "L14ec", L14ec);
-		fprintf(outfile, "%s %0.2lf\n", "L14ed", L14ed);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14aa", L14aa);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ab", L14ab);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ac", L14ac);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ad", L14ad);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ba", L14ba);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14bb", L14bb);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14bc", L14bc);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14bd", L14bd);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ca", L14ca);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14cb", L14cb);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14cc", L14cc);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14cd", L14cd);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14da", L14da);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14db", L14db);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14dc", L14dc);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14dd", L14dd);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ea", L14ea);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14eb", L14eb);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ec", L14ec);
+		results_fprintf(outfile, "%s %0.2lf\n", "L14ed", L14ed);
 
 		for(i = 15; i <= 23; i++){
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
 		}
 
 		for(i = 1; i <= 11; i++){
 			if((i != 3) && (i != 4) && (i != 5) && (i != 7))
-				fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "a", A[i]);
-			fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "b", B[i]);
-			fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "c", C[i]);
+				results_fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "a", A[i]);
+			results_fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "b", B[i]);
+			results_fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "c", C[i]);
 			if((i != 7) && (i != 9))
-				fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "d", D[i]);
+				results_fprintf(outfile, "WSII_%d%s %0.2lf\n", i, "d", D[i]);
 		}
-		fprintf(outfile, "WSII_%d %0.2lf     %s\n", 12, A[0], "PENALTY");
+		results_fprintf(outfile, "WSII_%d %0.2lf     %s\n", 12, A[0], "PENALTY");
 	
 		if((A[8] == 0) && (B[8] == 0) && (C[8] == 0) && (D[8] == 0))
-			fprintf(outfile, "As line 8 on WSII is zero for all payment periods, you don't owe a penalty.\n");
+			results_fprintf(outfile, "As line 8 on WSII is zero for all payment periods, you don't owe a penalty.\n");
 		else
-			fprintf(outfile, "%s\n%s\n%s\n", "There is an underpayment for one or more periods.  See the  instructions and if", "you have not already done so, enter the number of days any payment was late", "into the GUI so this program can calculate the penalty.");
+			results_fprintf(outfile, "%s\n%s\n%s\n", "There is an underpayment for one or more periods.  See the  instructions and if", "you have not already done so, enter the number of days any payment was late", "into the GUI so this program can calculate the penalty.");
 	}
 
   /*** 
@@ -770,8 +741,14 @@ showline( 6 );
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_CA_5805, argc, argv );
+}
@@ -39,16 +39,18 @@ float thisversion=19.00;
 #define Yes 1
 #define No  0
 
+THREAD_LOCAL double L17b=0.0;	/* Additional tax on distributions.  (Also read by the 1040, when it computes this form.) */
+
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_HSA_f8889( int argc, char *argv[] )
 {
  int i, j, k;
  char word[4000], outfname[4000], *answ, *infname=0;
  time_t now;
- double L14a=0.0, L14b=0.0, L14c=0.0, L17b=0.0;
+ double L14a=0.0, L14b=0.0, L14c=0.0;
 
- printf("Form 8889 HSA, 2021 - v%3.2f\n", thisversion );
+ console_printf("Form 8889 HSA, 2021 - v%3.2f\n", thisversion );
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -56,27 +58,33 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); taxsolve_exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); taxsolve_exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); taxsolve_exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); taxsolve_exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) { L[i] = 0.0; }
@@ -91,7 +99,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  GetTextLineF( "YourName:" );
  GetTextLineF( "YourSocSec#:" );
@@ -101,9 +109,9 @@ int main( int argc, char *argv[] )
  answ = GetTextLineF( "L1:" );
  next_word( answ, word, " \t;" );
  if (strcasecmp( word, "Self-Only" ) == 0)
-  fprintf(outfile,"CkSelf-Only: X\n");
+  results_fprintf(outfile,"CkSelf-Only: X\n");
  else
-  fprintf(outfile,"CkFamily: X\n");
+  results_fprintf(outfile,"CkFamily: X\n");
  writeout_line = 1;
 
  GetLineF( "L2", &L[2] );
@@ -124,7 +132,7 @@ int main( int argc, char *argv[] )
  L[13] = SmallerOf( L[2], L[12] );
  showline_wmsg( 13, "HSA Deduction.  Enter this on Sched-1 Part II, Line 13 on your 1040 Form." );
  if (L[2] > L[13])
-  fprintf(outfile,"Caution: Since L2 > L13, you may have to pay additional tax. See instructions.\n\n");
+  results_fprintf(outfile,"Caution: Since L2 > L13, you may have to pay additional tax. See instructions.\n\n");
 
  GetLineF( "L14a", &L14a );
  GetLineF( "L14b", &L14b );
@@ -138,7 +146,7 @@ int main( int argc, char *argv[] )
  answ = GetTextLineF( "L17a:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"Ck17a: X\n");
+  results_fprintf(outfile,"Ck17a: X\n");
  writeout_line = 1;
 
  if (toupper( word[0] ) != 'Y')
@@ -159,8 +167,16 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_HSA_f8889, argc, argv );
+}
+#endif
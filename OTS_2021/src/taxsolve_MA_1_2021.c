@@ -71,7 +71,7 @@ void check_if_yes( char *label )
  get_parameter( infile, 's', word, label );
  get_param_single_line( infile, 'b', &flag, label );
  if (flag) 
-  fprintf(outfile,"%s X\n", label );
+  results_fprintf(outfile,"%s X\n", label );
 }
 
 
@@ -79,7 +79,7 @@ void check_if_yes( char *label )
 /*----------------------------------------------------------------------------*/
 /* ---				Main					  --- */
 /*----------------------------------------------------------------------------*/
-int main( int argc, char *argv[] )
+int taxsolve_MA_1( int argc, char *argv[] )
 {
  int i, j, k, status=0, i65, iblind, ndep, dep_deduct, ndep12=0;
  int flag, notaxstatus=0;
@@ -92,7 +92,7 @@ int main( int argc, char *argv[] )
  double L23a=0.0, L33[6], L35a=0.0, L35b=0.0;
  double L43a=0.0, L43b=0.0;
  
- printf("Massachusetts Form-1 2021 - v%3.2f\n", thisversion);
+ console_printf("Massachusetts Form-1 2021 - v%3.2f\n", thisversion);
  
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -100,27 +100,33 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(argv[i],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(argv[i],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[i]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) { L[i] = 0.0; }
@@ -135,7 +141,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  /* Get status as:  Single, Married/joint, Head house, Married/sep. */
  get_parameter( infile, 's', word, "Status" );
@@ -147,11 +153,11 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else 
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
    exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  for (i=0; i<10; i++) {Exemptions[i] = 0.0;}
 
@@ -159,35 +165,35 @@ int main( int argc, char *argv[] )
   {
    case SINGLE: 
 	Exemptions[0] = 4400.0;
-	fprintf(outfile," Check_single x\n");
+	results_fprintf(outfile," Check_single x\n");
    	break;
    case MARRIED_FILING_SEPARAT:
 	Exemptions[0] = 4400.0;
-	fprintf(outfile," Check_sep x\n");
+	results_fprintf(outfile," Check_sep x\n");
    	break;
    case HEAD_OF_HOUSEHOLD:
 	Exemptions[0] = 6800.0;
-	fprintf(outfile," Check_hh x\n");
+	results_fprintf(outfile," Check_hh x\n");
 	break;
    case MARRIED_FILING_JOINTLY: 
 	Exemptions[0] = 8800.0;
-	fprintf(outfile," Check_mfj x\n");
+	results_fprintf(outfile," Check_mfj x\n");
 	break;
   }   
 
  GetLineF( "La", &L_a );	/* Only for PDF form.  Not used otherwise. */
  GetLineF( "Lb", &L_b );	/* Only for PDF form.  Not used otherwise. */
  
- fprintf(outfile,"L2. Exemptions: \n");
- fprintf(outfile,"  2a.  = %6.2f   Personal exemptions\n", Exemptions[0]);
+ results_fprintf(outfile,"L2. Exemptions: \n");
+ results_fprintf(outfile,"  2a.  = %6.2f   Personal exemptions\n", Exemptions[0]);
 
  get_parameter( infile, 's', word, "Dependents" );
  get_parameter( infile, 'i', &ndep, "Dependents"); 
  Exemptions[1] = (double)ndep * 1000.0;
  if (Exemptions[1] > 0.0)
   {
-   fprintf(outfile,"  2bnum  = %d  Number of dependents\n", ndep );
-   fprintf(outfile,"  2b.  = %6.2f  %d x 1,000\n", Exemptions[1], ndep );
+   results_fprintf(outfile,"  2bnum  = %d  Number of dependents\n", ndep );
+   results_fprintf(outfile,"  2b.  = %6.2f  %d x 1,000\n", Exemptions[1], ndep );
   }
 
  i65 = 0; iblind = 0;
@@ -196,20 +202,20 @@ int main( int argc, char *argv[] )
  if (flag)
   {
    i65++;
-   fprintf(outfile,"Check_2cyou X\n");
+   results_fprintf(outfile,"Check_2cyou X\n");
   }
  get_parameter( infile, 's', word, "Age65Spouse");
  get_param_single_line( infile, 'b', &flag, "Spouse age over 65?");
  if (flag) 
   {
    i65++;
-   fprintf(outfile,"Check_2csp X\n");
+   results_fprintf(outfile,"Check_2csp X\n");
   }
  Exemptions[2] = (double)i65 * 700.0;
  if (Exemptions[2] > 0)
   {
-   fprintf(outfile,"  2cnum = %d    Age 65 or over\n", i65 );
-   fprintf(outfile,"  2c. = %6.2f    %d x 700\n", Exemptions[2], i65 );
+   results_fprintf(outfile,"  2cnum = %d    Age 65 or over\n", i65 );
+   results_fprintf(outfile,"  2c. = %6.2f    %d x 700\n", Exemptions[2], i65 );
   }
 
  get_parameter( infile, 's', word, "BlindYou");
@@ -217,30 +223,30 @@ int main( int argc, char *argv[] )
  if (flag) 
   {
    iblind++;
-   fprintf(outfile,"Check_2dyou X\n");
+   results_fprintf(outfile,"Check_2dyou X\n");
   }
  get_parameter( infile, 's', word, "BlindSpouse");
  get_param_single_line( infile, 'b', &flag, "Spouse Blindness?");
  if (flag) 
   {
    iblind++;
-   fprintf(outfile,"Check_2dsp X\n");
+   results_fprintf(outfile,"Check_2dsp X\n");
   }
  Exemptions[3] = (double)iblind * 2200.0;
  if (Exemptions[3] > 0)
   {
-   fprintf(outfile,"  2dnum = %d    Blindness\n", iblind );
-   fprintf(outfile,"  2d. = %6.2f     %d x 2,200\n", Exemptions[3], iblind );
+   results_fprintf(outfile,"  2dnum = %d    Blindness\n", iblind );
+   results_fprintf(outfile,"  2d. = %6.2f     %d x 2,200\n", Exemptions[3], iblind );
   }
 
  GetLine( "Med/Dental", &(Exemptions[4]) );
- fprintf(outfile,"  2e. = %6.2f\n", Exemptions[4] );
+ results_fprintf(outfile,"  2e. = %6.2f\n", Exemptions[4] );
 
  GetLine( "Adoption", &(Exemptions[5]) );
- fprintf(outfile,"  2f. = %6.2f\n", Exemptions[5] );
+ results_fprintf(outfile,"  2f. = %6.2f\n", Exemptions[5] );
 
  L[2] = Sum( Exemptions, 0, 5 );
- fprintf(outfile,"  2g. = %6.2f Total Exemptions\n", L[2] );
+ results_fprintf(outfile,"  2g. = %6.2f Total Exemptions\n", L[2] );
 
  GetLine( "L3", &L[3] );	/* Wages, salery, tips (W-2). */
  showline(3);
@@ -253,7 +259,7 @@ int main( int argc, char *argv[] )
   Iexempt = 200;
  else
   Iexempt = 100;
- fprintf(outfile,"L5b = %6.2f\n", Iexempt );
+ results_fprintf(outfile,"L5b = %6.2f\n", Iexempt );
  L[5] = MassBankInterest - Iexempt;
  if (L[5] < 0.0) L[5] = 0.0;
  if (L[5] > 0.0)
@@ -382,8 +388,8 @@ int main( int argc, char *argv[] )
    ws[7] = ws[3] + ws[4] + ws[5] + ws[6];
    AGI = ws[7];
    for (j=1; j<=7; j++)
-    fprintf(outfile,"     AGI_Worksheet[%d] = %6.2f\n", j, ws[j] );
-   fprintf(outfile,"   AGI = %6.2f\n", AGI );
+    results_fprintf(outfile,"     AGI_Worksheet[%d] = %6.2f\n", j, ws[j] );
+   results_fprintf(outfile,"   AGI = %6.2f\n", AGI );
    if (status != MARRIED_FILING_SEPARAT)
     { /*not_sep*/
      switch (status)
@@ -400,17 +406,17 @@ int main( int argc, char *argv[] )
 		threshA = 16400.0 + 1000.0 * ndep;
 		threshB = 28700.0 + 1750.0 * ndep;
 		break;
-	default: fprintf(outfile,"Bad filing status.\n"); 
-		printf("Bad filing status.\n");  exit(1); break;
+	default: results_fprintf(outfile,"Bad filing status.\n"); 
+		console_printf("Bad filing status.\n");  exit(1); break;
       }
      if (AGI <= threshA)
       {
 	notaxstatus = 1;
-	fprintf(outfile,"    (%6.2f <= %6.2f)\n", AGI, threshA );
-	fprintf(outfile,"You qualify for No Tax Status.\n");
+	results_fprintf(outfile,"    (%6.2f <= %6.2f)\n", AGI, threshA );
+	results_fprintf(outfile,"You qualify for No Tax Status.\n");
       } else
      if (AGI <= threshB)
-      fprintf(outfile,"See Form 1 Line 29 special instructions for Limited Income.\n");
+      results_fprintf(outfile,"See Form 1 Line 29 special instructions for Limited Income.\n");
     } /*not_sep*/
 }
 
@@ -481,7 +487,7 @@ int main( int argc, char *argv[] )
  GetLineF( "L43a", &L43a );	/* Earned income credit (EIC): Number of dependent children.  */
 
  GetLineF( "L43b", &L43b );	/* Earned income credit (EIC): amount from US Return */
- if (L43b != 0.0) fprintf(outfile, " L43b = %6.2f\n", L43b );
+ if (L43b != 0.0) results_fprintf(outfile, " L43b = %6.2f\n", L43b );
  L[43] = L43b * 0.30;
  ShowLineNonZero(43);
 
@@ -493,7 +499,7 @@ int main( int argc, char *argv[] )
 
  get_parameter( infile, 's', word, "L46num" );	/* Number of dependent household members under 13 or over 65. */
  get_parameters( infile, 'i', &ndep12, "L46num"); 
- fprintf(outfile,"L46num = %d\n", ndep12 ); 
+ results_fprintf(outfile,"L46num = %d\n", ndep12 ); 
  L[46] = ndep12 * 180.0;
  ShowLineNonZero(46);
 
@@ -512,35 +518,35 @@ int main( int argc, char *argv[] )
  if (L[37] < L[49]) 
   {
    L[50] = L[49] - L[37];
-   fprintf(outfile,"L50 = %6.2f  Overpayment!\n", L[50] );
+   results_fprintf(outfile,"L50 = %6.2f  Overpayment!\n", L[50] );
    if (L[51] > L[50])
     L[51] = L[50];
    showline_wmsg(51, "Overpayment to be applied to next year's estimated tax");
    L[52] = L[50] - L[51];
-   fprintf(outfile,"L52 = %6.2f  THIS IS YOUR REFUND\n", L[52] );
+   results_fprintf(outfile,"L52 = %6.2f  THIS IS YOUR REFUND\n", L[52] );
   }
  else 
   {
    L[53] = L[37] - L[49];
-   fprintf(outfile,"L53 = %6.2f  TAX DUE !!!\n", L[53] );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[53] / (L[37] + 1e-9) );
+   results_fprintf(outfile,"L53 = %6.2f  TAX DUE !!!\n", L[53] );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[53] / (L[37] + 1e-9) );
    if ((L[53] > 400.0) && (L[49] < 0.80 * L[37]))
-    fprintf(outfile," You may owe Underpayment of Estimated Tax penalty.\n");
+    results_fprintf(outfile," You may owe Underpayment of Estimated Tax penalty.\n");
   }
 
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  GetTextLineF( "Your1stName:" );
  GetTextLineF( "YourInitial:" );
  GetTextLineF( "YourLastName:" );
  answ = GetTextLine( "YourSocSec#:" );
  format_socsec( answ , 1 );
- fprintf(outfile,"YourSocSec#: %s\n", answ );
+ results_fprintf(outfile,"YourSocSec#: %s\n", answ );
  GetTextLineF( "Spouse1stName:" );
  GetTextLineF( "SpouseInitial:" );
  GetTextLineF( "SpouseLastName:" );
  answ = GetTextLine( "SpouseSocSec#:" );
  format_socsec( answ , 1 );
- fprintf(outfile,"SpouseSocSec#: %s\n", answ );
+ results_fprintf(outfile,"SpouseSocSec#: %s\n", answ );
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Town:" );
  GetTextLineF( "State:" );
@@ -550,9 +556,9 @@ int main( int argc, char *argv[] )
  GetTextLineF( "AccntNum:" );
  answ = GetTextLine( "AccountType:" ); 
  if (strcasecmp( answ, "Savings" ) == 0)
-  fprintf(outfile," Check_SavingsAccnt X\n");
+  results_fprintf(outfile," Check_SavingsAccnt X\n");
  if (strcasecmp( answ, "Checking" ) == 0)
-  fprintf(outfile," Check_CheckingAccnt X\n");
+  results_fprintf(outfile," Check_CheckingAccnt X\n");
  GetTextLineF( "Payment_Interest:" );
  GetTextLineF( "Payment_Penalty:" );                // Payment penalty you calculated.
  GetTextLineF( "M2210_Amount:" );                   // M-2210 amount.
@@ -564,9 +570,15 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
- printf("\nResults writen to file: %s\n", outfname);
+ console_printf("\nResults writen to file: %s\n", outfname);
 
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_MA_1, argc, argv );
+}
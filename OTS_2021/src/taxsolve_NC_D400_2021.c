@@ -77,16 +77,16 @@ void convert_slashes( char *fname )
 
 void ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 {
- FILE *infile;
- char fline[1000], word[1000];
- int linenum;
+ struct fed_snapshot snap;
+ struct fed_record *r;
+ char *word;
+ int linenum, k;
 
  convert_slashes( fedlogfile );
- infile = fopen(fedlogfile, "r");
- if (infile==0)
+ if (!load_fed_snapshot( fedlogfile, &snap ))
   {
-   printf("Error: Could not open federal return '%s'\n", fedlogfile);
-   fprintf(outfile,"\nError: Could not open federal return '%s'\n", fedlogfile);
+   console_printf("Error: Could not open federal return '%s'\n", fedlogfile);
+   results_fprintf(outfile,"\nError: Could not open federal return '%s'\n", fedlogfile);
    #ifdef __MINGW32__
     system("dir");
    #else
@@ -95,7 +95,7 @@ void ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
    #endif
    exit(1);
   }
- printf(" Reading file: %s\n", fedlogfile );
+ console_printf(" Reading file: %s\n", fedlogfile );
 
  /* Set initial default values. */
  fed_data->Itemized = 1; 
@@ -104,41 +104,39 @@ void ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
  for (linenum=0; linenum<MAX_LINES; linenum++) fed_data->fedline[linenum] = 0.0;
  for (linenum=0; linenum<MAX_LINES; linenum++) fed_data->Sched_A[linenum] = 0.0;
 
- read_line(infile,fline);  linenum = 0;
- while (!feof(infile))
+ linenum = 0;
+ for (k=0; k < snap.nrecords; k++)
   {
-   if ( verbose ) printf( "Read Line: %s" ,fline );
-   if (strstr(fline,"Use standard deduction.")!=0) fed_data->Itemized = 0;
-   if (strstr(fline,"Deductions not limited")!=0) 
+   r = &(snap.records[k]);
+   word = fed_label( &snap, r );
+   if ( verbose ) console_printf( "Read Line: %s%s\n", word, snap.text + r->rest );
+   if (r->flags & FED_STD_DEDUCTION) fed_data->Itemized = 0;
+   if (r->flags & FED_NOT_LIMITED)
     {
      fed_data->Limited = 0;
-     if ( strstr(fline,"line 6") ) fed_data->Limited_L6 = 0;
+     if (r->flags & FED_LINE_6) fed_data->Limited_L6 = 0;
     }
-   next_word(fline, word, " \t=");
-   if ((strstr(word,"A")==word) && (isdigit(word[1])) && (strstr(fline," = ")!=0))
+   if ((word[0] == 'A') && (isdigit(word[1])) && (r->flags & FED_HAS_EQUALS))
     {
-     if (sscanf(&word[1],"%d",&linenum)!=1) printf("Error: Reading fed sched-A line number '%s%s'\n",word,fline);
-     next_word(fline, word, " 	=");
-     if (sscanf(word,"%lf", &fed_data->Sched_A[linenum])!=1) printf("Error: Reading fed sched-A line %d '%s%s'\n",linenum,word,fline);
-     if (verbose) printf("Sched_A[%d] = %2.2f\n", linenum, fed_data->Sched_A[linenum]);
+     if (r->flags & FED_HAS_LINE) linenum = r->line;  else  console_printf("Error: Reading fed sched-A line number '%s%s'\n",word,snap.text + r->rest);
+     if (r->flags & FED_HAS_VALUE) fed_data->Sched_A[linenum] = r->value;  else  console_printf("Error: Reading fed sched-A line %d '%s'\n",linenum,snap.text + r->rest);
+     if (verbose) console_printf("Sched_A[%d] = %2.2f\n", linenum, fed_data->Sched_A[linenum]);
     }
-   if ((strstr(word,"L")==word) && (strstr(fline," = ")!=0))
+   if ((word[0] == 'L') && (r->flags & FED_HAS_EQUALS))
     {
-     if (sscanf(&word[1],"%d",&linenum)!=1) printf("Error: Reading fed line number '%s%s'\n",word,fline);
-     next_word(fline, word, " 	=");
-     if (sscanf(word,"%lf", &fed_data->fedline[linenum])!=1) printf("Error: Reading fed line %d '%s%s'\n",linenum,word,fline);
-     if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
+     if (r->flags & FED_HAS_LINE) linenum = r->line;  else  console_printf("Error: Reading fed line number '%s%s'\n",word,snap.text + r->rest);
+     if (r->flags & FED_HAS_VALUE) fed_data->fedline[linenum] = r->value;  else  console_printf("Error: Reading fed line %d '%s'\n",linenum,snap.text + r->rest);
+     if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
     }
-   read_line(infile,fline);
   }
- fclose(infile);
+ release_fed_snapshot( &snap );
 }
 
 
 /* ------------------------------------------------------------------------------------ */
 /* ---				Main						    --- */
 /* ------------------------------------------------------------------------------------ */
-int main( int argc, char *argv[] )
+int taxsolve_NC_D400( int argc, char *argv[] )
 {
  int j, jj, k, status;
  char word[1000], *infname=0, outfname[1000], *socsec, socsectmp[100];
@@ -151,22 +149,28 @@ int main( int argc, char *argv[] )
  /*-----------------------------------------*/
  /* --- Decode any command line options. -- */
  /*-----------------------------------------*/
- printf("NC D400 2021 - v%3.2f\n", thisversion);
+ console_printf("NC D400 2021 - v%3.2f\n", thisversion);
  jj = 1;  k=1;
  while (jj < argc)
  {
   if (strcmp(argv[jj],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[jj],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[jj],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[jj],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[jj],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
   if (k==1)
    {
-    infname = strdup(argv[jj]);
-    infile = fopen(argv[jj],"r");
+    infname = return_strdup(argv[jj]);
+    infile = taxsolve_fopen(argv[jj],"r");
     if (infile==0)
      {
-	printf("ERROR: Parameter file '%s' could not be opened.\n", argv[jj]); 
-	fprintf(outfile,"ERROR: Parameter file '%s' could not be opened.\n", argv[jj]); 
+	console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[jj]); 
+	results_fprintf(outfile,"ERROR: Parameter file '%s' could not be opened.\n", argv[jj]); 
 	exit(1);
      }
     k = 2;
@@ -175,19 +179,19 @@ int main( int argc, char *argv[] )
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
+    outfile = open_output_file( outfname );
     if (outfile==0)
      {
-	printf("ERROR: Output file '%s' could not be opened.\n", outfname); 
-	fprintf(outfile,"ERROR: Output file '%s' could not be opened.\n", outfname); 
+	console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); 
+	results_fprintf(outfile,"ERROR: Output file '%s' could not be opened.\n", outfname); 
 	exit(1);
      }
-    printf("Writing results to file:  %s\n", outfname);
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
    {
-	printf("Unknown command-line parameter '%s'\n", argv[jj]); 
-	fprintf(outfile,"Unknown command-line parameter '%s'\n", argv[jj]); 
+	console_printf("Unknown command-line parameter '%s'\n", argv[jj]); 
+	results_fprintf(outfile,"Unknown command-line parameter '%s'\n", argv[jj]); 
 	exit(1);
    }
   jj++;
@@ -195,8 +199,8 @@ int main( int argc, char *argv[] )
 
  if (infile==0)
   {
-	printf("Error: No input file on command line.\n"); 
-	fprintf(outfile,"Error: No input file on command line.\n"); 
+	console_printf("Error: No input file on command line.\n"); 
+	results_fprintf(outfile,"Error: No input file on command line.\n"); 
 	exit(1);
   }
  
@@ -217,12 +221,12 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
 
  /* get_parameter(infile, kind, x, emssg ) */
  get_parameter( infile, 's', word, "FedReturn" );	/* File name of Federal Return log file. */
- if ( verbose ) printf( "word: %s\n", word );
+ if ( verbose ) console_printf( "word: %s\n", word );
  get_word( infile, word ); 
  ImportFederalReturnData( word, &fed_data);
 
@@ -236,11 +240,11 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
    exit(1); 
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  GetLine( "L7", &L[7] );	/* Additions to Fed AGI - From Sched-S Part A, Line 6. */  
  GetLine( "L9", &L[9] );	/* Deductions from Fed AGI - From Sched-S Part B, Line 14. */  
@@ -286,12 +290,12 @@ int main( int argc, char *argv[] )
 				 min2file = 16125.0;
 	break;
    default:  
-	stdded = 0;  printf("Unknown status\n");  fprintf(outfile,"Unknown status\n");
+	stdded = 0;  console_printf("Unknown status\n");  results_fprintf(outfile,"Unknown status\n");
 	exit(1); 
   }
 
  if (L[6] <= min2file)
-  fprintf(outfile, "You may not need to file NC tax return, due to your income.\n");
+  results_fprintf(outfile, "You may not need to file NC tax return, due to your income.\n");
 
  L[8] = L[6] + L[7];
 
@@ -349,7 +353,7 @@ int main( int argc, char *argv[] )
   * the amount on L18 in data file.
   */
 
- printf( "Assuming you have calculated your USE tax (%2.2f) according to instructions pg 9\n", L[18] );
+ console_printf( "Assuming you have calculated your USE tax (%2.2f) according to instructions pg 9\n", L[18] );
 
  L[19] = L[17] + L[18];
 
@@ -362,14 +366,14 @@ int main( int argc, char *argv[] )
  if (L[19] > L[25]) 
   {
    L[26] = L[19] - L[25];	/* You OWE */
-   printf("         (Which is %2.1f%% of the total amount owed.)\n", 100.0 * L[26] / (L[19] + 1e-9) );
+   console_printf("         (Which is %2.1f%% of the total amount owed.)\n", 100.0 * L[26] / (L[19] + 1e-9) );
 
    /* Check for under payment see form D422 Part I */
    min_payment = 0.9 * L[19]; /* Estimate min required tax payments, form D422 Part I */
    if ((L[23] < min_payment) && (L[19] > 1000.00)) 
     {
      /* We would calculate penalty here... */
-     printf("WARNING: Possible underpayment of est. taxes penalty. Calculation not performed.\n"); 
+     console_printf("WARNING: Possible underpayment of est. taxes penalty. Calculation not performed.\n"); 
     }
    L[27] = L[26];  /* Assumes no penalties. */
   }
@@ -390,13 +394,13 @@ int main( int argc, char *argv[] )
  showline(8);	
  showline(9);	/* Deductions */
  if (L10a > 0)
-  fprintf(outfile, "L10a	%d\n", L10a );
+  results_fprintf(outfile, "L10a	%d\n", L10a );
  showline(10);
  showline(11);
  if (L[11] <= stdded)
-  fprintf(outfile," Check_UsedStdDed: X\n");
+  results_fprintf(outfile," Check_UsedStdDed: X\n");
  else
-  fprintf(outfile," Check_ItemizedDed: X\n");
+  results_fprintf(outfile," Check_ItemizedDed: X\n");
  showline_wlabel( "L12a", L12a );
  showline(12);
  if (L[13] < 1.0) showline(13);	 /* Part-yr */
@@ -405,7 +409,7 @@ int main( int argc, char *argv[] )
  showline(16);
  showline(17);
  if (L[18] == 0.0)
-  fprintf(outfile,"Check_NoUseTax X\n");
+  results_fprintf(outfile,"Check_NoUseTax X\n");
  showline(18);
  showline(19);
  showline_wlabel( "L20a", L20a );
@@ -422,11 +426,11 @@ int main( int argc, char *argv[] )
   {
    showline_wlabelmsg( "L26a", L[26], "TAX DUE" );
    showline_wmsg( 27, "Pay this amount" );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[26] / (L[19] + 1e-9) );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[26] / (L[19] + 1e-9) );
    if ((L[23] < min_payment) && (L[19] > 1000.00))
     {
-     fprintf(outfile," You may owe underpayment interest and penalties.\n");
-     fprintf(outfile," See page 6+7 instructions to calculate them according to your situation.\n");
+     results_fprintf(outfile," You may owe underpayment interest and penalties.\n");
+     results_fprintf(outfile," See page 6+7 instructions to calculate them according to your situation.\n");
     }
   }
  else
@@ -441,7 +445,7 @@ int main( int argc, char *argv[] )
   }
 
  do_all_caps = 1;
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  GetTextLineF( "Your1stName:" );
  GetTextLineF( "YourInitial:" );
  GetTextLineF( "YourLastName:" );
@@ -450,8 +454,7 @@ int main( int argc, char *argv[] )
  socsec = GetTextLineF( "YourSocSec#:" );
  strcpy( socsectmp, socsec );   /* Copy to buffer, since formatting could add 2-chars. */
  format_socsec( socsectmp, 0 );
- fprintf(outfile,"YourSocSec#: %s\n", socsectmp );
- free( socsec );
+ results_fprintf(outfile,"YourSocSec#: %s\n", socsectmp );
  writeout_line = 1;
 
    GetTextLineF( "Spouse1stName:" );
@@ -461,8 +464,7 @@ int main( int argc, char *argv[] )
    socsec = GetTextLineF( "SpouseSocSec#:" );
    strcpy( socsectmp, socsec );   /* Copy to buffer, since formatting could add 2-chars. */
    format_socsec( socsectmp, 0 );
-   fprintf(outfile,"SpouseSocSec#: %s\n", socsectmp );
-   free( socsec );
+   results_fprintf(outfile,"SpouseSocSec#: %s\n", socsectmp );
    writeout_line = 1;
 
  GetTextLineF( "Number&Street:" );
@@ -475,6 +477,12 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
  Display_File( outfname );
- printf("\nResults written to file '%s'\n", outfname);
+ console_printf("\nResults written to file '%s'\n", outfname);
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_NC_D400, argc, argv );
+}
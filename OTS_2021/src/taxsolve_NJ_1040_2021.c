@@ -40,62 +40,43 @@ double COJ[MAX_LINES], S[MAX_LINES], F[MAX_LINES];
 #define WIDOW		        5
 
 
-double TaxRateFormula( double x, int status )
+/* The instructions give each bracket's tax as "income times rate, minus an amount". */
+/* The bases below are the tax at each bracket's start, so figured from those.	       */
+THREAD_LOCAL struct tax_schedule tax_schedules[2]={
+ { 7, 1, TAX_BASES_GIVEN,	/* Single, Married/sep */
+   { DOLLARS(0), DOLLARS(20000), DOLLARS(35000), DOLLARS(40000), DOLLARS(75000), DOLLARS(500000), DOLLARS(1000000) },
+   { RATE(0.014), RATE(0.0175), RATE(0.035), RATE(0.05525), RATE(0.0637), RATE(0.0897), RATE(0.1075) },
+   { 0, MONEY(280.0), MONEY(542.50), MONEY(717.50), MONEY(2651.25), MONEY(29723.75), MONEY(74573.75) } },
+ { 8, 1, TAX_BASES_GIVEN,	/* Married/Joint, HouseHead, widower. */
+   { DOLLARS(0), DOLLARS(20000), DOLLARS(50000), DOLLARS(70000), DOLLARS(80000), DOLLARS(150000), DOLLARS(500000), DOLLARS(1000000) },
+   { RATE(0.014), RATE(0.0175), RATE(0.0245), RATE(0.035), RATE(0.05525), RATE(0.0637), RATE(0.0897), RATE(0.1075) },
+   { 0, MONEY(280.0), MONEY(805.0), MONEY(1295.50), MONEY(1645.0), MONEY(5512.50), MONEY(27807.50), MONEY(72657.50) } },
+		     };
+
+struct tax_schedule *tax_schedule_for( int status )
 {
  if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))	/* Single, Married/sep */
-  {
-   if (x < 20000.0)   return x * 0.014;               else
-   if (x < 35000.0)   return x * 0.0175  -     70.0;  else
-   if (x < 40000.0)   return x * 0.035   -    682.5;  else
-   if (x < 75000.0)   return x * 0.05525 -   1492.5;  else
-   if (x < 500000.0)  return x * 0.0637  -   2126.25; else
-   if (x < 1000000.0) return x * 0.0897  -  15126.25;
-   else		      return x * 0.1075  -  32926.25;
-  }
+  return &(tax_schedules[0]);
  else
  if ((status==MARRIED_FILING_JOINTLY) || (status==HEAD_OF_HOUSEHOLD) || (status==WIDOW))
-  {								/* Married/Joint, HouseHead, widower. */
-   if (x < 20000.0)   return x * 0.014;              else
-   if (x < 50000.0)   return x * 0.0175  -     70.0; else
-   if (x < 70000.0)   return x * 0.0245  -    420.0; else
-   if (x < 80000.0)   return x * 0.035   -   1154.5; else
-   if (x < 150000.0)  return x * 0.05525 -   2775.0; else
-   if (x < 500000.0)  return x * 0.0637  -   4042.5; else
-   if (x < 1000000.0) return x * 0.0897  -  17042.5;
-   else		      return x * 0.1075  -  34842.5;
-  }
- else { printf("Status not covered.\n"); exit(1); }
+  return &(tax_schedules[1]);
+ else { console_printf("Status not covered.\n"); exit(1); }
+}
+
+
+double TaxRateFormula( double x, int status )
+{
+ return scheduled_tax( tax_schedule_for( status ), x, TAX_EXACT, 0 );
 }
 
 
 void Report_bracket_info( double x, int status )
 {
  double tx, rate;
- tx = TaxRateFormula( x, status );
- if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))	/* Single, Married/sep */
-  {
-   if (x < 20000.0)   rate = 0.014;	else
-   if (x < 35000.0)   rate = 0.0175;	else
-   if (x < 40000.0)   rate = 0.035;	else
-   if (x < 75000.0)   rate = 0.05525;	else
-   if (x < 500000.0)  rate = 0.0637;    else
-   if (x < 1000000.0) rate = 0.0897;
-   else		      rate = 0.1075;
-  }
- else
-  {								/* Married/Joint, HouseHead, widower. */
-   if (x < 20000.0)   rate = 0.014;	else
-   if (x < 50000.0)   rate = 0.0175;	else
-   if (x < 70000.0)   rate = 0.0245;	else
-   if (x < 80000.0)   rate = 0.035;	else
-   if (x < 150000.0)  rate = 0.05525;	else
-   if (x < 500000.0)  rate = 0.0637;    else
-   if (x < 100000.0)  rate = 0.0897;
-   else		      rate = 0.1075;
-  }
- printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ tx = scheduled_tax( tax_schedule_for( status ), x, TAX_EXACT, &rate );
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / x );
- fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / x );
 }
 
@@ -131,14 +112,14 @@ void place_blocked_value( char *phrase, int numpre, int numpost, char *label )
   buf[j] = ' ';
  buf[j] = '\0';
  strcat( buf, phrase );
- fprintf(outfile, "%s = \"%s\"\n", label, buf );
+ results_fprintf(outfile, "%s = \"%s\"\n", label, buf );
  free( buf );
 }
 
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_NJ_1040( int argc, char *argv[] )
 {
  int i, j, k, status=0, answer=0, HomeOwner=0, Tenant=0, eligible_proptax_ded=1;
  char word[1000], *infname=0, outfname[4000];
@@ -151,34 +132,40 @@ int main( int argc, char *argv[] )
  char YourNames[2048]="", *PT_Block="", *PT_Lot="";
 
  /* Intercept any command-line arguments. */
- printf("NJ 1040 2021 - v%3.1f\n", thisversion);
+ console_printf("NJ 1040 2021 - v%3.1f\n", thisversion);
  i = 1;  k=1;
  while (i < argc)
  {
   if (strcmp(argv[i],"-verbose")==0)  verbose = 1;
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[i],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(argv[i],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(argv[i],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[i]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
-  else {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+  else {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) 
@@ -203,7 +190,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ) );
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ) );
 
  /* get_parameter(infile, kind, x, mesage ) */
  get_parameter( infile, 's', word, "Status" );
@@ -215,95 +202,95 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
    exit(1); 
   }
  switch (status)
  {
-  case SINGLE: 			fprintf(outfile,"Status = Single (%d)\n", status); 
+  case SINGLE: 			results_fprintf(outfile,"Status = Single (%d)\n", status); 
 				L[6] = 1;
 				break;
-  case MARRIED_FILING_JOINTLY: fprintf(outfile,"Status = Married/Joint (%d)\n", status); 
-				fprintf(outfile," Check_Spouse = X\n"); 
+  case MARRIED_FILING_JOINTLY: results_fprintf(outfile,"Status = Married/Joint (%d)\n", status); 
+				results_fprintf(outfile," Check_Spouse = X\n"); 
 				L[6] = 2;
 				break;
-  case MARRIED_FILING_SEPARAT: fprintf(outfile,"Status = Married/Sep (%d)\n", status);
+  case MARRIED_FILING_SEPARAT: results_fprintf(outfile,"Status = Married/Sep (%d)\n", status);
 				L[6] = 1;
 				break;
-  case HEAD_OF_HOUSEHOLD: 	fprintf(outfile,"Status = Head_of_Household (%d)\n", status); 
+  case HEAD_OF_HOUSEHOLD: 	results_fprintf(outfile,"Status = Head_of_Household (%d)\n", status); 
 				L[6] = 1;
 				break;
-  case WIDOW: 		  	fprintf(outfile,"Status = Widow(er) (%d)\n", status); 
+  case WIDOW: 		  	results_fprintf(outfile,"Status = Widow(er) (%d)\n", status); 
 				L[6] = 1;
 				break;
  }
 
- fprintf(outfile, "L6a = %d\n", (int)(L[6]) );
+ results_fprintf(outfile, "L6a = %d\n", (int)(L[6]) );
  L[6] = 1000.0 * L[6];
  shownum(6); 
 
  GetYesNoSL( "YouOver65", &answer );			/* Exemptions, Over 65. */
  L[7] = answer;
- if (answer) fprintf(outfile," Check_Over65 = X\n");
+ if (answer) results_fprintf(outfile," Check_Over65 = X\n");
 
  GetYesNoSL( "SpouseOver65", &answer );			/* Exemptions, Spouse Over 65. */
  if (status == MARRIED_FILING_JOINTLY)
   {
    L[7] = L[7] + answer;
-   if (answer) fprintf(outfile," Check_SpOver65 = X\n");
+   if (answer) results_fprintf(outfile," Check_SpOver65 = X\n");
   }
- fprintf(outfile, "L7a = %d\n", (int)(L[7]) );
+ results_fprintf(outfile, "L7a = %d\n", (int)(L[7]) );
  L[7] = 1000.0 * L[7];
  shownum(7); 
 
  GetYesNoSL( "YouBlindDisa", &answer );   		/* Exemptions, Blind/disabled. */
  L[8] = answer;
- if (answer) fprintf(outfile," Check_Blind = X\n");
+ if (answer) results_fprintf(outfile," Check_Blind = X\n");
 
  GetYesNoSL( "SpouseBlindDisa", &answer );		/* Exemptions, Spouse Blind/disabled. */
  if (status == MARRIED_FILING_JOINTLY)
   {
    L[8] = L[8] + answer;
-   if (answer) fprintf(outfile," Check_SpBlind = X\n");
+   if (answer) results_fprintf(outfile," Check_SpBlind = X\n");
   }
- fprintf(outfile, "L8a = %d\n", (int)(L[8]) );
+ results_fprintf(outfile, "L8a = %d\n", (int)(L[8]) );
  L[8] = 1000.0 * L[8];
  shownum(8); 
 
  GetYesNoSL( "YouVeteran", &answer );			/* Exemptions, Veteran */
  L[9] = answer;
- if (answer) fprintf(outfile," Check_Vet = X\n");
+ if (answer) results_fprintf(outfile," Check_Vet = X\n");
 
  GetYesNoSL( "SpouseVeteran", &answer );		/* Exemptions, Spouse Veteran */
  if (status == MARRIED_FILING_JOINTLY)
   {
    L[9] = L[9] + answer;
-   if (answer) fprintf(outfile," Check_SpVet = X\n");
+   if (answer) results_fprintf(outfile," Check_SpVet = X\n");
   }
- fprintf(outfile, "L9a = %d\n", (int)(L[9]) );
+ results_fprintf(outfile, "L9a = %d\n", (int)(L[9]) );
  L[9] = 6000.0 * L[9];
  shownum(9); 
 
  get_parameter( infile, 's', word, "L10" );	/* Exemptions, children. */
  get_param_single_line( infile, 'i', &j, "L10");
- fprintf(outfile, "L10a = %d\n", j );
+ results_fprintf(outfile, "L10a = %d\n", j );
  L[10] = 1500.0 * j;
  shownum(10); 
 
  get_parameter( infile, 's', word, "L11" );	/* Exemptions, other dependents. */
  get_param_single_line( infile, 'i', &j, "L11"); 
- fprintf(outfile, "L11a = %d\n", j );
+ results_fprintf(outfile, "L11a = %d\n", j );
  L[11] = 1500.0 * j;
  shownum(11); 
 
  get_parameter( infile, 's', word, "L12" );	/* Exemptions, college kids. */
  get_param_single_line( infile, 'i', &j, "L12"); 
- fprintf(outfile, "L11a = %d\n", j );
+ results_fprintf(outfile, "L11a = %d\n", j );
  L[12] = 1000.0 * j;
  shownum(12); 
 
- fprintf(outfile," FillOutForm_wRoundedNumbers_wZerosAfterDecPt\n" );
+ results_fprintf(outfile," FillOutForm_wRoundedNumbers_wZerosAfterDecPt\n" );
 
  L[13] = L[6] + L[7] + L[8] + L[9] + L[10] + L[11] + L[12];
  showline(13); 
@@ -358,12 +345,12 @@ int main( int argc, char *argv[] )
   filing_threshold = 20000.0;
 
  if (L[29] < filing_threshold)
-   fprintf(outfile," --- You do not need to file, (except to get refund).  Income < $%6.2f. ---\n", filing_threshold );
+   results_fprintf(outfile," --- You do not need to file, (except to get refund).  Income < $%6.2f. ---\n", filing_threshold );
 
  L[30] = L[13];
  showline(30);
 
- fprintf(outfile,"\n");
+ results_fprintf(outfile,"\n");
  GetLine( "F1", &F[1] );	/* Worksheet F Medical Expenses (See pg 27). */
  showline_wrksht('F',1,F);
  F[2] = 0.02 * L[29];
@@ -376,7 +363,7 @@ int main( int argc, char *argv[] )
  showline_wrksht('F',5,F);
  F[6] = NotLessThanZero( F[3] + F[4] + F[5] );
  showline_wrksht('F',6,F);
- fprintf(outfile,"\n");
+ results_fprintf(outfile,"\n");
  L[31] = F[6];
  if (L[31] != 0.0)
   showline_wmsg(31," Medical Expenses Worksheet F (See pg 27)");
@@ -413,18 +400,18 @@ int main( int argc, char *argv[] )
  GetYesNoSL( "HomeOwner:", &HomeOwner );	/* Y/N */
  GetYesNoSL( "Tenant:", &Tenant );		/* Y/N */
  if (HomeOwner && Tenant)
-  fprintf(outfile," Both_OwnerTenant = X\n");
+  results_fprintf(outfile," Both_OwnerTenant = X\n");
  else
  if (HomeOwner)
-  fprintf(outfile," HomeOwner = X\n");
+  results_fprintf(outfile," HomeOwner = X\n");
  else
  if (Tenant)
-  fprintf(outfile," Tenant = X\n");
+  results_fprintf(outfile," Tenant = X\n");
 
  GetLine( "COJ1", &COJ[1] );	/* Income taxed by other jurisdictions, if any. */
  GetLine( "COJ9a",&COJ_9a );	/* Tax paid to other jurisdictions on that income, if any. */
 
- fprintf(outfile,"\n");  /* Property Tax Deduction Worksheet H (pg 30). */
+ results_fprintf(outfile,"\n");  /* Property Tax Deduction Worksheet H (pg 30). */
  H[1] = L[39];
  showline_wrksht('H',1,H);
  if (status != MARRIED_FILING_SEPARAT)
@@ -443,29 +430,29 @@ int main( int argc, char *argv[] )
     eligible_proptax_ded = 0;
     if (L[39] != 0.0)
      {
-      printf("You are not eligible for property tax deduction as per right column on p. 23 of instructions.\n");
-      fprintf(outfile,"You are not eligible for property tax deduction as per right column on p. 23 of instructions.\n");
+      console_printf("You are not eligible for property tax deduction as per right column on p. 23 of instructions.\n");
+      results_fprintf(outfile,"You are not eligible for property tax deduction as per right column on p. 23 of instructions.\n");
      }
   }
 
  if (COJ_9a == 0.0)
   { /*Worksheet-H*/
     H[3] = L[38];	 Hb[3] = L[38];
-    fprintf(outfile," H3a = %6.2f	H3b = %6.2f\n", H[3], Hb[3]);
+    results_fprintf(outfile," H3a = %6.2f	H3b = %6.2f\n", H[3], Hb[3]);
     H[4] = H[2];	 Hb[4] = 0.0;
-    fprintf(outfile," H4a = %6.2f	H4b = %6.2f\n", H[4], Hb[4]);
+    results_fprintf(outfile," H4a = %6.2f	H4b = %6.2f\n", H[4], Hb[4]);
     H[5] = H[3] - H[4];  Hb[5] = Hb[3] - Hb[4];
-    fprintf(outfile," H5a = %6.2f	H5b = %6.2f\n", H[5], Hb[5]);
+    results_fprintf(outfile," H5a = %6.2f	H5b = %6.2f\n", H[5], Hb[5]);
     H[6] = TaxRateFunction( H[5], status );
     Hb[6] = TaxRateFunction( Hb[5], status );
-    fprintf(outfile," H6a = %6.2f	H6b = %6.2f\n", H[6], Hb[6]);
+    results_fprintf(outfile," H6a = %6.2f	H6b = %6.2f\n", H[6], Hb[6]);
     H[7] = Hb[6] - H[6];
     showline_wrksht('H',7,H);
     if (eligible_proptax_ded)
      { /*eligible*/
       if (H[7] >= proptxcredit)
        { /*yes*/
-         fprintf(outfile," H8. Yes. (Take Property Tax Deduction.)\n");
+         results_fprintf(outfile," H8. Yes. (Take Property Tax Deduction.)\n");
          L[40] = H[4];
          L[41] = H[5];
          L[42] = H[6];
@@ -473,7 +460,7 @@ int main( int argc, char *argv[] )
        } /*yes*/
       else
        { /*no*/
-         fprintf(outfile," H8. No. (Take Property Tax Credit.)\n");
+         results_fprintf(outfile," H8. No. (Take Property Tax Credit.)\n");
          L[40] = 0.0;
          L[41] = Hb[5];
          L[42] = Hb[6];
@@ -490,40 +477,40 @@ int main( int argc, char *argv[] )
   } /*Worksheet-H*/
  else
   { /*Sched COJ +Worksheet-I*/
-    fprintf(outfile,"\nSchedule COJ Credit for Income or Wage Taxes Paid to Other Jurisdiction (Previously Sched A):\n");
+    results_fprintf(outfile,"\nSchedule COJ Credit for Income or Wage Taxes Paid to Other Jurisdiction (Previously Sched A):\n");
     showline_wlabel("COJ_1", COJ[1]); 
     COJ[2] = L[29];
     showline_wlabel("COJ_2", COJ[2]);
     COJ[3] = smallerof( 1.0, (COJ[1] / COJ[2]) );
-    fprintf(outfile," COJ_3 = %6.2f %%\n", 100.0 * COJ[3] );
+    results_fprintf(outfile," COJ_3 = %6.2f %%\n", 100.0 * COJ[3] );
     COJ[4] = L[38];
-    fprintf(outfile," COJ_4a = %6.2f	COJ_4b = %6.2f\n", COJ[4], COJ[4] );
-    fprintf(outfile," (5a = %6.2f)\n", H[1] );
+    results_fprintf(outfile," COJ_4a = %6.2f	COJ_4b = %6.2f\n", COJ[4], COJ[4] );
+    results_fprintf(outfile," (5a = %6.2f)\n", H[1] );
     COJ[5] = H[2];
-    fprintf(outfile," COJ_5a = %6.2f	COJ_5b = %6.2f\n", COJ[5], 0.0);
+    results_fprintf(outfile," COJ_5a = %6.2f	COJ_5b = %6.2f\n", COJ[5], 0.0);
     COJ[6]  = COJ[4] - COJ[5];
     COJ_b[6] = COJ[4] - 0.0;
-    fprintf(outfile," COJ_6a = %6.2f	COJ_6b = %6.2f\n", COJ[6], COJ_b[6]);
+    results_fprintf(outfile," COJ_6a = %6.2f	COJ_6b = %6.2f\n", COJ[6], COJ_b[6]);
     COJ[7]  = TaxRateFunction( COJ[6], status );
     COJ_b[7] = TaxRateFunction( COJ_b[6], status );
-    fprintf(outfile," COJ_7a = %6.2f	COJ_7b = %6.2f\n", COJ[7], COJ_b[7] );
+    results_fprintf(outfile," COJ_7a = %6.2f	COJ_7b = %6.2f\n", COJ[7], COJ_b[7] );
     COJ[8]  = COJ[3] * COJ[7];
     COJ_b[8] = COJ[3] * COJ_b[7];
-    fprintf(outfile," COJ_8a = %6.2f	COJ_8b = %6.2f\n", COJ[8], COJ_b[8] );
-    fprintf(outfile,"  (9a = %6.2f)\n", COJ_9a );
+    results_fprintf(outfile," COJ_8a = %6.2f	COJ_8b = %6.2f\n", COJ[8], COJ_b[8] );
+    results_fprintf(outfile,"  (9a = %6.2f)\n", COJ_9a );
     COJ[9] = smallerof( smallerof( COJ_9a, COJ[8] ), COJ[7] );
     COJ_b[9] = smallerof( smallerof( COJ_9a, COJ_b[8] ), COJ_b[7] );
-    fprintf(outfile," COJ_9a = %6.2f	COJ_9b = %6.2f\n", COJ[9], COJ_b[9] );
+    results_fprintf(outfile," COJ_9a = %6.2f	COJ_9b = %6.2f\n", COJ[9], COJ_b[9] );
 
-    fprintf(outfile,"\nWorksheet I:\n");
+    results_fprintf(outfile,"\nWorksheet I:\n");
     I[1] = COJ[7];	Ib[1] = COJ_b[7];
-    fprintf(outfile," I1a = %6.2f	I1b = %6.2f\n", I[1], Ib[1] );
+    results_fprintf(outfile," I1a = %6.2f	I1b = %6.2f\n", I[1], Ib[1] );
     I[2] = COJ[9];	Ib[2] = COJ_b[9];
-    fprintf(outfile," I2a = %6.2f	I2b = %6.2f\n", I[2], Ib[2] );
+    results_fprintf(outfile," I2a = %6.2f	I2b = %6.2f\n", I[2], Ib[2] );
 
     I[3]  = I[1] - I[2];
     Ib[3] = Ib[1] - Ib[2];
-    fprintf(outfile," I3a = %6.2f	I3b = %6.2f\n", I[3], Ib[3] );
+    results_fprintf(outfile," I3a = %6.2f	I3b = %6.2f\n", I[3], Ib[3] );
 
     Ib[4] = Ib[3] - I[3];
     showline_wrksht('I', 4, Ib);
@@ -532,7 +519,7 @@ int main( int argc, char *argv[] )
      { /*eligible*/
       if (Ib[4] >= proptxcredit)
        {
-        fprintf(outfile," Sched-I, Yes:  Take PropTax Deduction\n\n");
+        results_fprintf(outfile," Sched-I, Yes:  Take PropTax Deduction\n\n");
         L[40] = COJ[5];	// fprintf(outfile,"L36c = %6.2f\n", L[36]);
         L[41] = COJ[6];
         L[42] = COJ[7];
@@ -541,7 +528,7 @@ int main( int argc, char *argv[] )
        }
       else
        {
-        fprintf(outfile," Sched-I, No:  Take PropTax Credit\n\n");
+        results_fprintf(outfile," Sched-I, No:  Take PropTax Credit\n\n");
         L[40] = 0.0;
         L[41] = COJ_b[6];
         L[42] = COJ_b[7];
@@ -560,11 +547,11 @@ int main( int argc, char *argv[] )
   } /*SchedA+Worksheet-I*/
 
  if (L[39] > 0.0)
-  fprintf(outfile, "L39a = %6.2f\n", L[39]);
+  results_fprintf(outfile, "L39a = %6.2f\n", L[39]);
 
  showline_wmsg( 40, "Property Tax Deduction" );
 
- fprintf(outfile,"\n");  /* NJ Taxable Income.*/
+ results_fprintf(outfile,"\n");  /* NJ Taxable Income.*/
  // L[41] = L[38] - L[40];  /* Handled above in Sched-1. */
  if (L[41] > 0.0)
   showline_wmsg( 41, "NJ Taxable Income" );
@@ -622,8 +609,8 @@ int main( int argc, char *argv[] )
  if (L[64] < L[53])
   {
    L[65] = L[53] - L[64];
-   fprintf(outfile, "L65 = %6.2f	DUE !!!\n", L[65] );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[65] / (L[41] + 1e-9) );
+   results_fprintf(outfile, "L65 = %6.2f	DUE !!!\n", L[65] );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[65] / (L[41] + 1e-9) );
    showline_wmsg( 76, "( Total Adjustments to tax due )");
    L[77] = L[65] + L[76];
    showline_wmsg( 77, "Balance Due" );
@@ -631,14 +618,14 @@ int main( int argc, char *argv[] )
  else
   {
    L[66] = L[64] - L[53];
-   fprintf(outfile, "L66 = %6.2f	Overpayment\n", L[66] );
+   results_fprintf(outfile, "L66 = %6.2f	Overpayment\n", L[66] );
 
    showline_wmsg( 76, "( Total Adjustments to overpayment )");
    L[78] = L[66] - L[76];
    showline_wmsg( 78, "Refund !!!" );
   }
  
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  Your1stName    = GetTextLineF( "Your1stName:" );
  YourInitial    = GetTextLineF( "YourInitial:" );
  YourLastName   = GetTextLineF( "YourLastName:" );
@@ -672,7 +659,7 @@ int main( int argc, char *argv[] )
        strcat( YourNames, SpouseInitial );
       }
     }
-   fprintf(outfile,"YourNames: %s\n", YourNames );
+   results_fprintf(outfile,"YourNames: %s\n", YourNames );
   }
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Town:" );
@@ -683,6 +670,12 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
  Display_File( outfname );
- printf("\nResults written to file:  %s\n", outfname);
+ console_printf("\nResults written to file:  %s\n", outfname);
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_NJ_1040, argc, argv );
+}
@@ -100,7 +100,7 @@ char *pull_initial( char *name )
    }
   else
    strcpy( midinitial, "" );
-  return strdup( midinitial );
+  return return_strdup( midinitial );
 }
 
 
@@ -109,9 +109,9 @@ char *pull_initial( char *name )
 
 int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 {
- FILE *infile;
+ struct fed_snapshot snap;
  char fline[4000], word[4000], tword[2000];
- int linenum, j;
+ int linenum, j, k;
 
  for (linenum=0; linenum<MAX_LINES; linenum++) 
   { 
@@ -130,33 +130,34 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
  fed_data->schedA8b = 0.0;
  fed_data->schedA8c = 0.0;
  convert_slashes( fedlogfile );
- infile = fopen(fedlogfile, "r");
- if (infile==0)
+ if (!load_fed_snapshot( fedlogfile, &snap ))
   {
-   printf("Error: Could not open Federal return '%s'\n", fedlogfile);
-   fprintf(outfile,"Error: Could not open Federal return '%s'\n", fedlogfile);
+   console_printf("Error: Could not open Federal return '%s'\n", fedlogfile);
+   results_fprintf(outfile,"Error: Could not open Federal return '%s'\n", fedlogfile);
    return 0; 
   }
  fed_data->Itemized = 1; /* Set initial default values. */
- read_line(infile,fline);  linenum = 0;
- while (!feof(infile))
+ linenum = 0;
+ for (k=0; k < snap.nrecords; k++)
   {
-   if (strstr(fline,"Use standard deduction.")!=0) fed_data->Itemized = 0;
-   next_word(fline, word, " \t=");
+   if (snap.records[k].flags & FED_STD_DEDUCTION) fed_data->Itemized = 0;
+   strncpy( word, fed_label( &snap, &(snap.records[k]) ), sizeof(word) - 1 );
+   word[sizeof(word) - 1] = '\0';
+   fed_rest( &snap, &(snap.records[k]), fline, sizeof(fline) );
    if ((strstr(word,"L")==word) && (strstr(fline," = ")!=0))
     {
      if (strcmp(word,"L9b") != 0)
       {
        if (sscanf(&word[1],"%d",&linenum)!=1)
 	{
-	 printf("Error: Reading Fed line number '%s%s'\n",word,fline);
-	 fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
+	 console_printf("Error: Reading Fed line number '%s%s'\n",word,fline);
+	 results_fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
 	}
        next_word(fline, tword, " \t=");
        if (sscanf(tword,"%lf", &fed_data->fedline[linenum])!=1)
 	{
-	 printf("Error: Reading Fed line %d '%s%s'\n",linenum,tword,fline);
-	 fprintf(outfile,"Error: Reading Fed line %d '%s%s'\n",linenum,tword,fline);
+	 console_printf("Error: Reading Fed line %d '%s%s'\n",linenum,tword,fline);
+	 results_fprintf(outfile,"Error: Reading Fed line %d '%s%s'\n",linenum,tword,fline);
 	}
        if (round_to_whole_dollars)
 	fed_data->fedline[linenum] = Round( fed_data->fedline[linenum] );
@@ -167,7 +168,7 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
        if (strcmp(word,"L6b") == 0)
 	fed_data->fed_L6b = fed_data->fedline[linenum];
 
-       if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
+       if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
       }
     }
    else
@@ -178,12 +179,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA5a) != 1) 
          {
-          printf("Error: Reading Fed SchedA5a %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA5a %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA5a = Round( fed_data->schedA5a );
-	if (verbose) printf("FedLinSchedA5a = %2.2f\n", fed_data->schedA5a );
+	if (verbose) console_printf("FedLinSchedA5a = %2.2f\n", fed_data->schedA5a );
       }
      else
      if (strcmp( word, "A5b" ) == 0)
@@ -191,12 +192,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA5b) != 1) 
          {
-          printf("Error: Reading Fed SchedA5b %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA5b %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA5b = Round( fed_data->schedA5b );
-	if (verbose) printf("FedLinSchedA5b = %2.2f\n", fed_data->schedA5b );
+	if (verbose) console_printf("FedLinSchedA5b = %2.2f\n", fed_data->schedA5b );
       }
      else
      if (strcmp( word, "A5c" ) == 0)
@@ -204,12 +205,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA5c) != 1) 
          {
-          printf("Error: Reading Fed SchedA5c %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA5c %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA5c = Round( fed_data->schedA5c );
-	if (verbose) printf("FedLinSchedA5c = %2.2f\n", fed_data->schedA5c );
+	if (verbose) console_printf("FedLinSchedA5c = %2.2f\n", fed_data->schedA5c );
       }
      else
      if (strcmp( word, "A8a" ) == 0)
@@ -217,12 +218,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA8a) != 1) 
          {
-          printf("Error: Reading Fed SchedA8a %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA8a %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA8a = Round( fed_data->schedA8a );
-	if (verbose) printf("FedLinSchedA8a = %2.2f\n", fed_data->schedA8a );
+	if (verbose) console_printf("FedLinSchedA8a = %2.2f\n", fed_data->schedA8a );
       }
      else
      if (strcmp( word, "A8b" ) == 0)
@@ -230,12 +231,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA8b) != 1) 
          {
-          printf("Error: Reading Fed SchedA8b %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA8b %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA8b = Round( fed_data->schedA8b );
-	if (verbose) printf("FedLinSchedA8b = %2.2f\n", fed_data->schedA8b );
+	if (verbose) console_printf("FedLinSchedA8b = %2.2f\n", fed_data->schedA8b );
       }
      else
      if (strcmp( word, "A8c" ) == 0)
@@ -243,29 +244,29 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	next_word(fline, word, " \t=");
 	if (sscanf(word,"%lf", &fed_data->schedA8c) != 1) 
          {
-          printf("Error: Reading Fed SchedA8c %d '%s%s'\n",linenum,word,fline);
-	  fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
+          console_printf("Error: Reading Fed SchedA8c %d '%s%s'\n",linenum,word,fline);
+	  results_fprintf(outfile, "Error: Reading Fed SchedA %d '%s%s'\n",linenum,word,fline);
          }
         if (round_to_whole_dollars)
          fed_data->schedA8c = Round( fed_data->schedA8c );
-	if (verbose) printf("FedLinSchedA8c = %2.2f\n", fed_data->schedA8c );
+	if (verbose) console_printf("FedLinSchedA8c = %2.2f\n", fed_data->schedA8c );
       }
      else
       { /*normal*/
        if (sscanf(&word[1],"%d",&linenum)!=1)
         {
-	 printf("Error: Reading Fed line number '%s%s'\n",word,fline);
-	 fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
+	 console_printf("Error: Reading Fed line number '%s%s'\n",word,fline);
+	 results_fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
         }
        next_word(fline, word, " \t=");
        if (sscanf(word,"%lf", &fed_data->schedA[linenum])!=1) 
         {
-	 printf("Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
-	 fprintf(outfile, "Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
+	 console_printf("Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
+	 results_fprintf(outfile, "Error: Reading Fed schedA %d '%s%s'\n",linenum,word,fline);
         }
        if (round_to_whole_dollars)
         fed_data->schedA[linenum] = Round( fed_data->schedA[linenum] );
-       if (verbose) printf("FedLinSchedA[%d] = %2.2f\n", linenum, fed_data->schedA[linenum]);
+       if (verbose) console_printf("FedLinSchedA[%d] = %2.2f\n", linenum, fed_data->schedA[linenum]);
       } /*normal*/
     } /*Schedule-A*/
    else
@@ -273,8 +274,8 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
     { /*Schedule-D*/
      if (sscanf(&word[1],"%d",&linenum)!=1)
       {
-	printf("Error: Reading Fed line number '%s%s'\n",word,fline);
-	fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
+	console_printf("Error: Reading Fed line number '%s%s'\n",word,fline);
+	results_fprintf(outfile,"Error: Reading Fed line number '%s%s'\n",word,fline);
       }
      next_word(fline, word, " \t=");
      if (strcmp(word,"d") == 0)
@@ -283,7 +284,7 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	while (word[0] != '\0')
 	 {
 	  if (sscanf(word,"%lf", &fed_data->schedD[linenum]) != 1) 
-	   fprintf(outfile,"Error: Reading Fed schedD %d '%s %s'\n", linenum, word, fline);
+	   results_fprintf(outfile,"Error: Reading Fed schedD %d '%s %s'\n", linenum, word, fline);
 	  if (round_to_whole_dollars)
 	   fed_data->schedD[linenum] = Round( fed_data->schedD[linenum] );
 	  next_word(fline, word, " \teh=" );
@@ -297,26 +298,26 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
        if (strncasecmp(word,"no",1) == 0) fed_data->schedD[linenum] = 0;
        else
         {
-         printf("Error: Reading fed schedD %d '%s%s'\n", linenum, word, fline);
-	 fprintf(outfile,"Error: Reading Fed schedD %d '%s%s'\n", linenum, word, fline);
+         console_printf("Error: Reading fed schedD %d '%s%s'\n", linenum, word, fline);
+	 results_fprintf(outfile,"Error: Reading Fed schedD %d '%s%s'\n", linenum, word, fline);
         }
       }
      else
      if (round_to_whole_dollars)
        fed_data->schedD[linenum] = Round( fed_data->schedD[linenum] );
-     if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->schedD[linenum]);
+     if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->schedD[linenum]);
     }
    else
    if (strncmp(word,"S1_",3) == 0)
     {
      next_word( &(word[3]), tword, " \t=:");
      if (sscanf( tword, "%d", &linenum) != 1)
-      printf("Error: Reading Fed sched1 line-number '%s'\n", word );
+      console_printf("Error: Reading Fed sched1 line-number '%s'\n", word );
      else
       {
 	next_word(fline, word, " \t=:");
 	if (sscanf(word,"%lf", &fed_data->sched[1][linenum]) != 1) 
-	 printf("Error: Reading Fed sched1 line '%s'\n", word );
+	 console_printf("Error: Reading Fed sched1 line '%s'\n", word );
 	if (round_to_whole_dollars)
 	 fed_data->sched[1][linenum] = Round( fed_data->sched[1][linenum] );
       }
@@ -326,12 +327,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
     {
      next_word( &(word[3]), tword, " \t=:");
      if (sscanf( tword, "%d", &linenum) != 1)
-      printf("Error: Reading Fed sched2 line-number '%s'\n", word );
+      console_printf("Error: Reading Fed sched2 line-number '%s'\n", word );
      else
       {
 	next_word(fline, word, " \t=:");
 	if (sscanf(word,"%lf", &fed_data->sched[2][linenum]) != 1) 
-	 printf("Error: Reading Fed sched2 line '%s'\n", word );
+	 console_printf("Error: Reading Fed sched2 line '%s'\n", word );
 	if (round_to_whole_dollars)
 	 fed_data->sched[2][linenum] = Round( fed_data->sched[2][linenum] );
       }
@@ -341,12 +342,12 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
     {
      next_word( &(word[3]), tword, " \t=:");
      if (sscanf( tword, "%d", &linenum) != 1)
-      printf("Error: Reading Fed sched3 line-number '%s'\n", word );
+      console_printf("Error: Reading Fed sched3 line-number '%s'\n", word );
      else
       {
 	next_word(fline, word, " \t=:");
 	if (sscanf(word,"%lf", &fed_data->sched[3][linenum]) != 1) 
-	 printf("Error: Reading Fed sched3 line '%s'\n", word );
+	 console_printf("Error: Reading Fed sched3 line '%s'\n", word );
 	if (round_to_whole_dollars)
 	 fed_data->sched[3][linenum] = Round( fed_data->sched[3][linenum] );
       }
@@ -355,7 +356,7 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
    if (strcmp(word,"Status") == 0)
     {
      next_word(fline, word, " \t=");
-     fprintf(outfile," Status %s\n", word );
+     results_fprintf(outfile," Status %s\n", word );
      if (strncasecmp(word,"Single",4)==0)
 	status = SINGLE;
      else
@@ -372,52 +373,53 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 	status = WIDOW;
      else 
       { 
-       printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-       fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word);
+       console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+       results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word);
+       release_fed_snapshot( &snap );
        return 0; 
       }
     }
    else
    if (strcmp(word,"Your1stName:") == 0)
     {
-	Your1stName = strdup( fline );
+	Your1stName = return_strdup( fline );
 	YourInitial = pull_initial( Your1stName );
     }
    else
    if (strcmp(word,"YourLastName:") == 0)
     {
-	YourLastName = strdup( fline );
+	YourLastName = return_strdup( fline );
     }
    else
    if (strcmp(word,"YourSocSec#:") == 0)
     {
-	YourSocSec = strdup( fline );
+	YourSocSec = return_strdup( fline );
     }
    else
    if (strcmp(word,"Spouse1stName:") == 0)
     {
-	Spouse1stName = strdup( fline );
+	Spouse1stName = return_strdup( fline );
 	SpouseInitial = pull_initial( Spouse1stName );
     }
    else
    if (strcmp(word,"SpouseLastName:") == 0)
     {
-	SpouseLastName = strdup( fline );
+	SpouseLastName = return_strdup( fline );
     }
    else
    if (strcmp(word,"SpouseSocSec#:") == 0)
     {
-	SpouseSocSec = strdup( fline );
+	SpouseSocSec = return_strdup( fline );
     }
    else
    if (strcmp(word,"Number&Street:") == 0)
     {
-	MailAddress = strdup( fline );
+	MailAddress = return_strdup( fline );
     }
    else
    if (strcmp(word,"Apt#:") == 0)
     {
-	AptNumber = strdup( fline );
+	AptNumber = return_strdup( fline );
     }
    else
    if (strcmp(word,"TownStateZip:") == 0)
@@ -437,128 +439,78 @@ int ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
      if (j > 0)
       {
 	next_word( fline, word, " \t\n\r" );
-	Dep_info[j].Name1st = strdup( word );
-	read_line(infile,fline);
+	Dep_info[j].Name1st = return_strdup( word );
+	if (++k < snap.nrecords) fed_line( &snap, &(snap.records[k]), fline, sizeof(fline) );  else fline[0] = '\0';
 	next_word( fline, word, " \t\n\r" );
 	if (strstr( word, "_LastName:" ) == 0)
-	 { printf("Error: expected dependent %d last name, but found '%s'\n", j, word ); }
+	 { console_printf("Error: expected dependent %d last name, but found '%s'\n", j, word ); }
 	next_word( fline, word, " \t\n\r" );
-	Dep_info[j].NameLst = strdup( word );
-	read_line(infile,fline);
+	Dep_info[j].NameLst = return_strdup( word );
+	if (++k < snap.nrecords) fed_line( &snap, &(snap.records[k]), fline, sizeof(fline) );  else fline[0] = '\0';
         next_word( fline, word, " \t\n\r" );
         if (strstr( word, "_SocSec#:" ) == 0)
-         { printf("Error: expected dependent %d SocSec#, but found '%s'\n", j, word ); }
+         { console_printf("Error: expected dependent %d SocSec#, but found '%s'\n", j, word ); }
         next_word( fline, word, " \t\n\r" );
-        Dep_info[j].SocSec = strdup( word );
-        read_line(infile,fline);
+        Dep_info[j].SocSec = return_strdup( word );
+        if (++k < snap.nrecords) fed_line( &snap, &(snap.records[k]), fline, sizeof(fline) );  else fline[0] = '\0';
         next_word( fline, word, " \t\n\r" );
         if (strstr( word, "_Relation:" ) == 0)
-         { printf("Error: expected dependent %d Relation, but found '%s'\n", j, word ); }
+         { console_printf("Error: expected dependent %d Relation, but found '%s'\n", j, word ); }
         next_word( fline, word, " \t\n\r" );
-        Dep_info[j].Relat = strdup( word );
+        Dep_info[j].Relat = return_strdup( word );
         nDeps = j;
       }
     }
-   read_line(infile,fline);
   }
- fclose(infile);
+ release_fed_snapshot( &snap );
  return 1;
 }
 
 
 
-double TaxRateFunction( double income, int status )
+THREAD_LOCAL struct tax_schedule tax_schedules[3]={				/* Updated for 2021. */
+ { 10, 0, TAX_BASES_GIVEN,	/* Married/Joint, widow(er).  Data from pg 51. */
+   { DOLLARS(0), DOLLARS(17150), DOLLARS(23600), DOLLARS(27900), DOLLARS(43000), DOLLARS(161550), DOLLARS(323200), DOLLARS(2155350), DOLLARS(5000000), DOLLARS(25000000) },
+   { RATE(0.04), RATE(0.045), RATE(0.0525), RATE(0.059), RATE(0.0597), RATE(0.0633), RATE(0.0685), RATE(0.0965), RATE(0.103), RATE(0.109) },
+   { 0, DOLLARS(686), DOLLARS(976), DOLLARS(1202), DOLLARS(2093), DOLLARS(9170), DOLLARS(19403), DOLLARS(144905), DOLLARS(419414), DOLLARS(2479414) } },
+ { 10, 0, TAX_BASES_GIVEN,	/* Single, Married/sep */
+   { DOLLARS(0), DOLLARS(8500), DOLLARS(11700), DOLLARS(13900), DOLLARS(21400), DOLLARS(80650), DOLLARS(215400), DOLLARS(1077550), DOLLARS(5000000), DOLLARS(25000000) },
+   { RATE(0.04), RATE(0.045), RATE(0.0525), RATE(0.059), RATE(0.0597), RATE(0.0633), RATE(0.0685), RATE(0.0965), RATE(0.103), RATE(0.109) },
+   { 0, DOLLARS(340), DOLLARS(484), DOLLARS(600), DOLLARS(1042), DOLLARS(4579), DOLLARS(13109), DOLLARS(72166), DOLLARS(450683), DOLLARS(2510683) } },
+ { 10, 0, TAX_BASES_GIVEN,	/* Head of Household */
+   { DOLLARS(0), DOLLARS(12800), DOLLARS(17650), DOLLARS(20900), DOLLARS(32200), DOLLARS(107650), DOLLARS(269300), DOLLARS(1616450), DOLLARS(5000000), DOLLARS(25000000) },
+   { RATE(0.04), RATE(0.045), RATE(0.0525), RATE(0.059), RATE(0.0597), RATE(0.0633), RATE(0.0685), RATE(0.0965), RATE(0.103), RATE(0.109) },
+   { 0, DOLLARS(512), DOLLARS(730), DOLLARS(901), DOLLARS(1568), DOLLARS(6072), DOLLARS(16304), DOLLARS(108584), DOLLARS(435097), DOLLARS(2495097) } },
+		     };
+
+struct tax_schedule *tax_schedule_for( int status )
 {
- double tax;
  switch (status)
   {
-   case MARRIED_FILING_JOINTLY: case WIDOW:					/* Updated for 2021. */
-	if (income <=    17150.0) tax =             0.04 * income; else		/* Data from pg 51. */
-	if (income <=    23600.0) tax =     686.0 + 0.045  * (income - 17150.0); else
-	if (income <=    27900.0) tax =     976.0 + 0.0525 * (income - 23600.0); else
-	if (income <=    43000.0) tax =    1202.0 + 0.059  * (income - 27900.0); else
-	if (income <=   161550.0) tax =    2093.0 + 0.0597 * (income - 43000.0); else
-	if (income <=   323200.0) tax =    9170.0 + 0.0633 * (income - 161550.0); else
-	if (income <=  2155350.0) tax =   19403.0 + 0.0685 * (income - 323200.0); else
-	if (income <=  5000000.0) tax =  144905.0 + 0.0965 * (income - 2155350.0); else
-	if (income <= 25000000.0) tax =  419414.0 + 0.103 * (income - 5000000.0); else
-				  tax = 2479414.0 + 0.109 * (income - 25000000.0);
-      break;
-   case SINGLE: case MARRIED_FILING_SEPARAT:
-	if (income <=     8500.0) tax =  	    0.04   * income; else
-	if (income <=    11700.0) tax =     340.0 + 0.045  * (income - 8500.0); else
-	if (income <=    13900.0) tax =     484.0 + 0.0525 * (income - 11700.0); else
-	if (income <=    21400.0) tax =     600.0 + 0.059  * (income - 13900.0); else
-	if (income <=    80650.0) tax =    1042.0 + 0.0597 * (income - 21400.0); else
-	if (income <=   215400.0) tax =    4579.0 + 0.0633 * (income - 80650.0); else
-	if (income <=  1077550.0) tax =   13109.0 + 0.0685 * (income - 215400.0); else
-	if (income <=  5000000.0) tax =   72166.0 + 0.0965 * (income - 1077550.0); else
-	if (income <= 25000000.0) tax =  450683.0 + 0.103 * (income - 5000000.0); else
-			 	  tax = 2510683.0 + 0.109 * (income - 25000000.0);
-      break;
-   case HEAD_OF_HOUSEHOLD:
-	if (income <=    12080.0) tax =             0.04 * income; else
-	if (income <=    17650.0) tax =     512.0 + 0.045  * (income - 12800.0); else
-	if (income <=    20900.0) tax =     730.0 + 0.0525 * (income - 17650.0); else
-	if (income <=    32200.0) tax =     901.0 + 0.059  * (income - 20900.0); else
-	if (income <=   107650.0) tax =    1568.0 + 0.0597 * (income - 32200.0); else
-	if (income <=   269300.0) tax =    6072.0 + 0.0633 * (income - 107650.0); else
-	if (income <=  1616450.0) tax =   16304.0 + 0.0685 * (income - 269300.0); else
-	if (income <=  5000000.0) tax =  108584.0 + 0.0965 * (income - 1616450.0); else
-	if (income <= 25000000.0) tax =  435097.0 + 0.103 * (income - 5000000.0); else
-				  tax = 2495097.0 + 0.109 * (income - 25000000.0);
-      break;
-   default: printf("Error: Unhandled status\n"); exit(0); break;
+   case MARRIED_FILING_JOINTLY: case WIDOW:	return &(tax_schedules[0]);
+   case SINGLE: case MARRIED_FILING_SEPARAT:	return &(tax_schedules[1]);
+   case HEAD_OF_HOUSEHOLD:			return &(tax_schedules[2]);
+   default: console_printf("Error: Unhandled status\n"); exit(0); break;
   }
- return tax;
+ return 0;
+}
+
+
+double TaxRateFunction( double income, int status )
+{
+ return scheduled_tax( tax_schedule_for( status ), income, TAX_EXACT, 0 );
 }
 
 
 void Report_bracket_info( double income, double tx, int status )
 {
  double rate;
- switch (status)
-  {
-   case MARRIED_FILING_JOINTLY: case WIDOW:				/* Updated for 2021. */
-	if (income <=    17150.0) rate = 0.04;  else
-	if (income <=    23600.0) rate = 0.045;  else
-	if (income <=    27900.0) rate = 0.0525;  else
-	if (income <=    43000.0) rate = 0.059;  else
-	if (income <=   161550.0) rate = 0.0597;  else
-	if (income <=   323200.0) rate = 0.0633;  else
-	if (income <=  2155350.0) rate = 0.0685;  else  
-	if (income <=  5000000.0) rate = 0.0965; else
-	if (income <= 25000000.0) rate = 0.103; else rate = 0.109;
-      break;
-   case SINGLE: case MARRIED_FILING_SEPARAT:
-	if (income <=     8500.0) rate = 0.04;  else
-	if (income <=    11700.0) rate = 0.045;  else
-	if (income <=    13900.0) rate = 0.0525;  else
-	if (income <=    21400.0) rate = 0.059;  else
-	if (income <=    80650.0) rate = 0.0597;  else
-	if (income <=   215400.0) rate = 0.0633;  else
-	if (income <=  1077550.0) rate = 0.0685;  else
-	if (income <=  5000000.0) rate = 0.0965;  else
-	if (income <= 25000000.0) rate = 0.103;  else rate = 0.109;
-      break;
-   case HEAD_OF_HOUSEHOLD:
-	if (income <=    12800.0) rate = 0.04;  else
-	if (income <=    17650.0) rate = 0.045;  else
-	if (income <=    20900.0) rate = 0.0525;  else
-	if (income <=    32200.0) rate = 0.059;  else
-	if (income <=   107650.0) rate = 0.0597;  else
-	if (income <=   269300.0) rate = 0.0633;  else
-	if (income <=  1616450.0) rate = 0.0685;  else
-	if (income <=  5000000.0) rate = 0.0965;  else
-	if (income <= 25000000.0) rate = 0.103;  else rate = 0.109;
-      break;
-   default: printf("Error: Unhandled status\n"); exit(0); break;
-  }
- printf("tx = %g, income = %g\n", tx, income );
+ scheduled_tax( tax_schedule_for( status ), income, TAX_EXACT, &rate );
+ console_printf("tx = %g, income = %g\n", tx, income );
  if (income == 0.0) income = 0.0001;	/* Prevent divide by zero. */
- printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
- fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
 }
 
@@ -580,6 +532,21 @@ double TaxRateLookup( double income, int status )
 }
 
 
+THREAD_LOCAL struct tax_schedule nyc_tax_schedules[3]={			/* Updated for 2021. */
+ { 4, 1, TAX_BASES_GIVEN,	/* Married/Joint, widow(er) */
+   { DOLLARS(0), DOLLARS(21600), DOLLARS(45000), DOLLARS(90000) },
+   { RATE(0.03078), RATE(0.03762), RATE(0.03819), RATE(0.03876) },
+   { 0, DOLLARS(665), DOLLARS(1545), DOLLARS(3264) } },
+ { 4, 1, TAX_BASES_GIVEN,	/* Single, Married/sep */
+   { DOLLARS(0), DOLLARS(12000), DOLLARS(25000), DOLLARS(50000) },
+   { RATE(0.03078), RATE(0.03762), RATE(0.03819), RATE(0.03876) },
+   { 0, DOLLARS(369), DOLLARS(858), DOLLARS(1813) } },
+ { 4, 1, TAX_BASES_GIVEN,	/* Head of Household */
+   { DOLLARS(0), DOLLARS(14400), DOLLARS(30000), DOLLARS(60000) },
+   { RATE(0.03078), RATE(0.03762), RATE(0.03819), RATE(0.03876) },
+   { 0, DOLLARS(443), DOLLARS(1030), DOLLARS(2176) } },
+		     };
+
 double NYcityTaxRateFunction( double income, int status )	/* From page 67. */
 {
  double tax, dx;
@@ -593,29 +560,14 @@ double NYcityTaxRateFunction( double income, int status )	/* From page 67. */
   income = m * dx + 0.5 * dx;      /* Place into center of a $50 bracket. */
 
  if ((status==MARRIED_FILING_JOINTLY) || (status==WIDOW))		/* Updated for 2021. */
-  {
-   if (income < 21600.0)  tax = income * 0.03078; else
-   if (income < 45000.0)  tax = (income - 21600.00) * 0.03762 + 665.00; else
-   if (income < 90000.0)  tax = (income - 45000.00) * 0.03819 + 1545.0; else
-			  tax = (income - 90000.00) * 0.03876 + 3264.0;
-  }
+  tax = scheduled_tax( &(nyc_tax_schedules[0]), income, TAX_EXACT, 0 );
  else
  if ((status==SINGLE) || (status==MARRIED_FILING_SEPARAT))
-  {
-   if (income < 12000.0)  tax = income * 0.03078; else
-   if (income < 25000.0)  tax = (income - 12000.00) * 0.03762 + 369.0;  else
-   if (income < 50000.0)  tax = (income - 25000.00) * 0.03819 + 858.0;  else
-			  tax = (income - 50000.00) * 0.03876 + 1813.00;
-  }
+  tax = scheduled_tax( &(nyc_tax_schedules[1]), income, TAX_EXACT, 0 );
  else
  if (status==HEAD_OF_HOUSEHOLD)
-  {
-   if (income < 14400.00) tax = income * 0.03078; else
-   if (income < 30000.00) tax = (income - 14400.00) * 0.03762 +  443.0;  else
-   if (income < 60000.00) tax = (income - 30000.00) * 0.03819 + 1030.0;  else
-			  tax = (income - 60000.00) * 0.03876 + 2176.0;
- }
- else {printf("Status not covered.\n");  exit(1);}
+  tax = scheduled_tax( &(nyc_tax_schedules[2]), income, TAX_EXACT, 0 );
+ else {console_printf("Status not covered.\n");  exit(1);}
 
  if (income < 65000.0) tax = (int)(tax + 0.5);   /* Round result to whole dollar. */
  return tax;
@@ -624,7 +576,7 @@ double NYcityTaxRateFunction( double income, int status )	/* From page 67. */
 
 void worksheet1()	/*Tax Computation Worksheet 1 (pg 52) */		/* Updated for 2021. */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 1.\n");
+  console_printf(" Doing Tax Computation Worksheet 1.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0597 * ws[2];
@@ -646,7 +598,7 @@ void worksheet1()	/*Tax Computation Worksheet 1 (pg 52) */		/* Updated for 2021.
 
 void worksheet2()	/*Tax Computation Worksheet 2 (pg 52) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 2.\n");
+  console_printf(" Doing Tax Computation Worksheet 2.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0633 * ws[2];
@@ -670,7 +622,7 @@ void worksheet2()	/*Tax Computation Worksheet 2 (pg 52) */
 
 void worksheet3()	/*Tax Computation Worksheet 3 (pg 52) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 3.\n");
+  console_printf(" Doing Tax Computation Worksheet 3.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0685 * ws[2];
@@ -694,7 +646,7 @@ void worksheet3()	/*Tax Computation Worksheet 3 (pg 52) */
 
 void worksheet4()	/*Tax Computation Worksheet 4 (pg 52) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 4.\n");
+  console_printf(" Doing Tax Computation Worksheet 4.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0965 * ws[2];
@@ -718,7 +670,7 @@ void worksheet4()	/*Tax Computation Worksheet 4 (pg 52) */
 
 void worksheet5()	/*Tax Computation Worksheet 5 (pg 53) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 5.\n");
+  console_printf(" Doing Tax Computation Worksheet 5.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.103 * ws[2];
@@ -742,7 +694,7 @@ void worksheet5()	/*Tax Computation Worksheet 5 (pg 53) */
 
 void worksheet6()	/*Tax Computation Worksheet 6 (pg 53) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 6.\n");
+  console_printf(" Doing Tax Computation Worksheet 6.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.109 * ws[2];
@@ -778,7 +730,7 @@ void worksheet6()	/*Tax Computation Worksheet 6 (pg 53) */
 
 void worksheet7()	/*Tax Computation Worksheet 7 (pg 54) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 7.\n");
+  console_printf(" Doing Tax Computation Worksheet 7.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0633 * ws[2];
@@ -800,7 +752,7 @@ void worksheet7()	/*Tax Computation Worksheet 7 (pg 54) */
 
 void worksheet8()	/*Tax Computation Worksheet 8 (pg 54) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 8.\n");
+  console_printf(" Doing Tax Computation Worksheet 8.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0685 * ws[2];
@@ -824,7 +776,7 @@ void worksheet8()	/*Tax Computation Worksheet 8 (pg 54) */
 
 void worksheet9()	/*Tax Computation Worksheet 9 (pg 54) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 9.\n");
+  console_printf(" Doing Tax Computation Worksheet 9.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0965 * ws[2];
@@ -848,7 +800,7 @@ void worksheet9()	/*Tax Computation Worksheet 9 (pg 54) */
 
 void worksheet10()	/*Tax Computation Worksheet 10 (pg 54) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 10.\n");
+  console_printf(" Doing Tax Computation Worksheet 10.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0103 * ws[2];
@@ -872,7 +824,7 @@ void worksheet10()	/*Tax Computation Worksheet 10 (pg 54) */
 
 void worksheet11()	/*Tax Computation Worksheet 11 (pg 55) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 11.\n");
+  console_printf(" Doing Tax Computation Worksheet 11.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0109 * ws[2];
@@ -905,7 +857,7 @@ void worksheet11()	/*Tax Computation Worksheet 11 (pg 55) */
 
 void worksheet12()	/*Tax Computation Worksheet 12 (pg 56) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 12.\n");
+  console_printf(" Doing Tax Computation Worksheet 12.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0633 * ws[2];
@@ -927,7 +879,7 @@ void worksheet12()	/*Tax Computation Worksheet 12 (pg 56) */
 
 void worksheet13()	/*Tax Computation Worksheet 13 (pg 56) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 13.\n");
+  console_printf(" Doing Tax Computation Worksheet 13.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0685 * ws[2];
@@ -951,7 +903,7 @@ void worksheet13()	/*Tax Computation Worksheet 13 (pg 56) */
 
 void worksheet14()	/*Tax Computation Worksheet 14 (pg 56) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 14.\n");
+  console_printf(" Doing Tax Computation Worksheet 14.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0109 * ws[2];
@@ -975,7 +927,7 @@ void worksheet14()	/*Tax Computation Worksheet 14 (pg 56) */
 
 void worksheet15()	/*Tax Computation Worksheet 15 (pg 56) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 15.\n");
+  console_printf(" Doing Tax Computation Worksheet 15.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0109 * ws[2];
@@ -999,7 +951,7 @@ void worksheet15()	/*Tax Computation Worksheet 15 (pg 56) */
 
 void worksheet16()	/*Tax Computation Worksheet 16 (pg 57) */
 { double ws[100];
-  printf(" Doing Tax Computation Worksheet 16.\n");
+  console_printf(" Doing Tax Computation Worksheet 16.\n");
   ws[1] = L[33];
   ws[2] = L[38];
   ws[3] = 0.0109 * ws[2];
@@ -1053,8 +1005,8 @@ void tax_computation_worksheet( int status )
 	    worksheet5();
 	   else
 	    {
-		printf("AGI Case not handled.\n");
-		fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
+		console_printf("AGI Case not handled.\n");
+		results_fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
 		exit(1);
 	    }
 	 }
@@ -1077,8 +1029,8 @@ void tax_computation_worksheet( int status )
 	    worksheet10();
 	   else
 	    {
-		printf("AGI Case not handled.\n");
-		fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
+		console_printf("AGI Case not handled.\n");
+		results_fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
 		exit(1);
 	    }
 	 }
@@ -1102,22 +1054,22 @@ void tax_computation_worksheet( int status )
 	    worksheet15();
 	   else
 	    {
-		printf("AGI Case not handled.\n");
-		fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
+		console_printf("AGI Case not handled.\n");
+		results_fprintf(outfile,"AGI Case not handled. L33=%6.2f, L38=%6.2f\n", L[33], L[38] );
 		exit(1);
 	    }
 	 }
 	else
 	 worksheet16();
 	break;
-     default: printf("Case not handled.\n");  fprintf(outfile,"Case not handled.\n"); exit(1);
+     default: console_printf("Case not handled.\n");  results_fprintf(outfile,"Case not handled.\n"); exit(1);
   }
 }
 
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_NY_IT201( int argc, char *argv[] )
 {
  int j, k, argk, day, month, yyyy;
  char word[1000], *infname=0, outfname[1000], *answ;
@@ -1129,34 +1081,40 @@ int main( int argc, char *argv[] )
  char YourNames[2048]="";
 
  /* Intercept any command-line arguments. */
- printf("NY-IT201 - 2011 - v%3.1f\n", thisversion);
+ console_printf("NY-IT201 - 2011 - v%3.1f\n", thisversion);
  argk = 1;  k=1;
  while (argk < argc)
  {
   if (strcmp(argv[argk],"-verbose")==0)  verbose = 1;
   else
+  if (strcmp(argv[argk],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[argk],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[argk],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[argk],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
   if (k==1)
    {
-    infname = strdup(argv[argk]);
-    infile = fopen(argv[argk],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[argk]);  exit(1);}
+    infname = return_strdup(argv[argk]);
+    infile = taxsolve_fopen(argv[argk],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[argk]);  exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[argk]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname);  exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname);  exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
-  else {printf("Unknown command-line parameter '%s'\n", argv[argk]);  exit(1);}
+  else {console_printf("Unknown command-line parameter '%s'\n", argv[argk]);  exit(1);}
   argk = argk + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (j=0; j<MAX_LINES; j++) 
@@ -1177,7 +1135,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  get_parameter( infile, 's', word, "FileName" );      /* Preliminary Return Output File-name. */
  get_word(infile, prelim_1040_outfilename );
@@ -1191,15 +1149,15 @@ int main( int argc, char *argv[] )
 
  answ = GetTextLine( "YourDOB" );
  if (interpret_date( answ, &month, &day, &yyyy, "reading 'YourDOB'" ))
-   fprintf(outfile,"YourDOB \"%s\"\n", format_mmddyyyy( month, day, yyyy ) );
+   results_fprintf(outfile,"YourDOB \"%s\"\n", format_mmddyyyy( month, day, yyyy ) );
  else
-  fprintf(outfile,"YourDOB \"%s\"\n", answ );
+  results_fprintf(outfile,"YourDOB \"%s\"\n", answ );
 
  answ = GetTextLine( "SpouseDOB" );
  if (interpret_date( answ, &month, &day, &yyyy, "reading 'SpouseDOB'" ))
-   fprintf(outfile,"SpouseDOB \"%s\"\n", format_mmddyyyy( month, day, yyyy ) );
+   results_fprintf(outfile,"SpouseDOB \"%s\"\n", format_mmddyyyy( month, day, yyyy ) );
  else
-  fprintf(outfile,"SpouseDOB \"%s\"\n", answ );
+  results_fprintf(outfile,"SpouseDOB \"%s\"\n", answ );
 
  GetTextLineF( "County" );
  GetTextLineF( "SchooldDist" );
@@ -1208,33 +1166,33 @@ int main( int argc, char *argv[] )
  answ = GetTextLineF( "D1_ForeignAcct" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkD1y: X\n");
+  results_fprintf(outfile,"CkD1y: X\n");
  else
-  fprintf(outfile,"CkD1n: X\n");
+  results_fprintf(outfile,"CkD1n: X\n");
 
  answ = GetTextLineF( "D2_1-YonkRelCred" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkD2_1y: X\n");
+  results_fprintf(outfile,"CkD2_1y: X\n");
  else
  if ((mystrcasestr( word, "N/A" ) == 0) && (toupper( word[0] ) == 'N'))
-  fprintf(outfile,"CkD2_1n: X\n");
+  results_fprintf(outfile,"CkD2_1n: X\n");
 
  GetTextLineF( "D2_2-YRCamount" );
  
  answ = GetTextLineF( "D3-NonQualComp" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkD3y: X\n");
+  results_fprintf(outfile,"CkD3y: X\n");
  else
-  fprintf(outfile,"CkD3n: X\n");
+  results_fprintf(outfile,"CkD3n: X\n");
 
  answ = GetTextLineF( "E1_LivedNYC" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkE1y: X\n");
+  results_fprintf(outfile,"CkE1y: X\n");
  else
-  fprintf(outfile,"CkE1n: X\n");
+  results_fprintf(outfile,"CkE1n: X\n");
 
  GetTextLineF( "E2_DaysNYC" );
  GetTextLineF( "F1_MonthsYouNYC" );
@@ -1249,24 +1207,24 @@ int main( int argc, char *argv[] )
 
  if (PrelimFedReturn.Itemized)
   {
-   fprintf(outfile," Check box B = Yes\n");
-   fprintf(outfile,"  Check_Itemized = X\n");
+   results_fprintf(outfile," Check box B = Yes\n");
+   results_fprintf(outfile,"  Check_Itemized = X\n");
   }
  else
   {
-   fprintf(outfile," Check box B = No\n");
-   fprintf(outfile,"  Check_NoItemiz = X\n");
+   results_fprintf(outfile," Check box B = No\n");
+   results_fprintf(outfile,"  Check_NoItemiz = X\n");
   }
 
  if (Dependent==1)
   {
-   fprintf(outfile," Check box C = Yes\n");
-   fprintf(outfile,"  Check_Depend = X\n");
+   results_fprintf(outfile," Check box C = Yes\n");
+   results_fprintf(outfile,"  Check_Depend = X\n");
   }
  else
   {
-   fprintf(outfile," Check box C = No\n");
-   fprintf(outfile,"  Check_NotDep = X\n");
+   results_fprintf(outfile," Check box C = No\n");
+   results_fprintf(outfile,"  Check_NotDep = X\n");
   }
 
  showline(1);
@@ -1335,8 +1293,8 @@ int main( int argc, char *argv[] )
  showline(17);
  if (absolutev( L[17] - PrelimFedReturn.fedline[9]) > 0.1)
   {
-   printf(" Warning: L[17] = %6.2f, while Fed-line[9] = %6.2f\n", L[17], PrelimFedReturn.fedline[9] );
-   fprintf(outfile," Warning: L[17] = %6.2f, while Fed-line[9] = %6.2f\n", L[17], PrelimFedReturn.fedline[9] );
+   console_printf(" Warning: L[17] = %6.2f, while Fed-line[9] = %6.2f\n", L[17], PrelimFedReturn.fedline[9] );
+   results_fprintf(outfile," Warning: L[17] = %6.2f, while Fed-line[9] = %6.2f\n", L[17], PrelimFedReturn.fedline[9] );
   }
 
  // GetLineF( "L18", &L[18] );	/* Total federal adjustments to income (pg 14) */
@@ -1347,8 +1305,8 @@ int main( int argc, char *argv[] )
  showline_wmsg( 19, "Federal adjusted gross income" );
  if (absolutev(L[19] - PrelimFedReturn.fedline[11]) > 0.1)
   {
-   printf(" Warning: L[19] = %6.2f, while Fed-line[11] = %6.2f\n", L[19], PrelimFedReturn.fedline[11] );
-   fprintf(outfile," Warning: L[19] = %6.2f, while Fed-line[11] = %6.2f\n", L[19], PrelimFedReturn.fedline[11] );
+   console_printf(" Warning: L[19] = %6.2f, while Fed-line[11] = %6.2f\n", L[19], PrelimFedReturn.fedline[11] );
+   results_fprintf(outfile," Warning: L[19] = %6.2f, while Fed-line[11] = %6.2f\n", L[19], PrelimFedReturn.fedline[11] );
   }
  // TODO - L19a recomputed federal agi. (page 16, 19a worksheet)
 
@@ -1446,13 +1404,13 @@ int main( int argc, char *argv[] )
  if (std_ded > itemized_ded) 
   {
    L[34] = std_ded;
-   fprintf(outfile,"Check_Std = X\n");
+   results_fprintf(outfile,"Check_Std = X\n");
    showline_wmsg(34,"(Mark Std-deduction)");
   }
  else
   {
    L[34] = itemized_ded;
-   fprintf(outfile,"Check_Item = X\n");
+   results_fprintf(outfile,"Check_Item = X\n");
    showline_wmsg(34,"(Mark Itemized-deduction)");
   }
 
@@ -1465,7 +1423,7 @@ int main( int argc, char *argv[] )
  L[36] = 1000.0 * (double)k;
  showline(36);
  if (k > 0)
-  fprintf(outfile, "L36_enter %d\n", k ); 
+  results_fprintf(outfile, "L36_enter %d\n", k ); 
 
  L[37] = L[35] - L[36];
  if (L[37] < 0.0)
@@ -1697,46 +1655,46 @@ int main( int argc, char *argv[] )
  if (L[76] > L[62])
   {
    L[77] = L[76] - L[62];
-   fprintf(outfile,"L77 = %6.2f	REFUND !!!\n", L[77] );
+   results_fprintf(outfile,"L77 = %6.2f	REFUND !!!\n", L[77] );
    L[78] = L[77];
    showline(78);
   }
  else
   {
    L[80] = L[62] - L[76];
-   fprintf(outfile,"L80 = %6.2f	DUE !!!\n", L[80] );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[80] / (L[62] + 1e-9) );
+   results_fprintf(outfile,"L80 = %6.2f	DUE !!!\n", L[80] );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[80] / (L[62] + 1e-9) );
   }
 
 
 
 
  if (Your1stName)
-  fprintf(outfile,"Your1stName: %s\n", Your1stName );
+  results_fprintf(outfile,"Your1stName: %s\n", Your1stName );
  if (YourInitial)
-  fprintf(outfile,"YourInitial: %s\n", YourInitial );
+  results_fprintf(outfile,"YourInitial: %s\n", YourInitial );
  if (YourLastName)
-  fprintf(outfile,"YourLastName: %s\n", YourLastName );
+  results_fprintf(outfile,"YourLastName: %s\n", YourLastName );
  if (YourSocSec)
-  fprintf(outfile,"YourSocSec#: %s\n", YourSocSec );
+  results_fprintf(outfile,"YourSocSec#: %s\n", YourSocSec );
  if (Spouse1stName)
-  fprintf(outfile,"Spouse1stName: %s\n", Spouse1stName );
+  results_fprintf(outfile,"Spouse1stName: %s\n", Spouse1stName );
  if (SpouseInitial)
-  fprintf(outfile,"SpouseInitial: %s\n", SpouseInitial );
+  results_fprintf(outfile,"SpouseInitial: %s\n", SpouseInitial );
  if (SpouseLastName)
-  fprintf(outfile,"SpouseLastName: %s\n", SpouseLastName );
+  results_fprintf(outfile,"SpouseLastName: %s\n", SpouseLastName );
  if (SpouseSocSec)
-  fprintf(outfile,"SpouseSocSec#: %s\n", SpouseSocSec );
+  results_fprintf(outfile,"SpouseSocSec#: %s\n", SpouseSocSec );
  if (MailAddress)
-  fprintf(outfile,"Number&Street: %s\n", MailAddress );
+  results_fprintf(outfile,"Number&Street: %s\n", MailAddress );
  if (AptNumber)
-  fprintf(outfile,"Apt#: %s\n", AptNumber );
+  results_fprintf(outfile,"Apt#: %s\n", AptNumber );
  if (Town[0] != '\0')
-  fprintf(outfile,"Town: %s\n", Town );
+  results_fprintf(outfile,"Town: %s\n", Town );
  if (StateName[0] != '\0')
-  fprintf(outfile,"StateName: %s\n", StateName );
+  results_fprintf(outfile,"StateName: %s\n", StateName );
  if (Zipcode[0] != '\0')
-  fprintf(outfile,"Zipcode: %s\n", Zipcode );
+  results_fprintf(outfile,"Zipcode: %s\n", Zipcode );
 
  if (strlen( YourLastName ) > 0)
   {
@@ -1763,21 +1721,27 @@ int main( int argc, char *argv[] )
        strcat( YourNames, SpouseInitial );
       }
     }
-   fprintf(outfile,"YourNames: %s\n", YourNames );
+   results_fprintf(outfile,"YourNames: %s\n", YourNames );
   }
 
  for (j=1; j <= nDeps; j++)
   {
-    fprintf(outfile,"H%d_Name1st: %s\n", j, Dep_info[j].Name1st );
-    fprintf(outfile,"H%d_NameLst: %s\n", j, Dep_info[j].NameLst );
-    fprintf(outfile,"H%d_SocSec: %s\n", j, Dep_info[j].SocSec );
-    fprintf(outfile,"H%d_Relat: %s\n", j, Dep_info[j].Relat );
+    results_fprintf(outfile,"H%d_Name1st: %s\n", j, Dep_info[j].Name1st );
+    results_fprintf(outfile,"H%d_NameLst: %s\n", j, Dep_info[j].NameLst );
+    results_fprintf(outfile,"H%d_SocSec: %s\n", j, Dep_info[j].SocSec );
+    results_fprintf(outfile,"H%d_Relat: %s\n", j, Dep_info[j].Relat );
   }
 
  fclose(infile);
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_NY_IT201, argc, argv );
+}
@@ -36,27 +36,27 @@ double thisversion=19.00;
 #define MARRIED_FILING_SEPARAT 3
 #define HEAD_OF_HOUSEHOLD       1
 
+/* Income through $25,000 is not taxed; the later brackets carry the published base amounts. */
+THREAD_LOCAL struct tax_schedule tax_schedule={				/* Updated for 2021. */
+ 5, 0, TAX_BASES_GIVEN,
+ { DOLLARS(0), DOLLARS(25000), DOLLARS(44250), DOLLARS(88450), DOLLARS(110650) },
+ { RATE(0.0), RATE(0.02765), RATE(0.03226), RATE(0.03688), RATE(0.03990) },
+ { 0, MONEY(346.16), MONEY(878.42), MONEY(2304.31), MONEY(3123.05) }
+		     };
+
 double TaxRateFunction( double x, int status )
-{							/* Updated for 2021. */
- if (x <= 25000.0) return    0.0; else
- if (x <  44250.0) return  346.16 + (x-25000.0)  * 0.02765; else
- if (x <  88450.0) return  878.42 + (x-44250.0)  * 0.03226; else
- if (x < 110650.0) return 2204.31 + (x-88450.0)  * 0.03688; else
- 		   return 3123.05 + (x-110650.0) * 0.03990;
+{
+ return scheduled_tax( &tax_schedule, x, TAX_EXACT, 0 );
 }
 
 
 void Report_bracket_info( double income, double tx, int status )
-{							/* Updated for 2021. */
+{
  double rate;
- if (income <= 25000.0) rate = 0.0; else
- if (income <  44250.0) rate = 0.02765; else
- if (income <  88450.0) rate = 0.03226; else
- if (income < 110650.0) rate = 0.03688;
- else 		   	rate = 0.03990;
- printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ scheduled_tax( &tax_schedule, income, TAX_EXACT, &rate );
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
- fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
 }
 
@@ -77,13 +77,13 @@ char *pull_initial( char *name )
    }
   else
    strcpy( midinitial, "" );
-  return strdup( midinitial );
+  return return_strdup( midinitial );
 }
 
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_OH_IT1040( int argc, char *argv[] )
 {
  int j, k, mm;
  char word[4000], *infname=0, outfname[4000], label[90], *socsec, *pname, *MidInit;
@@ -96,32 +96,38 @@ int main( int argc, char *argv[] )
  char *DateBeganResidence, *DateEndResidence, *OtherState;
 
  /* Intercept any command-line arguments. */
- printf("OH IT1040 2021 - v%3.1f\n", thisversion);
+ console_printf("OH IT1040 2021 - v%3.1f\n", thisversion);
  mm = 1;  k=1;
  while (mm < argc)
  {
   if (strcmp(argv[mm],"-verbose")==0)  verbose = 1;
   else
+  if (strcmp(argv[mm],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[mm],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[mm],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[mm]);
-    infile = fopen(argv[mm],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[mm]);  exit(1);}
+    infname = return_strdup(argv[mm]);
+    infile = taxsolve_fopen(argv[mm],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[mm]);  exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[mm]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname);  exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname);  exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
-  else {printf("Unknown command-line parameter '%s'\n", argv[mm]); exit(1);}
+  else {console_printf("Unknown command-line parameter '%s'\n", argv[mm]); exit(1);}
   mm++;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n");  exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n");  exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (mm=0; mm<MAX_LINES; mm++) 
@@ -141,7 +147,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  /* get_parameter(infile, kind, x, emssg ) */
  get_parameter( infile, 's', word, "Status" );
@@ -152,11 +158,11 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Head_of_House",4)==0) status = HEAD_OF_HOUSEHOLD;
  else
   { 
-   printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house.\nExiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house.\nExiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house.\nExiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house.\nExiting.\n", word); 
    exit(1); 
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  get_parameter( infile, 's', word, "Exemptions" );	/* Exemptions, self/depend. */
  get_parameters( infile, 'i', &exemptions, "Exemptions"); 
@@ -358,10 +364,10 @@ int main( int argc, char *argv[] )
   }
 
  if ((L[1] < 24100.0) && (L[3] < 0.0))		/* Min2File. */
-  fprintf(outfile, "You do not need to file Ohio tax return (Fed AGI < minimum).\n");
+  results_fprintf(outfile, "You do not need to file Ohio tax return (Fed AGI < minimum).\n");
 
  if ((L[1] < 24100.0) && (L[4] >= L[3]))
-  fprintf(outfile, "You do not need to file Ohio tax return (L[4] >= L[3]).\n");
+  results_fprintf(outfile, "You do not need to file Ohio tax return (L[4] >= L[3]).\n");
 
 
  /* Output the Results. */
@@ -371,7 +377,7 @@ int main( int argc, char *argv[] )
  showline_wlabel( "L2b", L2b );
  showline(3);
  showline(4);
- fprintf(outfile," Exemptions = %d\n", exemptions );
+ results_fprintf(outfile," Exemptions = %d\n", exemptions );
  showline(5);
  showline(6);
  showline(7);
@@ -394,7 +400,7 @@ int main( int argc, char *argv[] )
     showline(21);
     showline(22);
     showline_wmsg( 23, "TOTAL AMOUNT DUE !!!" );
-    fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[23] / (L[13] + 1e-9) );
+    results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[23] / (L[13] + 1e-9) );
   }
  else
   {
@@ -402,21 +408,21 @@ int main( int argc, char *argv[] )
     showline_wmsg( 27, "YOUR REFUND !!!" );
   }
 
- fprintf(outfile,"\n-- 2021 Ohio Schedule A --\n");
+ results_fprintf(outfile,"\n-- 2021 Ohio Schedule A --\n");
  for (j = 1; j <= 39; j++)
   {
    sprintf( label, "SchedA%d", j );
    showline_wlabel( label, SchedA[j] );
   }
 
- fprintf(outfile,"\n-- 2021 Ohio Schedule of Credits --\n");
+ results_fprintf(outfile,"\n-- 2021 Ohio Schedule of Credits --\n");
  for (j = 1; j <= 11; j++)
   {
    sprintf( label, "Credits%d", j );
    showline_wlabel( label, SchedC[j] );
   }
  if (jfc > 0.0)
-  fprintf(outfile,"JFC = %d\n", (int)(100.0 * jfc + 0.25) );
+  results_fprintf(outfile,"JFC = %d\n", (int)(100.0 * jfc + 0.25) );
  for (j = 12; j <= 31; j++)
   {
    sprintf( label, "Credits%d", j );
@@ -424,15 +430,15 @@ int main( int argc, char *argv[] )
   }
 
  if (DateBeganResidence[0] != 0)
-  fprintf(outfile,"   DateBeganResidence: %s\n", DateBeganResidence );
+  results_fprintf(outfile,"   DateBeganResidence: %s\n", DateBeganResidence );
  if (DateEndResidence[0] != 0)
-  fprintf(outfile,"   DateEndResidence: %s\n", DateEndResidence );
+  results_fprintf(outfile,"   DateEndResidence: %s\n", DateEndResidence );
  if (OtherState[0] != 0)
-  fprintf(outfile,"   OtherState: %s\n", OtherState );
+  results_fprintf(outfile,"   OtherState: %s\n", OtherState );
 
  sprintf(word,"%5.4f", factorA );
-printf("factorA = %g, word = '%s'\n", factorA, word );
- fprintf(outfile,"   Credits32a \"%s\"\n", word );
+console_printf("factorA = %g, word = '%s'\n", factorA, word );
+ results_fprintf(outfile,"   Credits32a \"%s\"\n", word );
 
  for (j = 32; j <= 34; j++)
   {
@@ -441,8 +447,8 @@ printf("factorA = %g, word = '%s'\n", factorA, word );
   }
 
  sprintf(word,"%5.4f", factorB );
-printf("factorB = %g, word = '%s'\n", factorB, word );
- fprintf(outfile,"   Credits35a \"%s\"\n", word );
+console_printf("factorB = %g, word = '%s'\n", factorB, word );
+ results_fprintf(outfile,"   Credits35a \"%s\"\n", word );
 
  for (j = 35; j <= 44; j++)
   {
@@ -450,45 +456,49 @@ printf("factorB = %g, word = '%s'\n", factorB, word );
    showline_wlabel( label, SchedC[j] );
   }
 
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  pname = GetTextLine( "Your1stName:" );
  MidInit = pull_initial( pname );
- fprintf(outfile,"Your1stName: %s\n", pname );
- fprintf(outfile,"YourMidInit: %s\n", MidInit );
+ results_fprintf(outfile,"Your1stName: %s\n", pname );
+ results_fprintf(outfile,"YourMidInit: %s\n", MidInit );
  GetTextLineF( "YourLastName:" );
  writeout_line = 0;
  socsec = GetTextLine( "YourSocSec#:" );
  format_socsec( socsec, 0 );
- fprintf(outfile,"YourSocSec#: %s\n", socsec );
- free( socsec );
+ results_fprintf(outfile,"YourSocSec#: %s\n", socsec );
  writeout_line = 1;
  pname = GetTextLine( "Spouse1stName:" );
  MidInit = pull_initial( pname );
- fprintf(outfile,"Spouse1stName: %s\n", pname );
- fprintf(outfile,"SpouseMidInit: %s\n", MidInit );
+ results_fprintf(outfile,"Spouse1stName: %s\n", pname );
+ results_fprintf(outfile,"SpouseMidInit: %s\n", MidInit );
  GetTextLineF( "SpouseLastName:" );
  writeout_line = 0;
  socsec = GetTextLine( "SpouseSocSec#:" );
  format_socsec( socsec, 0 );
  if (status != MARRIED_FILING_SEPARAT)
-  fprintf(outfile,"SpouseSocSec#: %s\n", socsec );
+  results_fprintf(outfile,"SpouseSocSec#: %s\n", socsec );
  else
-  fprintf(outfile,"SpouseSocSec#Sep: %s\n", socsec );
- free( socsec );
+  results_fprintf(outfile,"SpouseSocSec#Sep: %s\n", socsec );
  writeout_line = 1;
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Town:" );
- fprintf(outfile,"State: OH\n");
+ results_fprintf(outfile,"State: OH\n");
  GetTextLineF( "Zipcode:" );
 
- fprintf(outfile,"CkFYrRes: X\n");
+ results_fprintf(outfile,"CkFYrRes: X\n");
  if (status == MARRIED_FILING_JOINTLY)
-  fprintf(outfile,"CkFYrResSp: X\n");
+  results_fprintf(outfile,"CkFYrResSp: X\n");
 
  fclose(infile);
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
  Display_File( outfname );
- printf("\nResults written to file:  %s\n", outfname);
+ console_printf("\nResults written to file:  %s\n", outfname);
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_OH_IT1040, argc, argv );
+}
@@ -47,7 +47,7 @@ double pos( double x )
 }
 
 
-int main( int argc, char *argv[] )
+int taxsolve_PA_40( int argc, char *argv[] )
 {
  int i, j, k, status=0;
  char word[2500], *infname=0, outfname[2500];
@@ -56,33 +56,39 @@ int main( int argc, char *argv[] )
  char *Your1stName=0, *YourLastName=0, *Spouse1stName=0, *SpouseLastName, *YourNames;
 
  /* Decode any command-line arguments. */
- printf("PA40 - 2021 - v%3.1f\n", thisversion);
+ console_printf("PA40 - 2021 - v%3.1f\n", thisversion);
  i = 1;  k=1;
  while (i < argc)
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(argv[i],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(argv[i],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[i]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) L[i] = 0.0;
@@ -96,7 +102,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  /* get_parameter(infile, kind, x, emssg ) */
  get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/sep, Widow(er) */
@@ -107,38 +113,38 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
    exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
- fprintf(outfile," Check_R_PennResident X\n");
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile," Check_R_PennResident X\n");
 
  GetLineF( "L1a", &oneA );	/* Gross compensation. */
 
  GetLineF( "L1b", &oneB );	/* Unreimbursed employee business expenses. */
 
  L[1] = oneA - oneB;
- fprintf(outfile,"L1c = %2.2f\n", L[1] );		/* Net compensation. */
+ results_fprintf(outfile,"L1c = %2.2f\n", L[1] );		/* Net compensation. */
  
  GetLineF( "L2", &L[2] );	/* Interest Income. */
 
  GetLineF( "L3", &L[3] );	/* Dividend Income. */
 
  GetLine( "L4", &L[4] );	/* Income or loss for business operations. */
- fprintf(outfile,"L4 = %6.2f\n", absolutev( L[4] ) );
+ results_fprintf(outfile,"L4 = %6.2f\n", absolutev( L[4] ) );
  if (L[4] < 0.0)
-  fprintf(outfile," Check_4Loss X\n");
+  results_fprintf(outfile," Check_4Loss X\n");
 
  GetLine( "L5", &L[5] );	/* Net gain or loss from disposition of property. */
- fprintf(outfile,"L5 = %6.2f\n", absolutev( L[5] ) );
+ results_fprintf(outfile,"L5 = %6.2f\n", absolutev( L[5] ) );
  if (L[5] < 0.0)
-  fprintf(outfile," Check_5Loss X\n");
+  results_fprintf(outfile," Check_5Loss X\n");
 
  GetLine( "L6", &L[6] );	/* Net gain or loss rents, royalties, patents, or copyrights. */
- fprintf(outfile,"L6 = %6.2f\n", absolutev( L[6] ) );
+ results_fprintf(outfile,"L6 = %6.2f\n", absolutev( L[6] ) );
  if (L[6] < 0.0)
-  fprintf(outfile," Check_6Loss X\n");
+  results_fprintf(outfile," Check_6Loss X\n");
 
  GetLineF( "L7", &L[7] );	/* Estate or Trust Income. */
 
@@ -193,7 +199,7 @@ int main( int argc, char *argv[] )
    if (L[28] > 0.0)
     {
      showline_wmsg( 28, "Total Payment Due" );
-     fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[28] / (L[12] + L[25] + 1e-9) );
+     results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[28] / (L[12] + L[25] + 1e-9) );
     }
   }
  else
@@ -206,7 +212,7 @@ int main( int argc, char *argv[] )
    showline_wmsg(30,"REFUND");
   }
  
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
  do_all_caps = 1;
  Your1stName = GetTextLineF( "Your1stName:" );
  GetTextLineF( "MidInitial:" );
@@ -218,7 +224,7 @@ int main( int argc, char *argv[] )
  GetTextLineF( "SpouseSocSec#:" );
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Town:" );
- fprintf(outfile,"State: PA\n");
+ results_fprintf(outfile,"State: PA\n");
  GetTextLineF( "Zipcode:" );
  GetTextLineF( "Phone:" );
  GetTextLineF( "SchoolCode:" );
@@ -229,7 +235,7 @@ int main( int argc, char *argv[] )
   {
    if (status == MARRIED_FILING_JOINTLY)
     {
-     YourNames = (char *)malloc( strlen(YourLastName) + strlen( Your1stName ) + 
+     YourNames = (char *)return_alloc( strlen(YourLastName) + strlen( Your1stName ) + 
 				  strlen( SpouseLastName ) + strlen( Spouse1stName ) + 20 );
      strcpy( YourNames, Your1stName );
      if (strcmp( YourLastName, SpouseLastName ) == 0)
@@ -251,17 +257,23 @@ int main( int argc, char *argv[] )
     }
    else
     {
-     YourNames = (char *)malloc( strlen(YourLastName) + strlen( Your1stName ) + 10 );
+     YourNames = (char *)return_alloc( strlen(YourLastName) + strlen( Your1stName ) + 10 );
      strcpy( YourNames, Your1stName );
      strcat( YourNames, ", " );
      strcat( YourNames, YourLastName );
     }
-   fprintf(outfile,"YourNames: %s\n", YourNames );
+   results_fprintf(outfile,"YourNames: %s\n", YourNames );
   }
  fclose(infile);
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_PA_40, argc, argv );
+}
@@ -37,7 +37,69 @@ float thisversion=19.01;
 #include <strings.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+#include "taxsolve_tax_tables_2021.h"
+
+/* The sub-forms whose results flow into Schedules 1 and 2, compiled-in to be	*/
+/* computed in-process.  (See Integrated Sub-Forms, below.)  Each one's version	*/
+/* and globals are renamed here, so they stay apart from the 1040's own.		*/
+#define NO_MAIN
+#define thisversion	sched_c_version
+#define L32	sched_c_L32
+#include "taxsolve_US_1040_Sched_C_2021.c"
+#undef thisversion
+#undef L32
+#define thisversion	sched_se_version
+#define L4a	sched_se_L4a
+#define L4c	sched_se_L4c
+#define L5a	sched_se_L5a
+#define L5b	sched_se_L5b
+#define L8a	sched_se_L8a
+#define L8b	sched_se_L8b
+#define L8c	sched_se_L8c
+#define L8d	sched_se_L8d
+#include "taxsolve_US_1040_Sched_SE_2021.c"
+#undef thisversion
+#undef L4a
+#undef L4c
+#undef L5a
+#undef L5b
+#undef L8a
+#undef L8b
+#undef L8c
+#undef L8d
+#define thisversion	f8889_version
+#define L17b	f8889_L17b
+#include "taxsolve_HSA_f8889.c"
+#undef thisversion
+#undef L17b
+#define thisversion	f8606_version
+#define L15a	f8606_L15a
+#define L15b	f8606_L15b
+#define L15c	f8606_L15c
+#define L25a	f8606_L25a
+#define L25b	f8606_L25b
+#define L25c	f8606_L25c
+#include "taxsolve_f8606.c"
+#undef thisversion
+#undef L15a
+#undef L15b
+#undef L15c
+#undef L25a
+#undef L25b
+#undef L25c
+#define thisversion	f8959_version
+#define status	f8959_status
+#include "taxsolve_f8959_2021.c"
+#undef thisversion
+#undef status
+#define thisversion	f8960_version
+#include "taxsolve_f8960_2021.c"
+#undef thisversion
+#undef NO_MAIN
 
 #define CAP_GAIN_ADJUSTMENT_CODES  "BTNHDQXRWLESCMOZY"   	/* Form 8949 Instructions */
 #define MAXADJERRCNT 25     /* Max number of adj_code errors to print to terminal */ 
@@ -50,106 +112,73 @@ float thisversion=19.01;
 #define Yes 1
 #define No  0
 
-double SchedA[MAX_LINES], SchedD[MAX_LINES], amtws[MAX_LINES];
-double Sched1[MAX_LINES], Sched2[MAX_LINES], Sched3[MAX_LINES];
-double Sched3_13a=0.0, Sched3_13b=0.0, Sched3_13c=0.0, Sched3_13d=0.0, Sched3_13e=0.0,
+THREAD_LOCAL double SchedA[MAX_LINES], SchedD[MAX_LINES], amtws[MAX_LINES];
+THREAD_LOCAL double Sched1[MAX_LINES], Sched2[MAX_LINES], Sched3[MAX_LINES];
+THREAD_LOCAL double Sched3_13a=0.0, Sched3_13b=0.0, Sched3_13c=0.0, Sched3_13d=0.0, Sched3_13e=0.0,
 	Sched3_13f=0.0, Sched3_13g=0.0, Sched3_13h=0.0, Sched3_13z=0.0;
-double L2a=0.0;			/* Tax-exempt interest (only for SocSec calculations). */
-double L3a=0.0;			/* Qualified dividends. */
-double L4a=0.0;			/* IRA distributions */
-double L5a=0.0;			/* Pensions, and annuities. */
-double L6a=0.0;			/* Social security benefits. */
-double L12a=0.0, L12b=0.0;
-double L25a=0.0, L25b=0.0, L25c=0.0;
-double L27a=0.0, L27b=0.0, L27c=0.0;
-double S4_60b=0.0;		/* First-time homebuyer credit repayment. Form 5405. */
-double qcgws[MAX_LINES];	/* Support for AMT calculation. (qual.div+cap.gain wrksht vals.)*/
-double amtws2c=0.0;		/* Investment interest expense (difference between regular tax and AMT) - AMT entry */
-double amtws2g=0.0;		/* Specified private activity bond interest exempt from regular tax - AMT entry */
-int Do_SchedD=No, Do_QDCGTW=No, Do_SDTW=No;
-int status, under65=Yes, over65=No, dependent=No, force_print_all_pdf_forms=0;
-int ForceItemize=0;
-double localtax[10], loctaxlimit, homemort[10];
-double  collectibles_gains=0.0, ws_sched_D[MAX_LINES];
-
-char adj_code_err[MAXADJERRCNT][1024];
-int adjerrcnt=0;
-
-			/* Following values taken from 1040-Instructions pg 110. */	/* Updated for 2021. */
-double brkpt[4][9]={
-		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 523600.0, 9e19 },  /* Single */
-		{ 0.0,  19900.0,  81050.0, 172750.0, 329850.0, 418850.0, 628300.0, 9e19 },  /* Married, filing jointly. */
-		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 314150.0, 9e19 },  /* Married, filing separate. */
-		{ 0.0,  14200.0,  54200.0,  86350.0, 164900.0, 209400.0, 523600.0, 9e19 },  /* Head of Household. */
-		     };
-  double txrt[4][9] ={
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Single */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing jointly. */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing separate. */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Head of Household. */
-		     };
-
-
-double TaxRateFormula( double x, int status )  /* Returns tax due. */
+THREAD_LOCAL double L2a=0.0;			/* Tax-exempt interest (only for SocSec calculations). */
+THREAD_LOCAL double L3a=0.0;			/* Qualified dividends. */
+THREAD_LOCAL double L4a=0.0;			/* IRA distributions */
+THREAD_LOCAL double L5a=0.0;			/* Pensions, and annuities. */
+THREAD_LOCAL double L6a=0.0;			/* Social security benefits. */
+THREAD_LOCAL double L12a=0.0, L12b=0.0;
+THREAD_LOCAL double L25a=0.0, L25b=0.0, L25c=0.0;
+THREAD_LOCAL double L27a=0.0, L27b=0.0, L27c=0.0;
+THREAD_LOCAL double S4_60b=0.0;		/* First-time homebuyer credit repayment. Form 5405. */
+THREAD_LOCAL double qcgws[MAX_LINES];	/* Support for AMT calculation. (qual.div+cap.gain wrksht vals.)*/
+THREAD_LOCAL double amtws2c=0.0;		/* Investment interest expense (difference between regular tax and AMT) - AMT entry */
+THREAD_LOCAL double amtws2g=0.0;		/* Specified private activity bond interest exempt from regular tax - AMT entry */
+THREAD_LOCAL int Do_SchedD=No, Do_QDCGTW=No, Do_SDTW=No;
+THREAD_LOCAL int status, under65=Yes, over65=No, dependent=No, force_print_all_pdf_forms=0;
+THREAD_LOCAL int ForceItemize=0;
+THREAD_LOCAL double localtax[10], loctaxlimit, homemort[10];
+THREAD_LOCAL double  collectibles_gains=0.0, ws_sched_D[MAX_LINES];
+
+THREAD_LOCAL char adj_code_err[MAXADJERRCNT][1024];
+THREAD_LOCAL int adjerrcnt=0;
+
+
+double TaxRateFormula( double x, int status )  /* Returns tax due.  Computed in exact cents. */
 {		
-  double sum=0.0;
-  int   bracket=0;
   if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
-  status = status - 1;  /* Arrays start at zero; not one. */
-  while (brkpt[status][bracket+1] < x)
-   {
-    sum = sum + (brkpt[status][bracket+1] - brkpt[status][bracket]) * txrt[status][bracket];
-    bracket = bracket + 1;
-   }
-  return (x - brkpt[status][bracket]) * txrt[status][bracket] + sum;
+  return scheduled_tax( &(fed_tax_schedules[status-1]), x, TAX_CENTS, 0 );
 }
 
 
 void Report_bracket_info( double income, double addedtx, int status )  
 {
-  double tx;
-  int  bracket=0;
-  tx = TaxRateFormula( income, status );  
+  double tx, rate;
   if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
-  status = status - 1;  /* Arrays start at zero; not one. */
-  while (brkpt[status][bracket+1] < income) bracket++;
-  printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
-          100.0 * txrt[status][bracket], 100.0 * (tx + addedtx) / (income + 1e-9) );
-  fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
-          100.0 * txrt[status][bracket], 100.0 * (tx + addedtx) / (income + 1e-9) );
+  tx = scheduled_tax( &(fed_tax_schedules[status-1]), income, TAX_CENTS, &rate );
+  console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
+          100.0 * rate, 100.0 * (tx + addedtx) / (income + 1e-9) );
+  results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your income.\n",
+          100.0 * rate, 100.0 * (tx + addedtx) / (income + 1e-9) );
 }
 
 
 double TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
 {
- double x, dx, tx;
- int k;
- if (income < 100000.0)	/* Quantize to match tax-table exactly. */
-  {
-   if (income < 25.0) x = 5.0; else
-   if (income < 3000.0) x = 25.0; else x = 50.0;
-   dx = 0.5 * x;
-   k = income / x;
-   x = x * (double)k + dx;
-   tx = (int)(TaxRateFormula( x, status ) + 0.5);
-  }
- else
-  tx = TaxRateFormula( income, status );
- return tx;
+ int row;
+ row = fed_tax_table_row( income );
+ if (row < 0)
+  return TaxRateFormula( income, status );
+ if (status == WIDOW) status = MARRIED_FILING_JOINTLY;
+ return fed_tax_table[row][status-1];
 }
 
 
 
 void showschedA( int linenum )
-{ if (SchedA[linenum] > 0.0) fprintf(outfile," A%d = %6.2f\n", linenum, SchedA[linenum] ); }
+{ if (SchedA[linenum] > 0.0) showline_wrksht( 'A', linenum, SchedA ); }
 
 void showschedA_wMsg( int linenum, char *msg )
-{ if (SchedA[linenum] > 0.0) fprintf(outfile," A%d = %6.2f	%s\n", linenum, SchedA[linenum], msg ); }
+{ char amt[AMOUNT_BUFSZ];  if (SchedA[linenum] > 0.0) results_fprintf(outfile," A%d = %s	%s\n", linenum, format_amount( SchedA[linenum], amt ), msg ); }
 
 void print2( char *msg )
 {
- printf("%s", msg );
- fprintf(outfile, "%s", msg );
+ console_printf("%s", msg );
+ results_fprintf(outfile, "%s", msg );
 }
 
 
@@ -202,9 +231,9 @@ void capgains_qualdividends_worksheets( int status )			/* Updated for 2021. */
  qcgws[25] = smallerof( qcgws[23], qcgws[24] );
  for (j = 1; j <= 25; j++)
   {
-   printf("	Qual. Div & Gains WorkSheet %d:  %8.2f\n", j, qcgws[j] );
-   if (j == 3) { if (Do_SchedD) fprintf(outfile,"\t\t3: Check Yes.\n"); else fprintf(outfile,"\t\t3: Check No.\n"); }
-   fprintf(outfile,"	Qual. Div & Gains WorkSheet %d:  %8.2f\n", j, qcgws[j] );
+   console_printf("	Qual. Div & Gains WorkSheet %d:  %8.2f\n", j, qcgws[j] );
+   if (j == 3) { if (Do_SchedD) results_fprintf(outfile,"\t\t3: Check Yes.\n"); else results_fprintf(outfile,"\t\t3: Check No.\n"); }
+   results_fprintf(outfile,"	Qual. Div & Gains WorkSheet %d:  %8.2f\n", j, qcgws[j] );
   }
  L[16] = Conditional_Round( qcgws[25] );
 }
@@ -227,8 +256,8 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
  double amtws2a=0.0, amtws2b=0.0, amtws2e=0.0;
  int j, file_amt=1;
 
- printf("Review AMT form6251 routine for your situation.\n");
- fprintf(outfile,"Review AMT form6251 routine for your situation.\n");
+ console_printf("Review AMT form6251 routine for your situation.\n");
+ results_fprintf(outfile,"Review AMT form6251 routine for your situation.\n");
 
  /* Part I - Alternative Minimum Taxable Income (AMTI) */
  if (L[15] > 0.0)  
@@ -300,7 +329,7 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
 	offsetA = 1999.0;
         amtexmption = 57300.0;
 	break;
-     default:  printf("Status %d not handled.\n", status);  exit(1); 
+     default:  console_printf("Status %d not handled.\n", status);  taxsolve_exit(1); 
   }
 
  if (amtws[4] > thresholdA)
@@ -369,7 +398,7 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
 	   case MARRIED_FILING_SEPARAT:	      amtws[25] = 250800.0;  break;
 	   case MARRIED_FILING_JOINTLY: case WIDOW:  amtws[25] = 501600.0;  break;
 	   case HEAD_OF_HOUSEHOLD: 		      amtws[25] = 473750.0;  break;
-	   default:  printf("Status %d not handled.\n", status);  exit(1); 
+	   default:  console_printf("Status %d not handled.\n", status);  taxsolve_exit(1); 
 	}
        amtws[26] = amtws[21];
        if (Do_QDCGTW)
@@ -415,23 +444,23 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
  amtws[10] = L[16] + Sched2[2] - Sched3[1];
  if (amtws[6] > 0.0) 
   amtws[11] = NotLessThanZero( amtws[9] - amtws[10] );
- printf("	AMTws[11] = Abs( %6.2f - %6.2f ) = Abs( %6.2f )\n", amtws[9], amtws[10], amtws[9] - amtws[10] );
+ console_printf("	AMTws[11] = Abs( %6.2f - %6.2f ) = Abs( %6.2f )\n", amtws[9], amtws[10], amtws[9] - amtws[10] );
  // Sched2[1] = amtws[11];	/* Redundant.  Is assigned by return value below. */
 
  /* These rules are stated on Form-6251 Instructions page-1. */
  if (amtws[7] > amtws[10])
   {
    file_amt = Yes;
-   fprintf(outfile,"You MUST file AMT form 6251. (%g > %g)\n", amtws[7], amtws[10] );
+   results_fprintf(outfile,"You MUST file AMT form 6251. (%g > %g)\n", amtws[7], amtws[10] );
   }
  else
   {
    if (amtws2c + amtws2e + amtws2g + amtws[3] < 0.0)
     {
      file_amt = Yes;
-     fprintf(outfile,"You may need to file AMT form 6251.  (sum(AMTws2c : AMTws3) = %g < 0.\n", 
+     results_fprintf(outfile,"You may need to file AMT form 6251.  (sum(AMTws2c : AMTws3) = %g < 0.\n", 
 			amtws2c + amtws2e + amtws2g + amtws[3] );
-     fprintf(outfile," (See \"Who Must File\" on page-1 of Instructions for Form-6251.)\n");
+     results_fprintf(outfile," (See \"Who Must File\" on page-1 of Instructions for Form-6251.)\n");
     }
    else
     file_amt = No;
@@ -439,7 +468,7 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
  if (force_print_all_pdf_forms) 
   file_amt = 1;
  if (file_amt)
-  fprintf(outfile,"PDFpage: 16 16\n");	/* Optional PDF Page. */
+  results_fprintf(outfile,"PDFpage: 16 16\n");	/* Optional PDF Page. */
  for (j=0; j<100; j++) 
   {
    if (j == 2)
@@ -458,17 +487,17 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
     }
    if ((j == 11) || (amtws[j] != 0.0))
     {
-     printf(" 		AMT Form 6251 L%d = %8.2f\n", j, amtws[j] );
-     fprintf(outfile," 		AMT_Form_6251_L%d = %8.2f\n", j, amtws[j] );
+     console_printf(" 		AMT Form 6251 L%d = %8.2f\n", j, amtws[j] );
+     results_fprintf(outfile," 		AMT_Form_6251_L%d = %8.2f\n", j, amtws[j] );
     }
    if (file_amt && (j == 11))
-    fprintf(outfile,"EndPDFpage.\nPDFpage: 17 17\n");
+    results_fprintf(outfile,"EndPDFpage.\nPDFpage: 17 17\n");
   }
  if (file_amt)
-  fprintf(outfile,"EndPDFpage.\n");
- fprintf(outfile,"	AMTws[11] = OnlyIfMoreThanZero( %6.2f - %6.2f ) = %6.2f\n", amtws[9], amtws[10], amtws[11] );
- fprintf(outfile,"Your Alternative Minimum Tax = %8.2f\n", amtws[11] ); 
- printf("Your Alternative Minimum Tax = %8.2f\n", amtws[11] ); 
+  results_fprintf(outfile,"EndPDFpage.\n");
+ results_fprintf(outfile,"	AMTws[11] = OnlyIfMoreThanZero( %6.2f - %6.2f ) = %6.2f\n", amtws[9], amtws[10], amtws[11] );
+ results_fprintf(outfile,"Your Alternative Minimum Tax = %8.2f\n", amtws[11] ); 
+ console_printf("Your Alternative Minimum Tax = %8.2f\n", amtws[11] ); 
  return amtws[11];
 }
 
@@ -476,7 +505,7 @@ double form6251_AlternativeMinimumTax( int itemized )						/* Updated for 2021.
 
 
 
-struct FedReturnData
+THREAD_LOCAL struct FedReturnData
  {
   double fedline[MAX_LINES], schedD[MAX_LINES];
   int Exception, Itemized;
@@ -503,52 +532,61 @@ void convert_slashes( char *fname )
 
 void ImportFederalReturnData( char *fedlogfile, struct FedReturnData *fed_data )
 {
- FILE *infile;
- char fline[1000], word[1000];
- int linenum;
+ struct fed_snapshot snap;
+ struct fed_record *r;
+ char fline[1000], word[1000], *label;
+ int linenum, k;
 
  for (linenum=0; linenum<MAX_LINES; linenum++) 
   { fed_data->fedline[linenum] = 0.0;  fed_data->schedD[linenum] = 0.0; }
  convert_slashes( fedlogfile );
- infile = fopen(fedlogfile, "r");
- if (infile==0)
+ if (!load_fed_snapshot( fedlogfile, &snap ))
   {
-   printf("Error: Could not open federal return '%s'\n", fedlogfile);
-   fprintf(outfile,"Error: Could not open federal return '%s'\n", fedlogfile);
-   exit(1);
+   console_printf("Error: Could not open federal return '%s'\n", fedlogfile);
+   results_fprintf(outfile,"Error: Could not open federal return '%s'\n", fedlogfile);
+   taxsolve_exit(1);
   }
- printf("Importing Last Year's Federal Return Data from file '%s'\n", fedlogfile );
+ console_printf("Importing Last Year's Federal Return Data from file '%s'\n", fedlogfile );
  fed_data->Itemized = 1; /* Set initial default values. */
- read_line(infile,fline);  linenum = 0;
- while (!feof(infile))
+ linenum = 0;
+ for (k=0; k < snap.nrecords; k++)
   {
-   if (strstr(fline,"Use standard deduction.")!=0) fed_data->Itemized = 0;
-   next_word(fline, word, " \t=");
-   if ((strstr(word,"L")==word) && (strstr(fline," = ")!=0))
+   r = &(snap.records[k]);
+   label = fed_label( &snap, r );
+   if (r->flags & FED_STD_DEDUCTION) fed_data->Itemized = 0;
+   if ((label[0] == 'L') && (r->flags & FED_HAS_EQUALS))
     {
-     if (sscanf(&word[1],"%d",&linenum)!=1) printf("Error: Reading fed line number '%s%s'\n",word,fline);
-     next_word(fline, word, " \t=");	remove_certain_chars( word, "," );
-     if (sscanf(word,"%lf", &fed_data->fedline[linenum])!=1)
-	printf("Error: Reading fed line %d '%s%s'\n",linenum,word,fline);
-     if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
+     if (r->flags & FED_HAS_LINE)
+      linenum = r->line;
+     else
+      console_printf("Error: Reading fed line number '%s%s'\n",label,snap.text + r->rest);
+     if (r->flags & FED_HAS_VALUE)
+      fed_data->fedline[linenum] = r->value;
+     else
+	console_printf("Error: Reading fed line %d '%s'\n",linenum,snap.text + r->rest);
+     if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->fedline[linenum]);
     }
-   if ((strstr(word,"D") == word) && (strstr(fline," = ") != 0)) 
+   if ((label[0] == 'D') && (r->flags & FED_HAS_EQUALS)) 
     {
-     if (sscanf(&word[1],"%d",&linenum)!=1) printf("Error: Reading fed line number '%s%s'\n",word,fline);
-     next_word(fline, word, " \t=");	remove_certain_chars( word, "," );
-     if (sscanf(word,"%lf", &fed_data->schedD[linenum]) != 1) 
+     if (r->flags & FED_HAS_LINE)
+      linenum = r->line;
+     else
+      console_printf("Error: Reading fed line number '%s%s'\n",label,snap.text + r->rest);
+     if (r->flags & FED_HAS_VALUE)
+      fed_data->schedD[linenum] = r->value;
+     else
       {
+       next_word( fed_rest( &snap, r, fline, sizeof(fline) ), word, " \t=" );
        if (strcasecmp(word,"yes") == 0) fed_data->schedD[linenum] = 1;
        else
        if (strcasecmp(word,"no") == 0) fed_data->schedD[linenum] = 0;
        else
-	printf("Error: Reading fed schedD %d '%s%s'\n",linenum,word,fline);
+	console_printf("Error: Reading fed schedD %d '%s%s'\n",linenum,word,fline);
       }
-     if (verbose) printf("FedLin[%d] = %2.2f\n", linenum, fed_data->schedD[linenum]);
+     if (verbose) console_printf("FedLin[%d] = %2.2f\n", linenum, fed_data->schedD[linenum]);
     }
-   read_line(infile,fline);
   }
- fclose(infile);
+ release_fed_snapshot( &snap );
 }
 
 
@@ -563,14 +601,14 @@ void CapitalLossCarryOverWorksheet( char *fedlogfile, struct FedReturnData *Last
  ImportFederalReturnData( fedlogfile, LastYearsReturn );
  if (LastYearsReturn->schedD[21] == 0.0) 
   {
-   printf(" No carry-over loss.\n");
-   fprintf(outfile," No carry-over loss.\n");
+   console_printf(" No carry-over loss.\n");
+   results_fprintf(outfile," No carry-over loss.\n");
    return;  /* Use this worksheet only if last year's D[21] was a loss. */
   }
  if ((absolutev(LastYearsReturn->schedD[21]) >= absolutev(LastYearsReturn->schedD[16])) && (LastYearsReturn->fedline[15] >= 0.0))
   {
-   printf(" No carry-over loss.\n");
-   fprintf(outfile," No carry-over loss.\n");
+   console_printf(" No carry-over loss.\n");
+   results_fprintf(outfile," No carry-over loss.\n");
    return;
   }
 
@@ -581,8 +619,8 @@ void CapitalLossCarryOverWorksheet( char *fedlogfile, struct FedReturnData *Last
  ws[4] = smallerof( ws[2], ws[3] );
  for (k=1; k<=4; k++)
   {
-   printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
-   fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+   console_printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+   results_fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
   }
  if (LastYearsReturn->schedD[7] < 0.0)
   { /*lines5-8*/
@@ -594,12 +632,12 @@ void CapitalLossCarryOverWorksheet( char *fedlogfile, struct FedReturnData *Last
      SchedD[6] = ws[8];
     for (k=5; k<=8; k++)
      {
-	printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
-	fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+	console_printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+	results_fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
      }
   } /*lines5-8*/
  else
-  printf("\t(Skip CarryOverWs lines 5-8.)\n");
+  console_printf("\t(Skip CarryOverWs lines 5-8.)\n");
 
  if (LastYearsReturn->schedD[15] < 0.0)
   { /*lines9-13*/
@@ -612,144 +650,250 @@ void CapitalLossCarryOverWorksheet( char *fedlogfile, struct FedReturnData *Last
      SchedD[14] = ws[13];
     for (k=9; k<=13; k++)
      {
-	printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
-	fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+	console_printf("\tCarryOverWs%d = %2.2f\n", k, ws[k] );
+	results_fprintf(outfile,"\tCarryOverWs%d = %2.2f\n", k, ws[k] );
      }
   } /*lines9-13*/
  else
-  printf("\t(Skip CarryOverWorkSheet lines 9-13.)\n");
+  console_printf("\t(Skip CarryOverWorkSheet lines 9-13.)\n");
 }
 
 
 
-struct capgain_record
+/*------------------------------------------------------------------------------*/
+/* Lot Store - The capital-gain lots of one Form 8949 part, kept as parallel	*/
+/*  arrays (one per field) that grow by doubling, so appending a lot costs	*/
+/*  O(1) however many there are.  Descriptions, dates, and codes are interned,	*/
+/*  since large trading accounts repeat them heavily.  All of it lives in the	*/
+/*  return_pool.  There is a short-term and a long-term store for each of the	*/
+/*  three sections (check-boxes A/D, B/E, and C/F), since an imported 1099-B	*/
+/*  fills all of them in one pass.						*/
+/*------------------------------------------------------------------------------*/
+THREAD_LOCAL struct lot_store
  {
-  char *comment, *buy_date, *sell_date, *adj_code;
-  double buy_amnt, sell_amnt, adj_amnt;
-  struct capgain_record *nxt;
- } *short_trades=0, *long_trades=0;
-
-double total_sales, total_costs=0.0, total_adjs;
-
-
-void new_capgain( struct capgain_record **list, char *comment, double buy_amnt, 
-		char *buy_date, double sell_amnt, char *sell_date, char *adj_code, double adj_amnt )
-{ /* Add a new entry to a list. */
-  struct capgain_record *new_item, *prev;
-
-  new_item = (struct capgain_record *)malloc( sizeof(struct capgain_record) );
-  new_item->comment = strdup( comment );	/* Make new list item and fill-in its fields. */
-  if (strlen( new_item->comment ) > 31)
-   new_item->comment[31] = '\0'; /* Limit comment length to avoid over-running column boundary. */
-  new_item->buy_amnt = buy_amnt;
-  new_item->buy_date = strdup( buy_date );
-  new_item->sell_amnt = sell_amnt;
-  new_item->sell_date = strdup( sell_date );
-  new_item->adj_code = strdup( adj_code );
-  new_item->adj_amnt = adj_amnt;
-  new_item->nxt = 0;
-  prev = *list;		/* Insert onto end of list. */
-  if (prev == 0)
-   *list = new_item;
-  else
+  int n, size;
+  char **comment, **buy_date, **sell_date, **adj_code;
+  double *buy_amnt, *sell_amnt, *adj_amnt;
+  int *buy_day, *sell_day;	/* Day-numbers of the dates, or 0 when not known (as for "various"). */
+ } short_trades[3], long_trades[3];	/* Indexed by section:  0 = A/D, 1 = B/E, 2 = C/F. */
+
+enum capgain_term { none, short_term, long_term };
+
+THREAD_LOCAL struct string_table lot_strings;	/* (Its pool is set to the return_pool on first use.) */
+
+THREAD_LOCAL double total_sales, total_costs=0.0, total_adjs;
+
+
+/*------------------------------------------------------------------------------*/
+/* Summary Reporting - With the "-8949_summary" option, lots whose basis was	*/
+/*  reported to the IRS (CapGains-A/D) and which have no adjustment are not	*/
+/*  stored.  Their amounts are summed as they are read, and go directly onto	*/
+/*  Schedule D lines 1a and 8a, as the Form 8949 instructions allow.  Memory	*/
+/*  and output then stay constant however many such lots there are.  With	*/
+/*  "-8949_statement", each summarized lot is also written, as it is read, to	*/
+/*  a separate statement file.  Lots with adjustments still go on Form 8949.	*/
+/*------------------------------------------------------------------------------*/
+THREAD_LOCAL int summarize_8949=0, itemize_8949_statement=0;
+THREAD_LOCAL FILE *statement_8949=0;
+THREAD_LOCAL int detect_wash_sales=0;	/* (With it, summarizing waits until the adjustments are known.  See below.) */
+
+THREAD_LOCAL struct lot_summary
+ {
+  int n;
+  money sales, costs;
+ } short_summary, long_summary;
+
+
+void print_capgain_row( FILE *outfile, char *comment, char *buy_date, char *sell_date, double sell_amnt, 
+			double buy_amnt, char *adj_code, double adj_amnt )
+{ /* One lot, in the human-readable Form 8949 layout. */
+ char word[4096];
+
+ strcpy( word, comment );
+ if (strlen( word ) > 27) word[30] = '\0';
+ if ((strlen(word) > 0) && (word[ strlen(word) - 1 ] == '}')) word[ strlen(word) - 1 ] = '\0';
+ while (strlen( word ) < 27) strcat( word, " " ); 	/* Fields become formatted right-justified. */
+ results_fprintf(outfile," %s %10s %10s %14.2f %14.2f %10s %14.2f %14.2f\n", word, buy_date, sell_date, sell_amnt, 
+	absolutev(buy_amnt), adj_code, adj_amnt, sell_amnt + buy_amnt + adj_amnt );
+}
+
+
+void summarize_capgain( struct lot_summary *summary, char *term, char *comment, double buy_amnt, 
+			char *buy_date, double sell_amnt, char *sell_date )
+{ /* Add a lot to the line 1a or 8a totals, without keeping it. */
+  char descr[32];
+
+  summary->n++;
+  summary->sales = summary->sales + to_money( sell_amnt );
+  summary->costs = summary->costs + to_money( buy_amnt );
+  if (statement_8949 != 0)
    {
-    while (prev->nxt != 0) prev = prev->nxt;
-    prev->nxt = new_item;
+    strncpy( descr, comment, 31 );
+    descr[31] = '\0';
+    results_fprintf(statement_8949,"%s", term );
+    print_capgain_row( statement_8949, descr, buy_date, sell_date, sell_amnt, buy_amnt, "~", 0.0 );
    }
 }
 
 
-void print_capgain_list( struct capgain_record *list, int section, char *message, char *pdfmsg )
+void open_8949_statement( char *outfname )
+{ /* The statement is named after the output file:  xxx_out.txt -> xxx_8949_statement.txt */
+ char fname[4096];
+ int j;
+
+ strcpy( fname, outfname );
+ j = strlen( fname ) - strlen( "_out.txt" );
+ if ((j >= 0) && (strcmp( &(fname[j]), "_out.txt" ) == 0))
+  fname[j] = '\0';
+ strcat( fname, "_8949_statement.txt" );
+ statement_8949 = taxsolve_fopen( fname, "w" );
+ if (statement_8949 == 0)
+  {
+   console_printf("ERROR: Form 8949 statement file '%s' could not be opened.\n", fname );
+   results_fprintf(outfile,"ERROR: Form 8949 statement file '%s' could not be opened.\n", fname );
+   taxsolve_exit(1);
+  }
+ results_fprintf(statement_8949,"Form 8949 Statement - Transactions reported in total on Schedule D lines 1a and 8a.\n");
+ results_fprintf(statement_8949,"(Basis reported to IRS, no adjustments.)\n\n");
+ results_fprintf(statement_8949,"Term (a Description)         (b Buy Date) (c Date Sold) (d Sold Price)   (e Cost)   (f Code)        (g Adj)       (h Gain)\n");
+ results_fprintf(statement_8949,"----------------------------------------------------------------------------------------------------------------------------\n");
+ console_printf("Writing Form 8949 statement to file:  %s\n", fname );
+}
+
+
+void close_8949_statement()
+{
+ results_fprintf(statement_8949,"----------------------------------------------------------------------------------------------------------------------------\n");
+ results_fprintf(statement_8949," Short-Term Totals (%d lots):                           %14.2f %14.2f                           %14.2f\n", 
+	short_summary.n, money_to_dollars( short_summary.sales ), money_to_dollars( -short_summary.costs ), 
+	money_to_dollars( short_summary.sales + short_summary.costs ) );
+ results_fprintf(statement_8949," Long-Term Totals  (%d lots):                           %14.2f %14.2f                           %14.2f\n", 
+	long_summary.n, money_to_dollars( long_summary.sales ), money_to_dollars( -long_summary.costs ), 
+	money_to_dollars( long_summary.sales + long_summary.costs ) );
+ fclose( statement_8949 );
+ statement_8949 = 0;
+}
+
+
+#define GROW_LOT_FIELD( lots, field, newsize ) \
+ { void *pt = return_alloc( (newsize) * sizeof(*(lots)->field) ); \
+   if ((lots)->n > 0) memcpy( pt, (lots)->field, (lots)->n * sizeof(*(lots)->field) ); \
+   (lots)->field = pt; }
+
+void grow_lot_store( struct lot_store *lots )
+{ /* (The old arrays stay in the return_pool, which is at most doubled by them.) */
+  int newsize = (lots->size == 0) ? 256 : 2 * lots->size;
+  GROW_LOT_FIELD( lots, comment, newsize );
+  GROW_LOT_FIELD( lots, buy_date, newsize );
+  GROW_LOT_FIELD( lots, sell_date, newsize );
+  GROW_LOT_FIELD( lots, adj_code, newsize );
+  GROW_LOT_FIELD( lots, buy_amnt, newsize );
+  GROW_LOT_FIELD( lots, sell_amnt, newsize );
+  GROW_LOT_FIELD( lots, adj_amnt, newsize );
+  GROW_LOT_FIELD( lots, buy_day, newsize );
+  GROW_LOT_FIELD( lots, sell_day, newsize );
+  lots->size = newsize;
+}
+
+
+void new_capgain( struct lot_store *lots, char *comment, double buy_amnt, char *buy_date, int buy_day,
+		double sell_amnt, char *sell_date, int sell_day, char *adj_code, double adj_amnt )
+{ /* Add a new lot to the end of the store. */
+  char descr[32];
+  int k;
+
+  if (lots->n == lots->size)
+   grow_lot_store( lots );
+  lot_strings.pool = &return_pool;
+  k = lots->n++;
+  strncpy( descr, comment, 31 );	/* Limit comment length to avoid over-running column boundary. */
+  descr[31] = '\0';
+  lots->comment[k] = intern_string( &lot_strings, descr );
+  lots->buy_amnt[k] = buy_amnt;
+  lots->buy_date[k] = intern_string( &lot_strings, buy_date );
+  lots->sell_amnt[k] = sell_amnt;
+  lots->sell_date[k] = intern_string( &lot_strings, sell_date );
+  lots->adj_code[k] = intern_string( &lot_strings, adj_code );
+  lots->adj_amnt[k] = adj_amnt;
+  lots->buy_day[k] = buy_day;
+  lots->sell_day[k] = sell_day;
+}
+
+
+void print_capgain_list( struct lot_store *lots, int section, char *message, char *pdfmsg )
 {
- struct capgain_record *item;
- char word[4096], row='a';
+ char row='a';
  char pdf_adj_code[20];
+ money sales=0, costs=0, adjs=0;
+ int k;
+
+ /* Totals are summed in exact cents, so they do not depend on the number or order of lots. */
+ for (k=0; k < lots->n; k++)
+  {
+   sales = sales + to_money( lots->sell_amnt[k] );
+   costs = costs + to_money( lots->buy_amnt[k] );
+   adjs = adjs + to_money( lots->adj_amnt[k] );
+  }
+ total_sales = money_to_dollars( sales );
+ total_costs = money_to_dollars( costs );
+ total_adjs = money_to_dollars( adjs );
 
  /* First write results in easily human-readable format. */
- total_sales = 0.0;
- total_costs = 0.0;
- total_adjs = 0.0;
- fprintf(outfile,"\n%s\n", message );
- fprintf(outfile," %d. (a Description)         (b Buy Date) (c Date Sold) (d Sold Price)   (e Cost)   (f Code)        (g Adj)       (h Gain)\n", section );
- fprintf(outfile," ------------------------------------------------------------------------------------------------------------------------\n");
- item = list;
- while (item != 0)
-  {
-   strcpy( word, item->comment );
-   if (strlen( word ) > 27) word[30] = '\0';
-   if ((strlen(word) > 0) && (word[ strlen(word) - 1 ] == '}')) word[ strlen(word) - 1 ] = '\0';
-   while (strlen( word ) < 27) strcat( word, " " ); 	/* Fields become formatted right-justified. */
-   fprintf(outfile," %s %10s %10s %14.2f %14.2f %10s %14.2f %14.2f\n", word, item->buy_date, item->sell_date, item->sell_amnt, 
-	absolutev(item->buy_amnt), item->adj_code, item->adj_amnt, item->sell_amnt + item->buy_amnt + item->adj_amnt );
-   total_sales = total_sales + item->sell_amnt;
-   total_costs = total_costs + item->buy_amnt;
-   total_adjs = total_adjs + item->adj_amnt;
-   item = item->nxt;
-  }
- fprintf(outfile," ------------------------------------------------------------------------------------------------------------------------\n");
- fprintf(outfile," %d. Totals:                                        %14.2f %14.2f            %14.2f %14.2f\n\n", 
+ results_fprintf(outfile,"\n%s\n", message );
+ results_fprintf(outfile," %d. (a Description)         (b Buy Date) (c Date Sold) (d Sold Price)   (e Cost)   (f Code)        (g Adj)       (h Gain)\n", section );
+ results_fprintf(outfile," ------------------------------------------------------------------------------------------------------------------------\n");
+ for (k=0; k < lots->n; k++)
+  print_capgain_row( outfile, lots->comment[k], lots->buy_date[k], lots->sell_date[k], lots->sell_amnt[k], 
+		     lots->buy_amnt[k], lots->adj_code[k], lots->adj_amnt[k] );
+ results_fprintf(outfile," ------------------------------------------------------------------------------------------------------------------------\n");
+ results_fprintf(outfile," %d. Totals:                                        %14.2f %14.2f            %14.2f %14.2f\n\n", 
 	section + 1, total_sales, absolutev(total_costs), total_adjs, total_sales + total_costs + total_adjs );
 
  /* Now re-list them for update by the PDF-Convertor. */
- fprintf(outfile,"PDFpage: %s\n", pdfmsg );	/* Optional PDF page. */
- item = list;
- while (item != 0)
+ results_fprintf(outfile,"PDFpage: %s\n", pdfmsg );	/* Optional PDF page. */
+ for (k=0; k < lots->n; k++)
   {
    if (row > 'n')
     { /* All form-entries filled, go to new form-page. */
-     fprintf(outfile," F8949_2d = ...\n");
-     fprintf(outfile," F8949_2e = ...\n");
-     fprintf(outfile," F8949_2h = ...\n");
-     fprintf(outfile,"EndPDFpage.\nPDFpage:  %s\n", pdfmsg );	/* Overflow page. */
+     results_fprintf(outfile," F8949_2d = ...\n");
+     results_fprintf(outfile," F8949_2e = ...\n");
+     results_fprintf(outfile," F8949_2h = ...\n");
+     results_fprintf(outfile,"EndPDFpage.\nPDFpage:  %s\n", pdfmsg );	/* Overflow page. */
      row = 'a';
     }
-   fprintf(outfile," F8949_1%ca: %s\n", row, item->comment );
-   fprintf(outfile," F8949_1%cb: %s\n", row, item->buy_date );
-   fprintf(outfile," F8949_1%cc: %s\n", row, item->sell_date );
-   fprintf(outfile," F8949_1%cd = %14.2f\n", row, item->sell_amnt );
-   fprintf(outfile," F8949_1%ce = %14.2f\n", row, absolutev(item->buy_amnt) );
-   if (strcmp(item->adj_code, "~") == 0 )  /* if match */ 
+   results_fprintf(outfile," F8949_1%ca: %s\n", row, lots->comment[k] );
+   results_fprintf(outfile," F8949_1%cb: %s\n", row, lots->buy_date[k] );
+   results_fprintf(outfile," F8949_1%cc: %s\n", row, lots->sell_date[k] );
+   results_fprintf(outfile," F8949_1%cd = %14.2f\n", row, lots->sell_amnt[k] );
+   results_fprintf(outfile," F8949_1%ce = %14.2f\n", row, absolutev(lots->buy_amnt[k]) );
+   if (strcmp(lots->adj_code[k], "~") == 0 )  /* if match */ 
     strcpy(pdf_adj_code, " ");             /* Convert "~"  to " " for PDF form */
    else
    {
-    strcpy(pdf_adj_code, item->adj_code);
+    strcpy(pdf_adj_code, lots->adj_code[k]);
    }
-   fprintf(outfile," F8949_1%cf = %3s\n", row, pdf_adj_code );
-   fprintf(outfile," F8949_1%cg = %14.2f\n", row, item->adj_amnt );
-   fprintf(outfile," F8949_1%ch = %14.2f\n", row, item->sell_amnt + item->buy_amnt + item->adj_amnt);
+   results_fprintf(outfile," F8949_1%cf = %3s\n", row, pdf_adj_code );
+   results_fprintf(outfile," F8949_1%cg = %14.2f\n", row, lots->adj_amnt[k] );
+   results_fprintf(outfile," F8949_1%ch = %14.2f\n", row, lots->sell_amnt[k] + lots->buy_amnt[k] + lots->adj_amnt[k]);
    row++;
-   item = item->nxt;
   }
- fprintf(outfile," F8949_2d = %14.2f\n", total_sales );
- fprintf(outfile," F8949_2e = %14.2f\n", absolutev(total_costs) );
- fprintf(outfile," F8949_2g = %14.2f\n", total_adjs );
- fprintf(outfile," F8949_2h = %14.2f\n", total_sales + total_costs + total_adjs );
- fprintf(outfile,"EndPDFpage.\n\n");
+ results_fprintf(outfile," F8949_2d = %14.2f\n", total_sales );
+ results_fprintf(outfile," F8949_2e = %14.2f\n", absolutev(total_costs) );
+ results_fprintf(outfile," F8949_2g = %14.2f\n", total_adjs );
+ results_fprintf(outfile," F8949_2h = %14.2f\n", total_sales + total_costs + total_adjs );
+ results_fprintf(outfile,"EndPDFpage.\n\n");
 }
 
 
-void free_capgain_list( struct capgain_record **list )
-{
- struct capgain_record *olditem;
-
- while (*list != 0)
-  {
-   olditem = *list;
-   *list = (*list)->nxt;
-   free( olditem->comment );
-   free( olditem );
-  }
+void free_capgain_list( struct lot_store *lots )
+{ /* Empty the store.  Its arrays are kept for the next part's lots, and are released with the return_pool. */
+ lots->n = 0;
 }
 
 
 int is_date1_beyond_date2 (struct date_rec date1, struct date_rec date2)
 {
- if (  (date1.year > date2.year)
-   || ((date1.year == date2.year) && (date1.month > date2.month))
-   || ((date1.year == date2.year) && (date1.month == date2.month) && (date1.day > date2.day)) )
-  return (1);   /* True - Date1 is beyond Date2 */
- else
-  return (0);   /* False */
+ return (date1.daynum > date2.daynum);	/* True (1) if Date1 is beyond Date2. */
 }
 
 void adj_code_validity_check (char *adj_code, char *errmsg )
@@ -805,40 +949,92 @@ void Display_adj_code_err()
 {
  int i, index;
  
-  printf("\n\n\n***** CAUTION:  Possible Invalid Form 8949  Adjustment Code  *****\n");
-  printf("*****  Does NOT affect processing                            *****\n\n");
-  printf("Code  Section      Description   BuyDate   DateSold\n"); 
+  console_printf("\n\n\n***** CAUTION:  Possible Invalid Form 8949  Adjustment Code  *****\n");
+  console_printf("*****  Does NOT affect processing                            *****\n\n");
+  console_printf("Code  Section      Description   BuyDate   DateSold\n"); 
   for ( i = 1; i <= adjerrcnt; i++)  /* adjerrcnt will never exceed MAXADJERRCNT */
   {
    index = i - 1;
-   printf("\n %s  \n", adj_code_err[index] );
+   console_printf("\n %s  \n", adj_code_err[index] );
   } 
  }
 
 
-void get_gain_and_losses( char *label )
+/* Long-term when sold more than one year after bought. */
+enum capgain_term holding_period_term( struct date_rec buydate, struct date_rec selldate )
+{
+ struct date_rec annivdate;
+
+ /* "annivdate" will be the date of the one year holding period relative to the Buy-date */
+ annivdate.year = buydate.year + 1;
+ annivdate.month = buydate.month;
+ annivdate.day = buydate.day;
+ if ((annivdate.month == 2) && (annivdate.day == 28) && (isleapyear(annivdate.year)))
+  annivdate.day=29;
+ else
+ if ((annivdate.month == 2) && (annivdate.day == 29) && !(isleapyear(annivdate.year)))
+  annivdate.day=28;
+ annivdate.daynum = date_daynum( annivdate.month, annivdate.day, annivdate.year );
+ if (is_date1_beyond_date2(selldate, annivdate))
+  return long_term;	/* Holding Period Test */
+ else
+  return short_term;
+}
+
+
+/* File a checked lot under its section and term, or into the Schedule D line 1a/8a totals. */
+void store_capgain( int section, enum capgain_term term_flg, char *comment, double amnt1, char *date_str1, int buy_day,
+		    double amnt2, char *date_str2, int sell_day, char *adj_code, double adj_amnt )
+{
+ if (summarize_8949 && (!detect_wash_sales) && (section == 0) && (strcmp( adj_code, "~" ) == 0) && (adj_amnt == 0.0))
+  { /* Reported in total on Schedule D line 1a or 8a. */
+   if (term_flg == long_term)
+    summarize_capgain( &long_summary, "  L ", comment, amnt1, date_str1, amnt2, date_str2 );
+   else
+    summarize_capgain( &short_summary, "  S ", comment, amnt1, date_str1, amnt2, date_str2 );
+  }
+ else
+ if (term_flg == long_term)
+  new_capgain( &(long_trades[section]), comment, amnt1, date_str1, buy_day, amnt2, date_str2, sell_day, adj_code, adj_amnt );
+ else
+  new_capgain( &(short_trades[section]), comment, amnt1, date_str1, buy_day, amnt2, date_str2, sell_day, adj_code, adj_amnt );
+}
+
+
+void get_gain_and_losses( char *label, int section )
 {
  char word[4096], date_str1[512], date_str2[512], adj_code[512]; 
  char comment[4096], comment2[2048], comment3[2048], labelcommentmsg[4096], adjcodeerrmsg[4096];
- double amnt1, amnt2, adj_amnt;
+ double amnt1=0.0, amnt2=0.0, adj_amnt;
  int toggle=0 ;
- struct date_rec buydate, selldate, annivdate;
- enum {none, short_term, long_term} term_flg=none;
+ struct numeric_scan ns;
+ struct date_rec buydate, selldate;
+ enum capgain_term term_flg=none;
 
  get_parameter( infile, 's', word, label );     /* Capital gains. */
  get_word(infile, word);
  while (word[0]!=';')
  { /*while_not_end*/
   if (feof(infile))
-   {printf("ERROR: Unexpected EOF on '%s'\n", label ); fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n", label ); exit(1);}
+   {
+    if (!collect_input_error( infile, 0, "Unexpected EOF on '%s'", label ))
+     {console_printf("ERROR: Unexpected EOF on '%s'\n", label ); results_fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n", label );}
+    taxsolve_exit(1);
+   }
   if (!Do_SchedD)
-   { fprintf(outfile,"\nForm(s) 8949:\n");  Do_SchedD = Yes; }
+   { results_fprintf(outfile,"\nForm(s) 8949:\n");  Do_SchedD = Yes; }
   switch (toggle)
    { /*switch_toggle*/
     case 0:	toggle++;
          term_flg = none;  /* Initialize */
-	 if (sscanf(word,"%lf",&amnt1)!=1)
-	  {printf("ERROR: Bad float '%s', reading %s.\n", word, label ); fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, label ); exit(1); }
+         buydate.daynum = selldate.daynum = 0;
+	 if (!scan_input_float( word, &ns ) && (ns.end == 0))	/* Tolerates trailing text, as always. */
+	  {
+	   if (!collect_input_error( infile, 0, "Bad float '%s', reading %s.", word, label ))
+	    {console_printf("ERROR: Bad float '%s', reading %s.\n", word, label ); results_fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, label ); taxsolve_exit(1); }
+	   ns.value = 0.0;
+	  }
+	 amnt1 = ns.value;
 	 if (amnt1 > 0.0) amnt1 = -amnt1;  /* Buy amounts must be negative. (It is a cost.) */
 	 break;
     case 1:	toggle++;
@@ -857,14 +1053,16 @@ void get_gain_and_losses( char *label )
 	 if (mystrcasestr( date_str1, "various-long" ) != 0)
 	  term_flg = long_term;
 	 else
-	  gen_date_rec ( word, labelcommentmsg, &buydate );
+	  gen_date_rec ( infile, word, labelcommentmsg, &buydate );
 	 break;
     case 2:	toggle++;
-	 if (sscanf(word,"%lf",&amnt2)!=1)
-	  { printf("ERROR: Bad float '%s', reading %s.\n", word, label ); 
-	    fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, label );
-	    exit(1);
+	 if ((!scan_input_float( word, &ns ) && (ns.end == 0))
+	     && (!collect_input_error( infile, 0, "Bad float '%s', reading %s.", word, label )))
+	  { console_printf("ERROR: Bad float '%s', reading %s.\n", word, label ); 
+	    results_fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, label );
+	    taxsolve_exit(1);
 	  }
+	 amnt2 = ns.value;
 	 break;
     case 3:	toggle++;
 	 strcpy( date_str2, word );
@@ -872,26 +1070,15 @@ void get_gain_and_losses( char *label )
          strcat( comment, comment2 );
          if (term_flg == none)		/* Executes if term_flg Not otherwise set in case: 1 */
 	  {
-           gen_date_rec ( word, labelcommentmsg, &selldate );
-           if (is_date1_beyond_date2 (buydate, selldate))
+           gen_date_rec ( infile, word, labelcommentmsg, &selldate );
+           if (is_date1_beyond_date2 (buydate, selldate) && (buydate.year != 0) && (selldate.year != 0)
+	       && (!collect_input_error( infile, 0, "Buy-date after sell-date.   '%s'  Buy-date '%s'  Sell-date '%s'", labelcommentmsg, date_str1, date_str2 )))
 	    {
-	     printf("DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
-	     fprintf(outfile,"DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
-	     exit(1);
+	     console_printf("DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
+	     results_fprintf(outfile,"DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
+	     taxsolve_exit(1);
             }
-           /* "annivdate" will be the date of the one year holding period relative to the Buy-date */
-           annivdate.year = buydate.year + 1;
-           annivdate.month = buydate.month;
-           annivdate.day = buydate.day;
-           if ((annivdate.month == 2) && (annivdate.day == 28) && (isleapyear(annivdate.year)))
-	    annivdate.day=29;
-           else
-           if ((annivdate.month == 2) && (annivdate.day == 29) && !(isleapyear(annivdate.year)))
-	    annivdate.day=28;
-           if (is_date1_beyond_date2(selldate, annivdate))
-	    term_flg = long_term;	/* Holding Period Test */
-           else
-           term_flg = short_term;
+           term_flg = holding_period_term( buydate, selldate );
 	  }
 	  break;
     case 4:	toggle++;
@@ -911,34 +1098,588 @@ void get_gain_and_losses( char *label )
 	  if (strcmp(word, "~") == 0) adj_amnt = 0.00;
 	  else
 	  {
- 	   if (sscanf(word, "%lf", &adj_amnt) != 1 )
+ 	   if ((!scan_input_float( word, &ns ) && (ns.end == 0))
+	       && (!collect_input_error( infile, 0, "Adj-Amnt - Bad float '%s', reading %s.", word, labelcommentmsg )))
 	   {
- 	    printf("ERROR: Adj-Amnt - Bad float '%s', reading %s.\n", word, labelcommentmsg);
-	    fprintf(outfile,"ERROR: Adj-Amnt - Bad float '%s', reading %s.\n", word, labelcommentmsg);
-	    exit(1);
+ 	    console_printf("ERROR: Adj-Amnt - Bad float '%s', reading %s.\n", word, labelcommentmsg);
+	    results_fprintf(outfile,"ERROR: Adj-Amnt - Bad float '%s', reading %s.\n", word, labelcommentmsg);
+	    taxsolve_exit(1);
 	   }
+	   adj_amnt = ns.value;
 	  }
-	 if (term_flg == long_term)
-	  { /*long-gain/loss*/
-	    new_capgain( &long_trades, comment, amnt1, date_str1, amnt2, date_str2, adj_code, adj_amnt );
-	  } /*long-gain/loss*/
-	 else
-	  { /*short-gain/loss*/
-	    new_capgain( &short_trades, comment, amnt1, date_str1, amnt2, date_str2, adj_code, adj_amnt );
-	  } /*short-gain/loss*/
+	 store_capgain( section, term_flg, comment, amnt1, date_str1, buydate.daynum, amnt2, date_str2, selldate.daynum, adj_code, adj_amnt );
 	 break;
    } /*switch_toggle*/
   get_word(infile, word);
  } /*while_not_end*/
- if (toggle!=0)
+ if ((toggle!=0) && (!collect_input_error( infile, 0, "Imbalanced cap-gains entry (toggle=%d), reading %s.", toggle, label )))
+  {
+   console_printf("ERROR: Imbalanced cap-gains entry (toggle=%d).\n", toggle);
+   results_fprintf(outfile,"ERROR: Imbalanced cap-gains entry (toggle=%d).\n", toggle);
+   taxsolve_exit(1);
+  }
+ adj_amnt = input_override( label );	/* Shifted by -sensitivity, as one more long-term lot. */
+ if (adj_amnt != 0.0)
+  {
+   if (!Do_SchedD)
+    { results_fprintf(outfile,"\nForm(s) 8949:\n");  Do_SchedD = Yes; }
+   store_capgain( section, long_term, "Sensitivity shift", (adj_amnt < 0.0) ? adj_amnt : 0.0, "various-long", 0,
+		  (adj_amnt > 0.0) ? adj_amnt : 0.0, "various-long", 0, "~", 0.0 );
+  }
+}
+
+
+
+/*------------------------------------------------------------------------------*/
+/* 1099-B Import - "-1099b file.csv" reads a broker's 1099-B export directly,	*/
+/*  in one pass, as though each row had been entered under CapGains-A/D, B/E,	*/
+/*  or C/F.  Each row gets the same checks as an entered lot.  Columns are	*/
+/*  found by their headings (see csv_headings), or as given by		*/
+/*  "-1099b_columns", by heading or by column number (from 1), as in:		*/
+/*	-1099b_columns "proceeds=Gross Proceeds;cost=5;box=Form 8949 Code"	*/
+/*  The letter in the box column picks the section:  A or D, B or E, C or F.	*/
+/*  When the date acquired is "Various", the letter also picks the term.	*/
+/*------------------------------------------------------------------------------*/
+#define MAX_1099B_FILES 16
+
+THREAD_LOCAL char *import_1099b_files[MAX_1099B_FILES];
+THREAD_LOCAL int num_1099b_files=0;
+THREAD_LOCAL char *import_1099b_columns=0;
+
+enum { COL_DESCR, COL_BUY_DATE, COL_SELL_DATE, COL_PROCEEDS, COL_COST, COL_ADJ_CODE, COL_ADJ_AMNT, COL_BOX, NUM_1099B_COLUMNS };
+
+char *csv_column_names[NUM_1099B_COLUMNS] =	/* As named in -1099b_columns. */
+ { "description", "acquired", "sold", "proceeds", "cost", "code", "adjustment", "box" };
+
+char *csv_headings[NUM_1099B_COLUMNS] =		/* Headings recognized by default, in lower-case. */
+ { "description|description of property|security|security description|1a",
+   "date acquired|acquired|buy date|open date|1b",
+   "date sold|date sold or disposed|sold|sell date|close date|1c",
+   "proceeds|gross proceeds|sales price|1d",
+   "cost|cost basis|cost or other basis|basis|1e",
+   "code|adjustment code|adj code|1f",
+   "adjustment|adjustment amount|adj amount|wash sale loss disallowed|1g",
+   "box|8949 box|form 8949 box|check box|checkbox" };
+
+
+void trim_csv_field( char *field )	/* Remove leading and trailing blanks. */
+{
+ int j=0, k;
+
+ while ((field[j] == ' ') || (field[j] == '\t')) j++;
+ k = strlen( field + j );
+ memmove( field, field + j, k + 1 );
+ while ((k > 0) && ((field[k-1] == ' ') || (field[k-1] == '\t'))) field[--k] = '\0';
+}
+
+
+int heading_matches( char *heading, char *names )	/* Names are '|' separated. */
+{
+ int j, k;
+
+ while (*names != '\0')
+  {
+   for (k=0; (names[k] != '\0') && (names[k] != '|'); k++);
+   for (j=0; (j < k) && (heading[j] != '\0') && (tolower( heading[j] ) == names[j]); j++);
+   if ((j == k) && (heading[j] == '\0'))
+    return 1;
+   names = names + k;
+   if (*names == '|') names++;
+  }
+ return 0;
+}
+
+
+void map_1099b_columns( char *fname, struct csv_record *rec, int *column )
+{
+ char spec[4096], *pt, *name, *value;
+ int j, k;
+
+ for (j=0; j < NUM_1099B_COLUMNS; j++)
+  column[j] = -1;
+ for (k=0; k < rec->nfields; k++)
+  {
+   trim_csv_field( rec->field[k] );
+   for (j=0; j < NUM_1099B_COLUMNS; j++)
+    if ((column[j] < 0) && heading_matches( rec->field[k], csv_headings[j] ))
+     column[j] = k;
+  }
+ if (import_1099b_columns != 0)
+  { /* Explicit choices, as:  name=heading;name=number;... */
+   strncpy( spec, import_1099b_columns, 4095 );
+   spec[4095] = '\0';
+   name = spec;
+   while (name != 0)
+    {
+     pt = strchr( name, ';' );
+     if (pt != 0) *pt++ = '\0';
+     value = strchr( name, '=' );
+     if (value == 0)
+      {
+       console_printf("ERROR: Bad -1099b_columns entry '%s'.  Expected name=heading or name=number.\n", name );
+       results_fprintf(outfile,"ERROR: Bad -1099b_columns entry '%s'.  Expected name=heading or name=number.\n", name );
+       taxsolve_exit(1);
+      }
+     *value++ = '\0';
+     trim_csv_field( name );
+     trim_csv_field( value );
+     for (j=0; (j < NUM_1099B_COLUMNS) && (strcasecmp( name, csv_column_names[j] ) != 0); j++);
+     if (j == NUM_1099B_COLUMNS)
+      {
+       console_printf("ERROR: Unknown -1099b_columns name '%s'.\n", name );
+       results_fprintf(outfile,"ERROR: Unknown -1099b_columns name '%s'.\n", name );
+       taxsolve_exit(1);
+      }
+     if (strspn( value, "0123456789" ) == strlen( value ))
+      column[j] = atoi( value ) - 1;
+     else
+      {
+       column[j] = -1;
+       for (k=0; (k < rec->nfields) && (column[j] < 0); k++)
+        if (strcasecmp( rec->field[k], value ) == 0)
+         column[j] = k;
+      }
+     if (column[j] < 0)
+      {
+       console_printf("ERROR: 1099-B file '%s' has no column '%s' for %s.\n", fname, value, name );
+       results_fprintf(outfile,"ERROR: 1099-B file '%s' has no column '%s' for %s.\n", fname, value, name );
+       taxsolve_exit(1);
+      }
+     name = pt;
+    }
+  }
+ for (j=0; j < NUM_1099B_COLUMNS; j++)
+  if ((column[j] < 0) && (j != COL_DESCR) && (j != COL_ADJ_CODE) && (j != COL_ADJ_AMNT))
+   {
+    console_printf("ERROR: 1099-B file '%s' has no '%s' column.  (Name it with -1099b_columns.)\n", fname, csv_column_names[j] );
+    results_fprintf(outfile,"ERROR: 1099-B file '%s' has no '%s' column.  (Name it with -1099b_columns.)\n", fname, csv_column_names[j] );
+    taxsolve_exit(1);
+   }
+}
+
+
+char *csv_field( struct csv_record *rec, int column )	/* Trimmed, or empty when absent. */
+{
+ if ((column < 0) || (column >= rec->nfields))
+  return "";
+ trim_csv_field( rec->field[column] );
+ return rec->field[column];
+}
+
+
+int csv_amount( char *field, double *value )	/* Accepts "$1,234.50" and "(12.00)".  Returns 1 if valid. */
+{
+ char word[512];
+ struct numeric_scan ns;
+ int j, k=0, negative=0;
+
+ for (j=0; (field[j] != '\0') && (k < 510); j++)
+  if (field[j] == '(')
+   negative = 1;
+  else
+  if ((field[j] != '$') && (field[j] != ',') && (field[j] != ')') && (field[j] != ' '))
+   word[k++] = field[j];
+ word[k] = '\0';
+ if (!scan_float( word, &ns ))
+  return 0;
+ *value = negative ? -ns.value : ns.value;
+ return 1;
+}
+
+
+void csv_date( char *field, char *date_str )	/* Re-order year-first dates, as 2021-03-15, to month-first. */
+{
+ int year, month, day, n;
+
+ if ((sscanf( field, "%4d-%2d-%2d%n", &year, &month, &day, &n ) == 3) && (n == (int)strlen( field )) && (year > 999))
+  sprintf( date_str, "%d-%d-%d", month, day, year );
+ else
+  {
+   strncpy( date_str, field, 511 );
+   date_str[511] = '\0';
+  }
+}
+
+
+void import_1099b( char *fname )
+{
+ struct csv_record rec;
+ struct date_rec buydate, selldate;
+ enum capgain_term term_flg;
+ char date_str1[512], date_str2[512], adj_code[512], *comment, *box;
+ char labelcommentmsg[4096], adjcodeerrmsg[8192];
+ double amnt1, amnt2, adj_amnt;
+ int column[NUM_1099B_COLUMNS], section, nlots=0, ok, j, k;
+ FILE *csvfile;
+
+ csvfile = taxsolve_fopen( fname, "r" );
+ if (csvfile == 0)
+  {
+   console_printf("ERROR: 1099-B file '%s' could not be opened.\n", fname );
+   results_fprintf(outfile,"ERROR: 1099-B file '%s' could not be opened.\n", fname );
+   taxsolve_exit(1);
+  }
+ memset( &rec, 0, sizeof(rec) );
+ if (get_csv_record( csvfile, &rec ) == 0)
+  {
+   console_printf("ERROR: 1099-B file '%s' is empty.\n", fname );
+   results_fprintf(outfile,"ERROR: 1099-B file '%s' is empty.\n", fname );
+   taxsolve_exit(1);
+  }
+ map_1099b_columns( fname, &rec, column );
+
+ while (get_csv_record( csvfile, &rec ) > 0)
+  {
+   if ((rec.nfields == 1) && (csv_field( &rec, 0 )[0] == '\0'))
+    continue;	/* Empty row. */
+   if (!Do_SchedD)
+    { results_fprintf(outfile,"\nForm(s) 8949:\n");  Do_SchedD = Yes; }
+   comment = csv_field( &rec, column[COL_DESCR] );
+   for (j=k=0; comment[j] != '\0'; j++)	/* A quoted description may span lines:  join them. */
+    if ((comment[j] != '\n') && (comment[j] != '\r'))
+     comment[k++] = comment[j];
+    else
+    if ((k > 0) && (comment[k-1] != ' '))
+     comment[k++] = ' ';
+   comment[k] = '\0';
+   snprintf( labelcommentmsg, sizeof(labelcommentmsg), "%s line %ld, %s", fname, rec.line, comment );
+
+   box = csv_field( &rec, column[COL_BOX] );
+   switch (toupper( box[0] ))
+    {
+     case 'A': case 'D':  section = 0;  break;
+     case 'B': case 'E':  section = 1;  break;
+     case 'C': case 'F':  section = 2;  break;
+     default:
+	if (!collect_input_error( 0, 0, "Bad 8949 box '%s', reading %s.", box, labelcommentmsg ))
+	 {
+	  console_printf("ERROR: Bad 8949 box '%s', reading %s.\n", box, labelcommentmsg );
+	  results_fprintf(outfile,"ERROR: Bad 8949 box '%s', reading %s.\n", box, labelcommentmsg );
+	  taxsolve_exit(1);
+	 }
+	continue;
+    }
+
+   ok = csv_amount( csv_field( &rec, column[COL_COST] ), &amnt1 );
+   ok = csv_amount( csv_field( &rec, column[COL_PROCEEDS] ), &amnt2 ) && ok;
+   adj_amnt = 0.0;
+   if (csv_field( &rec, column[COL_ADJ_AMNT] )[0] != '\0')
+    ok = csv_amount( csv_field( &rec, column[COL_ADJ_AMNT] ), &adj_amnt ) && ok;
+   if (!ok)
+    {
+     if (!collect_input_error( 0, 0, "Bad amount, reading %s.", labelcommentmsg ))
+      {
+       console_printf("ERROR: Bad amount, reading %s.\n", labelcommentmsg );
+       results_fprintf(outfile,"ERROR: Bad amount, reading %s.\n", labelcommentmsg );
+       taxsolve_exit(1);
+      }
+     continue;
+    }
+   if (amnt1 > 0.0) amnt1 = -amnt1;  /* Buy amounts must be negative. (It is a cost.) */
+
+   buydate.daynum = selldate.daynum = 0;
+   csv_date( csv_field( &rec, column[COL_BUY_DATE] ), date_str1 );
+   csv_date( csv_field( &rec, column[COL_SELL_DATE] ), date_str2 );
+   if (mystrcasestr( date_str1, "various" ) != 0)
+    term_flg = (strchr( "DEFdef", box[0] ) != 0) ? long_term : short_term;
+   else
+    {
+     gen_date_rec( 0, date_str1, labelcommentmsg, &buydate );
+     gen_date_rec( 0, date_str2, labelcommentmsg, &selldate );
+     if (is_date1_beyond_date2 (buydate, selldate) && (buydate.year != 0) && (selldate.year != 0)
+	 && (!collect_input_error( 0, 0, "Buy-date after sell-date.   '%s'  Buy-date '%s'  Sell-date '%s'", labelcommentmsg, date_str1, date_str2 )))
+      {
+       console_printf("DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
+       results_fprintf(outfile,"DATA ERROR: Buy-date after sell-date.   '%s'\n Buy-date '%s'  Sell-date '%s'\n", labelcommentmsg, date_str1, date_str2);
+       taxsolve_exit(1);
+      }
+     term_flg = holding_period_term( buydate, selldate );
+    }
+
+   strncpy( adj_code, csv_field( &rec, column[COL_ADJ_CODE] ), 511 );
+   adj_code[511] = '\0';
+   if (adj_code[0] == '\0')
+    strcpy( adj_code, "~" );
+   snprintf( adjcodeerrmsg, sizeof(adjcodeerrmsg), "%s   %s  %s  %s", adj_code, labelcommentmsg, date_str1, date_str2 );
+   adj_code_validity_check( adj_code, adjcodeerrmsg );
+
+   store_capgain( section, term_flg, comment, amnt1, date_str1, buydate.daynum, amnt2, date_str2, selldate.daynum, adj_code, adj_amnt );
+   nlots++;
+  }
+ results_fprintf(outfile," Imported %d lots from 1099-B file '%s'.\n", nlots, fname );
+ release_input_file( csvfile );
+ fclose( csvfile );
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Wash Sales - With the "-wash_sales" option, a loss is disallowed when the	*/
+/*  same security was bought, by another lot of the return, within 30 days	*/
+/*  before or after the sale.  The loss lot gets code W, with the disallowed	*/
+/*  loss as its adjustment, and the replacement lot gets code B, with the	*/
+/*  loss added to its basis.  Losses are taken in order of sale, and each is	*/
+/*  matched with the earliest purchases of its window whose shares are not	*/
+/*  yet used, until its own shares are.  The disallowed loss is pro-rated by	*/
+/*  the shares matched:  selling 100 shares at a loss, and buying 40, leaves	*/
+/*  60% of the loss allowed.  The share count is that leading the		*/
+/*  description ("100 SH ACME"), and the security is the rest ("ACME").  When	*/
+/*  either lot has no count, the two are matched whole, with a warning.	*/
+/*  Losses already coded W (as by a broker) are left as they are.  Purchases	*/
+/*  and losses are each sorted by security and date, so one sweep finds every	*/
+/*  loss's window, and used purchases are skipped by path-compressed links:	*/
+/*  O(n log n).								*/
+/*------------------------------------------------------------------------------*/
+struct wash_lot
+ {
+  char *security;	/* Interned, so the same security has the same pointer. */
+  int day;		/* Buy-day of a purchase, or sell-day of a loss. */
+  int store, k;		/* Which lot:  lots k of wash_store( store ). */
+  double shares;	/* Its share count, or 0 when not known.  (Of a purchase, those not yet used.) */
+ };
+
+#define WASH_SHARES_EPSILON	1e-6	/* Fewer shares left than this are none. */
+
+
+struct lot_store *wash_store( int store )	/* The six stores, as 0..5. */
+{
+ return (store < 3) ? &(short_trades[store]) : &(long_trades[store - 3]);
+}
+
+
+int compare_wash_lots( const void *a, const void *b )
+{
+ const struct wash_lot *w1=a, *w2=b;
+
+ if (w1->security != w2->security)
+  return (w1->security < w2->security) ? -1 : 1;
+ if (w1->day != w2->day)
+  return w1->day - w2->day;
+ if (w1->store != w2->store)
+  return w1->store - w2->store;
+ return w1->k - w2->k;
+}
+
+
+char *security_of( char *descr )	/* Interned.  (See above.) */
+{
+ char security[64], word[64];
+ int j=0, k=0, n;
+
+ while (isspace( descr[j] )) j++;
+ if (isdigit( descr[j] ) || (descr[j] == '.'))
+  { /* Drop a share count, and any unit after it. */
+   while (isdigit( descr[j] ) || (descr[j] == '.') || (descr[j] == ',')) j++;
+   while (isspace( descr[j] )) j++;
+   for (n=0; (n < 63) && isalpha( descr[j+n] ); n++)
+    word[n] = tolower( descr[j+n] );
+   word[n] = '\0';
+   if ((strcmp( word, "sh" ) == 0) || (strcmp( word, "shs" ) == 0) || (strcmp( word, "share" ) == 0) 
+       || (strcmp( word, "shares" ) == 0) || (strcmp( word, "units" ) == 0))
+    {
+     j = j + n;
+     while (isspace( descr[j] )) j++;
+     if ((tolower( descr[j] ) == 'o') && (tolower( descr[j+1] ) == 'f') && isspace( descr[j+2] ))
+      j = j + 3;
+    }
+  }
+ while ((descr[j] != '\0') && (descr[j] != '}') && (k < 63))
+  security[k++] = toupper( descr[j++] );
+ while ((k > 0) && isspace( security[k-1] )) k--;
+ security[k] = '\0';
+ return intern_string( &lot_strings, (k > 0) ? security : descr );
+}
+
+
+double shares_of( char *descr )	/* The share count that security_of drops, or 0 if none. */
+{
+ char count[64];
+ int j=0, k=0;
+
+ while (isspace( descr[j] )) j++;
+ for ( ; (isdigit( descr[j] ) || (descr[j] == '.') || (descr[j] == ',')) && (k < 63); j++)
+  if (descr[j] != ',')
+   count[k++] = descr[j];
+ count[k] = '\0';
+ return strtod( count, 0 );
+}
+
+
+char *with_adj_code( char *adj_code, char code )	/* Interned code-string, with the code added in alphabetical order. */
+{
+ char codes[512];
+ int j=0, k=0;
+
+ if (strcmp( adj_code, "~" ) == 0)
+  adj_code = "";
+ if (strchr( adj_code, code ) != 0)
+  return intern_string( &lot_strings, adj_code );
+ while ((adj_code[j] != '\0') && (adj_code[j] < code) && (k < 510))
+  codes[k++] = adj_code[j++];
+ codes[k++] = code;
+ while ((adj_code[j] != '\0') && (k < 511))
+  codes[k++] = adj_code[j++];
+ codes[k] = '\0';
+ return intern_string( &lot_strings, codes );
+}
+
+
+int next_unused_purchase( int *next, int j )	/* First unused purchase at or after j. */
+{
+ int r=j, t;
+
+ while (next[r] != r)
+  r = next[r];
+ while (next[j] != r)
+  { t = next[j];  next[j] = r;  j = t; }
+ return r;
+}
+
+
+money lot_gain( struct lot_store *lots, int k )
+{
+ return to_money( lots->sell_amnt[k] ) + to_money( lots->buy_amnt[k] ) + to_money( lots->adj_amnt[k] );
+}
+
+
+void find_wash_sales()
+{
+ struct wash_lot *buys, *losses;
+ struct lot_store *lots, *rlots;
+ int *next, store, j, k, m, b=0, nlots=0, nbuys=0, nlosses=0, nwash=0, nwhole=0, nmatched;
+ money loss, disallowed, part, total=0;
+ double shares, matched, q;
+
+ lot_strings.pool = &return_pool;
+ for (store=0; store < 6; store++)
+  nlots = nlots + wash_store( store )->n;
+ if (nlots == 0)
+  return;
+ buys = (struct wash_lot *)return_alloc( nlots * sizeof(struct wash_lot) );
+ losses = (struct wash_lot *)return_alloc( nlots * sizeof(struct wash_lot) );
+ next = (int *)return_alloc( (nlots + 1) * sizeof(int) );
+ for (store=0; store < 6; store++)
+  {
+   lots = wash_store( store );
+   for (k=0; k < lots->n; k++)
+    {
+     char *security = security_of( lots->comment[k] );
+     shares = shares_of( lots->comment[k] );
+     if (lots->buy_day[k] > 0)
+      {
+       buys[nbuys].security = security;
+       buys[nbuys].day = lots->buy_day[k];
+       buys[nbuys].store = store;
+       buys[nbuys].shares = shares;
+       buys[nbuys++].k = k;
+      }
+     if ((lots->sell_day[k] > 0) && (lot_gain( lots, k ) < 0) && (strchr( lots->adj_code[k], 'W' ) == 0))
+      {
+       losses[nlosses].security = security;
+       losses[nlosses].day = lots->sell_day[k];
+       losses[nlosses].store = store;
+       losses[nlosses].shares = shares;
+       losses[nlosses++].k = k;
+      }
+    }
+  }
+ qsort( buys, nbuys, sizeof(struct wash_lot), compare_wash_lots );
+ qsort( losses, nlosses, sizeof(struct wash_lot), compare_wash_lots );
+ for (j=0; j <= nbuys; j++)
+  next[j] = j;
+
+ for (m=0; m < nlosses; m++)
+  { /* Purchases before this loss's window can serve no later loss either. */
+   while ((b < nbuys) && ((buys[b].security < losses[m].security) 
+	  || ((buys[b].security == losses[m].security) && (buys[b].day < losses[m].day - 30))))
+    b++;
+   lots = wash_store( losses[m].store );
+   k = losses[m].k;
+   loss = -lot_gain( lots, k );	/* (Larger, if it was itself a replacement.) */
+   disallowed = 0;
+   matched = 0.0;
+   nmatched = 0;
+   j = next_unused_purchase( next, b );
+   for (;;)
+    {
+     while ((j < nbuys) && (buys[j].store == losses[m].store) && (buys[j].k == losses[m].k))
+      j = next_unused_purchase( next, j + 1 );	/* (Not its own purchase.) */
+     if ((j == nbuys) || (buys[j].security != losses[m].security) || (buys[j].day > losses[m].day + 30))
+      break;
+     if ((losses[m].shares > 0.0) && (buys[j].shares > 0.0))
+      { /* The loss on the shares matched so far, less that already disallowed. */
+       q = losses[m].shares - matched;
+       if (buys[j].shares < q)
+        q = buys[j].shares;
+       matched = matched + q;
+       buys[j].shares = buys[j].shares - q;
+       if (matched > losses[m].shares - WASH_SHARES_EPSILON)
+        part = loss - disallowed;
+       else
+        part = to_money( money_to_dollars( loss ) * matched / losses[m].shares ) - disallowed;
+      }
+     else
+      { /* Matched whole. */
+       matched = losses[m].shares;
+       buys[j].shares = 0.0;
+       part = loss - disallowed;
+       nwhole++;
+      }
+     disallowed = disallowed + part;
+     nmatched++;
+     rlots = wash_store( buys[j].store );
+     rlots->adj_amnt[ buys[j].k ] = money_to_dollars( to_money( rlots->adj_amnt[ buys[j].k ] ) - part );
+     rlots->adj_code[ buys[j].k ] = with_adj_code( rlots->adj_code[ buys[j].k ], 'B' );
+     if (buys[j].shares < WASH_SHARES_EPSILON)
+      next[j] = j + 1;	/* Used. */
+     if (matched > losses[m].shares - WASH_SHARES_EPSILON)
+      break;
+     j = next_unused_purchase( next, j + 1 );
+    }
+   if (nmatched == 0)
+    continue;
+   lots->adj_amnt[k] = money_to_dollars( to_money( lots->adj_amnt[k] ) + disallowed );
+   lots->adj_code[k] = with_adj_code( lots->adj_code[k], 'W' );
+   nwash++;
+   total = total + disallowed;
+  }
+ results_fprintf(outfile,"\nWash sales:  %d losses disallowed (code W), totaling %1.2f, added to the basis of replacement lots (code B).\n", 
+	nwash, money_to_dollars( total ) );
+ if (nwhole > 0)
   {
-   printf("ERROR: Imbalanced cap-gains entry (toggle=%d).\n", toggle);
-   fprintf(outfile,"ERROR: Imbalanced cap-gains entry (toggle=%d).\n", toggle);
-   exit(1);
+   console_printf("Warning: %d wash sales were matched as whole lots, since a share count was not known.\n"
+		  " Begin each lot's description with its count, as in \"100 SH ACME\", to pro-rate them.\n", nwhole );
+   results_fprintf(outfile,"Warning: %d wash sales were matched as whole lots, since a share count was not known.\n"
+		  " Begin each lot's description with its count, as in \"100 SH ACME\", to pro-rate them.\n", nwhole );
   }
 }
 
 
+/* With wash-sale detection, the lots to summarize are known only after it, so they are moved out then. */
+void summarize_unadjusted_lots( struct lot_store *lots, struct lot_summary *summary, char *term )
+{
+ int j, k=0;
+
+ for (j=0; j < lots->n; j++)
+  if ((strcmp( lots->adj_code[j], "~" ) == 0) && (lots->adj_amnt[j] == 0.0))
+   summarize_capgain( summary, term, lots->comment[j], lots->buy_amnt[j], lots->buy_date[j], lots->sell_amnt[j], lots->sell_date[j] );
+  else
+   { /* Keep it, for Form 8949. */
+    lots->comment[k] = lots->comment[j];
+    lots->buy_date[k] = lots->buy_date[j];
+    lots->sell_date[k] = lots->sell_date[j];
+    lots->adj_code[k] = lots->adj_code[j];
+    lots->buy_amnt[k] = lots->buy_amnt[j];
+    lots->sell_amnt[k] = lots->sell_amnt[j];
+    lots->adj_amnt[k] = lots->adj_amnt[j];
+    lots->buy_day[k] = lots->buy_day[j];
+    lots->sell_day[k] = lots->sell_day[j];
+    k++;
+   }
+ lots->n = k;
+}
+
+
+
 
 /************************************************************************/
 /* Get_Cap_Gains - Get and calculate gains.  Forms 8949 + Sched-D.	*/
@@ -951,77 +1692,111 @@ void get_gain_and_losses( char *label )
 /************************************************************************/
 void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
 {
- char word[4092], *LastYearsOutFile=0, labelx[1024]="";
+ char word[4092], *LastYearsOutFile=0, labelx[1024]="", amt[AMOUNT_BUFSZ];
  int j, doline22=0, got_collectibles=0;
  double stcg=0.0, ltcg=0.0;      /* Variables for short and long term gains. */
  double SchedDd[20], SchedDe[20], SchedDg[20];
+ double SchedD1ad=0.0, SchedD1ae=0.0, SchedD1ah=0.0, SchedD8ad=0.0, SchedD8ae=0.0, SchedD8ah=0.0;
+ struct numeric_scan ns;
 
  for (j=0; j<20; j++)		/* Initialize. */
   { SchedDd[j] = 0.0;  SchedDe[j] = 0.0; SchedDg[j] = 0.0; }
 
- /* Form 8849 - Adjunct form to Schedule-D. */
- get_gain_and_losses( "CapGains-A/D" );	/* (A) Basis Reported to IRS. */
- if (short_trades)
+ /* Form 8849 - Adjunct form to Schedule-D.  All lots are read before any are listed, */
+ /* so that wash sales may be found across sections. */
+ for (j=0; j < num_1099b_files; j++)
+  import_1099b( import_1099b_files[j] );	/* Broker exports, for any section. */
+ get_gain_and_losses( "CapGains-A/D", 0 );	/* (A) Basis Reported to IRS. */
+ get_gain_and_losses( "CapGains-B/E", 1 );	/* (B) Basis NOT Reported to IRS. */
+ get_gain_and_losses( "CapGains-C/F", 2 );	/* (C) Cannot check (A) or (B). */
+ if (detect_wash_sales)
+  {
+   find_wash_sales();
+   if (summarize_8949)
+    {
+     summarize_unadjusted_lots( &(short_trades[0]), &short_summary, "  S " );
+     summarize_unadjusted_lots( &(long_trades[0]), &long_summary, "  L " );
+    }
+  }
+ if (statement_8949 != 0)
+  close_8949_statement();
+ if (short_summary.n > 0)
   {
-   print_capgain_list( short_trades, 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (A) Basis Reported to IRS:", "14 14\n F8949_ckA X" );
+   SchedD1ad = money_to_dollars( short_summary.sales );
+   SchedD1ae = money_to_dollars( short_summary.costs );
+   SchedD1ah = money_to_dollars( short_summary.sales + short_summary.costs );
+   results_fprintf(outfile,"\nSchedule-D line 1a, Short-Term, Basis Reported to IRS, no adjustments:  %d lots reported in total.\n", short_summary.n );
+   results_fprintf(outfile," 1a. Totals:                                       %14.2f %14.2f                           %14.2f\n", 
+	SchedD1ad, absolutev(SchedD1ae), SchedD1ah );
+  }
+ if (long_summary.n > 0)
+  {
+   SchedD8ad = money_to_dollars( long_summary.sales );
+   SchedD8ae = money_to_dollars( long_summary.costs );
+   SchedD8ah = money_to_dollars( long_summary.sales + long_summary.costs );
+   results_fprintf(outfile,"\nSchedule-D line 8a, Long-Term, Basis Reported to IRS, no adjustments:  %d lots reported in total.\n", long_summary.n );
+   results_fprintf(outfile," 8a. Totals:                                       %14.2f %14.2f                           %14.2f\n", 
+	SchedD8ad, absolutev(SchedD8ae), SchedD8ah );
+  }
+ if (short_trades[0].n > 0)
+  {
+   print_capgain_list( &(short_trades[0]), 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (A) Basis Reported to IRS:", "14 14\n F8949_ckA X" );
    SchedDd[1] = total_sales;
    SchedDe[1] = total_costs;
    SchedDg[1] = total_adjs;
    SchedD[1] = SchedDd[1] + SchedDe[1] + SchedDg[1];
-   free_capgain_list( &short_trades );
+   free_capgain_list( &(short_trades[0]) );
   }
- if (long_trades)
+ if (long_trades[0].n > 0)
   {
-   print_capgain_list( long_trades, 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (D) Basis Reported to IRS:", "15 15\n F8949_ckD X" );
+   print_capgain_list( &(long_trades[0]), 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (D) Basis Reported to IRS:", "15 15\n F8949_ckD X" );
    SchedDd[8] = total_sales;
    SchedDe[8] = total_costs;
    SchedDg[8] = total_adjs;
    SchedD[8] = SchedDd[8] + SchedDe[8] + SchedDg[8];
-   free_capgain_list( &long_trades );
+   free_capgain_list( &(long_trades[0]) );
   }
 
- get_gain_and_losses( "CapGains-B/E" );	/* (B) Basis NOT Reported to IRS. */
- if (short_trades)
+ if (short_trades[1].n > 0)
   {
-   print_capgain_list( short_trades, 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (B) Basis NOT Reported to IRS:", "14 14\n F8949_ckB X" );
+   print_capgain_list( &(short_trades[1]), 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (B) Basis NOT Reported to IRS:", "14 14\n F8949_ckB X" );
    SchedDd[2] = total_sales;
    SchedDe[2] = total_costs;
    SchedDg[2] = total_adjs;
    SchedD[2] = SchedDd[2] + SchedDe[2] +SchedDg[2] ;
-   free_capgain_list( &short_trades );
+   free_capgain_list( &(short_trades[1]) );
   }
- if (long_trades)
+ if (long_trades[1].n > 0)
   {
-   print_capgain_list( long_trades, 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (E) Basis NOT Reported to IRS:", "15 15\n F8949_ckE X"  );
+   print_capgain_list( &(long_trades[1]), 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (E) Basis NOT Reported to IRS:", "15 15\n F8949_ckE X"  );
    SchedDd[9] = total_sales;
    SchedDe[9] = total_costs;
    SchedDg[9] = total_adjs;
    SchedD[9] = SchedDd[9] + SchedDe[9] + SchedDg[9];
-   free_capgain_list( &long_trades );
+   free_capgain_list( &(long_trades[1]) );
   }
 
- get_gain_and_losses( "CapGains-C/F" );	/* (C) Cannot check (A) or (B). */
- if (short_trades)
+ if (short_trades[2].n > 0)
   {
-   print_capgain_list( short_trades, 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (C) Not reported on Form 1099-B.\n", "14 14\n F8949_ckC X" );
+   print_capgain_list( &(short_trades[2]), 1, "Form 8949 Part-I, Short-Term Cap Gains+Losses, CHECK (C) Not reported on Form 1099-B.\n", "14 14\n F8949_ckC X" );
    SchedDd[3] = total_sales;
    SchedDe[3] = total_costs;
    SchedDg[3] = total_adjs;
    SchedD[3] = SchedDd[3] + SchedDe[3] + SchedDg[3];
-   free_capgain_list( &short_trades );
+   free_capgain_list( &(short_trades[2]) );
   }
- if (long_trades)
+ if (long_trades[2].n > 0)
   {
-   print_capgain_list( long_trades, 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (F) Not reported on Form 1099-B.\n", "15 15\n F8949_ckF X" );
+   print_capgain_list( &(long_trades[2]), 3, "Form 8949 Part-II, Long-Term Cap Gains+Losses, CHECK (F) Not reported on Form 1099-B.\n", "15 15\n F8949_ckF X" );
    SchedDd[10] = total_sales;
    SchedDe[10] = total_costs;
    SchedDg[10] = total_adjs;
    SchedD[10] = SchedDd[10] + SchedDe[10] + SchedDg[10];
-   free_capgain_list( &long_trades );
+   free_capgain_list( &(long_trades[2]) );
   }
 
- stcg = SchedD[1] + SchedD[2] + SchedD[3];
- ltcg = SchedD[8] + SchedD[9] + SchedD[10];
+ stcg = SchedD1ah + SchedD[1] + SchedD[2] + SchedD[3];
+ ltcg = SchedD8ah + SchedD[8] + SchedD[9] + SchedD[10];
 
  GetLine( "D4", &SchedD[4] );       /* Short term gain from 6252 and short-term gain or loss from Forms 4684, 6781, 8824. */
  GetLine( "D5", &SchedD[5] );       /* Net short-term gain or loss from partnerships, S corps, estates, trusts from K-1. */
@@ -1030,11 +1805,14 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
  get_word(infile,word);
  if (strcmp(word,";") != 0)
   {
-   if (sscanf(word,"%lf",&SchedD[6]) != 1) LastYearsOutFile = strdup(word);
+   if (scan_input_float( word, &ns ) || (ns.end > 0))
+    SchedD[6] = ns.value;
+   else
+    LastYearsOutFile = return_strdup(word);
    do
     { get_word(infile,word); 
       if ((strlen(word) > 0) && (strcmp(word,";") != 0))
-       fprintf(outfile,"Warning: Unexpected multiple values on line D6.  '%s' ignored.\n If multi-part filename, then surround it in quotes (\").", word );
+       results_fprintf(outfile,"Warning: Unexpected multiple values on line D6.  '%s' ignored.\n If multi-part filename, then surround it in quotes (\").", word );
     } while (strcmp(word,";") != 0);
   }
 
@@ -1056,14 +1834,14 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
     }
    else
     {
-     printf("ERROR1: Found '%s' when expecting 'D19 or Collectibles'\n", labelx ); 
-     fprintf(outfile,"ERROR1: Found '%s' when expecting 'D19 or Collectibles'\n", labelx );
-     exit(1);
+     console_printf("ERROR1: Found '%s' when expecting 'D19 or Collectibles'\n", labelx ); 
+     results_fprintf(outfile,"ERROR1: Found '%s' when expecting 'D19 or Collectibles'\n", labelx );
+     taxsolve_exit(1);
     }
   }
 
  // GetLine( "Collectibles", &collectibles_gains );	/* Gains or Losses from Collectibles. (Usually zero.) */
- if (collectibles_gains != 0.0) fprintf(outfile, "Collectibles_Gains = %6.2f\n", collectibles_gains );
+ if (collectibles_gains != 0.0) showline_wlabel( "Collectibles_Gains", collectibles_gains );
 
  if (LastYearsOutFile != 0)
   CapitalLossCarryOverWorksheet( LastYearsOutFile, &LastYearsReturn );
@@ -1085,40 +1863,44 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
 
  if (Do_SchedD)
   { /*Sched-D*/
-   fprintf(outfile," Cap Gains/Losses Schedule-D\n");
-   fprintf(outfile,"PDFpage: 12 12\n");
+   results_fprintf(outfile," Cap Gains/Losses Schedule-D\n");
+   results_fprintf(outfile,"PDFpage: 12 12\n");
    // Do_QDCGTW = Yes;	/* Tentatively set to do: Qualified Dividends and Capital Gain tax Worksheet. */
-   fprintf(outfile,"\tNet Forms-8949 Short-term Gains = %10.2f\n", stcg );
-   fprintf(outfile,"\tNet Forms-8949 Long-term Gains  = %10.2f\n", ltcg);
-   fprintf(outfile," D1bd = %10.2f\n   D1be = %10.2f\n    D1bg = %10.2f\n    D1bh = %10.2f\n", SchedDd[1], absolutev(SchedDe[1]), SchedDg[1], SchedD[1] );
-   fprintf(outfile," D2d = %10.2f\n   D2e = %10.2f\n    D2g = %10.2f\n    D2h = %10.2f\n", SchedDd[2], absolutev(SchedDe[2]),  SchedDg[2],SchedD[2] );
+   results_fprintf(outfile,"\tNet Forms-8949 Short-term Gains = %10.2f\n", stcg );
+   results_fprintf(outfile,"\tNet Forms-8949 Long-term Gains  = %10.2f\n", ltcg);
+   if (summarize_8949)
+    results_fprintf(outfile," D1ad = %10.2f\n   D1ae = %10.2f\n    D1ah = %10.2f\n", SchedD1ad, absolutev(SchedD1ae), SchedD1ah );
+   results_fprintf(outfile," D1bd = %10.2f\n   D1be = %10.2f\n    D1bg = %10.2f\n    D1bh = %10.2f\n", SchedDd[1], absolutev(SchedDe[1]), SchedDg[1], SchedD[1] );
+   results_fprintf(outfile," D2d = %10.2f\n   D2e = %10.2f\n    D2g = %10.2f\n    D2h = %10.2f\n", SchedDd[2], absolutev(SchedDe[2]),  SchedDg[2],SchedD[2] );
 
-   fprintf(outfile," D3d = %10.2f\n   D3e = %10.2f\n    D3g = %10.2f\n    D3h = %10.2f\n", SchedDd[3], absolutev(SchedDe[3]), SchedDg[3], SchedD[3] );
+   results_fprintf(outfile," D3d = %10.2f\n   D3e = %10.2f\n    D3g = %10.2f\n    D3h = %10.2f\n", SchedDd[3], absolutev(SchedDe[3]), SchedDg[3], SchedD[3] );
 
-   fprintf(outfile," D4 = %6.2f\n", SchedD[4] );
-   fprintf(outfile," D5 = %6.2f\n", SchedD[5] );
-   fprintf(outfile," D6 = %6.2f		(Carry-over Loss)\n", SchedD[6] );
-   SchedD[7] = SchedD[1] + SchedD[2] + SchedD[3] + SchedD[4] + SchedD[5] + SchedD[6];
-   fprintf(outfile," D7 = %6.2f		{ Net short-term capital gain or loss }\n", SchedD[7] );
+   showline_wrksht( 'D', 4, SchedD );
+   showline_wrksht( 'D', 5, SchedD );
+   results_fprintf(outfile," D6 = %s		(Carry-over Loss)\n", format_amount( SchedD[6], amt ) );
+   SchedD[7] = SchedD1ah + SchedD[1] + SchedD[2] + SchedD[3] + SchedD[4] + SchedD[5] + SchedD[6];
+   results_fprintf(outfile," D7 = %s		{ Net short-term capital gain or loss }\n", format_amount( SchedD[7], amt ) );
 
-   fprintf(outfile," D8bd = %10.2f\n   D8be = %10.2f\n   D8bg = %10.2f\n   D8bh = %10.2f\n", SchedDd[8], absolutev(SchedDe[8]), SchedDg[8], SchedD[8] );
+   if (summarize_8949)
+    results_fprintf(outfile," D8ad = %10.2f\n   D8ae = %10.2f\n   D8ah = %10.2f\n", SchedD8ad, absolutev(SchedD8ae), SchedD8ah );
+   results_fprintf(outfile," D8bd = %10.2f\n   D8be = %10.2f\n   D8bg = %10.2f\n   D8bh = %10.2f\n", SchedDd[8], absolutev(SchedDe[8]), SchedDg[8], SchedD[8] );
 
-   fprintf(outfile," D9d = %10.2f\n   D9e = %10.2f\n   D9g = %10.2f\n   D9h = %10.2f\n", SchedDd[9], absolutev(SchedDe[9]), SchedDg[9], SchedD[9] );
+   results_fprintf(outfile," D9d = %10.2f\n   D9e = %10.2f\n   D9g = %10.2f\n   D9h = %10.2f\n", SchedDd[9], absolutev(SchedDe[9]), SchedDg[9], SchedD[9] );
 
-   fprintf(outfile," D10d = %10.2f\n   D10e = %10.2f\n   D10g = %10.2f\n   D10h = %10.2f\n", SchedDd[10], 
+   results_fprintf(outfile," D10d = %10.2f\n   D10e = %10.2f\n   D10g = %10.2f\n   D10h = %10.2f\n", SchedDd[10], 
 			absolutev(SchedDe[10]),  SchedDg[10], SchedD[10] );
 
-   fprintf(outfile," D11 = %6.2f\n", SchedD[11] );
-   fprintf(outfile," D12 = %6.2f\n", SchedD[12] );
-   fprintf(outfile," D13 = %6.2f\n", SchedD[13] );
-   fprintf(outfile," D14 = %6.2f	(Carry-over Loss)\n", SchedD[14] );
-   SchedD[15] = SchedD[8] + SchedD[9] + SchedD[10] + SchedD[11] + SchedD[12] + SchedD[13] + SchedD[14];
-   fprintf(outfile," D15 = %6.2f		{ Net long-term capital gain or loss }\n", SchedD[15] );
-   fprintf(outfile,"EndPDFpage.\nPDFpage: 13 13\n");
+   showline_wrksht( 'D', 11, SchedD );
+   showline_wrksht( 'D', 12, SchedD );
+   showline_wrksht( 'D', 13, SchedD );
+   results_fprintf(outfile," D14 = %s	(Carry-over Loss)\n", format_amount( SchedD[14], amt ) );
+   SchedD[15] = SchedD8ah + SchedD[8] + SchedD[9] + SchedD[10] + SchedD[11] + SchedD[12] + SchedD[13] + SchedD[14];
+   results_fprintf(outfile," D15 = %s		{ Net long-term capital gain or loss }\n", format_amount( SchedD[15], amt ) );
+   results_fprintf(outfile,"EndPDFpage.\nPDFpage: 13 13\n");
 
    /* Part ||| */
    SchedD[16] = SchedD[7] + SchedD[15];
-   fprintf(outfile," D16 = %6.2f\n", SchedD[16]);
+   showline_wrksht( 'D', 16, SchedD );
    if (SchedD[16] > 0.0) 
     { /*gain*/
      L[7] = SchedD[16];
@@ -1126,7 +1908,7 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
       { /* Lines 17-21 */
 	double wsd[50];
 
-	fprintf(outfile," D17 = yes\n CkD17y X\n");
+	results_fprintf(outfile," D17 = yes\n CkD17y X\n");
 
 	/* '28% Rate Gain Worksheet' on instructions page D-13. */
 	wsd[1] = collectibles_gains;	/* Gain or losses from "Collectibles" only.  Usually zero. */
@@ -1137,20 +1919,20 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
 	if (SchedD[7] < 0.0)  wsd[6] = SchedD[7];  else  wsd[6] = 0.0;
 	wsd[7] = NotLessThanZero( wsd[1] + wsd[2] + wsd[3] + wsd[4] + wsd[5] + wsd[6] );
 	SchedD[18] = wsd[7];
-	fprintf(outfile," D18 = %6.2f\n", SchedD[18]);
+	showline_wrksht( 'D', 18, SchedD );
 
 	/* 'Unrecaptured Section 1250 Gain Worksheet' on page D14, usually 0. */
-	fprintf(outfile," D19 = %6.2f\n", SchedD[19]);
+	showline_wrksht( 'D', 19, SchedD );
 
         if ((SchedD[18] == 0.0) && (SchedD[19] == 0.0))
 	 { /*yes*/
-	  fprintf(outfile," D20 = Yes\n CkD20y X\n");
+	  results_fprintf(outfile," D20 = Yes\n CkD20y X\n");
 	  // printf("Complete 'Qualified Dividends and Capital Gain tax Worksheet', instructions page 43.\n");
 	  Do_QDCGTW = Yes;
 	 } /*yes*/
 	else
 	 { /*no*/
-	  fprintf(outfile," D20 = No\n CkD20n X\n");
+	  results_fprintf(outfile," D20 = No\n CkD20n X\n");
 	  // printf("Complete 'Schedule D Tax Worksheet', instructions page D-15.\n");
 	  Do_SDTW = Yes;
 	  Do_QDCGTW = No;
@@ -1159,7 +1941,7 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
       } /* Lines 17-21 */
      else 
       {
-       printf(" D17 = no\n CkD17n X\n");
+       console_printf(" D17 = no\n CkD17n X\n");
        doline22 = Yes;
       }
     } /*gain*/  
@@ -1170,7 +1952,7 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
 
      if (status == MARRIED_FILING_SEPARAT) maxloss = -1500.0; else maxloss = -3000.0;
      if (SchedD[16] < maxloss) SchedD[21] = maxloss; else SchedD[21] = SchedD[16];
-     fprintf(outfile," D21 = %6.2f\n", SchedD[21]);
+     showline_wrksht( 'D', 21, SchedD );
      L[7] = SchedD[21];
      doline22 = Yes;
     }
@@ -1184,18 +1966,18 @@ void get_cap_gains()		/* This is Schedule-D. */			/* Updated for 2021. */
     {
      if (L3a > 0.0)
       { /*yes*/
-       fprintf(outfile," D22 = Yes\n CkD22y X\n");
+       results_fprintf(outfile," D22 = Yes\n CkD22y X\n");
        // printf("Complete 'Qualified Dividends and Capital Gain tax Worksheet', instructions page 44.\n");
        Do_QDCGTW = Yes;	
       } /*yes*/
      else
       { /*no*/
-       fprintf(outfile," D22 = No\n CkD22n X\n");
+       results_fprintf(outfile," D22 = No\n CkD22n X\n");
        // Do_QDCGTW = No;	
       } /*no*/
     }
 
-    fprintf(outfile,"EndPDFpage.\n\n");
+    results_fprintf(outfile,"EndPDFpage.\n\n");
   } /*Sched-D*/
 }
 
@@ -1288,7 +2070,7 @@ void sched_D_tax_worksheet( int status )			/* Updated for 2021. */
   {
    ws_sched_D[k] = ws[k];	/* Save worksheet values for AMT, if needed. */
    if (ws[k] != 0.0)
-    fprintf(outfile,"  Sched-D tax Worksheet line %d = %6.2f\n", k, ws[k]);
+    results_fprintf(outfile,"  Sched-D tax Worksheet line %d = %6.2f\n", k, ws[k]);
   }
 }
 
@@ -1315,32 +2097,32 @@ void SocSec_Worksheet()							/* Updated for 2021. */
   ws[6] = ws[6] + Sched1[k];
  ws[6] = ws[6] + Sched1[23] + Sched1[25];
  for (k = 0; k <= 6; k++)
-  fprintf(outfile,"\tSocSecWorkSheet[%d] = %6.2f\n", k, ws[k] );
+  results_fprintf(outfile,"\tSocSecWorkSheet[%d] = %6.2f\n", k, ws[k] );
  if (ws[6] >= ws[5])
   {
    L[6] = 0.0;		/* Which is "L6b". */
-   fprintf(outfile,"\tSocSecWorkSheet[7]: Check 'No'\n" );
-   printf("None of your social security benefits are taxable.\n");
-   fprintf(outfile,"None of your social security benefits are taxable.\n");
+   results_fprintf(outfile,"\tSocSecWorkSheet[7]: Check 'No'\n" );
+   console_printf("None of your social security benefits are taxable.\n");
+   results_fprintf(outfile,"None of your social security benefits are taxable.\n");
    return;
   }
  ws[7] = ws[5] - ws[6];
- fprintf(outfile,"\tSocSecWorkSheet[7] = %6.2f  (Check 'Yes')\n", ws[7] );
+ results_fprintf(outfile,"\tSocSecWorkSheet[7] = %6.2f  (Check 'Yes')\n", ws[7] );
  if (status == MARRIED_FILING_JOINTLY)
   ws[8] = 32000.0;      						/* Updated for 2021. */
  else
   ws[8] = 25000.0;
- fprintf(outfile,"\tSocSecWorkSheet[8] = %6.2f\n", ws[8] );
+ results_fprintf(outfile,"\tSocSecWorkSheet[8] = %6.2f\n", ws[8] );
  if (ws[8] >= ws[7])
   {
    L[6] = 0.0;
-   fprintf(outfile,"\tSocSecWorkSheet[9]: Check 'No'\n" );
-   printf("None of your social security benefits are taxable.\n");
-   fprintf(outfile,"None of your social security benefits are taxable.\n");
+   results_fprintf(outfile,"\tSocSecWorkSheet[9]: Check 'No'\n" );
+   console_printf("None of your social security benefits are taxable.\n");
+   results_fprintf(outfile,"None of your social security benefits are taxable.\n");
    return;
   }
  ws[9] = ws[7] - ws[8];
- fprintf(outfile,"\tSocSecWorkSheet[9] = %6.2f  (Check 'Yes')\n", ws[9] );
+ results_fprintf(outfile,"\tSocSecWorkSheet[9] = %6.2f  (Check 'Yes')\n", ws[9] );
  if (status == MARRIED_FILING_JOINTLY)
   ws[10] = 12000.0;      						/* Updated for 2021. */
  else
@@ -1354,162 +2136,96 @@ void SocSec_Worksheet()							/* Updated for 2021. */
  ws[17] = Conditional_Round( 0.85 * ws[1]);
  ws[18] = smallerof( ws[16], ws[17] );
  for (k = 10; k <= 18; k++)
-  fprintf(outfile,"\tSocSecWorkSheet[%d] = %6.2f\n", k, ws[k] );
+  results_fprintf(outfile,"\tSocSecWorkSheet[%d] = %6.2f\n", k, ws[k] );
  L[6] = ws[18];		/* Which is "L6b". */
 }
 
 
 
-void pull_comment( char *line, char *word )
+THREAD_LOCAL struct payer_record	/* Schedule-B payer lines, collected while reading L2b and L3b. */
+ {
+  char *payer;
+  double amount;
+  struct payer_record *nxt;
+ } *interest_payers=0, *dividend_payers=0;
+
+
+/* Get a line value, or sum, like GetLineF, while also keeping each entry */
+/* with the payer-name written in the comment after it on the same line. */
+void GetPayerLinesF( char *linename, double *value, struct payer_record **list )
 {
- int j=0, k=0;
- while ((line[j] != '\0') && (line[j] != '{')) j++;
- if (line[j] != '\0')
+ char word[2048], payer[2048];
+ double y;
+ struct payer_record *new_item, **tail=list;
+ struct numeric_scan ns;
+
+ get_parameter( infile, 's', word, linename );
+ *value = 0.0;
+ get_word( infile, word );
+ while (word[0] != ';')
   {
-   j++;
-   while ((line[j+k] != '\0') && (line[j+k] != '}'))
+   if (feof(infile))
+    {
+     if (!collect_input_error( infile, 0, "Unexpected EOF on '%s'", linename ))
+      {console_printf("ERROR: Unexpected EOF on '%s'\n", linename ); results_fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n", linename );}
+     taxsolve_exit(1);
+    }
+   if (!scan_input_float( word, &ns ))
     {
-     word[k] = line[j+k];  k++;
+     if (!collect_input_error( infile, ns.column, "Bad float '%s', reading %s.", word, linename ))
+      {console_printf("ERROR: Bad float '%s', reading %s.\n", word, linename ); results_fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, linename ); taxsolve_exit(1); }
+     ns.value = 0.0;
     }
+   y = ns.value;
+   if (round_to_whole_dollars)
+    y = Round( y );
+   *value = *value + y;
+   get_comment_on_line( infile, payer, 2048 );
+   new_item = (struct payer_record *)return_alloc( sizeof(struct payer_record) );
+   new_item->payer = return_strdup( payer );
+   new_item->amount = y;
+   new_item->nxt = 0;
+   *tail = new_item;
+   tail = &(new_item->nxt);
+   get_word( infile, word );
   }
- word[k] = '\0';
+ showline_wlabel( linename, *value );
 }
 
 
-void Grab_ScheduleB_Payer_Lines( char *infname, FILE *outfile )
-{ /* Copy Schedule-B Line entries from input file, to output file -- only. Does not process data read. */
+void print_payer_lines( FILE *outfile, struct payer_record *list, char *pgstr1, int ncnt, char *addimsg )
+{ /* Write Schedule-B payer entries, spilling onto additional-form pages as needed. */
   /* Used for PDF form-FILING only.  Not used by tax-calculations. */
- int state=0, cnt=0, pg=0, ncnt=15, newentry=0;
- double value;
+ int cnt=0, pg=0;
  double total=0.0;
- char line[2048], word1[1024], word2[1024], pgstr[10]="";
- FILE *infile;
+ char *pgstr=pgstr1;
 
- infile = fopen( infname, "rb" );
- if (infile == 0)
-  {
-   printf("Can no longer read '%s'.\n", infname );
-   return;
-  }
- fprintf(outfile,"\nSchedules Data:\n");
- fgets( line, 200, infile );
- while (!feof(infile))
+ while (list != 0)
   {
-   next_word( line, word1, " \t\n\r" );
-   switch (state)
+   cnt++;
+   if (cnt == ncnt)
     {
-     case 0:
-	if (strcmp( word1, "L2b" ) == 0) 
-	 { 
-	  state = 8;  ncnt = 15; 
-	  pg = 0;  cnt = 0;  newentry = 1;
-	  strcpy( pgstr, "B1_" );
-	 }
-	else
-	if (strcmp( word1, "L3b" ) == 0)
-	 { 
-	  if (pg > 0)
-	   {
-	    fprintf(outfile,"EndPDFpage.\n");
-	   }
-	  state = 9;  ncnt = 17;  total = 0.0;
-	  pg = 0;  cnt = 0;  newentry = 1;
-	  strcpy( pgstr, "B5_" );
-	 }
-	break;
-     case 8:
-	if (word1[0] == ';')
-	 {
-	  state = 0;
-	  if (pg > 0) 
-           {
-            fprintf(outfile,"Btotal = %8.2f\n", total );
-            fprintf(outfile,"EndPDFpage.\n");
-	    pg = 0;
-           }
-	 }
-	else
-	if ((word1[0] != '\0') && (word1[0] != '{'))
-	 {
-	  pull_comment( line, word2 );
-	  cnt++;
-	  if (cnt == ncnt)
-	   {
-	    if (pg > 0) 
-	     {
-		fprintf(outfile,"Btotal = %8.2f\n", total );
-		fprintf(outfile,"EndPDFpage.\n");
-	     }
-	    fprintf(outfile,"PDFpage: 11 11\n");
-	    fprintf(outfile,"SchedB_Additional_form:  Schedule B - Additional Interest Income\n");
-	    strcpy( pgstr, "Baddi_" );
-	    cnt = 1;	ncnt = 30;	total = 0.0;
-	    pg++;
-	   }
-	  fprintf(outfile," %s%d_Text: %s\n", pgstr, cnt, word2 );
-	  remove_certain_chars( word1, "," );
-	  if (sscanf( word1, "%lf", &value ) != 1)
-	   printf(" Error reading L2b value '%s'\n", word1 );
-	  else
-	   {
-	    fprintf(outfile," %s%d %8.2f\n", pgstr, cnt, value );
-	    total = total + value;
-	   }
-     	 }
-	break;
-     case 9:
-	if (word1[0] == ';') 
-	 {
-	  state = 0;
-	  if (pg > 0) 
-           {
-            fprintf(outfile,"Btotal = %8.2f\n", total );
-            fprintf(outfile,"EndPDFpage.\n");
-	    pg = 0;
-           }
-	 }
-	else
-	if ((word1[0] != '\0') && (word1[0] != '{'))
-	 {
-	  pull_comment( line, word2 );
-	  cnt++;
-	  if (cnt == ncnt)
-	   {
-	    if (pg > 0) 
-	     {
-		fprintf(outfile,"Btotal = %8.2f\n", total );
-		fprintf(outfile,"EndPDFpage.\n");
-	     }
-	    fprintf(outfile,"PDFpage: 11 11\n");
-	    fprintf(outfile,"SchedB_Additional_form:  Schedule B - Additional Dividend Income\n");
-	    strcpy( pgstr, "Baddi_" );
-	    cnt = 1;	ncnt = 30;	total = 0.0;
-	    pg++;
-	   }
-	  fprintf(outfile," %s%d_Text: %s\n", pgstr, cnt, word2 );
-	  remove_certain_chars( word1, "," );
-	  if (sscanf( word1, "%lf", &value ) != 1)
-	   printf(" Error reading L3b value '%s'\n", word1 );
-	  else
-	   {
-	    fprintf(outfile," %s%d %8.2f\n", pgstr, cnt, value );
-	    total = total + value;
-	   }
-     	 }
-	break;
+     if (pg > 0) 
+      {
+	results_fprintf(outfile,"Btotal = %8.2f\n", total );
+	results_fprintf(outfile,"EndPDFpage.\n");
+      }
+     results_fprintf(outfile,"PDFpage: 11 11\n");
+     results_fprintf(outfile,"SchedB_Additional_form:  %s\n", addimsg );
+     pgstr = "Baddi_";
+     cnt = 1;	ncnt = 30;	total = 0.0;
+     pg++;
     }
-   if (!newentry)
-    fgets( line, 200, infile );
-   else
-    newentry = 0;
+   results_fprintf(outfile," %s%d_Text: %s\n", pgstr, cnt, list->payer );
+   results_fprintf(outfile," %s%d %8.2f\n", pgstr, cnt, list->amount );
+   total = total + list->amount;
+   list = list->nxt;
   }
  if (pg > 0) 
   {
-   printf("Error: Missing ending ';' on L%d\n", state );
-   fprintf(outfile,"Btotal = %6.2f\n", total );
-   fprintf(outfile,"EndPDFpage.\n");
+   results_fprintf(outfile,"Btotal = %8.2f\n", total );
+   results_fprintf(outfile,"EndPDFpage.\n");
   }
- fclose(infile);
 }
 
 
@@ -1548,13 +2264,777 @@ void Calc_StudentLoan_Sched1L21()		/* Page 94 */
 
 
 
+/* Put this return's state, and that of the sub-forms compiled-in, back to its	*/
+/* initial values.  Run_return calls it (as reset_solver_state) before each return. */
+void reset_US_1040_state( void )
+{
+ memset( SchedA, 0, sizeof(SchedA) );
+ memset( SchedD, 0, sizeof(SchedD) );
+ memset( amtws, 0, sizeof(amtws) );
+ memset( Sched1, 0, sizeof(Sched1) );
+ memset( Sched2, 0, sizeof(Sched2) );
+ memset( Sched3, 0, sizeof(Sched3) );
+ Sched3_13a = Sched3_13b = Sched3_13c = Sched3_13d = Sched3_13e = 0.0;
+ Sched3_13f = Sched3_13g = Sched3_13h = Sched3_13z = 0.0;
+ L2a = L3a = L4a = L5a = L6a = 0.0;
+ L12a = L12b = 0.0;
+ L25a = L25b = L25c = 0.0;
+ L27a = L27b = L27c = 0.0;
+ S4_60b = 0.0;
+ memset( qcgws, 0, sizeof(qcgws) );
+ amtws2c = amtws2g = 0.0;
+ Do_SchedD = Do_QDCGTW = Do_SDTW = No;
+ status = 0;
+ under65 = Yes;
+ over65 = dependent = No;
+ force_print_all_pdf_forms = 0;
+ ForceItemize = 0;
+ memset( localtax, 0, sizeof(localtax) );
+ memset( homemort, 0, sizeof(homemort) );
+ loctaxlimit = 0.0;
+ collectibles_gains = 0.0;
+ memset( ws_sched_D, 0, sizeof(ws_sched_D) );
+ adjerrcnt = 0;
+ memset( &LastYearsReturn, 0, sizeof(LastYearsReturn) );
+ memset( short_trades, 0, sizeof(short_trades) );	/* (Their arrays were in the return_pool.) */
+ memset( long_trades, 0, sizeof(long_trades) );
+ memset( &lot_strings, 0, sizeof(lot_strings) );
+ total_sales = total_costs = total_adjs = 0.0;
+ summarize_8949 = itemize_8949_statement = 0;
+ statement_8949 = 0;
+ detect_wash_sales = 0;
+ memset( &short_summary, 0, sizeof(short_summary) );
+ memset( &long_summary, 0, sizeof(long_summary) );
+ num_1099b_files = 0;
+ import_1099b_columns = 0;
+ interest_payers = dividend_payers = 0;
+ sched_c_L32 = 0;
+ sched_se_L4a = sched_se_L4c = sched_se_L5a = sched_se_L5b = 0.0;
+ sched_se_L8a = sched_se_L8b = sched_se_L8c = sched_se_L8d = 0.0;
+ f8889_L17b = 0.0;
+ f8606_L15a = f8606_L15b = f8606_L15c = 0.0;
+ f8606_L25a = f8606_L25b = f8606_L25c = 0.0;
+ f8959_status = 0;
+}
+
+
+
+/*------------------------------------------------------------------------------*/
+/* Sensitivity - "-sensitivity label from:to:step" re-computes the return with	*/
+/*  the value read for one line (such as L1, S1_3, or CapGains-A/D) shifted by	*/
+/*  each amount from "from" to "to", and writes the total tax (L24), with its	*/
+/*  marginal and effective rates, at each shift to xxx_sensitivity.csv.	*/
+/*  The marginal rate is the change in tax from the previous shift, over the	*/
+/*  step; the effective rate is the tax over the total income (L9).		*/
+/*  A CapGains shift is entered as one more long-term lot in that section.	*/
+/*  The return's own lines (those before any sub-form sections) are compiled	*/
+/*  once, in memory, as ots_compile would, and that image is shared, read-	*/
+/*  only, by every point, so no point re-reads or re-converts the text.  Its	*/
+/*  sub-forms computed before the 1040 are not re-computed:  their results	*/
+/*  from the return itself are preset for every point.  Those that take the	*/
+/*  1040's AGI (the 8959 and 8960) are re-computed in every point, from that	*/
+/*  point's lines, out of the sections of the return's text.  Each point is	*/
+/*  computed in memory by run_return, with its input override set and its	*/
+/*  results discarded, by a fixed pool of worker threads, one per core,	*/
+/*  each taking the next point not yet taken until none are left.		*/
+/*------------------------------------------------------------------------------*/
+#define MAX_SENSITIVITY_POINTS	10000000
+#define MAX_SENSITIVITY_THREADS	64
+
+struct sensitivity_point
+ {
+  double delta;
+  double total_income, taxable_income, total_tax;	/* L9, L15, and L24 when shifted by delta. */
+  int result, hits;
+ };
+
+struct sensitivity_run		/* Shared by the workers.  Read-only, but for next_point, */
+ {
+  char *label;
+  char *image;			/* The return's own lines, compiled. */
+  long image_len;
+  int argc;
+  char **argv;
+  struct input_addition *presets;	/* Its earlier sub-forms' results. */
+  int npresets;
+  char *text;			/* The return's text, holding the sections of */
+  struct subform_run *late;	/*  the sub-forms each point re-computes, or 0. */
+  struct sensitivity_point *points;
+  int npoints, next_point;
+ } sensitivity;
+pthread_mutex_t sensitivity_lock=PTHREAD_MUTEX_INITIALIZER;	/* which is taken under this. */
+
+int taxsolve_US_1040( int argc, char *argv[] );			/* Prototypes. */
+long first_subform_section( char *text, long pos, long len );
+struct subform_run *late_subform_run( char *text, struct input_addition *presets, int *npresets );
+void free_late_subform_run( struct subform_run *late );
+
+THREAD_LOCAL struct subform_run *late_subforms=0;	/* Set for each point, from sensitivity.late. */
+
+
+void *sensitivity_worker( void *arg )
+{
+ struct sensitivity_point *pt;
+ int j;
+
+ quiet = 1;
+ discard_results = 1;
+ preloaded_input = sensitivity.image;
+ preloaded_input_len = sensitivity.image_len;
+ input_override_label = sensitivity.label;
+ input_presets = sensitivity.presets;
+ num_input_presets = sensitivity.npresets;
+ late_subforms = sensitivity.late;
+ for (;;)
+  { /* Take the next point, until none are left. */
+   pthread_mutex_lock( &sensitivity_lock );
+   j = sensitivity.next_point++;
+   pthread_mutex_unlock( &sensitivity_lock );
+   if (j >= sensitivity.npoints)
+    return 0;
+   pt = &(sensitivity.points[j]);
+   input_override_delta = pt->delta;
+   pt->result = run_return( taxsolve_US_1040, sensitivity.argc, sensitivity.argv );
+   pt->hits = input_override_hits;
+   pt->total_income = L[9];
+   pt->taxable_income = L[15];
+   pt->total_tax = L[24];
+  }
+}
+
+
+char *read_whole_file( char *fname, long *len )	/* Caller frees.  Returns zero on failure. */
+{
+ FILE *fp;
+ char *data;
+ long sz;
+
+ fp = taxsolve_fopen( fname, "rb" );
+ if (fp == 0) return 0;
+ fseek( fp, 0, SEEK_END );
+ sz = ftell( fp );
+ fseek( fp, 0, SEEK_SET );
+ data = (sz > 0) ? (char *)malloc( sz ) : 0;
+ if ((data != 0) && (fread( data, 1, sz, fp ) != sz))
+  { free( data );  data = 0; }
+ fclose( fp );
+ *len = sz;
+ return data;
+}
+
+
+/* Compile the return's own lines, as read from infname, into sensitivity.image. */
+void compile_sensitivity_image( char *infname )
+{
+ FILE *fp;
+ struct otsb_header *hdr;
+ char *text;
+ long len, start;
+
+ text = read_whole_file( infname, &len );
+ if (text == 0)
+  { console_printf("ERROR: Could not read '%s' for -sensitivity.\n", infname );  taxsolve_exit(1); }
+ if ((len >= OTSB_MAGIC_LEN) && (memcmp( text, OTSB_MAGIC, OTSB_MAGIC_LEN ) == 0))
+  { /* A compiled return:  re-compile the text it holds. */
+   hdr = (struct otsb_header *)text;
+   if ((len < sizeof(struct otsb_header)) || (hdr->text_offset > len) || (hdr->text_len > len - hdr->text_offset))
+    { console_printf("ERROR: '%s' is not a whole compiled return.\n", infname );  taxsolve_exit(1); }
+   len = hdr->text_len;
+   memmove( text, text + hdr->text_offset, len );
+  }
+ start = first_subform_section( text, 0, len );
+ preloaded_input = text;
+ preloaded_input_len = (start < 0) ? len : start;
+ preloaded_input_name = infname;
+ fp = taxsolve_fopen( infname, "r" );
+ sensitivity.image = (fp == 0) ? 0 : compile_input( fp, &(sensitivity.image_len) );
+ if (fp != 0)
+  {
+   release_input_file( fp );
+   fclose( fp );
+  }
+ preloaded_input = 0;
+ preloaded_input_len = 0;
+ preloaded_input_name = 0;
+ sensitivity.text = text;	/* (Kept for the sections of the sub-forms the points re-compute.) */
+ if (sensitivity.image == 0)
+  { console_printf("ERROR: Could not compile '%s' for -sensitivity.\n", infname );  taxsolve_exit(1); }
+}
+
+
+void run_sensitivity( int argc, char *argv[], char *infname, char *label, double from, double to, double step )
+{
+ struct sensitivity_point *points;
+ pthread_t workers[MAX_SENSITIVITY_THREADS];
+ char csvname[4096];
+ FILE *csvfile;
+ int npoints, nthreads=1, j, k;
+
+ npoints = (int)((to - from) / step + 1e-9) + 1;
+ points = (struct sensitivity_point *)calloc( npoints, sizeof(struct sensitivity_point) );
+ if (points == 0)
+  { console_printf("ERROR: Out of memory for %d sensitivity points.\n", npoints );  taxsolve_exit(1); }
+ for (j=0; j < npoints; j++)
+  points[j].delta = from + step * j;
+ sensitivity.label = label;
+ sensitivity.points = points;
+ sensitivity.npoints = npoints;
+ sensitivity.next_point = 0;
+ compile_sensitivity_image( infname );
+
+ /* The results of the sub-forms computed before the 1040, as added to its own lines, */
+ /* and the sections of those computed after its AGI, which each point re-computes.   */
+ sensitivity.npresets = num_input_additions;
+ sensitivity.presets = (struct input_addition *)malloc( (num_input_additions + 1) * sizeof(struct input_addition) );
+ memcpy( sensitivity.presets, input_additions, num_input_additions * sizeof(struct input_addition) );
+ sensitivity.late = late_subform_run( sensitivity.text, sensitivity.presets, &(sensitivity.npresets) );
+
+ /* The points re-run this return's command-line, less -sensitivity and any 8949 statement file. */
+ sensitivity.argv = (char **)calloc( argc + 2, sizeof(char *) );
+ sensitivity.argc = 0;
+ for (j=0; j < argc; j++)
+  if ((strcmp( argv[j], "-sensitivity" ) == 0) && (j + 2 < argc))
+   j = j + 2;
+  else
+  if (strcmp( argv[j], "-8949_statement" ) == 0)
+   sensitivity.argv[ sensitivity.argc++ ] = "-8949_summary";
+  else
+   sensitivity.argv[ sensitivity.argc++ ] = argv[j];
+ sensitivity.argv[ sensitivity.argc ] = 0;
+
+ #ifdef _SC_NPROCESSORS_ONLN
+  nthreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+ #endif
+ if (nthreads < 1) nthreads = 1;
+ if (nthreads > MAX_SENSITIVITY_THREADS) nthreads = MAX_SENSITIVITY_THREADS;
+ if (nthreads > npoints) nthreads = npoints;
+ for (j=0; j < nthreads; j++)
+  if (pthread_create( &(workers[j]), 0, sensitivity_worker, 0 ) != 0)
+   { console_printf("ERROR: Could not start a thread for -sensitivity.\n");  taxsolve_exit(1); }
+ for (j=0; j < nthreads; j++)
+  pthread_join( workers[j], 0 );
+
+ for (j=0; j < npoints; j++)
+  if (points[j].result != 0)
+   { console_printf("ERROR: Return failed with '%s' shifted by %.2f.\n", label, points[j].delta );  taxsolve_exit(1); }
+ if (points[0].hits == 0)
+  { console_printf("ERROR: Line '%s' is not read from '%s', so -sensitivity cannot shift it.\n", label, infname );  taxsolve_exit(1); }
+
+ strcpy( csvname, infname );
+ k = strlen( csvname ) - 1;
+ while ((k >= 0) && (csvname[k] != '.')) k--;
+ if (k < 0) strcat( csvname, "_sensitivity.csv" ); else strcpy( &(csvname[k]), "_sensitivity.csv" );
+ csvfile = taxsolve_fopen( csvname, "w" );
+ if (csvfile == 0)
+  { console_printf("ERROR: Sensitivity file '%s' could not be opened.\n", csvname );  taxsolve_exit(1); }
+ results_fprintf(csvfile,"%s Shift,Total Income (L9),Taxable Income (L15),Total Tax (L24),Marginal Rate,Effective Rate\n", label );
+ for (j=0; j < npoints; j++)
+  {
+   results_fprintf(csvfile,"%.2f,%.2f,%.2f,%.2f,", points[j].delta, points[j].total_income, points[j].taxable_income, points[j].total_tax );
+   if (j > 0)
+    results_fprintf(csvfile,"%.6f", (points[j].total_tax - points[j-1].total_tax) / step );
+   results_fprintf(csvfile,",");
+   if (points[j].total_income > 0.0)
+    results_fprintf(csvfile,"%.6f", points[j].total_tax / points[j].total_income );
+   results_fprintf(csvfile,"\n");
+  }
+ fclose( csvfile );
+ console_printf("Wrote %d sensitivity points for '%s' to file:  %s\n", npoints, label, csvname );
+
+ free( points );
+ free( sensitivity.image );
+ free( sensitivity.presets );
+ free( sensitivity.text );
+ free_late_subform_run( sensitivity.late );
+ free( sensitivity.argv );
+}
+
+
+
+/*------------------------------------------------------------------------------*/
+/* Integrated Sub-Forms - A return file may also hold the entries of the	*/
+/*  sub-forms whose results go on Schedules 1 and 2 (and lines 4b and 25c),	*/
+/*  each in a section after the 1040's own lines, begun by a line such as:	*/
+/*	Form:  US_1040_Sched_SE							*/
+/*  and followed by that form's usual input, from its Title line on.  The	*/
+/*  1040 then reads only the lines before the first section.  Each section	*/
+/*  is computed in-process, straight from the return's buffer, by the solver	*/
+/*  compiled-in above, with its results written to xxx_<form>_out.txt.  The	*/
+/*  forms are computed in the order their amounts flow:  first Schedule C	*/
+/*  (and the 8889 and 8606), then Schedule SE, then the 1040 up to its AGI,	*/
+/*  then the 8959 and 8960.  Sections computed at the same stage run at the	*/
+/*  same time, each on a thread of its own.  Each form's results are added	*/
+/*  to the lines they go on, of the 1040 and of the forms computed after it,	*/
+/*  as though they had been entered there, so those lines should hold only	*/
+/*  any other amounts:  Schedule C's net profit goes to Schedule 1 line 3	*/
+/*  and Schedule SE line 2 (but a loss not all at risk, box 32b, is limited	*/
+/*  by Form 6198, so is left for you to enter), Schedule SE's earnings go	*/
+/*  to 8959 line 8, and the 1040's wages, interest, dividends, capital gain,	*/
+/*  and AGI go to lines 1 of the 8959, and 1, 2, 5a and 13 of the 8960.  A	*/
+/*  form may have several sections (such as one Schedule C per business),	*/
+/*  whose results are summed.  Amounts go on to a form only when it has one	*/
+/*  section, since which of several (such as each spouse's Schedule SE) they	*/
+/*  belong to is not known.  (With -sensitivity, the 8959 and 8960 are re-	*/
+/*  computed at each point.)  Errors found with -validate are located by their	*/
+/*  line in the return's file.  A compiled return's sections are found in	*/
+/*  the text it holds.								*/
+/*------------------------------------------------------------------------------*/
+#define MAX_SUBFORMS		50
+#define MAX_SUBFORM_RESULTS	5
+#define MAX_SUBFORM_FEEDS	20
+
+#define SUBFORMS_FIRST		0	/* Stages, in the order computed. */
+#define SUBFORMS_SE		1
+#define SUBFORMS_AFTER_AGI	2
+
+struct subform_job
+ {
+  struct subform *form;
+  char *input;		/* The section's text, in the 1040's input buffer. */
+  long input_pos, input_len;	/* (Its offset there.) */
+  int first_line;	/* Its line in the return's file. */
+  char *infname;	/* Name the section is read under.  (It need not exist.) */
+  char *argv[5];
+  int argc, discard, result;
+  struct input_addition *presets;	/* Amounts from the forms computed before it. */
+  int npresets;
+  int nresults;
+  char *result_form[MAX_SUBFORM_RESULTS];	/* Form the result goes on, or 0 for the 1040. */
+  char *result_label[MAX_SUBFORM_RESULTS];
+  double result_amount[MAX_SUBFORM_RESULTS];
+  char *note;		/* Shown when the job is done. */
+  pthread_t thread;
+ };
+
+THREAD_LOCAL struct subform_run		/* This return's sections, from compute_subforms on. */
+ {
+  struct subform_job *jobs;
+  int njobs;
+  char *infname;
+  struct subform_feed
+   {
+    char *form, *label;
+    double amount;
+   } feeds[MAX_SUBFORM_FEEDS];	/* Amounts for the forms not yet computed. */
+  int nfeeds;
+  struct subform_feed early_feeds[MAX_SUBFORM_FEEDS];	/* Those from the forms before the 1040, */
+  int nearly_feeds;
+  struct input_addition *early_additions;		/*  and their results for its lines. */
+  int nearly_additions;
+ } subform_run;
+
+void subform_result( struct subform_job *job, char *label, double amount )
+{
+ job->result_form[ job->nresults ] = 0;
+ job->result_label[ job->nresults ] = label;
+ job->result_amount[ job->nresults++ ] = amount;
+}
+
+void subform_feed( struct subform_job *job, char *form, char *label, double amount )	/* To a later form. */
+{
+ job->result_form[ job->nresults ] = form;
+ job->result_label[ job->nresults ] = label;
+ job->result_amount[ job->nresults++ ] = amount;
+}
+
+/* Each form's results, taken on its thread just after it is computed. */
+
+void Sched_C_results( struct subform_job *job )
+{
+ if ((L[31] < 0.0) && (sched_c_L32 != Yes))
+  {
+   job->note = "Schedule C loss not all at risk (32b):  enter the loss allowed by Form 6198 on S1_3, and on Schedule SE line 2.";
+   return;
+  }
+ subform_result( job, "S1_3", L[31] );		/* Net profit or loss. */
+ subform_feed( job, "US_1040_Sched_SE", "L2", L[31] );
+}
+
+void Sched_SE_results( struct subform_job *job )
+{
+ subform_result( job, "S2_4", L[12] );		/* Self-employment tax. */
+ subform_result( job, "S1_15", L[13] );		/* Deductible part of it. */
+ subform_feed( job, "Form_8959", "L8", L[6] );	/* Net earnings from self-employment. */
+}
+
+void f8889_results( struct subform_job *job )
+{
+ subform_result( job, "S1_13", L[13] );		/* HSA deduction. */
+ subform_result( job, "S1_8e", L[16] );		/* Taxable HSA distributions. */
+ subform_result( job, "S1_8z", L[20] );		/* Income for failing to remain eligible. */
+ subform_result( job, "S2_17c", f8889_L17b );	/* Additional tax on distributions. */
+ subform_result( job, "S2_17d", L[21] );	/* Additional tax for failing to remain eligible. */
+}
+
+void f8606_results( struct subform_job *job )
+{
+ subform_result( job, "L4b", NotLessThanZero( f8606_L15c ) + L[18] + NotLessThanZero( f8606_L25c ) );	/* Taxable IRA amounts. */
+}
+
+void f8959_results( struct subform_job *job )
+{
+ subform_result( job, "S2_11", L[18] );		/* Additional Medicare Tax. */
+ subform_result( job, "L25c", L[24] );		/* Its withholding. */
+}
+
+void f8960_results( struct subform_job *job )
+{
+ subform_result( job, "S2_12", L[17] );		/* Net investment income tax. */
+}
+
+struct subform
+ {
+  char *name;		/* As on the section's Form: line. */
+  int stage;
+  int (*solve)( int argc, char *argv[] );
+  void (*results)( struct subform_job *job );
+ } subforms[]=
+ {
+  { "US_1040_Sched_C",	SUBFORMS_FIRST,	    taxsolve_US_1040_Sched_C,	Sched_C_results },
+  { "US_1040_Sched_SE",	SUBFORMS_SE,	    taxsolve_US_1040_Sched_SE,	Sched_SE_results },
+  { "HSA_Form_8889",	SUBFORMS_FIRST,	    taxsolve_HSA_f8889,		f8889_results },
+  { "Form_8606",	SUBFORMS_FIRST,	    taxsolve_f8606,		f8606_results },
+  { "Form_8959",	SUBFORMS_AFTER_AGI, taxsolve_f8959,		f8959_results },
+  { "Form_8960",	SUBFORMS_AFTER_AGI, taxsolve_f8960,		f8960_results },
+  { 0, 0, 0, 0 }
+ };
+
+
+void *compute_subform( void *arg )
+{
+ struct subform_job *job = (struct subform_job *)arg;
+
+ quiet = 1;
+ discard_results = job->discard;
+ preloaded_input = job->input;
+ preloaded_input_len = job->input_len;
+ preloaded_input_name = job->infname;
+ preloaded_input_first_line = job->first_line;
+ input_presets = job->presets;
+ num_input_presets = job->npresets;
+ job->result = run_return( job->form->solve, job->argc, job->argv );
+ if (job->result == 0)
+  job->form->results( job );
+ return 0;
+}
+
+
+/* Return where the next line begins, skipping any {comments} that span lines. */
+long next_section_line( char *text, long pos, long len )
+{
+ int incomment=0;
+ while (pos < len)
+  {
+   if (text[pos] == '{') incomment = 1;	/* (Comments do not nest.) */
+   else
+   if (text[pos] == '}') incomment = 0;
+   else
+   if ((text[pos] == '\n') && (!incomment))
+    return pos + 1;
+   pos++;
+  }
+ return len;
+}
+
+
+/* Return where the first line that begins a section is, from pos on, or -1 if none. */
+long first_subform_section( char *text, long pos, long len )
+{
+ long next, k;
+ for ( ; pos < len; pos = next)
+  {
+   next = next_section_line( text, pos, len );
+   for (k = pos; (k < next) && ((text[k] == ' ') || (text[k] == '\t')); k++);
+   if ((next - k >= 5) && (strncmp( &(text[k]), "Form:", 5 ) == 0))
+    return pos;
+  }
+ return -1;
+}
+
+
+/* Add an amount for a form not yet computed. */
+void feed_subform( char *form, char *label, double amount )
+{
+ struct subform_feed *fd;
+ int j;
+
+ for (j=0; j < subform_run.nfeeds; j++)
+  if ((strcmp( subform_run.feeds[j].form, form ) == 0) && (strcmp( subform_run.feeds[j].label, label ) == 0))
+   {
+    subform_run.feeds[j].amount = subform_run.feeds[j].amount + amount;
+    return;
+   }
+ if (subform_run.nfeeds == MAX_SUBFORM_FEEDS)
+  { console_printf("ERROR: More than %d amounts between sub-forms.\n", MAX_SUBFORM_FEEDS );  taxsolve_exit(1); }
+ fd = &(subform_run.feeds[ subform_run.nfeeds++ ]);
+ fd->form = form;
+ fd->label = label;
+ fd->amount = amount;
+}
+
+
+/* Compute the sections of one stage, at the same time, and add their results to */
+/* the lines they go on.  (Results for the 1040 go through add_to_input.)	  */
+void compute_subform_stage( int stage )
+{
+ struct subform_job *jobs=subform_run.jobs, *job;
+ char outfname[4096];
+ int failed=0, nsections, j, k, f;
+
+ for (j=0; j < subform_run.njobs; j++)
+  {
+   job = &(jobs[j]);
+   if (job->form->stage != stage)
+    continue;
+   for (nsections=0, k=0; k < subform_run.njobs; k++)
+    if (jobs[k].form == job->form) nsections++;
+   job->presets = (struct input_addition *)return_alloc( (MAX_SUBFORM_FEEDS + 1) * sizeof(struct input_addition) );
+   job->npresets = 0;
+   for (f=0; f < subform_run.nfeeds; f++)
+    if (strcmp( subform_run.feeds[f].form, job->form->name ) == 0)
+     {
+      if (nsections > 1)
+       {
+        console_printf("Note: '%s' has %d %s sections, so its %s is not filled-in from the other forms.\n",
+		subform_run.infname, nsections, job->form->name, subform_run.feeds[f].label );
+        continue;
+       }
+      job->presets[ job->npresets ].label = subform_run.feeds[f].label;
+      job->presets[ job->npresets++ ].amount = subform_run.feeds[f].amount;
+     }
+   if (pthread_create( &(job->thread), 0, compute_subform, job ) != 0)
+    { console_printf("ERROR: Could not start a thread for the sub-forms.\n");  taxsolve_exit(1); }
+  }
+ for (j=0; j < subform_run.njobs; j++)
+  if (jobs[j].form->stage == stage)
+   pthread_join( jobs[j].thread, 0 );
+
+ for (j=0; j < subform_run.njobs; j++)
+  {
+   job = &(jobs[j]);
+   if (job->form->stage != stage)
+    continue;
+   strcpy( outfname, job->infname );
+   strcpy( &(outfname[ strlen( outfname ) - 4 ]), "_out.txt" );
+   if (job->result != 0)
+    {
+     console_printf("ERROR: Could not compute the %s section of '%s'.  (See '%s'.)\n", job->form->name, subform_run.infname, outfname );
+     results_fprintf(outfile,"ERROR: Could not compute the %s section of '%s'.  (See '%s'.)\n", job->form->name, subform_run.infname, outfname );
+     failed = 1;
+     continue;
+    }
+   console_printf("Computed %s, with results in file:  %s\n", job->form->name, outfname );
+   if (job->note != 0)
+    {
+     console_printf(" %s\n", job->note );
+     results_fprintf(outfile,"%s\n", job->note );
+    }
+   for (k=0; k < job->nresults; k++)
+    if (job->result_form[k] == 0)
+     add_to_input( job->result_label[k], job->result_amount[k] );
+    else
+     feed_subform( job->result_form[k], job->result_label[k], job->result_amount[k] );
+  }
+ if (failed)
+  taxsolve_exit(1);
+}
+
+
+/* Find the sub-form sections of the return in infile, and compute those the 1040 */
+/* takes amounts from, adding their results to the 1040 lines they go on.  Leaves  */
+/* infile holding just the 1040's lines.  (The rest are computed once the 1040 has */
+/* its AGI, by compute_late_subforms.)						   */
+void compute_subforms( char *infname )
+{
+ struct input_buffer *ib, unbuffered;
+ struct subform_job *jobs;
+ char *text, name[100], *tail, outfname[4096];
+ long pos, start, next, k;
+ int njobs=0, line, j, n;
+
+ subform_run.njobs = 0;	/* (Any earlier return's jobs were in its return_pool.) */
+ subform_run.early_additions = 0;
+ if (late_subforms != 0)
+  { /* A -sensitivity point, whose input holds only the 1040's lines:  re-compute */
+    /* the sections computed after its AGI, with the earlier forms' amounts.	   */
+   subform_run = *late_subforms;
+   subform_run.jobs = (struct subform_job *)return_alloc( late_subforms->njobs * sizeof(struct subform_job) );
+   memcpy( subform_run.jobs, late_subforms->jobs, late_subforms->njobs * sizeof(struct subform_job) );
+   return;
+  }
+ ib = get_input_buffer( infile, &unbuffered );
+ if (ib->data == 0)
+  return;
+ text = ib->data;	/* (Of a compiled return, the text it holds.) */
+ start = first_subform_section( text, ib->pos, ib->len );
+ if (start < 0)
+  return;
+
+ jobs = (struct subform_job *)return_alloc( MAX_SUBFORMS * sizeof(struct subform_job) );
+ memset( jobs, 0, MAX_SUBFORMS * sizeof(struct subform_job) );
+ tail = return_strdup( infname );	/* Sections are named after the return:  xxx_<form>.txt */
+ k = strlen( tail ) - 1;
+ while ((k >= 0) && (tail[k] != '.')) k--;
+ if (k >= 0) tail[k] = '\0';
+ for (line=1, k=0; k < start; k++)
+  if (text[k] == '\n') line++;
+ for (pos = start; pos < ib->len; pos = next)
+  {
+   next = next_section_line( text, pos, ib->len );
+   for (k = pos; (k < next) && ((text[k] == ' ') || (text[k] == '\t')); k++);
+   if ((next - k >= 5) && (strncmp( &(text[k]), "Form:", 5 ) == 0))
+    { /* Start a new section. */
+     for (k = k + 5; (k < next) && isspace( text[k] ); k++);
+     for (n = 0; (k < next) && (n < 99) && !isspace( text[k] ) && (text[k] != '{'); k++)
+      name[n++] = text[k];
+     name[n] = '\0';
+     for (j=0; (subforms[j].name != 0) && (strcmp( subforms[j].name, name ) != 0); j++);
+     if (subforms[j].name == 0)
+      {
+       console_printf("ERROR: Unknown form '%s' in '%s'.\n", name, infname );
+       results_fprintf(outfile,"ERROR: Unknown form '%s' in '%s'.\n", name, infname );
+       taxsolve_exit(1);
+      }
+     if (njobs == MAX_SUBFORMS)
+      {
+       console_printf("ERROR: More than %d sub-form sections in '%s'.\n", MAX_SUBFORMS, infname );
+       results_fprintf(outfile,"ERROR: More than %d sub-form sections in '%s'.\n", MAX_SUBFORMS, infname );
+       taxsolve_exit(1);
+      }
+     jobs[njobs].form = &(subforms[j]);
+     jobs[njobs].input = &(text[next]);
+     jobs[njobs].input_pos = next;
+     for (k = pos; k < next; k++)	/* The section begins on the line after its Form: line. */
+      if (text[k] == '\n') line++;
+     jobs[njobs].first_line = line;
+     for (n=0, k=0; k < njobs; k++)	/* Number any repeats of a form. */
+      if (jobs[k].form == jobs[njobs].form) n++;
+     if (n == 0)
+      sprintf( outfname, "%.3900s_%s.txt", tail, name );
+     else
+      sprintf( outfname, "%.3900s_%s_%d.txt", tail, name, n + 1 );
+     jobs[njobs].infname = return_strdup( outfname );
+     jobs[njobs].argc = 0;
+     jobs[njobs].argv[ jobs[njobs].argc++ ] = subforms[j].name;
+     if (labels_any_order)
+      jobs[njobs].argv[ jobs[njobs].argc++ ] = "-labels_any_order";
+     if (validate_input)
+      jobs[njobs].argv[ jobs[njobs].argc++ ] = "-validate";
+     jobs[njobs].argv[ jobs[njobs].argc++ ] = jobs[njobs].infname;
+     jobs[njobs].discard = discard_results;
+     njobs++;
+    }
+   else
+    for (k = pos; k < next; k++)
+     if (text[k] == '\n') line++;
+   jobs[njobs-1].input_len = next - (jobs[njobs-1].input - text);
+  }
+ limit_input_buffer( ib, start );	/* The 1040 reads only its own lines. */
+
+ subform_run.jobs = jobs;
+ subform_run.njobs = njobs;
+ subform_run.infname = infname;
+ subform_run.nfeeds = 0;
+ compute_subform_stage( SUBFORMS_FIRST );
+ compute_subform_stage( SUBFORMS_SE );
+}
+
+
+/* Compute the sections that take the 1040's wages and AGI (the 8959 and 8960), */
+/* once it has them, and add their results to its lines.			 */
+void compute_late_subforms( void )
+{
+ int j, k;
+
+ if (subform_run.njobs == 0)
+  return;
+ /* What the forms before the 1040 gave, which -sensitivity's points keep. */
+ memcpy( subform_run.early_feeds, subform_run.feeds, subform_run.nfeeds * sizeof(struct subform_feed) );
+ subform_run.nearly_feeds = subform_run.nfeeds;
+ subform_run.early_additions = (struct input_addition *)return_alloc( (num_input_additions + 1) * sizeof(struct input_addition) );
+ memcpy( subform_run.early_additions, input_additions, num_input_additions * sizeof(struct input_addition) );
+ subform_run.nearly_additions = num_input_additions;
+
+ feed_subform( "Form_8959", "L1", L[1] );	/* Wages. */
+ feed_subform( "Form_8960", "L1", L[2] );	/* Taxable interest. */
+ feed_subform( "Form_8960", "L2", L[3] );	/* Ordinary dividends. */
+ feed_subform( "Form_8960", "L5a", L[7] );	/* Capital gain or loss. */
+ feed_subform( "Form_8960", "L13", L[11] );	/* Modified AGI. */
+ compute_subform_stage( SUBFORMS_AFTER_AGI );
+
+ /* Line 25c was read before the 8959 could be computed, so its withholding is added here. */
+ for (j=0; j < subform_run.njobs; j++)
+  if ((subform_run.jobs[j].form->stage == SUBFORMS_AFTER_AGI) && (subform_run.jobs[j].result == 0))
+   for (k=0; k < subform_run.jobs[j].nresults; k++)
+    if ((subform_run.jobs[j].result_form[k] == 0) && (strcmp( subform_run.jobs[j].result_label[k], "L25c" ) == 0))
+     {
+      L25c = L25c + subform_run.jobs[j].result_amount[k];
+      L[25] = L[25] + subform_run.jobs[j].result_amount[k];
+     }
+}
+
+
+/* For -sensitivity:  The sections of this return computed after its AGI, as read	*/
+/* from text (the return's file), with the amounts the earlier forms gave them.	*/
+/* Returns 0 when there are none.  Otherwise, replaces presets (which hold all the	*/
+/* sub-forms' results) with just the earlier forms' results.  (Allocated, for the	*/
+/* points' threads to share.)							*/
+struct subform_run *late_subform_run( char *text, struct input_addition *presets, int *npresets )
+{
+ struct subform_run *late;
+ struct subform_job *job;
+ int j;
+
+ if ((subform_run.njobs == 0) || (subform_run.early_additions == 0))
+  return 0;
+ late = (struct subform_run *)malloc( sizeof(struct subform_run) );
+ *late = subform_run;
+ late->jobs = (struct subform_job *)calloc( subform_run.njobs, sizeof(struct subform_job) );
+ late->njobs = 0;
+ memcpy( late->feeds, subform_run.early_feeds, subform_run.nearly_feeds * sizeof(struct subform_feed) );
+ late->nfeeds = subform_run.nearly_feeds;
+ for (j=0; j < subform_run.njobs; j++)
+  if (subform_run.jobs[j].form->stage == SUBFORMS_AFTER_AGI)
+   {
+    job = &(late->jobs[ late->njobs++ ]);
+    *job = subform_run.jobs[j];
+    job->input = &(text[ job->input_pos ]);
+    job->discard = 1;
+    job->result = job->nresults = 0;
+    job->note = 0;
+   }
+ if (late->njobs == 0)
+  {
+   free( late->jobs );
+   free( late );
+   return 0;
+  }
+ memcpy( presets, subform_run.early_additions, subform_run.nearly_additions * sizeof(struct input_addition) );
+ *npresets = subform_run.nearly_additions;
+ return late;
+}
+
+
+void free_late_subform_run( struct subform_run *late )
+{
+ if (late == 0)
+  return;
+ free( late->jobs );
+ free( late );
+}
+
+
+
+
 /*----------------------------------------------------------------------*/
 /* Main									*/
 /*----------------------------------------------------------------------*/
-int main( int argc, char *argv[] )						/* Updated for 2021. */
+/* Compute one return.  Called by main, or by run_return for each of several returns computed at once. */
+int taxsolve_US_1040( int argc, char *argv[] )					/* Updated for 2021. */
 {
  int argk, j, k, itemize=0;
- char word[2000], outfname[2000], *infname="", labelx[1024]="";
+ char word[8192], outfname[2000], *infname="", labelx[8192]="", markupline[8192];
+ char timestr[100], amt[AMOUNT_BUFSZ];
  time_t now;
  double exemption_threshold=0.0, tmpval=0.0;
  double S_STD_DEDUC, MFS_STD_DEDUC, MFJ_STD_DEDUC, HH_STD_DEDUC, std_deduc;
@@ -1566,40 +3046,78 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  double ntcpe=0.0, pyei=0.0;
  double Sched2_17[50];
  char *S2_17a_Type, *S2_17z_Type, *S3_6z_Type, *S3_13z_Type;
+ char *sensitivity_label=0;
+ double sensitivity_from=0.0, sensitivity_to=0.0, sensitivity_step=0.0;
 
 
  /* Decode any command-line arguments. */
- printf("US 1040 2021 - v%3.2f\n", thisversion);
+ console_printf("US 1040 2021 - v%3.2f\n", thisversion);
  argk = 1;  k=1;
  while (argk < argc)
  {
   if (strcmp(argv[argk],"-verbose")==0)  { verbose = Yes; }
   else
+  if (strcmp(argv[argk],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[argk],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[argk],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[argk],"-allforms")==0)  { force_print_all_pdf_forms = 1; }
   else
   if (strcmp(argv[argk],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
+  if (strcmp(argv[argk],"-8949_summary")==0)  { summarize_8949 = 1; }
+  else
+  if (strcmp(argv[argk],"-8949_statement")==0)  { summarize_8949 = 1;  itemize_8949_statement = 1; }
+  else
+  if (strcmp(argv[argk],"-wash_sales")==0)  { detect_wash_sales = 1; }
+  else
+  if ((strcmp(argv[argk],"-1099b")==0) && (argk + 1 < argc))
+   {
+    if (num_1099b_files == MAX_1099B_FILES)
+     {console_printf("ERROR: At most %d -1099b files.\n", MAX_1099B_FILES ); taxsolve_exit(1);}
+    import_1099b_files[ num_1099b_files++ ] = argv[++argk];
+   }
+  else
+  if ((strcmp(argv[argk],"-1099b_columns")==0) && (argk + 1 < argc))  { import_1099b_columns = argv[++argk]; }
+  else
+  if ((strcmp(argv[argk],"-sensitivity")==0) && (argk + 2 < argc))
+   {
+    sensitivity_label = argv[++argk];
+    argk++;
+    if ((sscanf( argv[argk], "%lf:%lf:%lf", &sensitivity_from, &sensitivity_to, &sensitivity_step ) != 3)
+	|| (sensitivity_step <= 0.0) || (sensitivity_to < sensitivity_from)
+	|| ((sensitivity_to - sensitivity_from) / sensitivity_step >= MAX_SENSITIVITY_POINTS))
+     {console_printf("ERROR: Bad -sensitivity range '%s'.  Expected from:to:step, with at most %d steps.\n", argv[argk], MAX_SENSITIVITY_POINTS ); taxsolve_exit(1);}
+   }
+  else
   if (k==1)
    {
-    infname = strdup( argv[argk] );
-    infile = fopen( infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup( argv[argk] );
+    infile = taxsolve_fopen( infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); taxsolve_exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname, infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); taxsolve_exit(1);}
+    if (!discard_results)
+     start_fed_snapshot();	/* The state returns' snapshot is recorded as the results are written. */
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[argk]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[argk]); taxsolve_exit(1);}
   argk = argk + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); taxsolve_exit(1);}
+ compute_subforms( infname );
+ if (itemize_8949_statement)
+  open_8949_statement( outfname );
 
  /* Pre-initialize all lines to zeros. */
  for (j=0; j<MAX_LINES; j++)
@@ -1614,6 +3132,11 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
    amtws[j] = 0.0; 
    qcgws[j] = 0.0;
   }
+ memset( &short_trades, 0, sizeof(short_trades) );	/* (Any earlier return's lots went with its pool.) */
+ memset( &long_trades, 0, sizeof(long_trades) );
+ memset( &lot_strings, 0, sizeof(lot_strings) );
+ memset( &short_summary, 0, sizeof(short_summary) );
+ memset( &long_summary, 0, sizeof(long_summary) );
 
  /* Accept parameters from input file. */
  /* Expect  US-Fed-1040 lines, something like:
@@ -1626,7 +3149,12 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ) );
+ #ifndef __MINGW32__
+  ctime_r( &now, timestr );
+ #else
+  strcpy( timestr, ctime( &now ) );	/* Microsoft's ctime buffer is already per-thread. */
+ #endif
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, timestr );
 
  get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/sep, Head house, Widow(er) */
  get_parameter( infile, 'l', word, "Status?");
@@ -1637,11 +3165,11 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
-   exit(1);
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   taxsolve_exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  get_parameter( infile, 's', word, "You_65+Over?" );	/* Were you born before January 2, 1957 ? (Y/N) */
  get_parameter( infile, 'b', &j, "You_65+Over?" );
@@ -1651,14 +3179,14 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  else
   {
    under65 = 0;
-   fprintf(outfile,"CkYouOver65 X\n");
+   results_fprintf(outfile,"CkYouOver65 X\n");
   }
 
  get_parameter( infile, 's', word, "You_Blind?" );	/* Are you blind ? (Y/N) */
  get_parameter( infile, 'b', &j, "You_Blind?" );
  StdDedChart_NumBoxesChecked = StdDedChart_NumBoxesChecked + j;
  if (j)
-  fprintf(outfile,"CkYouBlind X\n");
+  results_fprintf(outfile,"CkYouBlind X\n");
 
  get_parameter( infile, 's', word, "Spouse_65+Over?" );	/* Was Spouse born before January 2, 1957 ? (Y/N) */
  get_param_single_line( infile, 'b', &j, "Spouse_65+Over?" );
@@ -1666,22 +3194,22 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  if (j == 0)
   under65++;
  else
-  fprintf(outfile,"CkSpouseOver65 X\n");
+  results_fprintf(outfile,"CkSpouseOver65 X\n");
 
  get_parameter( infile, 's', word, "Spouse_Blind?" );	/* Is Spouse blind ? (Y/N) */
  get_param_single_line( infile, 'b', &j, "Spouse_Blind?" );
  StdDedChart_NumBoxesChecked = StdDedChart_NumBoxesChecked + j;
  if (j)
-  fprintf(outfile,"CkSpouseBlind X\n");
+  results_fprintf(outfile,"CkSpouseBlind X\n");
 
  switch (status)
   {
-   case SINGLE: fprintf(outfile,"CkSingle X\nCkYourself X\nL6ab = 1\n");  break;
-   case MARRIED_FILING_JOINTLY: fprintf(outfile,"CkMFJ X\nCkYourself X\nCkSpouse X\nL6ab = 2\n");  break;
-   case MARRIED_FILING_SEPARAT: fprintf(outfile,"CkMFS X\nCkYourself X\nL6ab = 1\n");  break;
-   case HEAD_OF_HOUSEHOLD: fprintf(outfile,"CkHH X\nCkYourself X\nL6ab = 1\n");  break;
-   case WIDOW: fprintf(outfile,"CkQW X\nCkYourself X\nL6ab = 1\n");  break;
-   default: printf("Error: Unknown filing status %d.\n", status );
+   case SINGLE: results_fprintf(outfile,"CkSingle X\nCkYourself X\nL6ab = 1\n");  break;
+   case MARRIED_FILING_JOINTLY: results_fprintf(outfile,"CkMFJ X\nCkYourself X\nCkSpouse X\nL6ab = 2\n");  break;
+   case MARRIED_FILING_SEPARAT: results_fprintf(outfile,"CkMFS X\nCkYourself X\nL6ab = 1\n");  break;
+   case HEAD_OF_HOUSEHOLD: results_fprintf(outfile,"CkHH X\nCkYourself X\nL6ab = 1\n");  break;
+   case WIDOW: results_fprintf(outfile,"CkQW X\nCkYourself X\nL6ab = 1\n");  break;
+   default: console_printf("Error: Unknown filing status %d.\n", status );
   }
 
  GetLine1( "Dependents", &NumDependents );
@@ -1689,16 +3217,16 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  get_parameter( infile, 's', word, "VirtCurr?" );	/* During the year, did you have Virtual Currency? (Y/N) */
  get_parameter( infile, 'b', &j, "VirtCurr?" );
  if (j == 0)
-  fprintf(outfile,"ChkVirtNo X\n");
+  results_fprintf(outfile,"ChkVirtNo X\n");
  else
-  fprintf(outfile,"ChkVirtYes X\n");
+  results_fprintf(outfile,"ChkVirtYes X\n");
 
  GetLineF( "L1", &L[1] );	/* Wages, salery, tips (W-2). */
  GetLineFnz( "L2a", &L2a );	/* Tax-exempt interest. (only for SocialSecurity calculations) */
- GetLineF( "L2b", &L[2] );	/* Taxable interest. (Sched-B) */
+ GetPayerLinesF( "L2b", &L[2], &interest_payers );	/* Taxable interest. (Sched-B) */
  GetLineF( "L3a", &L3a );	/* Qualified Dividends. (Sched-B) */
  if (L3a > 0.0) Do_QDCGTW = Yes;	
- GetLineF( "L3b", &L[3] );	/* Ordinary Dividends. (Sched-B) */
+ GetPayerLinesF( "L3b", &L[3], &dividend_payers );	/* Ordinary Dividends. (Sched-B) */
  GetLineF( "L4a", &L4a );	/* IRAs distributions. */
  GetLineF( "L4b", &L[4] );	/* Taxable IRAs distributions. */
  GetLineF( "L5a", &L5a );	/* Pensions and annuities. */
@@ -1728,7 +3256,7 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 
 
  /* Determine your Std. Deduction value. */
- fprintf(outfile, "StdDedChart_NumBoxesChecked = %d\n", StdDedChart_NumBoxesChecked ); 
+ results_fprintf(outfile, "StdDedChart_NumBoxesChecked = %d\n", StdDedChart_NumBoxesChecked ); 
  if (StdDedChart_NumBoxesChecked == 0)
   {
    S_STD_DEDUC   = 12500.0;						/* Updated for 2021. */
@@ -1764,11 +3292,11 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 	S_STD_DEDUC   = 15950.0;	/* Cannot happen, but set to appease compiler. */
 	HH_STD_DEDUC  = 22200.0;	/* .. */
 	break;
-      default:  fprintf(outfile,"Error: StdDedChart_NumBoxesChecked (%d) not equal to 1, 2, 3, or 4.\n", StdDedChart_NumBoxesChecked );
-		printf("Error: StdDedChart_NumBoxesChecked (%d) not equal to 1, 2, 3, or 4.\n", StdDedChart_NumBoxesChecked );
-		exit(1); 
+      default:  results_fprintf(outfile,"Error: StdDedChart_NumBoxesChecked (%d) not equal to 1, 2, 3, or 4.\n", StdDedChart_NumBoxesChecked );
+		console_printf("Error: StdDedChart_NumBoxesChecked (%d) not equal to 1, 2, 3, or 4.\n", StdDedChart_NumBoxesChecked );
+		taxsolve_exit(1); 
      }
-    fprintf(outfile,"  (Assuming no one is claiming you, or your joint-spouse, as a dependent.)\n");
+    results_fprintf(outfile,"  (Assuming no one is claiming you, or your joint-spouse, as a dependent.)\n");
   }
 
  switch (status)
@@ -1782,7 +3310,7 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 		std_deduc = MFJ_STD_DEDUC;	break;
    case HEAD_OF_HOUSEHOLD:
 		std_deduc = HH_STD_DEDUC;	break;
-   default:  printf("Case (Line 12) not handled.\n"); fprintf(outfile,"Case (Line 12) not handled.\n"); exit(1);
+   default:  console_printf("Case (Line 12) not handled.\n"); results_fprintf(outfile,"Case (Line 12) not handled.\n"); taxsolve_exit(1);
   }
 
 
@@ -1920,7 +3448,7 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   {
    get_parameters( infile, 'b', &j, "CheckBoxA5a" );
    if (j)
-    fprintf(outfile,"CheckBoxA5a X\n");
+    results_fprintf(outfile,"CheckBoxA5a X\n");
    GetLine( "A5b", &localtax[2] );
   }
  else
@@ -1930,9 +3458,9 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   }
  else
   {
-   printf("Error: Found '%s' when expecteding CheckBoxA5a or A5b,\n", labelx );
-   fprintf(outfile,"Error: Found '%s' when expecteding CheckBoxA5a or A5b,\n", labelx );
-   exit(1);
+   console_printf("Error: Found '%s' when expecteding CheckBoxA5a or A5b,\n", labelx );
+   results_fprintf(outfile,"Error: Found '%s' when expecteding CheckBoxA5a or A5b,\n", labelx );
+   taxsolve_exit(1);
   }
  // GetLine( "A5b", &localtax[2] );	/* State and local real estate taxes. */	/* Optionally read-in just above. */
  GetLine( "A5c", &localtax[3] );	/* State and local personal property (eg. automobile) taxes. */
@@ -1955,9 +3483,9 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   }
  else
   {
-   printf("Error: Found '%s' when expecteding A8d,\n", labelx );
-   fprintf(outfile,"Error: Found '%s' when expecteding A8d,\n", labelx );
-   exit(1);
+   console_printf("Error: Found '%s' when expecteding A8d,\n", labelx );
+   results_fprintf(outfile,"Error: Found '%s' when expecteding A8d,\n", labelx );
+   taxsolve_exit(1);
   }
  // GetLine( "A9", &SchedA[9] );	/* Investment interest. Attach Form 4952*/	/* Optionally read-in just above. */
  GetLine( "A11", &SchedA[11] );	/* Charity contributions by cash or check.*/
@@ -1982,12 +3510,13 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   }
  else
   {
-   printf("Error: Found '%s' when expecteding A18 or B7a.\n", labelx );
-   fprintf(outfile,"Error: Found '%s' when expecteding A18 or B7a\n", labelx );
-   exit(1);
+   console_printf("Error: Found '%s' when expecteding A18 or B7a.\n", labelx );
+   results_fprintf(outfile,"Error: Found '%s' when expecteding A18 or B7a\n", labelx );
+   taxsolve_exit(1);
   }
 
  L[11] = L[9] - L[10];
+ compute_late_subforms();	/* The 8959 and 8960, which take the AGI. */
 
  /* -- Calculate Schedule A -- */
  SchedA[2] = L[11];
@@ -2013,26 +3542,26 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
    L12b = 0.0;		/* Charity contribs are handled in Sched-A above. */
    if (ForceItemize)
     {
-     printf(" You elected to itemize deductions, even though they may be less than your Standard Deduction.\n");
-     fprintf(outfile," You elected to itemize deductions, even though they may be less than your Standard Deduction.\n");
-     printf("  (Itemizations = %6.2f, Std-Deduction = %6.2f)\n", L12a, std_deduc );
-     fprintf(outfile,"  (Itemizations = %6.2f, Std-Deduction = %6.2f)\n", L12a, std_deduc );
+     console_printf(" You elected to itemize deductions, even though they may be less than your Standard Deduction.\n");
+     results_fprintf(outfile," You elected to itemize deductions, even though they may be less than your Standard Deduction.\n");
+     console_printf("  (Itemizations = %6.2f, Std-Deduction = %6.2f)\n", L12a, std_deduc );
+     results_fprintf(outfile,"  (Itemizations = %6.2f, Std-Deduction = %6.2f)\n", L12a, std_deduc );
     }
    else
     {
-     printf("  (Itemizations > Std-Deduction, %6.2f > %6.2f)\n", L12a, std_deduc );
-     fprintf(outfile,"	(Itemizations > Std-Deduction, %6.2f > %6.2f)\n", L12a, std_deduc );
+     console_printf("  (Itemizations > Std-Deduction, %6.2f > %6.2f)\n", L12a, std_deduc );
+     results_fprintf(outfile,"	(Itemizations > Std-Deduction, %6.2f > %6.2f)\n", L12a, std_deduc );
     }
-   fprintf(outfile,"Itemizing.\n");
+   results_fprintf(outfile,"Itemizing.\n");
   } /*Select_to_Itemize*/
  else
   { /*Select_to_use_StdDeduction*/
    itemize = No;
    L12a = std_deduc;		/* Take the Std.Deduction. */
    /* Leave the above tentative L12b deduction of charity contribs here when not itemizing. */
-   printf("  (Itemizations < Std-Deduction + Charity-Deduction, %6.2f < %6.2f)\n", SchedA[17], std_deduc );
-   fprintf(outfile,"  (Itemizations < Std-Deduction + Charity-Deduction, %6.2f < %6.2f)\n", SchedA[17], std_deduc + L12b);
-   fprintf(outfile,"Use standard deduction.\n");
+   console_printf("  (Itemizations < Std-Deduction + Charity-Deduction, %6.2f < %6.2f)\n", SchedA[17], std_deduc );
+   results_fprintf(outfile,"  (Itemizations < Std-Deduction + Charity-Deduction, %6.2f < %6.2f)\n", SchedA[17], std_deduc + L12b);
+   results_fprintf(outfile,"Use standard deduction.\n");
   } /*Select_to_use_StdDeduction*/
 
  L[12] = L12a + L12b;
@@ -2065,7 +3594,7 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   showschedA(16);
   showschedA(17);
   if (ForceItemize)
-   fprintf(outfile,"CheckBoxA18 = X\n");
+   results_fprintf(outfile,"CheckBoxA18 = X\n");
 
  showline_wlabel( "L6b", L[6] ); 
  showline( 7 );
@@ -2080,10 +3609,10 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 
  if ((L[2] != 0.0) || (L[3] != 0.0))
   {
-   fprintf(outfile," Schedule-B:\n");
-   fprintf(outfile,"  B2 = %6.2f\n", L[2] );
-   fprintf(outfile,"  B4 = %6.2f\n", L[2] );
-   fprintf(outfile,"  B6 = %6.2f\n", L[3] );
+   results_fprintf(outfile," Schedule-B:\n");
+   results_fprintf(outfile,"  B2 = %6.2f\n", L[2] );
+   results_fprintf(outfile,"  B4 = %6.2f\n", L[2] );
+   results_fprintf(outfile,"  B6 = %6.2f\n", L[3] );
   }
 
 
@@ -2109,9 +3638,9 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
   }
  if (L[11] < exemption_threshold)
   {
-   printf(" (L11 = %3.2f < Threshold = %3.2f)\n", L[11], exemption_threshold );
-   printf("You may not need to file a return, due to your income level.\n\n"); 
-   fprintf(outfile,"You may not need to file a return, due to your income level.\n\n");
+   console_printf(" (L11 = %3.2f < Threshold = %3.2f)\n", L[11], exemption_threshold );
+   console_printf("You may not need to file a return, due to your income level.\n\n"); 
+   results_fprintf(outfile,"You may not need to file a return, due to your income level.\n\n");
   }
 
  if (itemize)
@@ -2133,7 +3662,7 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 
  if (L[15] <= 0.0) 
   { /*exception*/	/* See rules on top of "Schedule D Tax Worksheet", pg 16 of Sched-D Instructions. */
-    printf(" Exception (Sched-D Instructions page D-16) - Do not use QDCGT or Sched-D Tax Worksheets.\n");
+    console_printf(" Exception (Sched-D Instructions page D-16) - Do not use QDCGT or Sched-D Tax Worksheets.\n");
   } /*exception*/
  else
   { /*no_exception*/
@@ -2141,13 +3670,13 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
     Do_QDCGTW = Yes;
    if (Do_QDCGTW)
     {
-     fprintf(outfile,"Doing 'Qualified Dividends and Capital Gain tax Worksheet', page 33.\n");
+     results_fprintf(outfile,"Doing 'Qualified Dividends and Capital Gain tax Worksheet', page 33.\n");
      capgains_qualdividends_worksheets( status );
     }
    else
    if (Do_SDTW)
    {
-    fprintf(outfile,"Doing 'Schedule D Tax Worksheet', page D16.\n");
+    results_fprintf(outfile,"Doing 'Schedule D Tax Worksheet', page D16.\n");
     sched_D_tax_worksheet( status );
    }
   } /*no_exception*/
@@ -2161,23 +3690,23 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  GetYesNo( "B8", &SchedB8 );
 
  if (SchedB7a)
-  fprintf(outfile,"CkB7a_Y X\n");
+  results_fprintf(outfile,"CkB7a_Y X\n");
  else
-  fprintf(outfile,"CkB7a_N X\n");
+  results_fprintf(outfile,"CkB7a_N X\n");
 
  if (SchedB7aa == 1)
-  fprintf(outfile,"CkB7aa_Y X\n");
+  results_fprintf(outfile,"CkB7aa_Y X\n");
  else
  if (SchedB7aa == 0)
-  fprintf(outfile,"CkB7aa_N X\n");
+  results_fprintf(outfile,"CkB7aa_N X\n");
 
  if (strlen( SchedB7b ) > 0)
-  fprintf(outfile,"B7b = %s\n", SchedB7b );
+  results_fprintf(outfile,"B7b = %s\n", SchedB7b );
 
  if (SchedB8)
-  fprintf(outfile,"CkB8_Y X\n");
+  results_fprintf(outfile,"CkB8_Y X\n");
  else
-  fprintf(outfile,"CkB8_N X\n");
+  results_fprintf(outfile,"CkB8_N X\n");
 
 
  /* -- Alternative Minimum Tax (AMT) Entries (if needed) -- */
@@ -2257,10 +3786,10 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
 
  Sched2[1] = form6251_AlternativeMinimumTax( itemize );		/* (Depends on Sched2[2] & Sched3[1].) */
  if (Sched2[1] == 0.0)
-  fprintf(outfile," (Not subject to Alternative Minimum Tax.)\n");
+  results_fprintf(outfile," (Not subject to Alternative Minimum Tax.)\n");
  else
   {
-   fprintf(outfile," (You must pay Alternative Minimum Tax.)\n");
+   results_fprintf(outfile," (You must pay Alternative Minimum Tax.)\n");
    showline_wlabelmsg( "S2_1", Sched2[1], "Alternative Minimum Tax" );
   }
  Sched2[3] = Sched2[1] + Sched2[2];
@@ -2271,14 +3800,14 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
    showline_wlabelnz( word, Sched2[j] );
   }
  showline_wlabelnz( "S2_17a", Sched2_17[0] );
- printf("S2_17a_Type: %s\n", S2_17a_Type );
- fprintf(outfile,"S2_17a_Type: %s\n", S2_17a_Type );
+ console_printf("S2_17a_Type: %s\n", S2_17a_Type );
+ results_fprintf(outfile,"S2_17a_Type: %s\n", S2_17a_Type );
  for (j=2; j <= nnn; j++)
   { 
    sprintf(word,"S2_17%c", 'a' + j - 1 );
    showline_wlabelnz( word, Sched2_17[j] );
   }
- fprintf(outfile,"S2_17z_Type: %s\n", S2_17z_Type );
+ results_fprintf(outfile,"S2_17z_Type: %s\n", S2_17z_Type );
 
  Sched2[21] = Sched2[4] + Sched2[18] + Sched2[19];
  for (j=7; j <= 16; j++)
@@ -2372,8 +3901,8 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  Sched3[7] = Sched3[7] + Sched3[6];
 
  S3_6z_Type = GetTextLine( "S3_6z_Type:" );
- printf("S3_6z_Type: %s\n", S3_6z_Type );
- fprintf(outfile,"S3_6z_Type: %s\n", S3_6z_Type );
+ console_printf("S3_6z_Type: %s\n", S3_6z_Type );
+ results_fprintf(outfile,"S3_6z_Type: %s\n", S3_6z_Type );
 
  showline_wlabel( "S3_7", Sched3[7] );
 
@@ -2422,8 +3951,8 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  showline_wlabelnz( "S3_13z", Sched3_13z );
 
  S3_13z_Type = GetTextLine( "S3_13z_Type:" );
- printf("S3_13z_Type: %s\n", S3_13z_Type );
- fprintf(outfile,"S3_13z_Type: %s\n", S3_13z_Type );
+ console_printf("S3_13z_Type: %s\n", S3_13z_Type );
+ results_fprintf(outfile,"S3_13z_Type: %s\n", S3_13z_Type );
 
  Sched3[14] = Sched3_13a + Sched3_13b + Sched3_13c + Sched3_13d + Sched3_13f + Sched3_13g + Sched3_13h;
  showline_wlabelnz( "S3_14", Sched3[14] );
@@ -2472,29 +4001,28 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  if (L[33] > L[24])
   { /* Refund */
    L[34] = L[33] - L[24];
-   fprintf(outfile,"L34 = %6.2f  Amount you Overpaid!!!\n", L[34] );
+   results_fprintf(outfile,"L34 = %s  Amount you Overpaid!!!\n", format_amount( L[34], amt ) );
    L[35] = L[34];
-   fprintf(outfile,"L35a = %6.2f \n", L[35] );
+   results_fprintf(outfile,"L35a = %s \n", format_amount( L[35], amt ) );
   }
  else 
   { /* Tax-Due */
    L[37] = L[24] - L[33];
-   fprintf(outfile,"L37 = %6.2f  DUE !!!\n", L[37] );
-   fprintf(outfile,"         (Which is %2.1f%% of your Total Federal Tax.)\n", 100.0 * L[37] / (L[16] + 1e-9) );
+   results_fprintf(outfile,"L37 = %s  DUE !!!\n", format_amount( L[37], amt ) );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your Total Federal Tax.)\n", 100.0 * L[37] / (L[16] + 1e-9) );
   }
  ShowLineNonZero( 38 );
- fprintf(outfile,"------------------------------\n");
+ results_fprintf(outfile,"------------------------------\n");
 
  
- fprintf(outfile,"\n{ --------- Identity-Information:  --------- }\n");
+ results_fprintf(outfile,"\n{ --------- Identity-Information:  --------- }\n");
  Your1stName    = GetTextLineF( "Your1stName:" );
  YourLastName   = GetTextLineF( "YourLastName:" );
  writeout_line = 0;
  socsec = GetTextLineF( "YourSocSec#:" );
  strcpy( socsectmp, socsec );	/* Copy to buffer, since formatting could add 2-chars. */
  format_socsec( socsectmp, 0 );
- fprintf(outfile,"YourSocSec#: %s\n", socsectmp );
- free( socsec );
+ results_fprintf(outfile,"YourSocSec#: %s\n", socsectmp );
  writeout_line = 1;
  Spouse1stName  = GetTextLineF( "Spouse1stName:" );
  SpouseLastName = GetTextLineF( "SpouseLastName:" );
@@ -2502,18 +4030,17 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  socsec = GetTextLineF( "SpouseSocSec#:" );
  strcpy( socsectmp, socsec );	/* Copy to buffer, since formatting could add 2-chars. */
  format_socsec( socsectmp, 0 );
- fprintf(outfile,"SpouseSocSec#: %s\n", socsectmp );
- free( socsec );
+ results_fprintf(outfile,"SpouseSocSec#: %s\n", socsectmp );
  writeout_line = 1;
  if (strlen( YourLastName ) > 0)
   {
    if (strcmp( YourLastName, SpouseLastName ) == 0)
-    fprintf(outfile,"YourNames: %s & %s, %s\n", Your1stName, Spouse1stName, YourLastName );
+    results_fprintf(outfile,"YourNames: %s & %s, %s\n", Your1stName, Spouse1stName, YourLastName );
    else
    if (strlen( SpouseLastName ) > 0)
-    fprintf(outfile,"YourNames: %s %s & %s %s\n", Your1stName, YourLastName, Spouse1stName, SpouseLastName );
+    results_fprintf(outfile,"YourNames: %s %s & %s %s\n", Your1stName, YourLastName, Spouse1stName, SpouseLastName );
    else
-    fprintf(outfile,"YourNames: %s %s\n", Your1stName, YourLastName );
+    results_fprintf(outfile,"YourNames: %s %s\n", Your1stName, YourLastName );
   }
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Apt#:" );
@@ -2526,10 +4053,19 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
  GetTextLineF( "YourOccupat:" );
  GetTextLineF( "SpouseOccupat:" );
 
- get_word(infile, labelx );	/* Look for optional Dependent fields. */
- while (!feof(infile))
+ /* Look for optional Dependent fields, and any PDF markups, through the end of the file. */
+ /* (They are only written out, so runs that discard their results skip them.) */
+ markupline[0] = '\0';
+ if (!discard_results)
+  read_comment_filtered_line( infile, markupline, 8192 );
+ while ((!discard_results) && ((!feof(infile)) || (markupline[0] != '\0')))
   { /*OptionalLine*/
-   read_comment_filtered_line( infile, word, 512 );
+   if (strstr( markupline, "MarkupPDF" ) != 0)
+    {
+     process_pdf_markup_command( markupline );
+     markupline[0] = '\0';
+    }
+   strcpy( word, trim_whitespace( scan_word( markupline, labelx, " \t" ) ) );
    // printf("\nLine '%s' = '%s'\n", labelx, word );
    if (word[0] != '\0')
     { /*valid_entry*/
@@ -2537,27 +4073,47 @@ int main( int argc, char *argv[] )						/* Updated for 2021. */
       {
 	if (strstr( labelx,"SocSec" ) != 0)
 	  format_socsec( word, 1 );
-	fprintf(outfile, "%s \"%s\"\n", labelx, word );
+	results_fprintf(outfile, "%s \"%s\"\n", labelx, word );
       }
      else
      if (strncmp( labelx,"CkDep", 5 ) == 0)
       {
 	if (toupper(word[0]) == 'Y')
-	 fprintf(outfile, "%s X\n", labelx );
+	 results_fprintf(outfile, "%s X\n", labelx );
       }
     } /*valid_entry*/
-   get_word(infile, labelx );
+   if (feof(infile))
+    break;
+   read_comment_filtered_line( infile, markupline, 8192 );
   } /*OptionalLine*/
 
  fclose(infile);
- Grab_ScheduleB_Payer_Lines( infname, outfile );
- grab_any_pdf_markups( infname, outfile );
+ infile = 0;	/* (So that run_return does not close them again, if a later step, such as -sensitivity, fails.) */
+ results_fprintf(outfile,"\nSchedules Data:\n");
+ print_payer_lines( outfile, interest_payers, "B1_", 15, "Schedule B - Additional Interest Income" );
+ print_payer_lines( outfile, dividend_payers, "B5_", 17, "Schedule B - Additional Dividend Income" );
+ exude_pdf_markups( outfile );
  fclose(outfile);
+ outfile = 0;
+ if ((!discard_results) && (!write_fed_snapshot( outfname )))
+  console_printf("Warning: Could not write the snapshot of '%s' for the state returns.\n", outfname );
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  if (adjerrcnt != 0 ) Display_adj_code_err();
 
+ if (sensitivity_label != 0)
+  run_sensitivity( argc, argv, infname, sensitivity_label, sensitivity_from, sensitivity_to, sensitivity_step );
+
  return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ reset_solver_state = reset_US_1040_state;
+ return run_return( taxsolve_US_1040, argc, argv );
+}
+#endif
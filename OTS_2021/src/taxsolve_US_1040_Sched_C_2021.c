@@ -41,15 +41,16 @@ float thisversion=19.00;
 #define Yes 1
 #define No  0
 
+THREAD_LOCAL int L32=0;		/* Whether all investment is at risk (32a), or not (32b). */
+
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_US_1040_Sched_C( int argc, char *argv[] )
 {
  int i, j, k;
  char word[4000], outfname[4000], *EIN=0, *answ, *infname=0;
  time_t now;
  double L16b=0.0, L20b=0.0, L24b=0.0, Mileage=0.0, L44a=0.0, L44b=0.0, L44c=0.0;
- int L32=0;
  char veh_mm[1024]="", veh_dd[1024]="", veh_yy[1024]="";
  char Ck45[1024]="", L46answ[1024]="", L47a_answ[1024]="", L47b_answ[1024]="";
  char *L48a_descr="", *L48b_descr="", *L48c_descr="", *L48d_descr="", *L48e_descr="",
@@ -57,7 +58,7 @@ int main( int argc, char *argv[] )
  double L48a_amnt=0.0, L48b_amnt=0.0, L48c_amnt=0.0, L48d_amnt=0.0, L48e_amnt=0.0,
         L48f_amnt=0.0, L48g_amnt=0.0, L48h_amnt=0.0, L48i_amnt=0.0;
 
- printf("US 1040 Schedule C, 2021 - v%3.2f\n", thisversion);
+ console_printf("US 1040 Schedule C, 2021 - v%3.2f\n", thisversion);
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -65,29 +66,35 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (strcmp(argv[i],"-round_to_whole_dollars")==0)  { round_to_whole_dollars = 1; }
   else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); taxsolve_exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); taxsolve_exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); taxsolve_exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); taxsolve_exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) { L[i] = 0.0; }
@@ -103,7 +110,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  GetTextLineF( "YourName:" );
  GetTextLineF( "YourSocSec#:" );
@@ -115,47 +122,47 @@ int main( int argc, char *argv[] )
  GetTextLineF( "ActivityCode:" );
  EIN = GetTextLine( "BusinessEIN:" );
  format_socsec( EIN, 1 );
- fprintf(outfile,"BusinessEIN: %s\n", EIN );
+ results_fprintf(outfile,"BusinessEIN: %s\n", EIN );
 
  answ = GetTextLine( "Fmethod:" );
  next_word( answ, word, " \t;" );
  if (strcasecmp( word, "Cash" ) == 0)
-  fprintf(outfile,"CkFcash: X\n");
+  results_fprintf(outfile,"CkFcash: X\n");
  else
   if (strcasecmp( word, "Accrual" ) == 0)
-  fprintf(outfile,"CkFsccrual: X\n");
+  results_fprintf(outfile,"CkFsccrual: X\n");
  else
   if (strcasecmp( word, "Other" ) == 0)
-  fprintf(outfile,"CkFother: X\n");
+  results_fprintf(outfile,"CkFother: X\n");
  
  answ = GetTextLine( "GPartic:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkParticipate: X\n");
+  results_fprintf(outfile,"CkParticipate: X\n");
  else
  if ((mystrcasestr( word, "N/A" ) == 0) && (toupper( word[0] ) == 'N'))
-  fprintf(outfile,"CkNotParticipate: X\n");
+  results_fprintf(outfile,"CkNotParticipate: X\n");
  
  answ = GetTextLine( "Hacquired:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkAcquired: X\n");
+  results_fprintf(outfile,"CkAcquired: X\n");
 
  answ = GetTextLine( "Ireq1099s:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkReq1099: X\n");
+  results_fprintf(outfile,"CkReq1099: X\n");
  else
  if ((mystrcasestr( word, "N/A" ) == 0) && (toupper( word[0] ) == 'N'))
-  fprintf(outfile,"CkNotReq1099: X\n");
+  results_fprintf(outfile,"CkNotReq1099: X\n");
  
  answ = GetTextLine( "Jfile1099s:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"CkWillFile1099: X\n");
+  results_fprintf(outfile,"CkWillFile1099: X\n");
  else
  if ((mystrcasestr( word, "N/A" ) == 0) && (toupper( word[0] ) == 'N'))
-  fprintf(outfile,"CkNotFile1099: X\n");
+  results_fprintf(outfile,"CkNotFile1099: X\n");
  
 
  GetLine( "L1", &L[1] );	/* Gross Receipts */
@@ -224,14 +231,14 @@ int main( int argc, char *argv[] )
  else
  if (word[0] != '\0')
   {
-   printf("Error: Unexpected answer for Line-32a (Y/N) = '%s'.  Exiting.\n", word );
-   fprintf(outfile,"Error: Unexpected answer for Line-32a (Y/N) = '%s'.  Exiting.\n", word );
-   exit(1);
+   console_printf("Error: Unexpected answer for Line-32a (Y/N) = '%s'.  Exiting.\n", word );
+   results_fprintf(outfile,"Error: Unexpected answer for Line-32a (Y/N) = '%s'.  Exiting.\n", word );
+   taxsolve_exit(1);
   }
  else
   {
-   printf(" No answer for Line-32a (Y/N).\n");
-   fprintf(outfile," No answer for Line-32a (Y/N).\n");
+   console_printf(" No answer for Line-32a (Y/N).\n");
+   results_fprintf(outfile," No answer for Line-32a (Y/N).\n");
   }
 
 
@@ -240,24 +247,24 @@ int main( int argc, char *argv[] )
  answ = GetTextLine( "L33:" );
  next_word( answ, word, " \t;" );
  if (strcasecmp( word, "Cost" ) == 0)
-  fprintf(outfile,"Ck33aCost: X\n");
+  results_fprintf(outfile,"Ck33aCost: X\n");
  else
  if (strcasecmp( word, "Market" ) == 0)
-  fprintf(outfile,"Ck33bMarket: X\n");
+  results_fprintf(outfile,"Ck33bMarket: X\n");
  else
  if (strcasecmp( word, "Other" ) == 0)
-  fprintf(outfile,"Ck33cOther: X\n");
+  results_fprintf(outfile,"Ck33cOther: X\n");
  else
  if (word[0] != '\0')
-  printf("Warning: Unexpected answer for L33: '%s'\n", word ); 
+  console_printf("Warning: Unexpected answer for L33: '%s'\n", word ); 
 
  answ = GetTextLine( "L34:" );
  next_word( answ, word, " \t;" );
  if (toupper( word[0] ) == 'Y')
-  fprintf(outfile,"Ck34Yes: X\n");
+  results_fprintf(outfile,"Ck34Yes: X\n");
  else
  if (toupper( word[0] ) == 'N')
-  fprintf(outfile,"Ck34No: X\n");
+  results_fprintf(outfile,"Ck34No: X\n");
  
  GetLine( "L35", &L[35] );	/* Inventory at beginning of year */
 
@@ -277,9 +284,9 @@ int main( int argc, char *argv[] )
 
 
  answ = GetTextLine( "L43:" );
- next_word( answ, veh_mm, " \t-/.,;" );
- next_word( answ, veh_dd, " \t-/.,;" );
- next_word( answ, veh_yy, " \t-/.,;" );
+ answ = scan_word( answ, veh_mm, " \t-/.,;" );
+ answ = scan_word( answ, veh_dd, " \t-/.,;" );
+ scan_word( answ, veh_yy, " \t-/.,;" );
  
  GetLine( "L44a", &L44a );		/* Vehicle Miles */
  GetLine( "L44b", &L44b );
@@ -349,18 +356,18 @@ int main( int argc, char *argv[] )
  showline(13);
  showline(14);
  showline(15);
- fprintf(outfile,"L16a = %6.2f\n", L[16]);
- fprintf(outfile,"L16b = %6.2f\n", L16b);
+ results_fprintf(outfile,"L16a = %6.2f\n", L[16]);
+ results_fprintf(outfile,"L16b = %6.2f\n", L16b);
  showline(17);
  showline(18);
  showline(19);
- fprintf(outfile,"L20a = %6.2f\n", L[20]);
- fprintf(outfile,"L20b = %6.2f\n", L20b);
+ results_fprintf(outfile,"L20a = %6.2f\n", L[20]);
+ results_fprintf(outfile,"L20b = %6.2f\n", L20b);
  showline(21);
  showline(22);
  showline(23);
- fprintf(outfile,"L24a = %6.2f\n", L[24]);
- fprintf(outfile,"L24b = %6.2f\n", L24b);
+ results_fprintf(outfile,"L24a = %6.2f\n", L[24]);
+ results_fprintf(outfile,"L24b = %6.2f\n", L24b);
  showline(25);
  showline(26);
  showline_wlabel( "L27a", L[27] );
@@ -373,21 +380,21 @@ int main( int argc, char *argv[] )
  L[31] = L[29] - L[30];
  showline_wmsg(31,"Net Profit (loss)");
  if (L[31] > 0.0)
-  fprintf(outfile,"Enter %2.2f on Form 1040 line S1_12. Sched-SE line 2. Estates/trusts on Form 1041 line 3.\n", L[31]);
+  results_fprintf(outfile,"Enter %2.2f on Form 1040 line S1_12. Sched-SE line 2. Estates/trusts on Form 1041 line 3.\n", L[31]);
  else
  if (L[31] < 0.0)
   {
    // fprintf(outfile,"Mark box 32a accordingly\n");
    if (L32 == Yes)
     {
-     fprintf(outfile,"If you checked 32a, enter %2.2f on Form 1040 line S1_12.\n", L[31]);
-     fprintf(outfile,"        Estates and trusts, enter on Form 1041, line 3.\n");
-     fprintf(outfile,"Ck32a: x\n");
+     results_fprintf(outfile,"If you checked 32a, enter %2.2f on Form 1040 line S1_12.\n", L[31]);
+     results_fprintf(outfile,"        Estates and trusts, enter on Form 1041, line 3.\n");
+     results_fprintf(outfile,"Ck32a: x\n");
     }
    else
     {
-     fprintf(outfile,"If you checked 32b, you must attach Form 6198. Your loss may be limited.\n");
-     fprintf(outfile,"Ck32b: x\n");
+     results_fprintf(outfile,"If you checked 32b, you must attach Form 6198. Your loss may be limited.\n");
+     results_fprintf(outfile,"Ck32b: x\n");
     }
   }
 
@@ -401,64 +408,64 @@ int main( int argc, char *argv[] )
  showline_wmsg(42,"Cost of goods sold");
 
 
- fprintf(outfile,"L43mm: %s\n", veh_mm );
- fprintf(outfile,"L43dd: %s\n", veh_dd );
- fprintf(outfile,"L43yy: %s\n", veh_yy );
+ results_fprintf(outfile,"L43mm: %s\n", veh_mm );
+ results_fprintf(outfile,"L43dd: %s\n", veh_dd );
+ results_fprintf(outfile,"L43yy: %s\n", veh_yy );
 
  showline_wlabelnz( "L44a", L44a );
  showline_wlabelnz( "L44b", L44b );
  showline_wlabelnz( "L44c", L44c );
 
  if (toupper( Ck45[0] ) == 'Y')
-  fprintf(outfile,"Ck45Yes: X\n");
+  results_fprintf(outfile,"Ck45Yes: X\n");
  else
  if (strcasecmp( Ck45, "No") == 0)
-  fprintf(outfile,"Ck45No: X\n");
+  results_fprintf(outfile,"Ck45No: X\n");
 
  if (toupper( L46answ[0] ) == 'Y')
-  fprintf(outfile,"Ck46Yes: X\n");
+  results_fprintf(outfile,"Ck46Yes: X\n");
  else
  if (strcasecmp( L46answ, "No") == 0)
-  fprintf(outfile,"Ck46No: X\n");
+  results_fprintf(outfile,"Ck46No: X\n");
 
  if (toupper( L47a_answ[0] ) == 'Y')
-  fprintf(outfile,"Ck47aYes: X\n");
+  results_fprintf(outfile,"Ck47aYes: X\n");
  else
  if (strcasecmp( L47a_answ, "No") == 0)
-  fprintf(outfile,"Ck47aNo: X\n");
+  results_fprintf(outfile,"Ck47aNo: X\n");
 
  if (toupper( L47b_answ[0] ) == 'Y')
-  fprintf(outfile,"Ck47bYes: X\n");
+  results_fprintf(outfile,"Ck47bYes: X\n");
  else
  if (strcasecmp( L47b_answ, "No") == 0)
-  fprintf(outfile,"Ck47bNo: X\n");
+  results_fprintf(outfile,"Ck47bNo: X\n");
 
  if (strlen( L48a_descr ) > 0)
-  fprintf(outfile,"L48a_descr: %s\n", L48a_descr );
+  results_fprintf(outfile,"L48a_descr: %s\n", L48a_descr );
  showline_wlabelnz( "L48a_amnt", L48a_amnt );
  if (strlen( L48b_descr ) > 0)
-  fprintf(outfile,"L48b_descr: %s\n", L48b_descr );
+  results_fprintf(outfile,"L48b_descr: %s\n", L48b_descr );
  showline_wlabelnz( "L48b_amnt", L48b_amnt );
  if (strlen( L48c_descr ) > 0)
-  fprintf(outfile,"L48c_descr: %s\n", L48c_descr );
+  results_fprintf(outfile,"L48c_descr: %s\n", L48c_descr );
  showline_wlabelnz( "L48c_amnt", L48c_amnt );
  if (strlen( L48d_descr ) > 0)
-  fprintf(outfile,"L48d_descr: %s\n", L48d_descr );
+  results_fprintf(outfile,"L48d_descr: %s\n", L48d_descr );
  showline_wlabelnz( "L48d_amnt", L48d_amnt );
  if (strlen( L48e_descr ) > 0)
-  fprintf(outfile,"L48e_descr: %s\n", L48e_descr );
+  results_fprintf(outfile,"L48e_descr: %s\n", L48e_descr );
  showline_wlabelnz( "L48e_amnt", L48e_amnt );
  if (strlen( L48f_descr ) > 0)
-  fprintf(outfile,"L48f_descr: %s\n", L48f_descr );
+  results_fprintf(outfile,"L48f_descr: %s\n", L48f_descr );
  showline_wlabelnz( "L48f_amnt", L48f_amnt );
  if (strlen( L48g_descr ) > 0)
-  fprintf(outfile,"L48g_descr: %s\n", L48g_descr );
+  results_fprintf(outfile,"L48g_descr: %s\n", L48g_descr );
  showline_wlabelnz( "L48g_amnt", L48g_amnt );
  if (strlen( L48h_descr ) > 0)
-  fprintf(outfile,"L48h_descr: %s\n", L48h_descr );
+  results_fprintf(outfile,"L48h_descr: %s\n", L48h_descr );
  showline_wlabelnz( "L48ha_amnt", L48h_amnt );
  if (strlen( L48i_descr ) > 0)
-  fprintf(outfile,"L48i_descr: %s\n", L48i_descr );
+  results_fprintf(outfile,"L48i_descr: %s\n", L48i_descr );
  showline_wlabelnz( "L48i_amnt", L48i_amnt );
 
  showline_wmsg( 48, "Total other expenses" );
@@ -467,8 +474,16 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_US_1040_Sched_C, argc, argv );
+}
+#endif
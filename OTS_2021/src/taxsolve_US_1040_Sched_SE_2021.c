@@ -39,19 +39,19 @@ float thisversion=2.00;
 #define Yes 1
 #define No  0
 
-double L4a=0.0, L4c=0.0;
-double L5a=0.0, L5b=0.0; 			/* Church employee income */
-double L8a=0.0, L8b=0.0, L8c=0.0, L8d=0.0; 	/* Wages & Tips */
+THREAD_LOCAL double L4a=0.0, L4c=0.0;
+THREAD_LOCAL double L5a=0.0, L5b=0.0; 			/* Church employee income */
+THREAD_LOCAL double L8a=0.0, L8b=0.0, L8c=0.0, L8d=0.0; 	/* Wages & Tips */
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_US_1040_Sched_SE( int argc, char *argv[] )
 {
  int i, j, k;
  char word[8000], outfname[8000], *infname=0;
  time_t now;
 
- printf("US 1040 Schedule SE, 2021 - v%1.0f\n", thisversion);
+ console_printf("US 1040 Schedule SE, 2021 - v%1.0f\n", thisversion);
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -59,26 +59,32 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); taxsolve_exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); taxsolve_exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); taxsolve_exit(1);}
   i = i + 1;
  }
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); taxsolve_exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) { L[i] = 0.0; }
@@ -94,7 +100,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
 
  /* ----- Accept form data and process the numbers.         ------ */
@@ -168,8 +174,16 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_US_1040_Sched_SE, argc, argv );
+}
+#endif
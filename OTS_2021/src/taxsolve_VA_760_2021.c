@@ -37,34 +37,35 @@ float thisversion=19.00;
 #define HEAD_OF_HOUSEHOLD       4
 #define WIDOW		        5
 
+THREAD_LOCAL struct tax_schedule tax_schedule={
+ 4, 1, TAX_BASES_COMPUTED,
+ { DOLLARS(0), DOLLARS(3000), DOLLARS(5000), DOLLARS(17000) },
+ { RATE(0.02), RATE(0.03), RATE(0.05), RATE(0.0575) }
+		     };
+
 double TaxRateFunction( double income, int status )
 {
- if (income < 3000.0) return income * 0.02; else
- if (income < 5000.0) return  60.0 + (income - 3000.0) * 0.03; else
- if (income < 17000.0) return 120.0 + (income - 5000.0) * 0.05; else
- return 720.0 + (income - 17000.0) * 0.0575; 
+ return scheduled_tax( &tax_schedule, income, TAX_EXACT, 0 );
 }
 
 
 void Report_bracket_info( double income, double tx, int status )
 {
  double rate;
- if (income < 3000.0) rate = 0.02;  else
- if (income < 5000.0) rate = 0.03;  else
- if (income < 17000.0) rate = 0.05; else  rate = 0.0575;
- printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ scheduled_tax( &tax_schedule, income, TAX_EXACT, &rate );
+ console_printf(" You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
- fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
+ results_fprintf(outfile," You are in the %2.1f%% marginal tax bracket,\n and you are paying an effective %2.1f%% tax on your total income.\n",
 	  100.0 * rate, 100.0 * tx / income );
 }
 
 
-struct date_record yourDOB, spouseDOB, DL;
+THREAD_LOCAL struct date_record yourDOB, spouseDOB, DL;
 
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_VA_760( int argc, char *argv[] )
 {
  int i, j, k;
  char word[1000], outfname[4000], *lnameptr, lastname[1024], *socsec, *datestr, *twrd, *infname=0;
@@ -73,32 +74,38 @@ int main( int argc, char *argv[] )
  double L19b=0.0, std_ded=0.0, min2file;
 
  /* Intercept any command-line arguments. */
- printf("VA-760 2021 - v%3.1f\n", thisversion);
+ console_printf("VA-760 2021 - v%3.1f\n", thisversion);
  i = 1;  k=1;
  while (i < argc)
  {
   if (strcmp(argv[i],"-verbose")==0)  verbose = 1;
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(argv[i],"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(argv[i],"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", argv[i]); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,argv[i]);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
-  else {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+  else {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
 
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) 
@@ -116,7 +123,7 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,	 v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
  /* get_parameter(infile, kind, x, emssg ) */
  get_parameter( infile, 's', word, "Status" );
@@ -127,33 +134,33 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Head_of_House",4)==0) status = HEAD_OF_HOUSEHOLD;
  else
   { 
-   printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Must be: Single, Married/joint, Married/sep, Head_of_house, Widow(er)\nExiting.\n", word); 
    exit(1); 
   }
- fprintf(outfile,"Status = %s\n", word );
- fprintf(outfile," FilingStatus: %d\n", status );
+ results_fprintf(outfile,"Status = %s\n", word );
+ results_fprintf(outfile," FilingStatus: %d\n", status );
 
  GetTextLineF( "Your1stName:" );
  GetTextLineF( "YourMI:" );
  lnameptr = GetTextLineF( "YourLastName:" );
  strcpy( lastname, lnameptr );
  lastname[4] = '\0';
- fprintf(outfile,"Y1st4: %s\n", lastname );
+ results_fprintf(outfile,"Y1st4: %s\n", lastname );
  writeout_line = 0;
  socsec = GetTextLineF( "YourSocSec#:" );
  format_socsec( socsec, 1 );
- fprintf(outfile,"YourSocSec#: %s\n", socsec );
+ results_fprintf(outfile,"YourSocSec#: %s\n", socsec );
  datestr = GetTextLineF( "YourDOB:" );
  if (datestr[0] == '\0')
   {
    show_errmsg("\nMissing 'YourDOB' -- needed to check age exemptions.\n");
-   datestr = strdup( "1 / 1 / 2000");	/* Pressume under 65. */
+   datestr = return_strdup( "1 / 1 / 2000");	/* Pressume under 65. */
   }
  if (interpret_date( datestr, &(yourDOB.month), &(yourDOB.day), &(yourDOB.year), "Bad YourDOB" ) != 1)
    exit(1);
  twrd = format_mmddyyyy( yourDOB.month, yourDOB.day, yourDOB.year );
- fprintf(outfile,"YourDOB: %s\n", twrd );
+ results_fprintf(outfile,"YourDOB: %s\n", twrd );
  writeout_line = 1;
  GetTextLineF( "YourDrivLic:" );
  writeout_line = 0;
@@ -161,7 +168,7 @@ int main( int argc, char *argv[] )
  if ((datestr[0] != '\0') && (interpret_date( datestr, &(DL.month), &(DL.day), &(DL.year), "Bad YourDL" )))
   {
    twrd = format_mmddyyyy( DL.month, DL.day, DL.year );
-   fprintf(outfile,"YourDLdate: %s\n", twrd );
+   results_fprintf(outfile,"YourDLdate: %s\n", twrd );
   }
  writeout_line = 1;
 
@@ -170,23 +177,23 @@ int main( int argc, char *argv[] )
  lnameptr = GetTextLineF( "SpouseLastName:" );
  strcpy( lastname, lnameptr );
  lastname[4] = '\0';
- fprintf(outfile,"S1st4: %s\n", lastname );
+ results_fprintf(outfile,"S1st4: %s\n", lastname );
  writeout_line = 0;
  socsec = GetTextLineF( "SpouseSocSec#:" );
  format_socsec( socsec, 1 );
- fprintf(outfile,"SpouseSocSec#: %s\n", socsec );
+ results_fprintf(outfile,"SpouseSocSec#: %s\n", socsec );
  datestr = GetTextLineF( "SpouseDOB:" );
  if (status == MARRIED_FILING_JOINTLY)
   {
    if (datestr[0] == '\0')
     {
      show_errmsg("\nMissing 'SpouseDOB' -- needed to check age exemptions.\n");
-     datestr = strdup( "1 / 1 / 2000");   /* Pressume under 65. */
+     datestr = return_strdup( "1 / 1 / 2000");   /* Pressume under 65. */
     }
    if (interpret_date( datestr, &(spouseDOB.month), &(spouseDOB.day), &(spouseDOB.year), "Bad SpouseDOB" ) != 1)
      exit(1);
   twrd = format_mmddyyyy( spouseDOB.month, spouseDOB.day, spouseDOB.year );
-  fprintf(outfile,"SpouseDOB: %s\n", twrd );
+  results_fprintf(outfile,"SpouseDOB: %s\n", twrd );
  }
  writeout_line = 1;
  GetTextLineF( "SpouseDrivLic:" );
@@ -195,30 +202,30 @@ int main( int argc, char *argv[] )
  if ((datestr[0] != '\0') && (interpret_date( datestr, &(DL.month), &(DL.day), &(DL.year), "Bad YourDL" )))
   {
    twrd = format_mmddyyyy( DL.month, DL.day, DL.year );
-   fprintf(outfile,"SpouseDLdate: %s\n", twrd );
+   results_fprintf(outfile,"SpouseDLdate: %s\n", twrd );
   }
  writeout_line = 1;
 
  GetTextLineF( "Number&Street:" );
  GetTextLineF( "Town:" );
- fprintf(outfile,"State: VA\n");
+ results_fprintf(outfile,"State: VA\n");
  GetTextLineF( "Zipcode:" );
- fprintf(outfile,"\n{ --------- }\n");
+ results_fprintf(outfile,"\n{ --------- }\n");
 
  get_parameter( infile, 's', word, "OtherDependents" );	/* Dependents not including you or spouse. */
  get_parameters( infile, 'i', &exemptionsA, "OtherDependents");
  if (exemptionsA > 0) 
-  fprintf(outfile,"ExmpDeps: %d\n", exemptionsA );
+  results_fprintf(outfile,"ExmpDeps: %d\n", exemptionsA );
  if (status == MARRIED_FILING_JOINTLY)
   exemptionsA = 2 + exemptionsA;
  else
   exemptionsA = 1 + exemptionsA; 
- fprintf(outfile,"NExemptionsA = %d\n", exemptionsA );
- fprintf(outfile,"ExemptionsA = %d\n", 930 * exemptionsA );
+ results_fprintf(outfile,"NExemptionsA = %d\n", exemptionsA );
+ results_fprintf(outfile,"ExemptionsA = %d\n", 930 * exemptionsA );
 
  if (yourDOB.year < 1957)			/* Updated for 2021. */
   {
-   fprintf(outfile,"YouOver65 = 1\n" );		/* You are 65 or over. */
+   results_fprintf(outfile,"YouOver65 = 1\n" );		/* You are 65 or over. */
    exemptionsB = 1;
   }
  else
@@ -230,7 +237,7 @@ int main( int argc, char *argv[] )
  get_parameter( infile, 'b', &youBlind, "YouBlind"); 
  if (youBlind != 0)
   {
-   fprintf(outfile,"YouBlind = 1\n");
+   results_fprintf(outfile,"YouBlind = 1\n");
    exemptionsB++;
   }
 
@@ -240,28 +247,28 @@ int main( int argc, char *argv[] )
   {
    if (spouseDOB.year < 1956)			/* Not updated for 2021. */
     {
-     fprintf(outfile,"SpouseOver65 = 1\n" );	/* Spouse is 65 or over. */
+     results_fprintf(outfile,"SpouseOver65 = 1\n" );	/* Spouse is 65 or over. */
      exemptionsB++;
     }
    if (spouseBlind != 0)
     {
-     fprintf(outfile,"SpouseBlind = 1\n");
+     results_fprintf(outfile,"SpouseBlind = 1\n");
      exemptionsB++;
     }
   }
 
- fprintf(outfile,"NExemptionsB = %d\n", exemptionsB );
- fprintf(outfile,"ExemptionsB = %d\n", 800 * exemptionsB );
+ results_fprintf(outfile,"NExemptionsB = %d\n", exemptionsB );
+ results_fprintf(outfile,"ExemptionsB = %d\n", 800 * exemptionsB );
 
  if (status == MARRIED_FILING_JOINTLY)
   {
-   fprintf(outfile,"ExmpSpouse:  1\n");
+   results_fprintf(outfile,"ExmpSpouse:  1\n");
    if (exemptionsA > 2)
-    fprintf(outfile,"ExmpDeps: %d\n", exemptionsA - 2 );
+    results_fprintf(outfile,"ExmpDeps: %d\n", exemptionsA - 2 );
   }
  else
  if (exemptionsA > 1)
-  fprintf(outfile,"ExmpDeps: %d\n", exemptionsA - 1 );
+  results_fprintf(outfile,"ExmpDeps: %d\n", exemptionsA - 1 );
 
  GetLineF( "L1", &L[1] );	/* Federal Adjusted Gross Income */
 
@@ -291,8 +298,8 @@ int main( int argc, char *argv[] )
    case SINGLE:  		  std_ded = 4500.0;  min2file = 11950.0;  break;
    case MARRIED_FILING_JOINTLY:  std_ded = 9000.0;  min2file = 23900.0;  break;
    case MARRIED_FILING_SEPARAT:  std_ded = 4500.0;  min2file = 11950.0;  break;
-   default:  printf("Unexpected status.\n");
-	     fprintf(outfile,"Unexpected status.\n");
+   default:  console_printf("Unexpected status.\n");
+	     results_fprintf(outfile,"Unexpected status.\n");
 	     exit(1);  
 	break;
   }
@@ -338,7 +345,7 @@ int main( int argc, char *argv[] )
 
  if ((L[23] > 0.0) && (exemptionsB > 0.0))
   {
-   fprintf(outfile," Cannot claim both Low-Income Credit and Age or Blind Exemptions.\n");
+   results_fprintf(outfile," Cannot claim both Low-Income Credit and Age or Blind Exemptions.\n");
    L[23] = 0.0;	/* Cannot claim both low-income credit and exemptions. */
   }
  showline(23);
@@ -374,14 +381,14 @@ int main( int argc, char *argv[] )
   {
    L[35] = L[27] + L[34];
    showline_wmsg( 35, "AMOUNT DUE" );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[35] / (L[18] + 1e-9) );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[35] / (L[18] + 1e-9) );
   }
  else
  if (L[28] < L[34])
   {
    L[35] = L[34] - L[28];
    showline_wmsg( 35, "AMOUNT DUE" );
-   fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[35] / (L[19] + 1e-9) );
+   results_fprintf(outfile,"         (Which is %2.1f%% of your total tax.)\n", 100.0 * L[35] / (L[19] + 1e-9) );
   }
  else
  if (L[28] > L[34])
@@ -392,17 +399,23 @@ int main( int argc, char *argv[] )
 
  if (L[9] < min2file)
   {
-   fprintf(outfile,"\nYour VAGI is less than the minimum required to file a return.\n");
+   results_fprintf(outfile,"\nYour VAGI is less than the minimum required to file a return.\n");
    if (L[19] + L19b + L[20] > 0.0)
-    fprintf(outfile," But you need to file return to receive refund of withheld taxes.\n");
+    results_fprintf(outfile," But you need to file return to receive refund of withheld taxes.\n");
    else
-    fprintf(outfile,"You do not need to file return.  Your VA Tax is zero.\n");
+    results_fprintf(outfile,"You do not need to file return.  Your VA Tax is zero.\n");
   }
 
  fclose(infile);
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
  Display_File( outfname );
- printf("\nResults written to file:  %s\n", outfname);
+ console_printf("\nResults written to file:  %s\n", outfname);
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_VA_760, argc, argv );
+}
@@ -12,6 +12,8 @@ float thisversion=3.00;
 #include <stdlib.h>
 
 #include "taxsolve_routines.c"
+#include "taxsolve_tax_schedules_2021.c"
+#include "taxsolve_tax_tables_2021.h"
 
 #define SINGLE 		        1
 #define MARRIED_FILING_JOINTLY 2
@@ -28,56 +30,26 @@ int BoxA, BoxB, BoxC, BoxD, BoxE, Num_Days = 0;
 
 /*-----------Tax Routines Copied From taxsolve_US_1040_2021.c ----------------*/
 
-			/* Following values taken from 1040-Instructions pg 110. */	/* Updated for 2021. */
-double brkpt[4][9]={
-		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 523600.0, 9e19 },  /* Single */
-		{ 0.0,  19900.0,  81050.0, 172750.0, 329850.0, 418850.0, 628300.0, 9e19 },  /* Married, filing jointly. */
-		{ 0.0,   9950.0,  40525.0,  86375.0, 164925.0, 209425.0, 314150.0, 9e19 },  /* Married, filing separate. */
-		{ 0.0,  14200.0,  54200.0,  86350.0, 164900.0, 209400.0, 523600.0, 9e19 },  /* Head of Household. */
-		     };
-  double txrt[4][9] ={
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Single */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing jointly. */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Married, filing separate. */
-		{ 0.1, 0.12, 0.22, 0.24, 0.32, 0.35, 0.37 },	/* Head of Household. */
-		     };
-
 double TaxRateFormula( double x, int status )  /* Returns tax due. */
 {		
-  double sum=0.0;
-  int   bracket=0;
   if (status == WIDOW) status = MARRIED_FILING_JOINTLY;  /* Handle case of widow(er). */
-  status = status - 1;  /* Arrays start at zero; not one. */
-  while (brkpt[status][bracket+1] < x)
-   {
-    sum = sum + (brkpt[status][bracket+1] - brkpt[status][bracket]) * txrt[status][bracket];
-    bracket = bracket + 1;
-   }
-  return (x - brkpt[status][bracket]) * txrt[status][bracket] + sum;
+  return scheduled_tax( &(fed_tax_schedules[status-1]), x, TAX_EXACT, 0 );
 }
 
 double TaxRateFunction( double income, int status )     /* Emulates table lookup or function appropriately. */
 {
- double x, dx, tx;
- int k;
- if (income < 100000.0)	/* Quantize to match tax-table exactly. */
-  {
-   if (income < 25.0) x = 5.0; else
-   if (income < 3000.0) x = 25.0; else x = 50.0;
-   dx = 0.5 * x;
-   k = income / x;
-   x = x * (double)k + dx;
-   tx = (int)(TaxRateFormula( x, status ) + 0.5);
-  }
- else
-  tx = TaxRateFormula( income, status );
- return tx;
+ int row;
+ row = fed_tax_table_row( income );
+ if (row < 0)
+  return TaxRateFormula( income, status );
+ if (status == WIDOW) status = MARRIED_FILING_JOINTLY;
+ return fed_tax_table[row][status-1];
 }
 
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_f2210( int argc, char *argv[] )
 {
   int i, j, k, status, individual = Yes;
  char word[4000], outfname[4000], *infname=0;
@@ -91,7 +63,7 @@ int main( int argc, char *argv[] )
  double a[37], b[37], c[37], d[37];	/* cells in grid of Schedule AI comprised of lines 1 through 36 */
 					/* e.g., cell 1(a) will be in variable a[1] */
 
- printf("Form 2210, 2021 - v%3.2f\n", thisversion);
+ console_printf("Form 2210, 2021 - v%3.2f\n", thisversion);
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -99,26 +71,32 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
   i = i + 1;
  }
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); exit(1);}
 
  /* Pre-initialize all lines to zeros. */
 
@@ -148,10 +126,10 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
-fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
- fprintf(outfile,"--- NOT YET FULLY UPDATED FOR 2021. ---\n\n");
+results_fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
+ results_fprintf(outfile,"--- NOT YET FULLY UPDATED FOR 2021. ---\n\n");
 
  // MarkupPDF( 1, 240, 40, 17, 1.0, 0, 0 ) NotReady "This program is NOT updated for 2021."
  add_pdf_markup( "NotReady", 1, 240, 40, 17, 1, 1.0, 0, 0, "\"This program is NOT ready for 2021.\"" );
@@ -159,9 +137,9 @@ fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
  add_pdf_markup( "NotReady", 3, 240, 40, 17, 1, 1.0, 0, 0, "\"This program is NOT ready for 2021.\"" );
 
 
- fprintf(outfile, "%s\n", "==================================================");
- fprintf(outfile, "%s\n", "                                                            CAUTION\nThis program fills out Form 2210 to determine WHETHER OR NOT you owe a penalty\nfor underpayment of estimated tax.  It does NOT calculate the AMOUNT of any\npenalty you may owe.  If you owe a penalty, you may need to fill out the Penalty\nWorksheet in the Form 2210 instructions to calculate the amount of your penalty.\nDO NOT INTERPRET the default zero value shown on page 2, line 19, of the filled\nPDF to indicate that you do not owe a penalty.  Scroll down about 1/3 of the way in\nthis results file (to BELOW the SecA results lines) to see if you might owe a penalty.");
- fprintf(outfile, "%s\n\n", "==================================================");
+ results_fprintf(outfile, "%s\n", "==================================================");
+ results_fprintf(outfile, "%s\n", "                                                            CAUTION\nThis program fills out Form 2210 to determine WHETHER OR NOT you owe a penalty\nfor underpayment of estimated tax.  It does NOT calculate the AMOUNT of any\npenalty you may owe.  If you owe a penalty, you may need to fill out the Penalty\nWorksheet in the Form 2210 instructions to calculate the amount of your penalty.\nDO NOT INTERPRET the default zero value shown on page 2, line 19, of the filled\nPDF to indicate that you do not owe a penalty.  Scroll down about 1/3 of the way in\nthis results file (to BELOW the SecA results lines) to see if you might owe a penalty.");
+ results_fprintf(outfile, "%s\n\n", "==================================================");
 
  /* ----- Accept form data and process the numbers.         ------ */
  /* ----- Place all your form-specific code below here .... ------ */
@@ -178,7 +156,7 @@ fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
  get_parameter( infile, 's', word, "Entity" );
  get_parameter( infile, 'w', word, "Entity?");
  if (strncasecmp(word,"Individual",3)==0) individual = Yes;
- fprintf(outfile,"Entity = %s (%d)\n", word, individual);
+ results_fprintf(outfile,"Entity = %s (%d)\n", word, individual);
 
 get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/sep, Head house, Widow(er) */
  get_parameter( infile, 'l', word, "Status?");
@@ -189,11 +167,11 @@ get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
    exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  GetLineF( "L1", &L[1] );
  GetLineF( "L2", &L[2] );
@@ -209,63 +187,63 @@ get_parameter( infile, 's', word, "Status" );	/* Single, Married/joint, Married/
  L[9] = SmallerOf(L[5], L[8]);
  showline( 9 );
  if(L[9] > L[6])
-	fprintf(outfile,  "CkL9Yes X\n");	/* Yes, may owe penalty */
+	results_fprintf(outfile,  "CkL9Yes X\n");	/* Yes, may owe penalty */
  else
- 	fprintf(outfile,  "CkL9No X\n");	/* No, don't owe penalty */
+ 	results_fprintf(outfile,  "CkL9No X\n");	/* No, don't owe penalty */
 
  get_parameter( infile, 's', word, "BoxA" );
  get_parameter( infile, 'w', word, "BoxA?");
  if (strncasecmp(word,"Yes",1)==0){
 	BoxA = Yes;
-	fprintf(outfile,"CkBoxA X\n");
+	results_fprintf(outfile,"CkBoxA X\n");
 }
 
 get_parameter( infile, 's', word, "BoxB" );
 get_parameter( infile, 'w', word, "BoxB?");
  if (strncasecmp(word,"Yes",1)==0){
 	BoxB = Yes;
-	fprintf(outfile,"CkBoxB X\n");
+	results_fprintf(outfile,"CkBoxB X\n");
 }
 
  get_parameter( infile, 's', word, "BoxC" );
  get_parameter( infile, 'w', word, "BoxC?");
  if (strncasecmp(word,"Yes",1)==0){
 	BoxC = Yes;
-	fprintf(outfile,"CkBoxC X\n");
+	results_fprintf(outfile,"CkBoxC X\n");
 }
 
 get_parameter( infile, 's', word, "BoxD" );
  get_parameter( infile, 'w', word, "BoxD?");
  if (strncasecmp(word,"Yes",1)==0){
 	BoxD = Yes;
-	fprintf(outfile,"CkBoxD X\n");
+	results_fprintf(outfile,"CkBoxD X\n");
 }
 
 get_parameter( infile, 's', word, "BoxE" );
  get_parameter( infile, 'w', word, "BoxE?");
  if (strncasecmp(word,"Yes",1)==0){
 	BoxE = Yes;
-	fprintf(outfile,"CkBoxE X\n");
+	results_fprintf(outfile,"CkBoxE X\n");
 }
 
 if((L[4] < 1000) || (L[7] < 1000))
-	fprintf(outfile, "Line 4 or Line 7 less than $1,000.  Don't file Form 2210. You don't owe a penalty.\n");
+	results_fprintf(outfile, "Line 4 or Line 7 less than $1,000.  Don't file Form 2210. You don't owe a penalty.\n");
 
 else if(L[6] >= L[9]){
 	if(BoxE == Yes)
-		fprintf(outfile, "You don't owe a penalty.  Because Box E in Part II applies, file page 1 of Form 2210.\n");
+		results_fprintf(outfile, "You don't owe a penalty.  Because Box E in Part II applies, file page 1 of Form 2210.\n");
 	else
-		fprintf(outfile, "You don't owe a penalty.  Don't file Form 2210.\n");
+		results_fprintf(outfile, "You don't owe a penalty.  Don't file Form 2210.\n");
 }
 else if((BoxA == Yes) || (BoxB == Yes) || (BoxC == Yes) || (BoxD == Yes) || (BoxE == Yes)){
-	fprintf(outfile, "You MUST file Form 2210.\n");
+	results_fprintf(outfile, "You MUST file Form 2210.\n");
 	if((BoxB == Yes) || (BoxC == Yes) || (BoxD == Yes))
-		fprintf(outfile, "You must figure your penalty.\n");
+		results_fprintf(outfile, "You must figure your penalty.\n");
 	else
-		fprintf(outfile, "%s", "You aren't required to figure your penalty because the IRS\nwill figure it and send you a bill for any unpaid amount.\nIf you want to figure it, you may use Part III as a\nworksheet and enter your penalty amount on your tax return,\nbut FILE ONLY PAGE 1 OF FORM 2210.\n");
+		results_fprintf(outfile, "%s", "You aren't required to figure your penalty because the IRS\nwill figure it and send you a bill for any unpaid amount.\nIf you want to figure it, you may use Part III as a\nworksheet and enter your penalty amount on your tax return,\nbut FILE ONLY PAGE 1 OF FORM 2210.\n");
 }
 else
-	fprintf(outfile, "%s", "Don't file Form 2210. You aren't required to figure\nyour penalty because the IRS will figure it and send\nyou a bill for any unpaid amount. If you want to figure\nit, you may use Part III as a worksheet and\nenter your penalty amount on your tax return, but\ndon't file Form 2210.\n");
+	results_fprintf(outfile, "%s", "Don't file Form 2210. You aren't required to figure\nyour penalty because the IRS will figure it and send\nyou a bill for any unpaid amount. If you want to figure\nit, you may use Part III as a worksheet and\nenter your penalty amount on your tax return, but\ndon't file Form 2210.\n");
 
 	/* Inputs must be read; */
 	/* otherwise, error message re: unexpected input is thrown */
@@ -538,45 +516,51 @@ else
 			D[18] = D[15] - D[10];
 
 		for(i = 10; i <= 18; i++){
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "a", A[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "b", B[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "c", C[i]);
-			fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "d", D[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "a", A[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "b", B[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "c", C[i]);
+			results_fprintf(outfile, "SecA_%d%s %0.2lf\n", i, "d", D[i]);
 		}
 
 		if((A[17] == 0) && (B[17] == 0) && (C[17] == 0) && (D[17] == 0)){
-			fprintf(outfile, "\n%s\n", "If line 17 on page 2 is zero for all payment periods, you don't owe a penalty.\nBut if you checked box C or D in Part II, you must file Form 2210 with your return.\nIf you checked box E, you must file page 1 of Form 2210 with your return.\nIn certain circumstances, the IRS will waive all or part of the underpayment\npenalty.  See Waiver of Penalty in the instructions.\n");
+			results_fprintf(outfile, "\n%s\n", "If line 17 on page 2 is zero for all payment periods, you don't owe a penalty.\nBut if you checked box C or D in Part II, you must file Form 2210 with your return.\nIf you checked box E, you must file page 1 of Form 2210 with your return.\nIn certain circumstances, the IRS will waive all or part of the underpayment\npenalty.  See Waiver of Penalty in the instructions.\n");
 
-		fprintf(outfile, "L19 %0.2lf\n", 0.0);
+		results_fprintf(outfile, "L19 %0.2lf\n", 0.0);
 		}
 		else{
-			fprintf(outfile, "\n%s\n", "There is an underpayment for one or more periods.\nUse the 	Worksheet for Form 2210, Part III, Section B-Figure the Penalty\n(Penalty Worksheet), in the instructions to figure your penalty.\nEnter the penalty amount in the OTS GUI for Form 2210 (last line).\n");
+			results_fprintf(outfile, "\n%s\n", "There is an underpayment for one or more periods.\nUse the 	Worksheet for Form 2210, Part III, Section B-Figure the Penalty\n(Penalty Worksheet), in the instructions to figure your penalty.\nEnter the penalty amount in the OTS GUI for Form 2210 (last line).\n");
 
-		fprintf(outfile, "L19 %0.2lf     %s\n\n", L[19], "This is the penalty amount YOU HAVE ENTERED.  It defaults to zero\nuntil you enter your penalty.  DO NOT INTERPRET THE DEFAULT ZERO VALUE TO\nINDICATE YOU DO NOT OWE A PENALTY.  See above instructions and the form 2210\ninstructions to determine if you need to calculate a penalty.");
+		results_fprintf(outfile, "L19 %0.2lf     %s\n\n", L[19], "This is the penalty amount YOU HAVE ENTERED.  It defaults to zero\nuntil you enter your penalty.  DO NOT INTERPRET THE DEFAULT ZERO VALUE TO\nINDICATE YOU DO NOT OWE A PENALTY.  See above instructions and the form 2210\ninstructions to determine if you need to calculate a penalty.");
 
-		fprintf(outfile, "%s\n", "In certain circumstances, the IRS will waive all or part of the underpayment\npenalty.  See Waiver of Penalty in the form 2210 instructions.\n");
+		results_fprintf(outfile, "%s\n", "In certain circumstances, the IRS will waive all or part of the underpayment\npenalty.  See Waiver of Penalty in the form 2210 instructions.\n");
 		}
 
 		for(i = 1; i <= 31; i++){
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
 		}
 
 		for(i = 33; i <= 36; i++){
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
-			fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "a", a[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "b", b[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "c", c[i]);
+			results_fprintf(outfile, "SchdAI_%d%s %0.2lf\n", i, "d", d[i]);
 		}
 
  fclose(infile);
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_f2210, argc, argv );
+}
@@ -17,18 +17,20 @@ float thisversion = 1.00;
 #define Yes 1
 #define No 0
 
+/* Taxable amounts.  (Also read by the 1040, when it computes this form.) */
+THREAD_LOCAL double L15a = 0.0, L15b = 0.0, L15c = 0.0;
+THREAD_LOCAL double L25a = 0.0, L25b = 0.0, L25c = 0.0;
+
 /*----------------------------------------------------------------------------*/
 
-int main(int argc, char *argv[])
+int taxsolve_f8606(int argc, char *argv[])
 {
   int i, j, k;
   int complete_part_one, complete_part_two, complete_part_three, dist_or_conv;
   char word[4000], outfname[4000], *infname = 0;
   time_t now;
-  double L15a = 0.0, L15b = 0.0, L15c = 0.0;
-  double L25a = 0.0, L25b = 0.0, L25c = 0.0;
 
-  printf("Form 8606, 2021 - v%3.2f\n", thisversion);
+  console_printf("Form 8606, 2021 - v%3.2f\n", thisversion);
 
   /* Decode any command-line arguments. */
   i = 1;
@@ -36,12 +38,18 @@ int main(int argc, char *argv[])
   while (i < argc) {
     if (strcmp(argv[i], "-verbose") == 0) {
       verbose = 1;
+    } else if (strcmp(argv[i], "-labels_any_order") == 0) {
+      labels_any_order = 1;
+    } else if (strcmp(argv[i], "-validate") == 0) {
+      validate_input = 1;
+    } else if (strcmp(argv[i], "-quiet") == 0) {
+      quiet = 1;
     } else if (k == 1) {
-      infname = strdup(argv[i]);
-      infile = fopen(infname, "r");
+      infname = return_strdup(argv[i]);
+      infile = taxsolve_fopen(infname, "r");
       if (infile == 0) {
-        printf("ERROR: Parameter file '%s' could not be opened.\n", infname);
-        exit(1);
+        console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname);
+        taxsolve_exit(1);
       }
       k = 2;
       /* Base name of output file on input file. */
@@ -53,21 +61,21 @@ int main(int argc, char *argv[])
         strcat(outfname, "_out.txt");
       else
         strcpy(&(outfname[j]), "_out.txt");
-      outfile = fopen(outfname, "w");
+      outfile = open_output_file(outfname);
       if (outfile == 0) {
-        printf("ERROR: Output file '%s' could not be opened.\n", outfname);
-        exit(1);
+        console_printf("ERROR: Output file '%s' could not be opened.\n", outfname);
+        taxsolve_exit(1);
       }
-      printf("Writing results to file:  %s\n", outfname);
+      console_printf("Writing results to file:  %s\n", outfname);
     } else {
-      printf("Unknown command-line parameter '%s'\n", argv[i]);
-      exit(1);
+      console_printf("Unknown command-line parameter '%s'\n", argv[i]);
+      taxsolve_exit(1);
     }
     i = i + 1;
   }
   if (infile == 0) {
-    printf("Error: No input file on command line.\n");
-    exit(1);
+    console_printf("Error: No input file on command line.\n");
+    taxsolve_exit(1);
   }
 
   /* Pre-initialize all lines to zeros. */
@@ -86,7 +94,7 @@ int main(int argc, char *argv[])
    */
   read_line(infile, word);
   now = time(0);
-  fprintf(outfile, "\n%s,  v%2.2f, %s\n", word, thisversion, ctime(&now));
+  results_fprintf(outfile, "\n%s,  v%2.2f, %s\n", word, thisversion, ctime(&now));
 
   // Begin form-specific code
 
@@ -140,8 +148,8 @@ int main(int argc, char *argv[])
       int integral_int, fractional_int;
       integral_int = integral;
       fractional_int = abs( (int)(1000.0 * fractional) );
-      fprintf(outfile, "L10intpart %d\n", integral_int);
-      fprintf(outfile, "L10rest %03d\n", fractional_int);
+      results_fprintf(outfile, "L10intpart %d\n", integral_int);
+      results_fprintf(outfile, "L10rest %03d\n", fractional_int);
 
       L[11] = L[8] * L[10];
       showline(11);
@@ -249,8 +257,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(outfile, "------------------------------\n");
-  fprintf(outfile, "\n{ --------- Identity-Information:  --------- }\n");
+  results_fprintf(outfile, "------------------------------\n");
+  results_fprintf(outfile, "\n{ --------- Identity-Information:  --------- }\n");
   GetTextLineF("Name:");
   GetTextLineF("SocSec#:");
   GetTextLineF("Number&Street:");
@@ -266,8 +274,16 @@ int main(int argc, char *argv[])
   grab_any_pdf_markups(infname, outfile);
   fclose(outfile);
 
-  printf("\nListing results from file: %s\n\n", outfname);
+  console_printf("\nListing results from file: %s\n\n", outfname);
   Display_File(outfname);
 
   return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_f8606, argc, argv );
+}
+#endif
@@ -22,7 +22,7 @@ float thisversion=2.00;
 
 /*----------------------------------------------------------------------------*/
 
-int main( int argc, char *argv[] )
+int taxsolve_f8960( int argc, char *argv[] )
 {
  int i, j, k;
  char word[6000], outfname[4000], *infname=0;
@@ -36,7 +36,7 @@ int main( int argc, char *argv[] )
 
  int status, individual = No;
 
- printf("Form 8960, 2021 - v%3.2f\n", thisversion);
+ console_printf("Form 8960, 2021 - v%3.2f\n", thisversion);
 
  /* Decode any command-line arguments. */
  i = 1;  k=1;
@@ -44,26 +44,32 @@ int main( int argc, char *argv[] )
  {
   if (strcmp(argv[i],"-verbose")==0)  { verbose = 1; }
   else
+  if (strcmp(argv[i],"-labels_any_order")==0)  { labels_any_order = 1; }
+  else
+  if (strcmp(argv[i],"-validate")==0)  { validate_input = 1; }
+  else
+  if (strcmp(argv[i],"-quiet")==0)  { quiet = 1; }
+  else
   if (k==1)
    {
-    infname = strdup(argv[i]);
-    infile = fopen(infname,"r");
-    if (infile==0) {printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); exit(1);}
+    infname = return_strdup(argv[i]);
+    infile = taxsolve_fopen(infname,"r");
+    if (infile==0) {console_printf("ERROR: Parameter file '%s' could not be opened.\n", infname ); taxsolve_exit(1);}
     k = 2;
     /* Base name of output file on input file. */
     strcpy(outfname,infname);
     j = strlen(outfname)-1;
     while ((j>=0) && (outfname[j]!='.')) j--;
     if (j<0) strcat(outfname,"_out.txt"); else strcpy(&(outfname[j]),"_out.txt");
-    outfile = fopen(outfname,"w");
-    if (outfile==0) {printf("ERROR: Output file '%s' could not be opened.\n", outfname); exit(1);}
-    printf("Writing results to file:  %s\n", outfname);
+    outfile = open_output_file( outfname );
+    if (outfile==0) {console_printf("ERROR: Output file '%s' could not be opened.\n", outfname); taxsolve_exit(1);}
+    console_printf("Writing results to file:  %s\n", outfname);
    }
   else
-   {printf("Unknown command-line parameter '%s'\n", argv[i]); exit(1);}
+   {console_printf("Unknown command-line parameter '%s'\n", argv[i]); taxsolve_exit(1);}
   i = i + 1;
  }
- if (infile==0) {printf("Error: No input file on command line.\n"); exit(1);}
+ if (infile==0) {console_printf("Error: No input file on command line.\n"); taxsolve_exit(1);}
 
  /* Pre-initialize all lines to zeros. */
  for (i=0; i<MAX_LINES; i++) { L[i] = 0.0; }
@@ -79,14 +85,14 @@ int main( int argc, char *argv[] )
  /* Accept Form's "Title" line, and put out with date-stamp for your records. */
  read_line( infile, word );
  now = time(0);
- fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
+ results_fprintf(outfile,"\n%s,  v%2.2f, %s\n", word, thisversion, ctime( &now ));
 
 
  /* ----- Accept form data and process the numbers.         ------ */
  /* ----- Place all your form-specific code below here .... ------ */
 
- fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
- fprintf(outfile,"--- NOT YET FULLY UPDATED FOR 2021. ---\n\n");
+ results_fprintf(outfile,"\n--- THIS IS PRELIMINARY USER-CONTRIBUTED FORM ---\n");
+ results_fprintf(outfile,"--- NOT YET FULLY UPDATED FOR 2021. ---\n\n");
 
  // MarkupPDF( 1, 240, 40, 17, 1.0, 0, 0 ) NotReady "This program is NOT updated for 2021."
  add_pdf_markup( "NotReady", 1, 240, 40, 17, 1, 1.0, 0, 0, "\"This program is NOT ready for 2021.\"" );
@@ -110,31 +116,31 @@ int main( int argc, char *argv[] )
  if (strncasecmp(word,"Widow",4)==0) status = WIDOW;
  else
   { 
-   printf("Error: unrecognized status '%s'. Exiting.\n", word); 
-   fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
-   exit(1);
+   console_printf("Error: unrecognized status '%s'. Exiting.\n", word); 
+   results_fprintf(outfile,"Error: unrecognized status '%s'. Exiting.\n", word); 
+   taxsolve_exit(1);
   }
- fprintf(outfile,"Status = %s (%d)\n", word, status);
+ results_fprintf(outfile,"Status = %s (%d)\n", word, status);
 
  get_parameter( infile, 's', word, "Entity" );
  get_parameter( infile, 'l', word, "Entity?");
  if (strncasecmp(word,"Individual",3)==0) individual = Yes;
- fprintf(outfile,"Entity = %s (%d)\n", word, individual);
+ results_fprintf(outfile,"Entity = %s (%d)\n", word, individual);
      
  get_parameter( infile, 's', word, "Sec6013g" );
  get_parameter( infile, 'l', word, "Sec6013g?");
  if (strncasecmp(word,"Yes",1)==0)
-   fprintf(outfile, "CkSec6013g X\n");
+   results_fprintf(outfile, "CkSec6013g X\n");
   
  get_parameter( infile, 's', word, "Sec6013h" );
  get_parameter( infile, 'l', word, "Sec6013h?");
  if (strncasecmp(word,"Yes",1)==0)
-   fprintf(outfile, "CkSec6013h X\n");
+   results_fprintf(outfile, "CkSec6013h X\n");
   
  get_parameter( infile, 's', word, "Sec1141_10g" );
  get_parameter( infile, 'l', word, "Sec1141_10g?");
  if (strncasecmp(word,"Yes",1)==0)
-   fprintf(outfile, "CkSec1141_10g X\n");  
+   results_fprintf(outfile, "CkSec1141_10g X\n");  
 
  GetLineF( "L1", &L[1] );
  GetLineF( "L2", &L[2] );
@@ -224,8 +230,16 @@ int main( int argc, char *argv[] )
  grab_any_pdf_markups( infname, outfile );
  fclose(outfile);
 
- printf("\nListing results from file: %s\n\n", outfname);
+ console_printf("\nListing results from file: %s\n\n", outfname);
  Display_File( outfname );
 
  return 0;
 }
+
+
+#ifndef NO_MAIN
+int main( int argc, char *argv[] )
+{
+ return run_return( taxsolve_f8960, argc, argv );
+}
+#endif
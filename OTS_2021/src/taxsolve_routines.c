@@ -25,31 +25,153 @@
 /* Aston Roberts 1-1-2004	aston_roberts@yahoo.com			*/
 /************************************************************************/
 
+#ifndef TAXSOLVE_ROUTINES_INCLUDED	/* The 1040 includes sub-form solvers, which include this too. */
+#define TAXSOLVE_ROUTINES_INCLUDED
+
 #include <stdio.h>
 #include <time.h>
 #include <string.h>
 #include <strings.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef __MINGW32__
+#include <sys/mman.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TAX_BATCH_X86	/* Vector kernels for scheduled_tax_batch. */
+#endif
+#include "string_routines.c"
 
 #define MAX_LINES 1000
 
-double L[MAX_LINES];	/* Declare the Line entry variables. */
-char errmsg[15000];
+/* The state of the return being computed is kept per-thread, so that one process */
+/* may compute several returns at once, each on its own thread.  (See run_return.) */
+#ifdef _MSC_VER
+ #define THREAD_LOCAL __declspec(thread)
+#else
+ #define THREAD_LOCAL __thread
+#endif
+
+THREAD_LOCAL double L[MAX_LINES];	/* Declare the Line entry variables. */
+THREAD_LOCAL char errmsg[15000];
+
+THREAD_LOCAL FILE *infile=0,	 /* Main input file to be used for reading tax input data. */
+		  *outfile=0;	 /* Main output file. */
+THREAD_LOCAL int verbose=0;	 /* Declare and set the "verbosity" flag. */
+THREAD_LOCAL int notappvalue=0;
+THREAD_LOCAL int single_line_entry=0;
+THREAD_LOCAL int whole_line_entry=0;
+THREAD_LOCAL int round_to_whole_dollars=0;	/* Option to use whole-dollars. */
+THREAD_LOCAL int labels_any_order=0;	/* Option to look-up line labels wherever they appear in the input file. */
+THREAD_LOCAL int validate_input=0;	/* Option to collect all input errors, rather than stop at the first. */
+THREAD_LOCAL int quiet=0;		/* Option to not echo results to the console, for batch runs. */
+THREAD_LOCAL jmp_buf *return_abort=0;	/* Where taxsolve_exit goes, when inside run_return. */
+THREAD_LOCAL struct mem_pool return_pool;	/* Holds records and strings that last until the return is done. */
+
+
+/* Stop computing the current return.  Exits the process, unless the return is being run by run_return. */
+void taxsolve_exit( int code )
+{
+ if (return_abort != 0)
+  longjmp( *return_abort, (code != 0) ? code : 1 );
+ exit( code );
+}
+
+/* Console messages go through console_printf, which -quiet silences.  The results	*/
+/* (and any errors) are still written to the output file, and the exit status is	*/
+/* still set, so batch runs need not spend time formatting the console echo.		*/
+int console_printf( const char *fmt, ... )
+{
+ va_list ap;
+ int n;
+ if (quiet) return 0;
+ va_start( ap, fmt );
+ n = vprintf( fmt, ap );
+ va_end( ap );
+ return n;
+}
+
+
+/* Results go through results_fprintf, which discard_results silences, for runs	*/
+/* that want only the computed lines (such as what-if re-runs of a return).	*/
+/* Then the output file is the null device, and nothing is formatted for it.	*/
+/* While the 1040 is recording its federal snapshot, its results are also	*/
+/* handed to record_fed_results as they are written.  (See below.)		*/
+THREAD_LOCAL int discard_results=0;
+THREAD_LOCAL int recording_fed_snapshot=0;
+
+int record_fed_results( FILE *fp, const char *fmt, va_list ap );	/* Prototypes. */
+void note_fed_amount( char *text, double value );
+
+int results_fprintf( FILE *fp, const char *fmt, ... )
+{
+ va_list ap;
+ int n;
+ if ((discard_results) && (fp == outfile)) return 0;
+ va_start( ap, fmt );
+ if ((recording_fed_snapshot) && (fp == outfile))
+  n = record_fed_results( fp, fmt, ap );
+ else
+  n = vfprintf( fp, fmt, ap );
+ va_end( ap );
+ return n;
+}
+
+
+#ifdef __MINGW32__
+ #define NULL_DEVICE "NUL"
+#else
+ #define NULL_DEVICE "/dev/null"
+#endif
+
+
+/* Open the results file.  It is written through one large buffer, so that a	*/
+/* return's output normally reaches the file in a single write when it is closed. */
+#define OUTPUT_BUFFER_SIZE  (1 << 20)
+THREAD_LOCAL char *output_buffer=0;	/* Freed by run_return. */
+
+FILE *open_output_file( char *fname )
+{
+ FILE *fp;
+ if (discard_results)
+  return fopen( NULL_DEVICE, "w" );
+ fp = fopen( fname, "w" );
+ if (fp == 0)
+  return 0;
+ if (output_buffer == 0)
+  output_buffer = (char *)malloc( OUTPUT_BUFFER_SIZE );
+ if (output_buffer != 0)
+  setvbuf( fp, output_buffer, _IOFBF, OUTPUT_BUFFER_SIZE );
+ return fp;
+}
+
+
+/* Allocate zeroed memory, or copy a string, that lasts until the current return is finished. */
+/* (Such memory must not be passed to free.  It is all released by run_return at once.) */
+void *return_alloc( size_t size )
+{
+ return pool_alloc( &return_pool, size );
+}
 
-FILE *infile=0,	 /* Main input file to be used for reading tax input data. */
-     *outfile=0; /* Main output file. */
-int verbose=0;	 /* Declare and set the "verbosity" flag. */
-int notappvalue=0;
-int single_line_entry=0;
-int whole_line_entry=0;
-int round_to_whole_dollars=0;	/* Option to use whole-dollars. */
+char *return_strdup( char *str )
+{
+ return pool_strdup( &return_pool, str );
+}
 
 struct date_rec  /* Used by get_gain_and_losses  and  gen_date_rec */
 {
   int month;
   int day;
   int year;
+  int daynum;	/* Days since 1-1-0000, for comparing dates. */
 };
 
 
@@ -59,9 +181,9 @@ struct date_rec  /* Used by get_gain_and_losses  and  gen_date_rec */
 
 void show_errmsg( char *emsg )
 {
- printf("%s\n", emsg );
+ console_printf("%s\n", emsg );
  if (outfile != 0)
-  fprintf(outfile,"%s\n", emsg );
+  results_fprintf(outfile,"%s\n", emsg );
 }
 
 int Round( double x )
@@ -77,65 +199,1163 @@ double Conditional_Round( double x )
 }
 
 
+/*------------------------------------------------------------------------------*/
+/* Money - Amounts held as a whole number of cents, so that sums and products	*/
+/*  with tax rates are exact and do not depend on the compiler's floating-point	*/
+/*  code.  Rates are held in millionths (parts-per-million).  The rounding	*/
+/*  rules are explicit:  to_money, money_times_rate, and money_round_dollars	*/
+/*  all round halves away from zero, as the tax forms do.  Line values remain	*/
+/*  doubles; convert with to_money and money_to_dollars where exact		*/
+/*  arithmetic matters.								*/
+/*------------------------------------------------------------------------------*/
+typedef long long money;	/* Cents. */
+
+#define MONEY_MAX	0x7fffffffffffffffLL
+#define DOLLARS(d)	((money)(d) * 100)		/* Whole-dollar constant. */
+#define MONEY(x)	((money)((x) * 100.0 + (((x) < 0) ? -0.5 : 0.5)))	/* Dollars-and-cents constant. */
+#define RATE(r)		((long long)((r) * 1000000.0 + 0.5))	/* Rate constant, as millionths. */
+
+money to_money( double x )	/* Nearest cent. */
+{
+ double c = x * 100.0;
+ return (money)((c < 0.0) ? c - 0.5 : c + 0.5);
+}
+
+double money_to_dollars( money m )
+{
+ return (double)m / 100.0;
+}
+
+money money_times_rate( money m, long long rate )	/* Nearest cent of m * rate. */
+{
+ long long p = m * rate;
+ return (p < 0) ? -((-p + 500000) / 1000000) : (p + 500000) / 1000000;
+}
+
+money money_round_dollars( money m )	/* Nearest whole dollar. */
+{
+ return (m < 0) ? -(((-m + 50) / 100) * 100) : ((m + 50) / 100) * 100;
+}
+
+money money_rated_dollars( money base, money m, long long rate )   /* Nearest whole dollar of base + m * rate. */
+{	/* (Rounded once, from millionths of a cent, so that no cents-rounding step can tip a half-dollar.) */
+ long long p = base * 1000000 + m * rate;
+ return (p < 0) ? -(((-p + 50000000) / 100000000) * 100) : ((p + 50000000) / 100000000) * 100;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Tax Schedules - One engine for the graduated-rate tax of every solver.	*/
+/*  A schedule lists each bracket's starting income and rate, and the tax on	*/
+/*  the income below each start.  Where the instructions publish those (some	*/
+/*  round them, or set them apart from the rates), they are given as such;	*/
+/*  otherwise the schedule says TAX_BASES_COMPUTED, and they are precomputed	*/
+/*  from the rates on first use.  The bracket is found by counting the starts	*/
+/*  below the income, without branching, and one look-up gives both the tax	*/
+/*  and the marginal rate.  Amounts are exact cents and rates are millionths	*/
+/*  (as RATE), so the tax is exact until rounded as the caller asks:		*/
+/*  TAX_EXACT, TAX_CENTS, or TAX_DOLLARS (once, to the nearest whole dollar).	*/
+/*  Schedules should be THREAD_LOCAL, since the first use fills them in.	*/
+/*------------------------------------------------------------------------------*/
+#define MAX_TAX_BRACKETS 12
+
+#define TAX_BASES_GIVEN		0
+#define TAX_BASES_COMPUTED	1
+
+#define TAX_EXACT	0
+#define TAX_CENTS	1
+#define TAX_DOLLARS	100
+
+struct tax_schedule
+ {
+  int nbrackets;
+  int at_start;		/* 1 if income equal to a start is taxed in that bracket, 0 if in the one below. */
+  int bases;		/* TAX_BASES_GIVEN or TAX_BASES_COMPUTED. */
+  money start[MAX_TAX_BRACKETS];	/* Start[0] is the lowest income taxed, usually 0. */
+  long long rate[MAX_TAX_BRACKETS];	/* RATE() on income above the start. */
+  money base[MAX_TAX_BRACKETS];		/* Tax on income up to the start. */
+  money cut[MAX_TAX_BRACKETS];		/* Incomes above which each bracket applies, padded with MONEY_MAX. */
+  int ready;
+ };
+
+
+void setup_tax_schedule( struct tax_schedule *s )
+{
+ int k;
+
+ for (k=0; k < MAX_TAX_BRACKETS; k++)
+  if ((k == 0) || (k >= s->nbrackets))
+   s->cut[k] = (k == 0) ? -MONEY_MAX : MONEY_MAX;
+  else
+   s->cut[k] = s->start[k] - s->at_start;	/* (Income and starts are whole cents.) */
+ if (s->bases == TAX_BASES_COMPUTED)
+  for (k=1; k < s->nbrackets; k++)
+   s->base[k] = s->base[k-1] + money_times_rate( s->start[k] - s->start[k-1], s->rate[k-1] );
+ s->ready = 1;
+}
+
+
+int tax_bracket( struct tax_schedule *s, money income )	/* Index of the bracket income falls in. */
+{
+ int k, bracket=0;
+
+ if (!s->ready)
+  setup_tax_schedule( s );
+ for (k=1; k < MAX_TAX_BRACKETS; k++)
+  bracket = bracket + (income > s->cut[k]);
+ return bracket;
+}
+
+
+/* Tax on income, rounded as asked, and, if rate is not zero, the marginal rate there. */
+double scheduled_tax( struct tax_schedule *s, double income, int rounding, double *rate )
+{
+ money m=to_money( income );
+ long long p;
+ int b;
+
+ b = tax_bracket( s, m );
+ if (rate != 0)
+  *rate = (double)(s->rate[b]) / 1000000.0;
+ p = s->base[b] * 1000000 + (m - s->start[b]) * s->rate[b];	/* Millionths of a cent. */
+ if (rounding == TAX_EXACT)
+  return (double)p / 100000000.0;
+ if (rounding == TAX_CENTS)
+  return money_to_dollars( (p < 0) ? -((-p + 500000) / 1000000) : (p + 500000) / 1000000 );
+ return money_to_dollars( (p < 0) ? -(((-p + 50000000) / 100000000) * 100) : ((p + 50000000) / 100000000) * 100 );
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Scheduled_Tax_Batch - Scheduled_tax over n incomes at once, for planning	*/
+/*  tools that evaluate many (income, status) pairs.  The inputs and outputs	*/
+/*  are parallel arrays:  income[i] is taxed on schedules[which[i]], giving	*/
+/*  tax[i] and, if rate is not zero, rate[i].  The results are those of	*/
+/*  scheduled_tax, to the bit.							*/
+/*  Incomes are sorted by schedule, a block at a time, and each schedule's	*/
+/*  are taxed by a vector kernel (AVX four at a time, SSE2 two).  The kernels	*/
+/*  rewrite the schedule as a sum of terms, one per bracket start, so that	*/
+/*  every lane adds up its own brackets without a table look-up:		*/
+/*	tax = sum, over the starts below income, of term_add + income*term_rate	*/
+/*  in millionths of a cent held in doubles.  Below 2^31 cents, every product	*/
+/*  and partial sum is an integer under 2^53, so nothing is rounded until the	*/
+/*  final floor of a quotient, which is exact there too.  Other incomes	*/
+/*  (negative, over $21 million, or not numbers) go to scheduled_tax, as do	*/
+/*  those on schedules past the first MAX_BATCH_SCHEDULES.  An income whose	*/
+/*  which[i] is not a schedule gets a tax (and rate) of zero;  the number of	*/
+/*  these is returned, so the caller can treat them as the error they are.	*/
+/*  Tax_batch_kernel picks the kernel; by default, the best the CPU has.	*/
+/*------------------------------------------------------------------------------*/
+#define MAX_BATCH_SCHEDULES	8
+#define TAX_BATCH_BLOCK		512
+
+#define TAX_BATCH_AUTO		0
+#define TAX_BATCH_SCALAR	1
+#define TAX_BATCH_SSE2		2
+#define TAX_BATCH_AVX		3
+
+int tax_batch_kernel=TAX_BATCH_AUTO;
+
+struct tax_batch_terms
+ {
+  int nbrackets;
+  double lowest;	/* Smallest income, in cents, the kernels may take. */
+  double cut[MAX_TAX_BRACKETS], term_add[MAX_TAX_BRACKETS], term_rate[MAX_TAX_BRACKETS];
+ };
+
+#define TAX_BATCH_LIMIT	2147483648.0	/* 2^31 cents. */
+
+
+/* Fill in the terms.  Returns 0 if the schedule is outside what the kernels handle exactly. */
+int tax_batch_terms( struct tax_schedule *s, struct tax_batch_terms *t )
+{
+ int k;
+
+ if (!s->ready)
+  setup_tax_schedule( s );
+ t->nbrackets = s->nbrackets;
+ t->lowest = (s->start[0] > 0) ? (double)(s->start[0]) : 0.0;
+ for (k=0; k < s->nbrackets; k++)
+  {	/* Rising starts, rates up to 100%, and bases no more than the start keep the sums exact. */
+   if ((s->rate[k] < 0) || (s->rate[k] > 1000000) || (s->base[k] < 0) || (s->start[k] < 0)
+       || (s->base[k] > s->start[k]) || (s->start[k] >= (money)TAX_BATCH_LIMIT)
+       || ((k > 1) && (s->cut[k] <= s->cut[k-1])))
+    return 0;
+   if (k == 0)
+    {
+     t->cut[k] = -1.0;
+     t->term_add[k] = (double)(s->base[0] * 1000000 - s->start[0] * s->rate[0]);
+     t->term_rate[k] = (double)(s->rate[0]);
+    }
+   else
+    {
+     t->cut[k] = (double)(s->cut[k]);
+     t->term_add[k] = (double)((s->base[k] - s->base[k-1]) * 1000000
+				- s->start[k] * s->rate[k] + s->start[k-1] * s->rate[k-1]);
+     t->term_rate[k] = (double)(s->rate[k] - s->rate[k-1]);
+    }
+  }
+ return 1;
+}
+
+
+#ifdef TAX_BATCH_X86
+
+__attribute__((target("sse2")))
+static __m128d floor_sse2( __m128d y )		/* Floor, for 0 <= y < 2^52. */
+{
+ __m128d two52 = _mm_set1_pd( 4503599627370496.0 ), r;
+ r = _mm_sub_pd( _mm_add_pd( y, two52 ), two52 );
+ return _mm_sub_pd( r, _mm_and_pd( _mm_cmpgt_pd( r, y ), _mm_set1_pd( 1.0 ) ) );
+}
+
+/* Taxes the incomes listed in idx[0..n), two at a time.  Returns how many were done. */
+__attribute__((target("sse2")))
+static int tax_batch_sse2( struct tax_batch_terms *t, const double *income, const int *idx, int n,
+			   int rounding, double *tax, double *rate )
+{
+ __m128d m, on, p, r;
+ double tx[2], rt[2];
+ int i, k;
+
+ for (i=0; i + 2 <= n; i += 2)
+  {
+   m = _mm_mul_pd( _mm_set_pd( income[idx[i+1]], income[idx[i]] ), _mm_set1_pd( 100.0 ) );
+   m = floor_sse2( _mm_add_pd( m, _mm_set1_pd( 0.5 ) ) );	/* As to_money, for incomes in range. */
+   if (_mm_movemask_pd( _mm_and_pd( _mm_cmpge_pd( m, _mm_set1_pd( t->lowest ) ),
+				    _mm_cmplt_pd( m, _mm_set1_pd( TAX_BATCH_LIMIT ) ) ) ) != 3)
+    break;
+   p = _mm_setzero_pd();
+   r = _mm_setzero_pd();
+   for (k=0; k < t->nbrackets; k++)
+    {
+     on = _mm_cmpgt_pd( m, _mm_set1_pd( t->cut[k] ) );
+     p = _mm_add_pd( p, _mm_and_pd( on, _mm_add_pd( _mm_mul_pd( m, _mm_set1_pd( t->term_rate[k] ) ),
+						    _mm_set1_pd( t->term_add[k] ) ) ) );
+     r = _mm_add_pd( r, _mm_and_pd( on, _mm_set1_pd( t->term_rate[k] ) ) );
+    }
+   if (rounding == TAX_EXACT)
+    p = _mm_div_pd( p, _mm_set1_pd( 100000000.0 ) );
+   else
+   if (rounding == TAX_CENTS)
+    p = _mm_div_pd( floor_sse2( _mm_div_pd( _mm_add_pd( p, _mm_set1_pd( 500000.0 ) ), _mm_set1_pd( 1000000.0 ) ) ),
+		    _mm_set1_pd( 100.0 ) );
+   else
+    p = floor_sse2( _mm_div_pd( _mm_add_pd( p, _mm_set1_pd( 50000000.0 ) ), _mm_set1_pd( 100000000.0 ) ) );
+   _mm_storeu_pd( tx, p );
+   tax[idx[i]] = tx[0];  tax[idx[i+1]] = tx[1];
+   if (rate != 0)
+    {
+     _mm_storeu_pd( rt, _mm_div_pd( r, _mm_set1_pd( 1000000.0 ) ) );
+     rate[idx[i]] = rt[0];  rate[idx[i+1]] = rt[1];
+    }
+  }
+ return i;
+}
+
+/* Taxes the incomes listed in idx[0..n), four at a time.  Returns how many were done. */
+__attribute__((target("avx")))
+static int tax_batch_avx( struct tax_batch_terms *t, const double *income, const int *idx, int n,
+			  int rounding, double *tax, double *rate )
+{
+ __m256d m, on, p, r;
+ double tx[4], rt[4];
+ int i, k;
+
+ for (i=0; i + 4 <= n; i += 4)
+  {
+   m = _mm256_mul_pd( _mm256_set_pd( income[idx[i+3]], income[idx[i+2]], income[idx[i+1]], income[idx[i]] ),
+		      _mm256_set1_pd( 100.0 ) );
+   m = _mm256_floor_pd( _mm256_add_pd( m, _mm256_set1_pd( 0.5 ) ) );	/* As to_money, for incomes in range. */
+   if (_mm256_movemask_pd( _mm256_and_pd( _mm256_cmp_pd( m, _mm256_set1_pd( t->lowest ), _CMP_GE_OQ ),
+					  _mm256_cmp_pd( m, _mm256_set1_pd( TAX_BATCH_LIMIT ), _CMP_LT_OQ ) ) ) != 15)
+    break;
+   p = _mm256_setzero_pd();
+   r = _mm256_setzero_pd();
+   for (k=0; k < t->nbrackets; k++)
+    {
+     on = _mm256_cmp_pd( m, _mm256_set1_pd( t->cut[k] ), _CMP_GT_OQ );
+     p = _mm256_add_pd( p, _mm256_and_pd( on, _mm256_add_pd( _mm256_mul_pd( m, _mm256_set1_pd( t->term_rate[k] ) ),
+							     _mm256_set1_pd( t->term_add[k] ) ) ) );
+     r = _mm256_add_pd( r, _mm256_and_pd( on, _mm256_set1_pd( t->term_rate[k] ) ) );
+    }
+   if (rounding == TAX_EXACT)
+    p = _mm256_div_pd( p, _mm256_set1_pd( 100000000.0 ) );
+   else
+   if (rounding == TAX_CENTS)
+    p = _mm256_div_pd( _mm256_floor_pd( _mm256_div_pd( _mm256_add_pd( p, _mm256_set1_pd( 500000.0 ) ),
+						       _mm256_set1_pd( 1000000.0 ) ) ), _mm256_set1_pd( 100.0 ) );
+   else
+    p = _mm256_floor_pd( _mm256_div_pd( _mm256_add_pd( p, _mm256_set1_pd( 50000000.0 ) ), _mm256_set1_pd( 100000000.0 ) ) );
+   _mm256_storeu_pd( tx, p );
+   tax[idx[i]] = tx[0];  tax[idx[i+1]] = tx[1];  tax[idx[i+2]] = tx[2];  tax[idx[i+3]] = tx[3];
+   if (rate != 0)
+    {
+     _mm256_storeu_pd( rt, _mm256_div_pd( r, _mm256_set1_pd( 1000000.0 ) ) );
+     rate[idx[i]] = rt[0];  rate[idx[i+1]] = rt[1];  rate[idx[i+2]] = rt[2];  rate[idx[i+3]] = rt[3];
+    }
+  }
+ return i;
+}
+
+#endif
+
+
+/* The kernel scheduled_tax_batch will use, after resolving TAX_BATCH_AUTO. */
+int tax_batch_kernel_in_use()
+{
+#ifdef TAX_BATCH_X86
+ if ((tax_batch_kernel == TAX_BATCH_AVX) || (tax_batch_kernel == TAX_BATCH_AUTO))
+  if (__builtin_cpu_supports( "avx" ))
+   return TAX_BATCH_AVX;
+ if (tax_batch_kernel != TAX_BATCH_SCALAR)
+  if (__builtin_cpu_supports( "sse2" ))
+   return TAX_BATCH_SSE2;
+#endif
+ return TAX_BATCH_SCALAR;
+}
+
+
+int scheduled_tax_batch( struct tax_schedule *schedules[], int nschedules, const double *income, const int *which,
+			 int n, int rounding, double *tax, double *rate )
+{
+ struct tax_batch_terms terms[MAX_BATCH_SCHEDULES];
+ int idx[MAX_BATCH_SCHEDULES][TAX_BATCH_BLOCK], count[MAX_BATCH_SCHEDULES], vector[MAX_BATCH_SCHEDULES];
+ int kernel, nvector, block, end, i, j, k, done, bad=0;
+
+ kernel = tax_batch_kernel_in_use();
+ nvector = (nschedules < MAX_BATCH_SCHEDULES) ? nschedules : MAX_BATCH_SCHEDULES;
+ for (j=0; j < nvector; j++)
+  vector[j] = (kernel != TAX_BATCH_SCALAR) && tax_batch_terms( schedules[j], &(terms[j]) );
+ for (block=0; block < n; block += TAX_BATCH_BLOCK)
+  {
+   end = (n - block < TAX_BATCH_BLOCK) ? n : block + TAX_BATCH_BLOCK;
+   for (j=0; j < nvector; j++)
+    count[j] = 0;
+   for (i=block; i < end; i++)	/* Sort the block by schedule, keeping the rest for scheduled_tax. */
+    {
+     j = which[i];
+     if ((j < 0) || (j >= nschedules))
+      {
+       tax[i] = 0.0;
+       if (rate != 0) rate[i] = 0.0;
+       bad++;
+      }
+     else
+     if ((j < nvector) && vector[j] && (income[i] >= 0.0) && (income[i] < 0.01 * TAX_BATCH_LIMIT))
+      idx[j][count[j]++] = i;
+     else
+      tax[i] = scheduled_tax( schedules[j], income[i], rounding, (rate != 0) ? rate + i : 0 );
+    }
+   for (j=0; j < nvector; j++)
+    for (k=0; k < count[j]; k += done)
+     {
+      done = 0;
+      #ifdef TAX_BATCH_X86
+       if (kernel == TAX_BATCH_AVX)
+        done = tax_batch_avx( &(terms[j]), income, idx[j] + k, count[j] - k, rounding, tax, rate );
+       else
+        done = tax_batch_sse2( &(terms[j]), income, idx[j] + k, count[j] - k, rounding, tax, rate );
+      #endif
+      if (done == 0)
+       {	/* The odd ones left over, and any group holding an income the kernel does not take. */
+        i = idx[j][k];
+        tax[i] = scheduled_tax( schedules[j], income[i], rounding, (rate != 0) ? rate + i : 0 );
+        done = 1;
+       }
+     }
+  }
+ return bad;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Format_Amount - Formats x exactly as printf's "%6.2f" does, but with integer	*/
+/*  arithmetic, which is several times faster.  Rounding to cents is done on	*/
+/*  x*100, which can differ from printf's rounding of the exact value of x only	*/
+/*  when x*100 lies within its rounding error of a half-cent;  those rare	*/
+/*  values (and huge or non-finite ones) are handed to snprintf instead.	*/
+/*  Buf must hold AMOUNT_BUFSZ characters (enough for any double).  Returns buf. */
+/*  While a federal snapshot is recorded, the amount is noted with its value.	*/
+/*------------------------------------------------------------------------------*/
+#define AMOUNT_BUFSZ 400
+
+char *format_amount( double x, char *buf )
+{
+ char tmp[32], *pt;
+ double y, frac, err;
+ money c, cents;
+ int neg, j;
+
+ y = x * 100.0;
+ if (!((y > -1e15) && (y < 1e15)))
+  { snprintf( buf, AMOUNT_BUFSZ, "%6.2f", x );  return buf; }
+ neg = (x < 0.0) || ((x == 0.0) && (1.0 / x < 0.0));	/* (Printf shows -0.00.) */
+ if (neg) y = -y;
+ c = (money)y;
+ frac = y - (double)c;
+ err = y * 2.3e-16;
+ if ((frac > 0.5 - err) && (frac < 0.5 + err))
+  { snprintf( buf, AMOUNT_BUFSZ, "%6.2f", x );  return buf; }
+ if (frac > 0.5) c++;
+ cents = c;
+ pt = &(tmp[31]);
+ *pt = '\0';
+ *--pt = '0' + c % 10;  c /= 10;
+ *--pt = '0' + c % 10;  c /= 10;
+ *--pt = '.';
+ do { *--pt = '0' + c % 10;  c /= 10; } while (c > 0);
+ if (neg) *--pt = '-';
+ if (recording_fed_snapshot)
+  note_fed_amount( pt, neg ? -(cents / 100.0) : cents / 100.0 );
+ j = 0;
+ while (&(tmp[31]) - pt + j < 6)
+  buf[j++] = ' ';
+ strcpy( &(buf[j]), pt );
+ return buf;
+}
+
+
 void intercept_any_pragmas( FILE *infile, char *word );	/* Prototype. */
-void consume_leading_trailing_whitespace( char *line );
 
 
 /*------------------------------------------------------------------------------*/
-/* Get_Word - Read next word from input file, while ignoring any comments.	*/
+/* Input Buffers - The first time a tax-input file is read by the routines	*/
+/* below, its whole contents are mapped (or read) into memory once, and all	*/
+/* later tokenizing scans bytes from memory instead of calling getc() for	*/
+/* each character.  The FILE itself is left positioned at its end, and its	*/
+/* end-of-file flag is raised when the buffer runs out, so that callers may	*/
+/* still test feof(infile) as before.  Streams that cannot be positioned	*/
+/* (such as pipes) are read through stdio directly.				*/
 /*------------------------------------------------------------------------------*/
-void get_word( FILE *infile, char *word )	/* Absorb comments. */
+#define MAX_INPUT_BUFFERS 8
+
+struct label_index;
+struct otsb_token;
+struct otsb_markup;
+
+THREAD_LOCAL struct input_buffer
+ {
+  FILE *fp;
+  char *data;		/* File contents.  Zero when reading through stdio. */
+  long len, pos;	/* Length of contents, and next byte to be read. */
+  long tokpos;		/* Where the last token read began, for error locations. */
+  long linepos;		/* Where the last error located was, and its line number, */
+  int line;		/*  from which the next one is counted.  (Zero before the first.) */
+  int mapped, eof;
+  struct label_index *index;	/* Built on first look-up, when labels_any_order is set. */
+  char *base;		/* Start of the mapping (or allocation), which precedes data in a compiled return. */
+  long baselen;
+  struct otsb_token *tokens;	/* Pre-read tokens of a compiled return, or zero.  (See below.) */
+  long ntokens, tokcur;
+  char *strings;
+  struct otsb_markup *markups;
+  long nmarkups;
+  int compiled;
+  int borrowed;		/* Contents are preloaded_input, which belongs to someone else. */
+ } input_buffers[MAX_INPUT_BUFFERS];
+
+struct token_view	/* A token returned without copying.  Not null-terminated. */
+ {
+  char *text;
+  int len;
+ };
+
+#define IB_GETC(ib)  (((ib)->pos < (ib)->len) ? (ib)->data[(ib)->pos++] : input_buffer_underflow(ib))
+#define IB_EOF(ib)   (((ib)->data != 0) ? (ib)->eof : feof((ib)->fp))
+
+
+int input_buffer_underflow( struct input_buffer *ib )
 {
- int j=0;
- char ltc='\n';	 /* Line termination character. */
+ if (ib->data == 0)
+  return getc( ib->fp );
+ if (!ib->eof)
+  {
+   ib->eof = 1;
+   getc( ib->fp );	/* Raise the stdio end-of-file flag too. */
+  }
+ return EOF;
+}
+
+
+void input_buffer_ungetc( int c, struct input_buffer *ib )
+{
+ if (ib->data == 0)
+  { ungetc( c, ib->fp );  return; }
+ if ((c == EOF) || (ib->pos == 0))
+  return;
+ ib->pos--;
+ if (ib->eof)
+  { ib->eof = 0;  clearerr( ib->fp ); }
+}
+
+
+void release_label_index( struct label_index *lx );	/* Prototype. */
+
+void release_input_buffer( struct input_buffer *ib )
+{
+ if (ib->index != 0)
+  release_label_index( ib->index );
+ if (ib->data != 0)
+  {
+  #ifndef __MINGW32__
+   if (ib->mapped)
+    munmap( ib->base, ib->baselen );
+   else
+  #endif
+   if (!ib->borrowed)
+    free( ib->base );
+  }
+ memset( ib, 0, sizeof(struct input_buffer) );
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Compiled Returns - Ots_compile converts a tax-input file into a binary	*/
+/*  ".otsb" file, which any solver reads in place of the text.  It holds the	*/
+/*  original text verbatim (so character-level readers, and decompiling, are	*/
+/*  exact), followed by every token that get_token reads from it in the	*/
+/*  default mode, already split-out, with its value when it is a number,	*/
+/*  plus the lines holding PDF markups.  Get_token then answers from the	*/
+/*  table whenever it is asked for a token where the compiler read one, and	*/
+/*  otherwise scans the text as usual.					*/
+/*  The layout is that of the compiling machine; the header's byte-order mark	*/
+/*  and record size reject files compiled elsewhere.				*/
+/*------------------------------------------------------------------------------*/
+#define OTSB_MAGIC	"OTSBIN\r\n"
+#define OTSB_MAGIC_LEN	8
+#define OTSB_BYTEORDER	0x01020304
+#define OTSB_VERSION	2
+
+struct otsb_header
+ {
+  char magic[OTSB_MAGIC_LEN];
+  unsigned int byteorder, version, token_size;
+  unsigned int text_offset, text_len;
+  unsigned int tokens_offset, ntokens;
+  unsigned int strings_offset, strings_len;
+  unsigned int markups_offset, nmarkups;
+ };
+
+#define OTSB_AT_EOF	1	/* Reading the token reached the end of the text. */
+#define OTSB_IN_STRINGS	2	/* Token text is in the strings section, not the text section. */
+#define OTSB_NO_TOKPOS	4	/* No token was started, so tokpos is not changed. */
+#define OTSB_FLOAT	8	/* Value is the token's scan_float value. */
+#define OTSB_INT	16	/* And scan_int takes it too.  (Invalid scans are re-done from the text.) */
+
+struct numeric_scan
+ {
+  double value;		/* Converted decimal value. */
+  int ivalue;		/* Converted integer value. */
+  int error, column;	/* Kind and location of any error. */
+  int end;		/* Offset just past the leading number. */
+ };
+
+struct otsb_token
+ {
+  unsigned int from;		/* Reading from 'from' gives this token. */
+  unsigned int tokpos, end;	/* Where the token began, and where reading stopped. */
+  unsigned int text, len;	/* Offset and length of the token's text. */
+  unsigned int flags;
+  double value;			/* When OTSB_FLOAT. */
+ };
+
+struct otsb_markup
+ {
+  unsigned int text, len;	/* Comment-filtered line in the strings section. */
+ };
+
+
+void attach_compiled_return( struct input_buffer *ib )
+{
+ struct otsb_header *hdr;
+ unsigned long sz;
+
+ hdr = (struct otsb_header *)ib->base;
+ sz = ib->baselen;
+ if ((sz < sizeof(struct otsb_header)) || (hdr->byteorder != OTSB_BYTEORDER) || (hdr->version != OTSB_VERSION)
+     || (hdr->token_size != sizeof(struct otsb_token))
+     || (hdr->text_offset > sz) || (hdr->text_len > sz - hdr->text_offset)
+     || (hdr->tokens_offset > sz) || (hdr->ntokens > (sz - hdr->tokens_offset) / sizeof(struct otsb_token))
+     || (hdr->strings_offset > sz) || (hdr->strings_len > sz - hdr->strings_offset)
+     || (hdr->markups_offset > sz) || (hdr->nmarkups > (sz - hdr->markups_offset) / sizeof(struct otsb_markup)))
+  {
+   console_printf("ERROR: Compiled return was made by a different version or machine.  Re-compile it with ots_compile.\n");
+   if (outfile) results_fprintf(outfile,"ERROR: Compiled return was made by a different version or machine.  Re-compile it with ots_compile.\n");
+   taxsolve_exit(1);
+  }
+ ib->compiled = 1;
+ ib->data = ib->base + hdr->text_offset;
+ ib->len = hdr->text_len;
+ ib->pos = 0;
+ ib->tokens = (struct otsb_token *)(ib->base + hdr->tokens_offset);
+ ib->ntokens = hdr->ntokens;
+ ib->tokcur = 0;
+ ib->strings = ib->base + hdr->strings_offset;
+ ib->markups = (struct otsb_markup *)(ib->base + hdr->markups_offset);
+ ib->nmarkups = hdr->nmarkups;
+}
+
+
+/* End the buffered contents at len, as though the file were that long.  Tokens of a */
+/* compiled return that read up to or past len are dropped, so the text is scanned  */
+/* there instead, and finds the new end.					     */
+void limit_input_buffer( struct input_buffer *ib, long len )
+{
+ if ((ib->data == 0) || (len >= ib->len))
+  return;
+ ib->len = len;
+ while ((ib->ntokens > 0) && ((ib->tokens[ ib->ntokens - 1 ].end >= len) || (ib->tokens[ ib->ntokens - 1 ].flags & OTSB_AT_EOF)))
+  ib->ntokens--;
+ if (ib->tokcur > ib->ntokens)
+  ib->tokcur = ib->ntokens;
+}
+
+
+/* Find the compiled token that get_token would read from the current position, if any. */
+struct otsb_token *find_compiled_token( struct input_buffer *ib )
+{
+ struct otsb_token *t;
+ long k, lo, hi, mid, P=ib->pos;
+
+ k = ib->tokcur;	/* Usually the one after the last. */
+ if ((k >= ib->ntokens) || (ib->tokens[k].from > P) || ((k + 1 < ib->ntokens) && (ib->tokens[k+1].from <= P)))
+  { /* Binary search for the last token starting at or before P. */
+   lo = 0;  hi = ib->ntokens - 1;
+   k = -1;
+   while (lo <= hi)
+    {
+     mid = (lo + hi) / 2;
+     if (ib->tokens[mid].from <= P)
+      { k = mid;  lo = mid + 1; }
+     else
+      hi = mid - 1;
+    }
+   if (k < 0) return 0;
+  }
+ t = &(ib->tokens[k]);
+ if (P != t->from)
+  return 0;
+ ib->tokcur = k + 1;
+ return t;
+}
+
+
+/* The compiled token last returned by get_token, and the word get_word copied it into, */
+/* so that scan_input_float and scan_input_int can skip re-converting it.		  */
+THREAD_LOCAL struct otsb_token *last_compiled_token=0;
+THREAD_LOCAL char *last_compiled_text=0, *last_compiled_word=0;
+
+
+/* The contents of the main input file, when they are already in memory.  Several */
+/* threads computing variations of one return may share a single read-only copy.  */
+/* When preloaded_input_name is also set, an input file of that name need not	   */
+/* exist:  opening it for reading gives preloaded_file, which reads the contents.  */
+THREAD_LOCAL char *preloaded_input=0;
+THREAD_LOCAL long preloaded_input_len=0;
+THREAD_LOCAL char *preloaded_input_name=0;
+THREAD_LOCAL int preloaded_input_first_line=1;	/* Its line in a larger file, for locating errors. */
+THREAD_LOCAL FILE *preloaded_file=0;
+
+
+/* Return the buffer attached to fp, attaching one if needed.  When the file cannot */
+/* be buffered, fills-in and returns "unbuffered", which reads through stdio.	    */
+struct input_buffer *get_input_buffer( FILE *fp, struct input_buffer *unbuffered )
+{
+ struct input_buffer *ib=0;
+ struct stat st;
+ long start;
+ int j;
+
+ for (j=0; j < MAX_INPUT_BUFFERS; j++)
+  if (input_buffers[j].fp == fp)
+   return &(input_buffers[j]);
+ memset( unbuffered, 0, sizeof(struct input_buffer) );
+ unbuffered->fp = fp;
+ for (j=0; (j < MAX_INPUT_BUFFERS) && (ib == 0); j++)
+  if (input_buffers[j].fp == 0)
+   ib = &(input_buffers[j]);
+ if ((ib != 0) && ((fp == infile) || (fp == preloaded_file)) && (preloaded_input != 0) && (preloaded_input_len > 0) && (ftell( fp ) == 0))
+  { /* Already in memory. */
+   ib->data = preloaded_input;
+   ib->len = preloaded_input_len;
+   ib->borrowed = 1;
+   ib->line = preloaded_input_first_line;
+   ib->linepos = 0;
+   start = 0;
+  }
+ else
+  {
+   if ((ib == 0) || (fstat( fileno( fp ), &st ) != 0) || (!S_ISREG( st.st_mode )) || (st.st_size <= 0))
+    return unbuffered;
+   start = ftell( fp );
+   if ((start < 0) || (start > st.st_size))
+    return unbuffered;
+   #ifndef __MINGW32__
+    ib->data = (char *)mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+    if (ib->data == MAP_FAILED)
+     { ib->data = 0;  return unbuffered; }
+    ib->mapped = 1;
+    ib->len = st.st_size;
+    ib->pos = start;
+   #else
+    ib->data = (char *)malloc( st.st_size - start + 1 );
+    if (start == 0)
+     { /* Read compiled returns in binary-mode. */
+      _setmode( fileno( fp ), _O_BINARY );
+      ib->len = fread( ib->data, 1, st.st_size, fp );
+      if ((ib->len < OTSB_MAGIC_LEN) || (memcmp( ib->data, OTSB_MAGIC, OTSB_MAGIC_LEN ) != 0))
+       {
+        fseek( fp, 0, SEEK_SET );
+        _setmode( fileno( fp ), _O_TEXT );
+        ib->len = fread( ib->data, 1, st.st_size, fp );
+       }
+     }
+    else
+     ib->len = fread( ib->data, 1, st.st_size - start, fp );	/* Text-mode may shorten it. */
+    ib->pos = 0;
+    clearerr( fp );
+   #endif
+  }
+ ib->base = ib->data;
+ ib->baselen = ib->len;
+ if ((start == 0) && (ib->len >= OTSB_MAGIC_LEN) && (memcmp( ib->data, OTSB_MAGIC, OTSB_MAGIC_LEN ) == 0))
+  attach_compiled_return( ib );
+ ib->fp = fp;
+ fseek( fp, 0, SEEK_END );
+ return ib;
+}
+
+
+/* Release the buffer attached to fp, if any.  For files closed before the return is done. */
+void release_input_file( FILE *fp )
+{
+ int j;
+
+ for (j=0; j < MAX_INPUT_BUFFERS; j++)
+  if (input_buffers[j].fp == fp)
+   release_input_buffer( &(input_buffers[j]) );
+}
+
+
+/* Files are opened through taxsolve_fopen, which drops any buffer still attached	*/
+/* to a closed FILE whose address the new one re-uses.  So get_input_buffer need	*/
+/* not check the stdio position of its FILE on every read.			*/
+FILE *taxsolve_fopen( const char *fname, const char *mode )
+{
+ FILE *fp;
+ if ((preloaded_input_name != 0) && (mode[0] == 'r') && (strcmp( fname, preloaded_input_name ) == 0))
+  { /* Read from preloaded_input.  (The null device gives it a FILE to be attached to.) */
+   fp = fopen( NULL_DEVICE, mode );
+   if (fp != 0)
+    {
+     release_input_file( fp );
+     preloaded_file = fp;
+    }
+   return fp;
+  }
+ fp = fopen( fname, mode );
+ if (fp != 0)
+  release_input_file( fp );
+ return fp;
+}
+
+
+/* Same as feof( fp ), for a file read by these routines, but answered from its	*/
+/* buffer, without taking the stdio lock that feof takes on every call.		*/
+int input_eof( FILE *fp )
+{
+ struct input_buffer *ib, unbuffered;
+ ib = get_input_buffer( fp, &unbuffered );
+ return IB_EOF(ib);
+}
+
+
+THREAD_LOCAL char *token_scratch=0;	/* Holds tokens that cannot be viewed in place. */
+THREAD_LOCAL long token_scratch_sz=0;
+
+void grow_token_scratch( long needed )
+{
+ if (needed < token_scratch_sz) return;
+ token_scratch_sz = 2 * needed + 4096;
+ token_scratch = (char *)realloc( token_scratch, token_scratch_sz );
+}
+
+#define TOKEN_PUT(k, ch)  { if (!clean) { grow_token_scratch( k );  token_scratch[k] = ch; } }
+#define TOKEN_DIRTY(k)    { if (clean) { clean = 0;  grow_token_scratch( k );  memcpy( token_scratch, ib->data + start, k ); } }
+
+
+/*------------------------------------------------------------------------------*/
+/* Get_Token - Read next token from input file, while ignoring any comments.	*/
+/*  Returns a view of the token.  When the token appears verbatim in the	*/
+/*  buffered file, the view points into the buffer, otherwise (when commas or	*/
+/*  embedded comments were removed) into a scratch area.  Either way, it is	*/
+/*  only valid until the next token is read.  Compiled returns are answered	*/
+/*  from their token table when possible.					*/
+/*------------------------------------------------------------------------------*/
+void get_token( FILE *infile, struct token_view *tok )
+{
+ struct input_buffer *ib, unbuffered;
+ struct otsb_token *t;
+ long j=0, start=0;
+ int clean;
+ char c, ltc='\n';	 /* Line termination character. */
  char spc=' ';
 
  if (single_line_entry)
   ltc = ' ';
  if (whole_line_entry)
   spc='\n';
+ ib = get_input_buffer( infile, &unbuffered );
+ last_compiled_token = 0;
+ if ((ib->tokens != 0) && (!single_line_entry) && (!whole_line_entry) && (!ib->eof)
+     && ((t = find_compiled_token( ib )) != 0))
+  {
+   if (!(t->flags & OTSB_NO_TOKPOS))
+    ib->tokpos = t->tokpos;
+   ib->pos = t->end;
+   if (t->flags & OTSB_AT_EOF)
+    input_buffer_underflow( ib );
+   tok->text = ((t->flags & OTSB_IN_STRINGS) ? ib->strings : ib->data) + t->text;
+   tok->len = t->len;
+   last_compiled_token = t;
+   last_compiled_text = tok->text;
+   return;
+  }
+ clean = (ib->data != 0);
  do
   {  /*Absorb any leading white-space.*/
-     word[j]=getc(infile); 
-     if (word[j]=='{') 
-      { 
-       do word[j]=getc(infile); while ((word[j]!='}') && (!feof(infile)));
-       word[j]=getc(infile);
+     c = IB_GETC(ib);
+     if (c=='{')
+      {
+       do c = IB_GETC(ib); while ((c!='}') && (!IB_EOF(ib)));
+       c = IB_GETC(ib);
       }
-  } 
- while ((!feof(infile)) && ((word[j]==' ') || (word[j]=='\t') || (word[j]==ltc) || (word[j]=='\r')));
- if (word[j]=='$')
-  word[j]=getc(infile);
- if (word[j]==';') 
-  j++;
+  }
+ while ((!IB_EOF(ib)) && ((c==' ') || (c=='\t') || (c==ltc) || (c=='\r')));
+ if (c=='$')
+  c = IB_GETC(ib);
+ if (IB_EOF(ib))
+  clean = 0;
  else
- if (word[j]=='\n')
-  word[j] = '\0';	/* Terminate empty single-line entries. */
+  start = ib->tokpos = ib->pos - 1;
+ if (c==';')
+  { TOKEN_PUT( 0, c );  j = 1; }
  else
- if (word[j]=='"')
+ if (c=='\n')
+  j = 0;	/* Terminate empty single-line entries. */
+ else
+ if (c=='"')
   { /* Get quoted string. */
-    j = 0;
+    start = ib->pos;
     do
-     word[j++] = getc(infile);
-    while ((word[j-1] != '"') && (!feof(infile)));
-    if (word[j-1] == '"') j--;	/* Remove trailing quote. */
+     {
+      c = IB_GETC(ib);
+      if (IB_EOF(ib)) TOKEN_DIRTY( j );
+      TOKEN_PUT( j, c );
+      j++;
+     }
+    while ((c != '"') && (!IB_EOF(ib)));
+    if (c == '"') j--;	/* Remove trailing quote. */
   }
  else
   { /* Normal case. */
+   TOKEN_PUT( 0, c );
    do {	/*Get word until white-space or ;.*/
-        j++;  word[j] = getc(infile);
-        if (word[j]=='{') do word[j] = getc(infile); while ((!feof(infile)) && (word[j]!='}'));
-	if (word[j]==',') word[j] = getc(infile);
+        j++;  c = IB_GETC(ib);
+        if (c=='{')
+	 {
+	  TOKEN_DIRTY( j );
+	  do c = IB_GETC(ib); while ((!IB_EOF(ib)) && (c!='}'));
+	 }
+	if (c==',')
+	 {
+	  TOKEN_DIRTY( j );
+	  c = IB_GETC(ib);
+	 }
+	TOKEN_PUT( j, c );
       } 
-   while ((!feof(infile)) && ((word[j]!=spc) && (word[j]!='\t') && (word[j]!='\n') && (word[j]!=';')));
-   if (word[j]==';') ungetc(word[j],infile);
+   while ((!IB_EOF(ib)) && ((c!=spc) && (c!='\t') && (c!='\n') && (c!=';')));
+   if (c==';') input_buffer_ungetc( c, ib );
   }
- word[j] = '\0';	/* Add termination character. */
- if (verbose) printf("Read: '%s'\n", word);
+ if (clean)
+  tok->text = ib->data + start;
+ else
+  {
+   grow_token_scratch( j );
+   tok->text = token_scratch;
+  }
+ tok->len = j;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Get_Word - Read next word from input file, while ignoring any comments.	*/
+/*------------------------------------------------------------------------------*/
+void get_word( FILE *infile, char *word )	/* Absorb comments. */
+{
+ struct token_view tok;
+
+ get_token( infile, &tok );
+ memcpy( word, tok.text, tok.len );
+ word[tok.len] = '\0';	/* Add termination character. */
+ last_compiled_word = word;
+ if (verbose) console_printf("Read: '%s'\n", word);
  intercept_any_pragmas( infile, word );	/* Intercept any pragmas. */
 }
 
 
+/*------------------------------------------------------------------------------*/
+/* Label Index - When labels_any_order is set, the first look-up of a line	*/
+/* label scans the remainder of the buffered input file once, and hashes the	*/
+/* position of every word that begins a line (outside of comments) by its	*/
+/* text.  Get_Parameter then jumps directly to the next unused occurrence of	*/
+/* each label it expects, so entries may appear in any order in the file.	*/
+/* Occurrences at or after the current position are preferred, so files in	*/
+/* template order are read exactly as before.  Words that begin a line but	*/
+/* are not labels (such as continued values) are harmlessly indexed too.	*/
+/*------------------------------------------------------------------------------*/
+struct label_entry
+ {
+  char *text;		/* Points into the input buffer.  Not null-terminated. */
+  int len, used;
+  long pos;		/* Offset of the label in the buffer. */
+  struct label_entry *nxt;	/* Next occurrence of same label, in file order. */
+ };
+
+struct label_index
+ {
+  struct label_entry **table;	/* Open-addressed, on first occurrence of each label. */
+  struct label_entry *entries;
+  unsigned long tblsz;
+  long nentries;
+ };
+
+
+void release_label_index( struct label_index *lx )
+{
+ free( lx->table );
+ free( lx->entries );
+ free( lx );
+}
+
+
+struct label_index *build_label_index( struct input_buffer *ib )
+{
+ struct label_index *lx;
+ struct label_entry *e, *last;
+ long j, k, nalloc=64;
+ unsigned long h;
+ char *d=ib->data;
+
+ lx = (struct label_index *)calloc( 1, sizeof(struct label_index) );
+ lx->entries = (struct label_entry *)malloc( nalloc * sizeof(struct label_entry) );
+ j = ib->pos;
+ while (j < ib->len)
+  { /* At start of a line.  Absorb leading white-space and comments. */
+   while ((j < ib->len) && ((d[j]==' ') || (d[j]=='\t') || (d[j]=='\r') || (d[j]=='{')))
+    {
+     if (d[j]=='{')
+      while ((j < ib->len) && (d[j]!='}')) j++;
+     j++;
+    }
+   if ((j < ib->len) && (isalpha( (unsigned char)d[j] ) || (d[j]=='_')))
+    { /* Word starting the line. */
+     k = j;
+     while ((k < ib->len) && (d[k]!=' ') && (d[k]!='\t') && (d[k]!='\n') && (d[k]!='\r') && (d[k]!=';') && (d[k]!='{'))
+      k++;
+     if ((k - j == 22) && (strncmp( d + j, "Round_to_Whole_Dollars", 22 ) == 0))
+      round_to_whole_dollars = 1;	/* Pragmas would otherwise be skipped-over. */
+     if (lx->nentries == nalloc)
+      {
+       nalloc = 2 * nalloc;
+       lx->entries = (struct label_entry *)realloc( lx->entries, nalloc * sizeof(struct label_entry) );
+      }
+     e = &(lx->entries[lx->nentries++]);
+     e->text = d + j;
+     e->len = k - j;
+     e->pos = j;
+     e->used = 0;
+     e->nxt = 0;
+     j = k;
+    }
+   while ((j < ib->len) && (d[j]!='\n'))	/* Skip rest of line. */
+    {
+     if (d[j]=='{')
+      while ((j < ib->len) && (d[j]!='}')) j++;
+     j++;
+    }
+   j++;
+  }
+
+ lx->tblsz = 64;
+ while (lx->tblsz < 2 * lx->nentries) lx->tblsz = 2 * lx->tblsz;
+ lx->table = (struct label_entry **)calloc( lx->tblsz, sizeof(struct label_entry *) );
+ for (k=0; k < lx->nentries; k++)
+  {
+   e = &(lx->entries[k]);
+   h = fnv_hash( FNV_BASIS, e->text, e->len ) & (lx->tblsz - 1);
+   while ((lx->table[h] != 0) && ((lx->table[h]->len != e->len) || (strncmp( lx->table[h]->text, e->text, e->len ) != 0)))
+    h = (h + 1) & (lx->tblsz - 1);
+   if (lx->table[h] == 0)
+    lx->table[h] = e;
+   else
+    { /* Append to the occurrences already seen. */
+     last = lx->table[h];
+     while (last->nxt != 0) last = last->nxt;
+     last->nxt = e;
+    }
+  }
+ return lx;
+}
+
+
+/* Position infile at the next unused occurrence of label, if it is indexed, and return 1. */
+/* Otherwise leave it be, and return 0.							   */
+int seek_label( FILE *infile, char *label )
+{
+ struct input_buffer *ib, unbuffered;
+ struct label_entry *e, *found=0;
+ unsigned long h;
+ int len=strlen( label );
+
+ ib = get_input_buffer( infile, &unbuffered );
+ if (ib->data == 0)
+  return 0;	/* Not seekable; read sequentially. */
+ if (ib->index == 0)
+  ib->index = build_label_index( ib );
+ h = fnv_hash( FNV_BASIS, label, len ) & (ib->index->tblsz - 1);
+ while ((ib->index->table[h] != 0) && ((ib->index->table[h]->len != len) || (strncmp( ib->index->table[h]->text, label, len ) != 0)))
+  h = (h + 1) & (ib->index->tblsz - 1);
+ for (e = ib->index->table[h]; e != 0; e = e->nxt)
+  if (!e->used)
+   {
+    if (found == 0)
+     found = e;
+    if (e->pos >= ib->pos)
+     { found = e;  break; }
+   }
+ if (found == 0)
+  return 0;
+ found->used = 1;
+ ib->pos = found->pos;
+ if (ib->eof)
+  { ib->eof = 0;  clearerr( ib->fp ); }
+ return 1;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Input Validation - With the -validate option, errors in the input file	*/
+/*  that can be recovered from are collected, with their line and column,	*/
+/*  instead of ending the run at the first one.  A bad value is taken as zero.	*/
+/*  After a misplaced label, reading resumes at the expected label wherever it	*/
+/*  is, or when it is nowhere, the word found is taken as a misspelling of it.	*/
+/*  All the errors are listed when the return ends (see run_return), and its	*/
+/*  status, which main returns, is 1.						*/
+/*------------------------------------------------------------------------------*/
+struct input_error
+ {
+  long pos;		/* Offset in the input file, for sorting. */
+  int seq, line, col;
+  char *mssg;
+ };
+
+THREAD_LOCAL struct input_error *input_errors=0;
+THREAD_LOCAL int num_input_errors=0, max_input_errors=0;
+
+
+int compare_input_errors( const void *a, const void *b )
+{
+ const struct input_error *e1=a, *e2=b;
+ if (e1->pos != e2->pos)
+  return (e1->pos < e2->pos) ? -1 : 1;
+ return e1->seq - e2->seq;
+}
+
+
+int print_input_errors( void )	/* List the errors collected, in file order.  Returns their number. */
+{
+ int j, n=num_input_errors;
+
+ qsort( input_errors, n, sizeof(struct input_error), compare_input_errors );
+ /* (Shown even when quiet, since it is what -validate was asked for.) */
+ results_fprintf(stdout,"\nValidation found %d error%s in the input file:\n", n, (n == 1) ? "" : "s" );
+ for (j=0; j < n; j++)
+  {
+   if (input_errors[j].line > 0)
+    results_fprintf(stdout,"  line %d, column %d:  %s\n", input_errors[j].line, input_errors[j].col, input_errors[j].mssg );
+   else
+    results_fprintf(stdout,"  %s\n", input_errors[j].mssg );
+   free( input_errors[j].mssg );
+  }
+ free( input_errors );
+ input_errors = 0;
+ num_input_errors = 0;
+ max_input_errors = 0;
+ return n;
+}
+
+
+/* When validating, record an error found "offset" characters into the last token read */
+/* from infile, and return 1 so that reading may go on.  Otherwise, return 0.		   */
+int collect_input_error( FILE *infile, int offset, char *fmt, ... )
+{
+ struct input_buffer *ib, unbuffered;
+ struct input_error *e;
+ char mssg[4096];
+ va_list ap;
+ long j;
+
+ if (!validate_input)
+  return 0;
+ if (num_input_errors == max_input_errors)
+  {
+   max_input_errors = 2 * max_input_errors + 32;
+   input_errors = (struct input_error *)realloc( input_errors, max_input_errors * sizeof(struct input_error) );
+  }
+ e = &(input_errors[num_input_errors]);
+ va_start( ap, fmt );
+ vsnprintf( mssg, sizeof(mssg), fmt, ap );
+ va_end( ap );
+ e->mssg = strdup( mssg );
+ e->seq = num_input_errors++;
+ e->pos = e->line = e->col = 0;
+ if (infile == 0)
+  return 1;
+ ib = get_input_buffer( infile, &unbuffered );
+ if (ib->data == 0)
+  return 1;	/* Location not known. */
+ e->pos = ib->tokpos + offset;
+ if (e->pos > ib->len)
+  e->pos = ib->len;
+ if (ib->line == 0)
+  { ib->line = 1;  ib->linepos = 0; }
+ /* Count lines from the last error located, not from the top, since errors */
+ /* come mostly in file order.  (Back, after a seek to an earlier label.)    */
+ for (j=ib->linepos; j < e->pos; j++)
+  if (ib->data[j] == '\n')
+   ib->line++;
+ for (j=ib->linepos; j > e->pos; j--)
+  if (ib->data[j-1] == '\n')
+   ib->line--;
+ ib->linepos = e->pos;
+ e->line = ib->line;
+ for (j=e->pos; (j > 0) && (ib->data[j-1] != '\n'); j--);
+ e->col = e->pos - j + 1;
+ return 1;
+}
+
+
+/* When validating and a label is not where expected, resume at the label wherever it */
+/* is.  If it is nowhere, take the word read as a misspelling of it, and go on.	   */
+void resync_on_label( FILE *infile, char *word, char *label )
+{
+ if (seek_label( infile, label ))
+  get_word( infile, word );
+}
+
+
 #ifdef microsoft	   /* Apparently Microsoft doesn't know of strcasecmp(), define one. */
 int strcasecmp( char *str1, char *str2 )
 {
@@ -163,28 +1383,6 @@ int strncasecmp( char *str1, char *str2, int len )
 }
 #endif
 
-char *mystrcasestr( char *haystack, char *needle )
-{
- int j=0;
- char *hs, *ndl, *pt;
- hs = strdup( haystack );
- while (hs[j] != '\0') { hs[j] = toupper( hs[j] );  j++; }
- ndl = strdup( needle );
- j = 0;
- while (ndl[j] != '\0') { ndl[j] = toupper( ndl[j] );  j++; }
- pt = strstr( hs, ndl );
- if (pt != 0)
-  {
-   j = 0;
-   while (pt != &(hs[j])) j++;
-   pt = &(haystack[j]);
-  }
- free( ndl );
- free( hs );
- return pt;
-}
-
-
 void intercept_any_pragmas( FILE *infile, char *word )	/* Intercept any special command pragmas. */
 {
  if (strcmp( word, "Round_to_Whole_Dollars" ) == 0)	/* Intercept any mode-setting commands. */
@@ -195,110 +1393,233 @@ void intercept_any_pragmas( FILE *infile, char *word )	/* Intercept any special
 }
 
 
-int valid_int( char *word )	/* Check for a valid integer in string, and nothing else following it. */
-{	/* Returns 1 if valid, 0 if invalid. */
- int j=0, state=0;
- while (word[j] != '\0')
+/*------------------------------------------------------------------------------*/
+/* Numeric Scanner - Validates and converts a numeric word in one pass.	*/
+/*  Accepts the same forms as always:  Integers are an optional sign, digits,	*/
+/*  and an optional trailing decimal-point.  Decimal values are an optional	*/
+/*  sign, digits with an optional decimal-point, and an optional exponent.	*/
+/*  On error, reports what was wrong and the column where it was found.	*/
+/*  The leading number is still converted (into value and end) when only	*/
+/*  trailing text is in error, for callers that tolerate such text.		*/
+/*------------------------------------------------------------------------------*/
+#define SCAN_OK		0
+#define SCAN_EMPTY	1	/* No digits where a number was expected. */
+#define SCAN_BAD_CHAR	2	/* Unexpected character at column. */
+#define SCAN_RANGE	3	/* Integer too large. */
+
+double scan_pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+int scan_int( char *word, struct numeric_scan *ns )	/* Returns 1 if valid, 0 if invalid. */
+{
+ int j=0, neg=0;
+ long long n=0;
+
+ ns->error = SCAN_OK;
+ ns->ivalue = 0;
+ if ((word[j] == '-') || (word[j] == '+'))
+  { neg = (word[j] == '-');  j++; }
+ if ((word[j] < '0') || (word[j] > '9'))
   {
-   switch( state )
-    {
-     case 0: if ((word[j] == '-') || (word[j] == '+'))
-		state = 1;
-	     else
-	     if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 2;
-	     else
-		return 0;
-	break;
-      case 1: if ((word[j] >= '0') && (word[j] <= '9'))
-                state = 2;
-             else
-		return 0;
-	break;
-      case 2: if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 2;
-	      else
-	      if (word[j] == '.')
-		state = 3;
-	      else
-		return 0;
-	break;
-      case 3:  return 0;
-	break;
-      default:  return 0;
-    }
+   ns->error = (word[j] == '\0') ? SCAN_EMPTY : SCAN_BAD_CHAR;
+   ns->column = j;
+   ns->end = 0;
+   return 0;
+  }
+ while ((word[j] >= '0') && (word[j] <= '9'))
+  {
+   if (n <= 2147483648LL)
+    n = 10 * n + (word[j] - '0');
    j++;
   }
- if (j != 0)
-  return 1;
+ if (n > 2147483647LL + neg)
+  { ns->error = SCAN_RANGE;  ns->column = 0; }
  else
-  return 0;
+  ns->ivalue = neg ? (int)(-n) : (int)n;
+ ns->end = j;
+ if (word[j] == '.')
+  j++;
+ if ((word[j] != '\0') && (ns->error == SCAN_OK))
+  { ns->error = SCAN_BAD_CHAR;  ns->column = j; }
+ return (ns->error == SCAN_OK);
 }
 
 
-int valid_float( char *word )	/* Check for a valid decimal value in string, and nothing else following it. */
-{	/* Returns 1 if valid, 0 if invalid. */
- int j=0, state=0;
- while (word[j] != '\0')
+int scan_float( char *word, struct numeric_scan *ns )	/* Returns 1 if valid, 0 if invalid. */
+{
+ int j=0, neg=0, ndigits=0, nsig=0, expon=0, eneg=0, e10=0;
+ unsigned long long m=0;
+ char buf[512];
+
+ ns->error = SCAN_OK;
+ ns->value = 0.0;
+ if ((word[j] == '-') || (word[j] == '+'))
   {
-   switch( state )
+   neg = (word[j] == '-');  j++;
+   if (((word[j] < '0') || (word[j] > '9'))	/* A digit, or a point and a digit, must follow a sign. */
+       && ((word[j] != '.') || (word[j+1] < '0') || (word[j+1] > '9')))
     {
-     case 0: if ((word[j] == '-') || (word[j] == '+'))
-		state = 1;
-	     else
-	     if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 2;
-	     else
-	     if (word[j] == '.')
-		state = 3;
-	     else
-		return 0;
-	break;
-      case 1: if ((word[j] >= '0') && (word[j] <= '9'))
-                state = 2;
-             else
-		return 0;
-	break;
-      case 2: if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 2;
-	      else
-	      if (word[j] == '.')
-		state = 3;
-	      else
-	      if ((word[j] == 'e') || (word[j] == 'E'))
-		state = 4;
-	      else
-		return 0;
-	break;
-      case 3: if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 3;
-	      else
-	      if ((word[j] == 'e') || (word[j] == 'E'))
-		state = 4;
-	      else
-		return 0;
-	break;
-      case 4: if ((word[j] >= '0') && (word[j] <= '9'))
-		state = 5;
-	      else
-      	      if ((word[j] == '-') || (word[j] == '+'))
-		state = 5;
-	      else
-		return 0;
-        break;
-      case 5:  if ((word[j] >= '0') && (word[j] <= '9'))
-                state = 5;
-              else
-		return 0;
-	break;
-      default:  return 0;
+     ns->error = (word[j] == '\0') ? SCAN_EMPTY : SCAN_BAD_CHAR;
+     ns->column = j;
+     ns->end = 0;
+     return 0;
     }
+  }
+ for (; (word[j] >= '0') && (word[j] <= '9'); j++, ndigits++)
+  if (nsig < 19)
+   { m = 10 * m + (word[j] - '0');  if (m != 0) nsig++; }
+  else
+   e10++;
+ if (word[j] == '.')
+  for (j++; (word[j] >= '0') && (word[j] <= '9'); j++, ndigits++)
+   if (nsig < 19)
+    { m = 10 * m + (word[j] - '0');  if (m != 0) nsig++;  e10--; }
+ if (ndigits == 0)
+  {
+   ns->error = (word[0] == '\0') ? SCAN_EMPTY : SCAN_BAD_CHAR;
+   ns->column = ns->end = 0;
+   return 0;
+  }
+ if ((word[j] == 'e') || (word[j] == 'E'))
+  {
    j++;
+   if ((word[j] == '-') || (word[j] == '+'))
+    { eneg = (word[j] == '-');  j++; }
+   for (; (word[j] >= '0') && (word[j] <= '9'); j++)
+    if (expon < 100000)
+     expon = 10 * expon + (word[j] - '0');
+   e10 = eneg ? e10 - expon : e10 + expon;
+  }
+ ns->end = j;
+ if (word[j] != '\0')
+  { ns->error = SCAN_BAD_CHAR;  ns->column = j; }
+
+ if ((m <= (1ULL << 53)) && (e10 >= -22) && (e10 <= 22) && (nsig < 19))
+  { /* Both m and the power of ten are exact, so one operation rounds correctly. */
+   if (e10 < 0)
+    ns->value = (double)m / scan_pow10[-e10];
+   else
+    ns->value = (double)m * scan_pow10[e10];
+   if (neg)
+    ns->value = -ns->value;
+  }
+ else
+ if (j < (int)sizeof(buf))
+  {
+   strncpy( buf, word, j );
+   buf[j] = '\0';
+   ns->value = strtod( buf, 0 );
   }
- if (j != 0)
-  return 1;
  else
+  ns->value = strtod( word, 0 );
+ return (ns->error == SCAN_OK);
+}
+
+
+/* Return the compiled token's scan of word, when word is exactly the token get_word just read. */
+struct otsb_token *compiled_scan_of( char *word )
+{
+ struct otsb_token *t=last_compiled_token;
+ if ((t == 0) || (word != last_compiled_word) || (word[t->len] != '\0') || (memcmp( word, last_compiled_text, t->len ) != 0))
   return 0;
+ return t;
+}
+
+/* Like scan_float and scan_int, but for words just read by get_word, which were */
+/* usually converted already when reading a compiled return.			 */
+int scan_input_float( char *word, struct numeric_scan *ns )
+{
+ struct otsb_token *t=compiled_scan_of( word );
+ if ((t == 0) || !(t->flags & OTSB_FLOAT))
+  return scan_float( word, ns );
+ ns->error = SCAN_OK;
+ ns->value = t->value;
+ ns->end = t->len;
+ return 1;
+}
+
+int scan_input_int( char *word, struct numeric_scan *ns )
+{
+ struct otsb_token *t=compiled_scan_of( word );
+ if ((t == 0) || !(t->flags & OTSB_INT))
+  return scan_int( word, ns );
+ ns->error = SCAN_OK;
+ ns->ivalue = (int)(t->value);
+ ns->end = (word[t->len - 1] == '.') ? t->len - 1 : t->len;
+ return 1;
+}
+
+
+int valid_int( char *word )	/* Check for a valid integer in string, and nothing else following it. */
+{	/* Returns 1 if valid, 0 if invalid. */
+ struct numeric_scan ns;
+ return scan_int( word, &ns ) || (ns.error == SCAN_RANGE);
+}
+
+
+int valid_float( char *word )	/* Check for a valid decimal value in string, and nothing else following it. */
+{	/* Returns 1 if valid, 0 if invalid. */
+ struct numeric_scan ns;
+ return scan_float( word, &ns );
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Input Override - Shifts the value read for one line label by a fixed amount,	*/
+/*  as though the input file said so, without touching the file.  Used to	*/
+/*  re-compute a return at several values of one input.  Input_override_hits	*/
+/*  counts the reads it applied to, so a label never read can be reported.	*/
+/*  Input additions likewise add amounts computed elsewhere (such as by a	*/
+/*  sub-form) to the values read for their labels.  Input presets are	*/
+/*  additions the caller sets-up before the return, like the override, such	*/
+/*  as sub-form results computed once for many re-computations of a return.	*/
+/*------------------------------------------------------------------------------*/
+THREAD_LOCAL char *input_override_label=0;
+THREAD_LOCAL double input_override_delta=0.0;
+THREAD_LOCAL int input_override_hits=0;
+
+#define MAX_INPUT_ADDITIONS 100
+
+THREAD_LOCAL struct input_addition
+ {
+  char *label;
+  double amount;
+ } input_additions[MAX_INPUT_ADDITIONS];
+THREAD_LOCAL int num_input_additions=0;
+THREAD_LOCAL struct input_addition *input_presets=0;
+THREAD_LOCAL int num_input_presets=0;
+
+void add_to_input( char *linename, double amount )	/* Add amount to the value read for linename. */
+{
+ int j;
+ for (j=0; j < num_input_additions; j++)
+  if (strcmp( input_additions[j].label, linename ) == 0)
+   {
+    input_additions[j].amount = input_additions[j].amount + amount;
+    return;
+   }
+ if (num_input_additions == MAX_INPUT_ADDITIONS)
+  { console_printf("ERROR: More than %d input additions.\n", MAX_INPUT_ADDITIONS );  taxsolve_exit(1); }
+ input_additions[j].label = linename;
+ input_additions[j].amount = amount;
+ num_input_additions++;
+}
+
+double input_override( char *linename )	/* Amount to add to the value read for linename. */
+{
+ double delta=0.0;
+ int j;
+ for (j=0; j < num_input_additions; j++)
+  if (strcmp( linename, input_additions[j].label ) == 0)
+   delta = delta + input_additions[j].amount;
+ for (j=0; j < num_input_presets; j++)
+  if (strcmp( linename, input_presets[j].label ) == 0)
+   delta = delta + input_presets[j].amount;
+ if ((input_override_label == 0) || (strcmp( linename, input_override_label ) != 0))
+  return delta;
+ input_override_hits++;
+ return delta + input_override_delta;
 }
 
 
@@ -311,34 +1632,49 @@ void get_parameter( FILE *infile, char kind, void *x, char *emssg )
  char word[2048], *owrd;
  int i, *ii;
  double y, *yy;
+ struct numeric_scan ns;
 
  if (kind=='w') 
   { single_line_entry = 1;  whole_line_entry = 1; }
 
+ if ((labels_any_order) && (kind=='s') && (emssg[0]!='\0'))
+  seek_label( infile, emssg );
  get_word(infile, word);
 
- if (feof(infile))
+ if (input_eof(infile))
   {
-   printf("ERROR: Unexpected EOF on '%s'\n",emssg);
-   if (outfile) fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n",emssg);
-   exit(1);
+   if (!collect_input_error( infile, 0, "Unexpected EOF on '%s'", emssg ))
+    {
+     console_printf("ERROR: Unexpected EOF on '%s'\n",emssg);
+     if (outfile) results_fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n",emssg);
+    }
+   taxsolve_exit(1);
   }
  if (kind=='i')
   {
-   if ((!valid_int(word)) || (sscanf(word,"%d",&i)!=1))
-    {printf("ERROR: Bad integer '%s', reading %s.\n", word, emssg); fprintf(outfile,"ERROR: Bad integer '%s', reading %s.\n", word, emssg); exit(1); }
+   if (!scan_input_int( word, &ns ))
+    {
+     if (!collect_input_error( infile, ns.column, "Bad integer '%s', reading %s.", word, emssg ))
+      {console_printf("ERROR: Bad integer '%s', reading %s.\n", word, emssg); results_fprintf(outfile,"ERROR: Bad integer '%s', reading %s.\n", word, emssg); taxsolve_exit(1); }
+     ns.ivalue = 0;
+    }
    ii = (int *)x;
-   *ii = i;
+   *ii = ns.ivalue;
   }
  else
  if (kind=='f')
   {
-   if ((!valid_float(word)) || (sscanf(word,"%lf",&y)!=1)) 
-    {printf("ERROR: Bad float '%s', reading %s.\n", word, emssg); fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, emssg); exit(1); }
+   if (!scan_input_float( word, &ns ))
+    {
+     if (!collect_input_error( infile, ns.column, "Bad float '%s', reading %s.", word, emssg ))
+      {console_printf("ERROR: Bad float '%s', reading %s.\n", word, emssg); results_fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, emssg); taxsolve_exit(1); }
+     ns.value = 0.0;
+    }
+   y = ns.value;
    if (round_to_whole_dollars)
     y = Round( y );
    yy = (double *)x;
-   *yy = y;
+   *yy = y + input_override( emssg );
   }
  else
  if (kind=='s')
@@ -347,7 +1683,11 @@ void get_parameter( FILE *infile, char kind, void *x, char *emssg )
    strcpy( owrd, word );
    if (emssg[0]!='\0')
     { if (strcmp(word,emssg)!=0) 
-       {printf("ERROR1: Found '%s' when expecting '%s'\n", word, emssg); fprintf(outfile,"ERROR1: Found '%s' when expecting '%s'\n", word, emssg); exit(1); } 
+       {
+	if (!collect_input_error( infile, 0, "Found '%s' when expecting '%s'.", word, emssg ))
+	 {console_printf("ERROR1: Found '%s' when expecting '%s'\n", word, emssg); results_fprintf(outfile,"ERROR1: Found '%s' when expecting '%s'\n", word, emssg); taxsolve_exit(1); } 
+	resync_on_label( infile, owrd, emssg );
+       }
     }
   }
  else
@@ -374,12 +1714,14 @@ void get_parameter( FILE *infile, char kind, void *x, char *emssg )
    else if ((strcasecmp(word,"FALSE")==0) || (strcasecmp(word,"NO")==0) || (strcmp(word,"0")==0)) i = 0;
    else if (strcasecmp(word,"N/A")==0) i = notappvalue;
    else if ((single_line_entry) && (strlen( word ) == 0)) i = notappvalue;
-   else {printf("ERROR1: Bad boolean '%s', reading %s.\n", word, emssg); fprintf(outfile,"ERROR: Bad boolean '%s', reading %s.\n", word, emssg); exit(1);}
+   else
+   if (collect_input_error( infile, 0, "Bad boolean '%s', reading %s.", word, emssg )) i = 0;
+   else {console_printf("ERROR1: Bad boolean '%s', reading %s.\n", word, emssg); results_fprintf(outfile,"ERROR: Bad boolean '%s', reading %s.\n", word, emssg); taxsolve_exit(1);}
    ii = (int *)x;
    *ii = i;
   }
  else
-  {printf("ERROR: Unknown type '%c'\n", kind); fprintf(outfile,"ERROR: Unknown type '%c'\n", kind); exit(1);}
+  {console_printf("ERROR: Unknown type '%c'\n", kind); results_fprintf(outfile,"ERROR: Unknown type '%c'\n", kind); taxsolve_exit(1);}
 }
 
 
@@ -401,6 +1743,7 @@ void get_parameters( FILE *infile, char kind, void *x, char *emssg )
  char word[2048], *owrd=0;
  int j, *ii;
  double y, *yy;
+ struct numeric_scan ns;
 
  if (kind == 'f') { yy = (double *)x;  *yy = 0.0; }
  else
@@ -409,20 +1752,33 @@ void get_parameters( FILE *infile, char kind, void *x, char *emssg )
  get_word(infile,word);
  while (word[0]!=';')
  {
- if (feof(infile))
-  {printf("ERROR: Unexpected EOF on '%s'\n",emssg); fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n",emssg); exit(1);}
+ if (input_eof(infile))
+  {
+   if (!collect_input_error( infile, 0, "Unexpected EOF on '%s'", emssg ))
+    {console_printf("ERROR: Unexpected EOF on '%s'\n",emssg); results_fprintf(outfile,"ERROR: Unexpected EOF on '%s'\n",emssg);}
+   taxsolve_exit(1);
+  }
  if (kind=='i')
   {
-   if ((!valid_int(word)) || (sscanf(word,"%d",&j)!=1))
-    {printf("ERROR: Bad integer '%s', reading %s.\n", word, emssg); fprintf(outfile,"ERROR: Bad integer '%s', reading %s.\n", word, emssg); exit(1); }
+   if (!scan_input_int( word, &ns ))
+    {
+     if (!collect_input_error( infile, ns.column, "Bad integer '%s', reading %s.", word, emssg ))
+      {console_printf("ERROR: Bad integer '%s', reading %s.\n", word, emssg); results_fprintf(outfile,"ERROR: Bad integer '%s', reading %s.\n", word, emssg); taxsolve_exit(1); }
+     ns.ivalue = 0;
+    }
    ii = (int *)x;
-   *ii = j;
+   *ii = ns.ivalue;
   }
  else
  if (kind=='f')
   {
-   if ((!valid_float(word)) || ((sscanf(word,"%lf",&y))!=1))
-    {printf("ERROR: Bad float '%s', reading %s.\n", word, emssg); fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, emssg); exit(1); }
+   if (!scan_input_float( word, &ns ))
+    {
+     if (!collect_input_error( infile, ns.column, "Bad float '%s', reading %s.", word, emssg ))
+      {console_printf("ERROR: Bad float '%s', reading %s.\n", word, emssg); results_fprintf(outfile,"ERROR: Bad float '%s', reading %s.\n", word, emssg); taxsolve_exit(1); }
+     ns.value = 0.0;
+    }
+   y = ns.value;
    if (round_to_whole_dollars)
     y = Round( y );
    yy = (double *)x;
@@ -435,8 +1791,8 @@ void get_parameters( FILE *infile, char kind, void *x, char *emssg )
    owrd = (char *)x;
    strcpy( owrd, word );
    if (emssg[0]!='\0')
-    { if (strcmp(word,emssg)!=0)
-       {printf("ERROR2: Found '%s' when expecting '%s'\n", word, emssg); fprintf(outfile,"ERROR2: Found '%s' when expecting '%s'\n", word, emssg); exit(1); }
+    { if ((strcmp(word,emssg)!=0) && (!collect_input_error( infile, 0, "Found '%s' when expecting '%s'.", word, emssg )))
+       {console_printf("ERROR2: Found '%s' when expecting '%s'\n", word, emssg); results_fprintf(outfile,"ERROR2: Found '%s' when expecting '%s'\n", word, emssg); taxsolve_exit(1); }
     }
   }
  else
@@ -459,69 +1815,29 @@ void get_parameters( FILE *infile, char kind, void *x, char *emssg )
 	get_word(infile,word);
 	return;
      }
+   else
+   if (collect_input_error( infile, 0, "Bad boolean '%s', reading %s.", word, emssg ))
+	j = 0;
    else 
-    {printf("ERROR2: Bad boolean '%s', reading %s.\n", word, emssg); 
-     fprintf(outfile,"ERROR: Bad boolean '%s', reading %s.\n", word, emssg); 
-     exit(1);
+    {console_printf("ERROR2: Bad boolean '%s', reading %s.\n", word, emssg); 
+     results_fprintf(outfile,"ERROR: Bad boolean '%s', reading %s.\n", word, emssg); 
+     taxsolve_exit(1);
     }
    ii = (int *)x;
    *ii = j;
   }
  else
-  {printf("ERROR: Unknown type '%c'\n", kind); fprintf(outfile,"ERROR: Unknown type '%c'\n", kind); exit(1);}
+  {console_printf("ERROR: Unknown type '%c'\n", kind); results_fprintf(outfile,"ERROR: Unknown type '%c'\n", kind); taxsolve_exit(1);}
  get_word(infile,word);
  }
+ if (kind == 'f')
+  *yy = *yy + input_override( emssg );
 }
 
 
 
 
-/*.......................................................................
-  .     NEXT_WORD - accepts a line of text, and returns with the        .
-  . next word in that text in the third parameter, the original line    .
-  . is shortened from the beginning so that the word is removed.        .
-  . If the line encountered is empty, then the word returned will be    .
-  . empty.                                                              .
-  . NEXTWORD can parse on an arbitrary number of delimiters, and it 	.
-  . returns everthing that was cut away in the second parameter.	.
-  . Parameters:								.
-  .   line - input character string, on output shortened by word.	.
-  .   pre_trash - white-space or delimiters skipped before word.	.
-  .   word - output of this routine, single word, without delimiters.   .
-  .   delim - list of delimiters, whitepace chars, etc..		.
-  .......................................................................*/
-void next_word( char *line, char *word, char *delim )
-{
- int i=0, j=0, m=0, flag=1;
-
- /* Eat away preceding garbage */
- while ((line[i] !='\0') && (flag))
-  {
-   j = 0;
-   while ((delim[j] != '\0') && (line[i] != delim[j])) j = j + 1;
-   if (line[i] == delim[j]) i++;
-   else  flag = 0;
-  }
- while ((line[i] != '\0') && (!flag))
-  {
-   word[m++] = line[i++];
-   if (line[i] != '\0')
-    {
-     j = 0;
-     while ((delim[j] != '\0') && (line[i] != delim[j])) j = j + 1;
-     if (line[i] == delim[j]) flag = 1;
-    }
-  }
- /* Shorten line. */
- j = 0;
- while (line[i]!='\0') { line[j++] = line[i++]; }
- /* Terminate the char-strings. */
- line[j] = '\0';
- word[m] = '\0';
-}
-
-
-struct date_record
+THREAD_LOCAL struct date_record
  {
    int month, day, year;
  } yourDOB, spouseDOB, DL;
@@ -535,7 +1851,7 @@ char *format_mmddyyyy( int month, int day, int year )
  strcat( datestr, dd );
  sprintf( yy, "%d", year );
  strcat( datestr, yy );
- return strdup( datestr );
+ return return_strdup( datestr );
 }
 
 
@@ -548,45 +1864,67 @@ int isleapyear (int year)  /* Used by interpret_date and get_gain_and_losses */
 }
 
 
-/* Handy routine for interpreting dates in various formats. */
+/* Copy the next field of a date-string into "field", skipping any delimiters before it.  */
+/* Returns a pointer past the field.  Fields longer than maxlen-1 are cut short.	  */
+char *next_date_field( char *pt, char *field, int maxlen )
+{
+ int k=0;
+ while ((*pt != '\0') && (strchr( " /,-\t\n\r", *pt ) != 0))
+  pt++;
+ while ((*pt != '\0') && (strchr( " /,-\t\n\r", *pt ) == 0))
+  {
+   if (k < maxlen - 1)
+    field[k++] = *pt;
+   pt++;
+  }
+ field[k] = '\0';
+ return pt;
+}
+
+
+int date_field_value( char *field, int *value )	/* Leading integer of field, like sscanf "%d".  Returns 1 on success. */
+{
+ struct numeric_scan ns;
+ if ((!scan_int( field, &ns )) && ((ns.end == 0) || (ns.error == SCAN_RANGE)))
+  return 0;
+ *value = ns.ivalue;
+ return 1;
+}
+
+
+/* Handy routine for interpreting dates in various formats.  Does not allocate memory. */
 int interpret_date( char *datestr, int *month, int *day, int *year, char *emssg )
 { /* Returns 1 on success. 0 on failure. */
- char word1[500], *owrd;
- int monthdays;
+ char word1[500], *pt;
+ int monthdays, k;
  int std_days[13]={0,31,28,31,30,31,30,31,31,30,31,30,31};  /* Array of Days in each month */
+ char *month_names="janfebmaraprmayjunjulaugsepoctnovdec";
   /* Expect month-day-year as in: 3-3-01, Feb 3, 2021, or 3/3/2008, etc. */
- owrd = strdup( datestr);
- next_word( owrd, word1, " /,-\t\n\r" );
- if (strncasecmp( word1, "Jan", 3 ) == 0)  *month = 1;  else
- if (strncasecmp( word1, "Feb", 3 ) == 0)  *month = 2;  else
- if (strncasecmp( word1, "Mar", 3 ) == 0)  *month = 3;  else
- if (strncasecmp( word1, "Apr", 3 ) == 0)  *month = 4;  else
- if (strncasecmp( word1, "May", 3 ) == 0)  *month = 5;  else
- if (strncasecmp( word1, "Jun", 3 ) == 0)  *month = 6;  else
- if (strncasecmp( word1, "Jul", 3 ) == 0)  *month = 7;  else
- if (strncasecmp( word1, "Aug", 3 ) == 0)  *month = 8;  else
- if (strncasecmp( word1, "Sep", 3 ) == 0)  *month = 9;  else
- if (strncasecmp( word1, "Oct", 3 ) == 0)  *month = 10;  else
- if (strncasecmp( word1, "Nov", 3 ) == 0)  *month = 11;  else
- if (strncasecmp( word1, "Dec", 3 ) == 0)  *month = 12;  else
- if ((sscanf( word1, "%d", month) != 1) || (*month < 1) || (*month > 12))
-  {printf("DATA ERROR: Bad month '%s' in '%s' at '%s'\n", word1, datestr, emssg );
-   fprintf(outfile,"DATA ERROR: Bad month '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+ pt = next_date_field( datestr, word1, 500 );
+ for (k=0; k < 12; k++)
+  if ((tolower( word1[0] ) == month_names[3*k]) && (tolower( word1[1] ) == month_names[3*k+1])
+      && (tolower( word1[2] ) == month_names[3*k+2]))
+   break;
+ if (k < 12)
+  *month = k + 1;
+ else
+ if ((!date_field_value( word1, month )) || (*month < 1) || (*month > 12))
+  {console_printf("DATA ERROR: Bad month '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+   results_fprintf(outfile,"DATA ERROR: Bad month '%s' in '%s' at '%s'\n", word1, datestr, emssg );
    return 0;
   }
- next_word( owrd, word1, " /,-\t\n\r" );
- if ((sscanf( word1, "%d", day) != 1) || (*day < 1) )
-  {printf("DATA ERROR: Bad day '%s' in '%s' at '%s'\n", word1, datestr, emssg );
-   fprintf(outfile,"DATA ERROR: Bad day '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+ pt = next_date_field( pt, word1, 500 );
+ if ((!date_field_value( word1, day )) || (*day < 1) )
+  {console_printf("DATA ERROR: Bad day '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+   results_fprintf(outfile,"DATA ERROR: Bad day '%s' in '%s' at '%s'\n", word1, datestr, emssg );
    return 0;
   }
- next_word( owrd, word1, " /,-\t\n\r" );
- if ((sscanf( word1, "%d", year) != 1) || (*year < 0) || (*year > 3000))
-  {printf("DATA ERROR: Bad year '%s' in '%s' at '%s'\n", word1, datestr, emssg );
-   fprintf(outfile,"DATA ERROR: Bad year '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+ next_date_field( pt, word1, 500 );
+ if ((!date_field_value( word1, year )) || (*year < 0) || (*year > 3000))
+  {console_printf("DATA ERROR: Bad year '%s' in '%s' at '%s'\n", word1, datestr, emssg );
+   results_fprintf(outfile,"DATA ERROR: Bad year '%s' in '%s' at '%s'\n", word1, datestr, emssg );
    return 0;
   }
- free( owrd );
  if (*year < 40)	/* Convert any 2-digit year to four digits. */
    *year = *year + 2000;  /* Assumes any 2-digit years are after 1940. */
  else
@@ -596,59 +1934,112 @@ int interpret_date( char *datestr, int *month, int *day, int *year, char *emssg
  if ((*month == 2) && (isleapyear ( *year)) ) monthdays=29;
   else monthdays=std_days[*month];
  if (*day > monthdays)
-  {printf("DATA ERROR: Invalid day '%d' in '%s' at '%s'\n", *day, datestr, emssg );
-   fprintf(outfile,"DATA ERROR: Invalid day '%d' in '%s' at '%s'\n", *day, datestr, emssg );
+  {console_printf("DATA ERROR: Invalid day '%d' in '%s' at '%s'\n", *day, datestr, emssg );
+   results_fprintf(outfile,"DATA ERROR: Invalid day '%d' in '%s' at '%s'\n", *day, datestr, emssg );
    return 0;
   }
  return 1;
 }
 
 
+int date_daynum( int month, int day, int year )	/* Days since 1-1-0000 of a valid date. */
+{
+ int cumdays[13]={0,0,31,59,90,120,151,181,212,243,273,304,334};  /* Days before each month */
+ int n;
+ n = 365 * year + (year + 3) / 4 - (year + 99) / 100 + (year + 399) / 400;   /* Leap days in prior years. */
+ n = n + cumdays[month] + day - 1;
+ if ((month > 2) && (isleapyear( year )))
+  n++;
+ return n;
+}
+
+
+/* Recently seen date-strings, and their values.  Lots often share the same dates. */
+#define DATE_CACHE_SIZE 256
+#define DATE_CACHE_KEYLEN 24
+
+THREAD_LOCAL struct date_cache_entry
+ {
+  char datestr[DATE_CACHE_KEYLEN];
+  struct date_rec date;
+ } date_cache[DATE_CACHE_SIZE];
+
+
 /**********************************************************************************************/
 /* gen_date_rec - Input is "datestr". Generates a record (structure variable)                 */
-/*   "date_rec" with numerical (integer) month, day, year.                   	              */
+/*   "date_rec" with numerical (integer) month, day, year, and day-number.     	              */
 /* Date Record used in get_gain_and_losses function to determine if holding period is greater */
 /* than one Calendar Year and for sell-before-buy check.				      */
 /**********************************************************************************************/
-void gen_date_rec(char *datestr, char *emssg, struct date_rec *date )
-{
- int month, day, year, result ;
+void gen_date_rec( FILE *infile, char *datestr, char *emssg, struct date_rec *date )
+{ /* (Errors are located in infile, when validating.  It may be zero, for other sources.) */
+ struct date_cache_entry *ce=0;
+ int month, day, year, result, len ;
+
+ len = strlen( datestr );
+ if ((len > 0) && (len < DATE_CACHE_KEYLEN))
+  {
+   ce = &(date_cache[ fnv_hash( FNV_BASIS, datestr, len ) % DATE_CACHE_SIZE ]);
+   if (strcmp( ce->datestr, datestr ) == 0)
+    {
+     *date = ce->date;
+     if ((date->year<1980) || (date->year>2050))
+      console_printf("Warning:  Unusual year in '%s' .  Use mm-dd-yy date like 5-23-02.   '%s'\n", datestr, emssg );
+     return;
+    }
+  }
  /* Expect month-day-year, 3-3-01 */
  result = interpret_date( datestr, &month, &day, &year, emssg );
  if (result != 1)
-  exit(1);
+  {
+   if (!collect_input_error( infile, 0, "Bad date '%s', reading %s.", datestr, emssg ))
+    taxsolve_exit(1);
+   month = day = year = 0;	/* Validating.  Mark date as unknown. */
+   ce = 0;
+  }
+ else
  if ((year<1980) || (year>2050))
-  printf("Warning:  Unusual year in '%s' .  Use mm-dd-yy date like 5-23-02.   '%s'\n", datestr, emssg );
+  console_printf("Warning:  Unusual year in '%s' .  Use mm-dd-yy date like 5-23-02.   '%s'\n", datestr, emssg );
  /* Put the results in the "date_rec" record via pointer */
  date->month = month;
  date->day=day;
  date->year=year;
+ date->daynum = (result == 1) ? date_daynum( month, day, year ) : 0;
+ if (ce != 0)
+  {
+   strcpy( ce->datestr, datestr );
+   ce->date = *date;
+  }
 }
 
 
 void read_line( FILE *infile, char *line )
 {
+ struct input_buffer *ib, unbuffered;
  int j=0;
- do  line[j++] = getc(infile);  while ((!feof(infile)) && (line[j-1] != '\n'));
+ ib = get_input_buffer( infile, &unbuffered );
+ do  line[j++] = IB_GETC(ib);  while ((!IB_EOF(ib)) && (line[j-1] != '\n'));
  line[j-1] = '\0';
 }
 
 
 void read_comment_filtered_line( FILE *infile, char *line, int maxlen )
 { /* Read next line, while filtering-out any comments. */
+ struct input_buffer *ib, unbuffered;
  int j=0;
+ ib = get_input_buffer( infile, &unbuffered );
  do
   {
-   line[j] = getc(infile);  
+   line[j] = IB_GETC(ib);  
    if (line[j]=='{') 
     { 
-     do line[j] = getc(infile); 
-     while ((line[j] != '}') && (!feof(infile)));
+     do line[j] = IB_GETC(ib); 
+     while ((line[j] != '}') && (!IB_EOF(ib)));
      line[j] = ' ';
     }
    j++;
   }
- while ((!feof(infile)) && (line[j-1] != '\n') && (j < maxlen-2));
+ while ((!IB_EOF(ib)) && (line[j-1] != '\n') && (j < maxlen-2));
  j--;
  line[j] = '\0';
  consume_leading_trailing_whitespace( line );
@@ -657,11 +2048,11 @@ void read_comment_filtered_line( FILE *infile, char *line, int maxlen )
 
 /* Show a line-number and it's value. */
 void showline( int j )
-{ fprintf(outfile, "L%d = %6.2f\n", j, L[j]); }
+{ char amt[AMOUNT_BUFSZ];  results_fprintf(outfile, "L%d = %s\n", j, format_amount( L[j], amt )); }
 
 /* Show an integer valued line. */
 void shownum( int j )
-{ fprintf(outfile, "L%d = %d\n", j, (int)L[j]); }
+{ results_fprintf(outfile, "L%d = %d\n", j, (int)L[j]); }
 
 /* Show line only if non-zero. */	/* Depricated in favor of ShowLineNonZero (clearer name). */
 void ShowLine( int j )	
@@ -673,7 +2064,7 @@ void ShowLineNonZero( int j )
 
 /* Show-Line with a message. */
 void showline_wmsg( int j, char *msg )	
-{ fprintf(outfile,"L%d = %6.2f\t\t%s\n", j, L[j], msg); }
+{ char amt[AMOUNT_BUFSZ];  results_fprintf(outfile,"L%d = %s\t\t%s\n", j, format_amount( L[j], amt ), msg); }
 
 /* Show line with a message, only if non-zero. */
 void ShowLineNonZero_wMsg( int j, char *msg )
@@ -681,32 +2072,33 @@ void ShowLineNonZero_wMsg( int j, char *msg )
 
 /* For worksheet calculations, indent and show special line character. */
 void showline_wrksht( char wrksht, int j, double *x )
-{ fprintf(outfile," %c%d = %6.2f\n", wrksht, j, x[j]); }
+{ char amt[AMOUNT_BUFSZ];  results_fprintf(outfile," %c%d = %s\n", wrksht, j, format_amount( x[j], amt )); }
 
 /* For worksheet calculations, indent and show special line character, if not zero. */
 void showline_wrksht_nz( char *wrksht, int j, double *x )
-{ if (x[j] != 0.0) fprintf(outfile," %s%d = %6.2f\n", wrksht, j, x[j] ); }
+{ char amt[AMOUNT_BUFSZ];  if (x[j] != 0.0) results_fprintf(outfile," %s%d = %s\n", wrksht, j, format_amount( x[j], amt ) ); }
 
 /* Show-line with specified label and value. */
 void showline_wlabel( char *label, double value )
-{ fprintf(outfile, "%s = %6.2f\n", label, value ); }
+{ char amt[AMOUNT_BUFSZ];  results_fprintf(outfile, "%s = %s\n", label, format_amount( value, amt ) ); }
 
 /* Show-line with specified label and value. */
 void showline_wlabelnz( char *label, double value )
 { 
+ char amt[AMOUNT_BUFSZ];
  if (value != 0.0)
-  fprintf(outfile, "%s = %6.2f\n", label, value ); 
+  results_fprintf(outfile, "%s = %s\n", label, format_amount( value, amt ) ); 
 }
 
 /* Show-line with specified label, value, and message. */
 void showline_wlabelmsg( char *label, double value, char *msg )
-{ fprintf(outfile, "%s = %6.2f\t\t%s\n", label, value, msg ); }
+{ char amt[AMOUNT_BUFSZ];  results_fprintf(outfile, "%s = %s\t\t%s\n", label, format_amount( value, amt ), msg ); }
 
 /* Show a character-string line with specified label, if string is not empty. */
 void Show_String_wLabel( char *label, char *msg )
 { 
  if ((msg != 0) && (msg[0] != '\0'))
-  fprintf(outfile, "%s %s\n", label, msg );
+  results_fprintf(outfile, "%s %s\n", label, msg );
 }
 
 
@@ -730,14 +2122,14 @@ void GetLine1( char *linename, double *value )
 void GetLineF( char *linename, double *value )
 {
  GetLine( linename, value );
- fprintf(outfile, "%s = %6.2f\n", linename, *value );
+ showline_wlabel( linename, *value );
 }
 
 /* Get a line value, and print it to file if not zero. */
 void GetLineFnz( char *linename, double *value )
 {
  GetLine( linename, value );
- if (*value != 0.0) fprintf(outfile, "%s = %6.2f\n", linename, *value );
+ showline_wlabelnz( linename, *value );
 }
 
 /* Get optional line with label. */
@@ -798,12 +2190,13 @@ void Display_File( char *filename )
  FILE *infile;
  char line[500];
 
- infile = fopen(filename,"r");
- if (infile==0) {printf("Could not open %s\n", filename); return;}
+ if (quiet) return;
+ infile = taxsolve_fopen(filename,"r");
+ if (infile==0) {console_printf("Could not open %s\n", filename); return;}
  fgets(line, 500, infile);
  while (!feof(infile))
   {
-   printf("%s", line);
+   console_printf("%s", line);
    fgets(line, 500, infile);
   } 
  fclose(infile);
@@ -817,16 +2210,18 @@ void Display_File( char *filename )
 /*------------------------------------------------------------------------------*/
 void get_comment( FILE *infile, char *word )
 {
+ struct input_buffer *ib, unbuffered;
  int j=0;
 
+ ib = get_input_buffer( infile, &unbuffered );
  do  /*Absorb any leading white-space.*/
-     word[j] = getc(infile); 
- while ((!feof(infile)) && ((word[j]==' ') || (word[j]=='\t') || (word[j]=='\n') || (word[j]=='\r')));
+     word[j] = IB_GETC(ib); 
+ while ((!IB_EOF(ib)) && ((word[j]==' ') || (word[j]=='\t') || (word[j]=='\n') || (word[j]=='\r')));
  if (word[j] == '{')
   {
    do  /*Get words until end of comment.*/
-       word[j++] = getc(infile);
-   while ((!feof(infile)) && (word[j-1] != '}'));
+       word[j++] = IB_GETC(ib);
+   while ((!IB_EOF(ib)) && (word[j-1] != '}'));
    if (word[j-1] == '}')
     word[j-1] = '\0';
    else
@@ -834,32 +2229,147 @@ void get_comment( FILE *infile, char *word )
   }
  else
   {
-   ungetc(word[j], infile);
+   input_buffer_ungetc( word[j], ib );
    word[0] = '\0';
   }
- if (verbose) printf("Read Coment: {%s}\n", word);
+ if (verbose) console_printf("Read Coment: {%s}\n", word);
 }
 
 
-void consume_leading_trailing_whitespace( char *line )
-{ int j, k;
-  while (isspace( line[0] ))
-   {
-    j = 0;
-    do { line[j] = line[j+1];  j++; }
-    while (line[j-1] != '\0');
-   }
- k = strlen( line ) - 1;
- while ((k >= 0) && (isspace( line[k] )))
+/*------------------------------------------------------------------------------*/
+/* Get_Comment_On_Line - Like get_comment, but only takes a comment that starts	*/
+/*  on the remainder of the current line, such as the payer-name after a value.	*/
+/*------------------------------------------------------------------------------*/
+void get_comment_on_line( FILE *infile, char *word, int maxlen )
+{
+ struct input_buffer *ib, unbuffered;
+ int j=0;
+ char c;
+
+ ib = get_input_buffer( infile, &unbuffered );
+ do  /*Absorb any leading spaces, but not the end of line.*/
+     c = IB_GETC(ib);
+ while ((!IB_EOF(ib)) && ((c==' ') || (c=='\t') || (c=='\r')));
+ if (c == '{')
   {
-   line[k] = '\0';
-   k--;
+   c = IB_GETC(ib);
+   while ((!IB_EOF(ib)) && (c != '}'))
+    {
+     if (j < maxlen-1)
+      word[j++] = c;
+     c = IB_GETC(ib);
+    }
+  }
+ else
+  input_buffer_ungetc( c, ib );
+ word[j] = '\0';
+ if (verbose) console_printf("Read Coment: {%s}\n", word);
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Get_CSV_Record - Read the next record of a comma-separated-values file, such	*/
+/*  as a broker's export.  A field may be double-quoted, to hold commas,	*/
+/*  line-breaks, or quotes (written doubled).  The record is unquoted into	*/
+/*  rec->text, which grows in the return_pool only as long as the longest	*/
+/*  record, and rec->field[k] points at each null-terminated field.  Fields	*/
+/*  past MAX_CSV_FIELDS are dropped.  Blank lines are skipped.  Returns the	*/
+/*  number of fields, or 0 at the end of the file.				*/
+/*------------------------------------------------------------------------------*/
+#define MAX_CSV_FIELDS 64
+
+struct csv_record
+ {
+  char *text;
+  long size;
+  char *field[MAX_CSV_FIELDS];
+  int nfields;
+  long line, nextline;	/* Line on which the record starts, and of the next one. */
+ };
+
+int get_csv_record( FILE *fp, struct csv_record *rec )
+{
+ struct input_buffer *ib, unbuffered;
+ long start[MAX_CSV_FIELDS], j=0;
+ int c, quoted=0, done=0, k;
+ char *pt;
+
+ ib = get_input_buffer( fp, &unbuffered );
+ if (rec->nextline == 0)
+  rec->nextline = 1;
+ do  /* Skip blank lines. */
+  {
+   c = IB_GETC(ib);
+   if (c == '\n') rec->nextline++;
+  }
+ while ((c == '\n') || (c == '\r'));
+ if (c == EOF)
+  return 0;
+ if ((rec->nextline == 1) && ((c & 0xff) == 0xef) && (ib->pos == 1) && (ib->len >= 3)
+     && ((ib->data[1] & 0xff) == 0xbb) && ((ib->data[2] & 0xff) == 0xbf))
+  { /* Skip a UTF-8 byte-order mark. */
+   IB_GETC(ib);  IB_GETC(ib);
+   c = IB_GETC(ib);
+  }
+ rec->line = rec->nextline;
+ rec->nfields = 1;
+ start[0] = 0;
+ while (!done)
+  {
+   if (j + 2 > rec->size)
+    { /* (The old text stays in the return_pool, which is at most doubled by it.) */
+     pt = (char *)return_alloc( 2 * rec->size + 256 );
+     if (j > 0) memcpy( pt, rec->text, j );
+     rec->text = pt;
+     rec->size = 2 * rec->size + 256;
+    }
+   if (c == EOF)
+    done = 1;
+   else
+   if (quoted)
+    {
+     if (c == '"')
+      {
+       c = IB_GETC(ib);
+       if (c == '"')
+        rec->text[j++] = '"';
+       else
+        { quoted = 0;  continue; }
+      }
+     else
+      {
+       if (c == '\n') rec->nextline++;
+       rec->text[j++] = c;
+      }
+    }
+   else
+   if (c == '"')
+    quoted = 1;
+   else
+   if (c == ',')
+    {
+     rec->text[j++] = '\0';
+     if (rec->nfields < MAX_CSV_FIELDS)
+      start[ rec->nfields++ ] = j;
+    }
+   else
+   if (c == '\n')
+    { rec->nextline++;  done = 1; }
+   else
+   if (c != '\r')
+    rec->text[j++] = c;
+   if (!done)
+    c = IB_GETC(ib);
   }
+ rec->text[j] = '\0';
+ for (k=0; k < rec->nfields; k++)
+  rec->field[k] = rec->text + start[k];
+ return rec->nfields;
 }
 
 
-int do_all_caps=0;
-int writeout_line=1;
+THREAD_LOCAL int do_all_caps=0;
+THREAD_LOCAL int writeout_line=1;
 
 void capitalize( char *word )
 {
@@ -877,16 +2387,18 @@ void capitalize( char *word )
 /*------------------------------------------------------------------------------*/
 char *GetTextLineF( char *linename )
 {
+ struct input_buffer *ib, unbuffered;
  int k=0;
  char line[5000];
  get_parameter( infile, 's', line, linename );
- line[k] = getc(infile);
- while ((!feof(infile)) && (line[k] != '\n'))
+ ib = get_input_buffer( infile, &unbuffered );
+ line[k] = IB_GETC(ib);
+ while ((!IB_EOF(ib)) && (line[k] != '\n'))
   {
    if (line[k] == '{')
     {
-     do line[k] = getc(infile); while ((!feof(infile)) && (line[k] != '}'));
-     if (line[k] == '}') line[k] = getc(infile);
+     do line[k] = IB_GETC(ib); while ((!IB_EOF(ib)) && (line[k] != '}'));
+     if (line[k] == '}') line[k] = IB_GETC(ib);
     }
    else
     {
@@ -894,12 +2406,12 @@ char *GetTextLineF( char *linename )
      if (k >= 5000)
       { 
         line[k-1] = '\0';  
-        while ((!feof(infile)) && (getc(infile) != '\n'));  
+        while ((!IB_EOF(ib)) && (IB_GETC(ib) != '\n'));  
         consume_leading_trailing_whitespace( line );
-	fprintf(outfile, "%s %s\n", linename, line );
-        return strdup( line );
+	results_fprintf(outfile, "%s %s\n", linename, line );
+        return return_strdup( line );
       }
-     line[k] = getc(infile);
+     line[k] = IB_GETC(ib);
     }
   }
  line[k] = '\0';
@@ -907,8 +2419,8 @@ char *GetTextLineF( char *linename )
  if (do_all_caps)
   capitalize( line );
  if (writeout_line)
-  fprintf(outfile, "%s %s\n", linename, line ); 
- return strdup( line );
+  results_fprintf(outfile, "%s %s\n", linename, line ); 
+ return return_strdup( line );
 }
 
 
@@ -942,37 +2454,6 @@ void format_socsec( char *line, int kind )
 }
 
 
-void remove_certain_chars( char *line, char *badchars )
-{ /* Removes any specified characters from a string, so as to uniformly format dates, ID numbers, etc.. */
-  int j=0, k, m=0;
-  while (line[j] != '\0')
-   {
-    k = 0;
-    while ((badchars[k] != '\0') && (line[j] != badchars[k]))
-     k++;
-    if (badchars[k] == '\0')
-     line[m++] = line[j];
-    j++;
-   }
-  line[m] = '\0';
-}
-
-
-void substitute_chars( char *line, char *badchars, char replace_char )
-{ /* Replaces any specified characters from a string, so as to uniformly format dates, ID numbers, etc.. */
-  int j=0, k;
-  while (line[j] != '\0')
-   {
-    k = 0;
-    while ((badchars[k] != '\0') && (line[j] != badchars[k]))
-     k++;
-    if (badchars[k] != '\0')
-     line[j] = replace_char;
-    j++;
-   }
-}
-
-
 /* --- PDF Markup Support --- */
 /* This class supports the ability to intercept "MarkupPDF" commands in a Tax Input File,
    and to forward them to the Tax Output File, where they can be interpretted by the
@@ -997,7 +2478,7 @@ void substitute_chars( char *line, char *badchars, char replace_char )
 	assuming 110 units per inch.
    You can add such markup commands to your saved tax file.
 */
-struct pdf_markup_record
+THREAD_LOCAL struct pdf_markup_record
  {
   char *tagname, *value;
   int page, fontsz, setcol;
@@ -1009,11 +2490,11 @@ void add_pdf_markup( char *tagname, int page, float xpos, float ypos,
 			int fontsz, int setcol, float txtred, float txtgrn, float txtblu, char *value )
 {
  struct pdf_markup_record *new;
- new = (struct pdf_markup_record *)calloc( 1, sizeof( struct pdf_markup_record ) );
+ new = (struct pdf_markup_record *)return_alloc( sizeof( struct pdf_markup_record ) );
  new->next = pdf_markup_list;
  pdf_markup_list = new;
- new->tagname = strdup( tagname );
- new->value = strdup( value );
+ new->tagname = return_strdup( tagname );
+ new->value = return_strdup( value );
  new->page = page;
  new->xpos = xpos;
  new->ypos = ypos;
@@ -1026,72 +2507,86 @@ void add_pdf_markup( char *tagname, int page, float xpos, float ypos,
 
 void process_pdf_markup_command( char *line )
 {
- char word[4096], word2[4096], tagname[4096], value[4096];
+ char word[4096], word2[4096], tagname[4096], value[4096], *pt=line, *args;
  int pgnum=-1, fsz=10, setcol=0;
  float xpos=0.0, ypos=0.0, txtred=0.0, txtgrn=0.0, txtblu=0.0;
  if (mystrcasestr( line, "MarkupPDF" ) == 0) return;
  if (mystrcasestr( line, "MarkupPDF(" ) != 0)
   {
-   next_word( line, word2, "(" );
-   next_word( line, word2, "()" );
-   next_word( word2, word, " \t(," );
+   pt = scan_word( pt, word2, "(" );
+   pt = scan_word( pt, word2, "()" );
+   args = scan_word( word2, word, " \t(," );
    if (sscanf( word, "%d", &pgnum ) != 1)
-    { printf("Error reading MarkupPDF page-num '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF page-num '%s'\n", word );
+    { console_printf("Error reading MarkupPDF page-num '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF page-num '%s'\n", word );
       return;
     }
-   next_word( word2, word, " \t," );
+   args = scan_word( args, word, " \t," );
    if (sscanf( word, "%f", &xpos ) != 1)
-    { printf("Error reading MarkupPDF Xposition '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF Xposition '%s'\n", word );
+    { console_printf("Error reading MarkupPDF Xposition '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF Xposition '%s'\n", word );
       return;
     }
-   next_word( word2, word, " \t,)" );
+   args = scan_word( args, word, " \t,)" );
    if (sscanf( word, "%f", &ypos ) != 1)
-    { printf("Error reading MarkupPDF Yposition '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF Yposition '%s'\n", word );
+    { console_printf("Error reading MarkupPDF Yposition '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF Yposition '%s'\n", word );
       return;
     }
-   next_word( word2, word, " \t,)" );
+   args = scan_word( args, word, " \t,)" );
    if ((word[0] != '\0') && (sscanf( word, "%d", &fsz ) != 1))
-    { printf("Error reading MarkupPDF fontsz '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF fontsz '%s'\n", word );
+    { console_printf("Error reading MarkupPDF fontsz '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF fontsz '%s'\n", word );
     }
-   next_word( word2, word, " \t,)" );
+   args = scan_word( args, word, " \t,)" );
    if ((word[0] != '\0') && (sscanf( word, "%g", &txtred ) != 1))
-    { printf("Error reading MarkupPDF txtred '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF textred '%s'\n", word );
+    { console_printf("Error reading MarkupPDF txtred '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF textred '%s'\n", word );
     }
    else
     setcol = 1;
-   next_word( word2, word, " \t,)" );
+   args = scan_word( args, word, " \t,)" );
    if ((word[0] != '\0') && (sscanf( word, "%g", &txtgrn ) != 1))
-    { printf("Error reading MarkupPDF txtgrn '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF txtgrn '%s'\n", word );
+    { console_printf("Error reading MarkupPDF txtgrn '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF txtgrn '%s'\n", word );
     }
-   next_word( word2, word, " \t,)" );
+   args = scan_word( args, word, " \t,)" );
    if ((word[0] != '\0') && (sscanf( word, "%g", &txtblu ) != 1))
-    { printf("Error reading MarkupPDF txtblue '%s'\n", word );
-      fprintf(outfile,"Error reading MarkupPDF txtblue '%s'\n", word );
+    { console_printf("Error reading MarkupPDF txtblue '%s'\n", word );
+      results_fprintf(outfile,"Error reading MarkupPDF txtblue '%s'\n", word );
     }
-   next_word( line, word, " \t,)=" );
+   pt = scan_word( pt, word, " \t,)=" );
   }
  else
   {
-   next_word( line, word, " \t" );
-   next_word( line, word, " \t=" );
+   pt = scan_word( pt, word, " \t" );
+   pt = scan_word( pt, word, " \t=" );
   }
  strcpy( tagname, word );		/* Grab tag-name. */
- next_word( line, value, " \t=" );	/* Grab 1st word of value after '=', if any. */
+ pt = scan_word( pt, value, " \t=" );	/* Grab 1st word of value after '=', if any. */
  // strcat( value, " " );			/* Add white-space in case other words on line. */
- strcat( value, line );			/* Add any following words on the remainder of the line. */
+ strcat( value, pt );			/* Add any following words on the remainder of the line. */
  add_pdf_markup( tagname, pgnum, xpos, ypos, fsz, setcol, txtred, txtgrn, txtblu, value );
 }
 
 void intercept_any_pdf_markups( FILE *infile )
 {
+ struct input_buffer *ib, unbuffered;
  char line[8192];
+ long j;
  if (!outfile) return;
+ ib = get_input_buffer( infile, &unbuffered );
+ if ((ib->compiled) && (ib->pos == 0))
+  { /* The compiler kept the markup lines, so the text need not be re-read. */
+    for (j=0; j < ib->nmarkups; j++)
+     {
+      memcpy( line, ib->strings + ib->markups[j].text, ib->markups[j].len + 1 );
+      process_pdf_markup_command( line );
+     }
+    ib->pos = ib->len;
+    input_buffer_underflow( ib );
+    return;
+  }
  read_comment_filtered_line( infile, line, 8192 );
  while (!feof(infile))
   {
@@ -1103,17 +2598,16 @@ void intercept_any_pdf_markups( FILE *infile )
 
 void exude_pdf_markups( FILE *outfile )
 { /* Add any intercepted PDF-markups to the tax-output file. */
-  struct pdf_markup_record *old;
   if (!outfile) return;  
   while (pdf_markup_list)
    {
     if (pdf_markup_list->page > 0)
      {
       if ((pdf_markup_list->fontsz == 10) && (pdf_markup_list->setcol == 0))
-       fprintf(outfile,"NewPDFMarkup( %d, %g, %g ) %s\n", pdf_markup_list->page, 
+       results_fprintf(outfile,"NewPDFMarkup( %d, %g, %g ) %s\n", pdf_markup_list->page, 
 		pdf_markup_list->xpos, pdf_markup_list->ypos, pdf_markup_list->tagname );
       else
-       fprintf(outfile,"NewPDFMarkup( %d, %g, %g, %d, %d, %g, %g, %g ) %s\n", 
+       results_fprintf(outfile,"NewPDFMarkup( %d, %g, %g, %d, %d, %g, %g, %g ) %s\n", 
 		pdf_markup_list->page, 
 		pdf_markup_list->xpos, pdf_markup_list->ypos,
 		pdf_markup_list->fontsz, pdf_markup_list->setcol, 
@@ -1121,25 +2615,745 @@ void exude_pdf_markups( FILE *outfile )
 		pdf_markup_list->tagname );
      }
     if (strstr( pdf_markup_list->tagname, ":" ) == 0)
-     fprintf(outfile,"%s = %s\n", pdf_markup_list->tagname, pdf_markup_list->value );
+     results_fprintf(outfile,"%s = %s\n", pdf_markup_list->tagname, pdf_markup_list->value );
     else
-     fprintf(outfile,"%s \t%s\n", pdf_markup_list->tagname, pdf_markup_list->value );
-    old = pdf_markup_list;
-    pdf_markup_list = pdf_markup_list->next;
-    free( old->tagname );
-    free( old->value );
-    free( old );
+     results_fprintf(outfile,"%s \t%s\n", pdf_markup_list->tagname, pdf_markup_list->value );
+    pdf_markup_list = pdf_markup_list->next;	/* (Records are released with the return_pool.) */
    }
 }
 
 void grab_any_pdf_markups( char *infname, FILE *outfile )
 {
  FILE *infile;
- infile = fopen( infname, "rb" );
- if (infile == 0) { printf("GAPM: Cannot open '%s' for reading.\n", infname );  return; }
+ infile = taxsolve_fopen( infname, "rb" );
+ if (infile == 0) { console_printf("GAPM: Cannot open '%s' for reading.\n", infname );  return; }
  intercept_any_pdf_markups( infile );
  fclose( infile );
  exude_pdf_markups( outfile );
 }
 
 /* --- End PDF Markup Support --- */
+
+
+/*------------------------------------------------------------------------------*/
+/* Compile_Input - Build the compiled return (see Compiled Returns, above) of	*/
+/*  the tax-input file fp, in memory:  every token, as read from the top in	*/
+/*  default mode, with its conversions, and the lines holding PDF markups.	*/
+/*  Ots_compile writes the image out as an .otsb file.  A solver re-computing	*/
+/*  one return many times may instead compile it once, and hand the image to	*/
+/*  each computation as its preloaded_input.  Leaves fp's buffer at no	*/
+/*  particular position.  Returns the image, which the caller frees, with its	*/
+/*  size in len, or zero when fp cannot be buffered or is too large.		*/
+/*------------------------------------------------------------------------------*/
+struct otsb_section	/* Growable array, for a section being built. */
+ {
+  char *data;
+  unsigned long len, size;
+ };
+
+unsigned long section_add( struct otsb_section *sec, void *item, unsigned long n )
+{
+ unsigned long offset=sec->len;
+ if (sec->len + n > sec->size)
+  {
+   sec->size = 2 * (sec->len + n) + 4096;
+   sec->data = (char *)realloc( sec->data, sec->size );
+   if (sec->data == 0)
+    { console_printf("ERROR: Out of memory compiling the return.\n");  taxsolve_exit(1); }
+  }
+ memcpy( sec->data + sec->len, item, n );
+ sec->len += n;
+ return offset;
+}
+
+
+/* Read one token from position P in default mode, and report where it ended. */
+void token_from( FILE *fp, struct input_buffer *ib, long P, struct token_view *tok, long *tokpos, long *end, int *at_eof )
+{
+ ib->pos = P;
+ ib->eof = 0;
+ clearerr( fp );
+ ib->tokpos = -1;
+ get_token( fp, tok );
+ *tokpos = ib->tokpos;
+ *end = ib->pos;
+ *at_eof = ib->eof;
+}
+
+
+#define OTSB_ALIGN(x)  (((x) + 7) & ~7UL)
+
+
+char *compile_input( FILE *fp, long *len )
+{
+ struct input_buffer *ib, unbuffered;
+ struct otsb_section tokens={0}, strings={0}, markups={0};
+ struct otsb_header hdr;
+ struct otsb_token t;
+ struct otsb_markup m;
+ struct token_view tok;
+ struct numeric_scan ns;
+ char *word=0, *text=0, *image, line[8192];
+ long word_sz=0, from, tokpos, end;
+ int at_eof;
+
+ ib = get_input_buffer( fp, &unbuffered );
+ if ((ib == &unbuffered) || (ib->len >= 0xffffffffL))
+  return 0;
+
+ /* Record every token, as read from the top in default mode. */
+ from = 0;
+ do
+  {
+   token_from( fp, ib, from, &tok, &tokpos, &end, &at_eof );
+   memset( &t, 0, sizeof(t) );
+   t.from = from;
+   t.end = end;
+   t.len = tok.len;
+   if (at_eof) t.flags |= OTSB_AT_EOF;
+   if (tokpos < 0)
+    t.flags |= OTSB_NO_TOKPOS;
+   else
+    t.tokpos = tokpos;
+   if ((tok.text >= ib->data) && (tok.text + tok.len <= ib->data + ib->len))
+    t.text = tok.text - ib->data;
+   else
+    {
+     t.flags |= OTSB_IN_STRINGS;
+     t.text = section_add( &strings, tok.text, tok.len );
+     section_add( &strings, "", 1 );
+    }
+   text = ((t.flags & OTSB_IN_STRINGS) ? strings.data : ib->data) + t.text;
+   if (tok.len + 1 > word_sz)
+    {
+     word_sz = 2 * tok.len + 4096;
+     word = (char *)realloc( word, word_sz );
+    }
+   memcpy( word, text, tok.len );
+   word[tok.len] = '\0';
+   if (scan_float( word, &ns ))
+    {
+     t.flags |= OTSB_FLOAT;
+     t.value = ns.value;
+     if (scan_int( word, &ns ))
+      t.flags |= OTSB_INT;
+    }
+   section_add( &tokens, &t, sizeof(t) );
+   from = end;
+  }
+ while (!at_eof);
+
+ /* Record the lines holding PDF markups, as intercept_any_pdf_markups finds them. */
+ ib->pos = 0;
+ ib->eof = 0;
+ clearerr( fp );
+ read_comment_filtered_line( fp, line, 8192 );
+ while (!feof(fp))
+  {
+   if (strstr( line, "MarkupPDF" ) != 0)
+    {
+     m.len = strlen( line );
+     m.text = section_add( &strings, line, m.len + 1 );
+     section_add( &markups, &m, sizeof(m) );
+    }
+   read_comment_filtered_line( fp, line, 8192 );
+  }
+
+ memset( &hdr, 0, sizeof(hdr) );
+ memcpy( hdr.magic, OTSB_MAGIC, OTSB_MAGIC_LEN );
+ hdr.byteorder = OTSB_BYTEORDER;
+ hdr.version = OTSB_VERSION;
+ hdr.token_size = sizeof(struct otsb_token);
+ hdr.text_offset = OTSB_ALIGN( sizeof(hdr) );
+ hdr.text_len = ib->len;
+ hdr.tokens_offset = OTSB_ALIGN( hdr.text_offset + hdr.text_len );
+ hdr.ntokens = tokens.len / sizeof(struct otsb_token);
+ hdr.strings_offset = hdr.tokens_offset + tokens.len;
+ hdr.strings_len = strings.len;
+ hdr.markups_offset = OTSB_ALIGN( hdr.strings_offset + hdr.strings_len );
+ hdr.nmarkups = markups.len / sizeof(struct otsb_markup);
+
+ *len = hdr.markups_offset + markups.len;
+ image = (char *)calloc( *len, 1 );	/* (Zeros pad the sections for alignment.) */
+ if (image == 0)
+  { console_printf("ERROR: Out of memory compiling the return.\n");  taxsolve_exit(1); }
+ memcpy( image, &hdr, sizeof(hdr) );
+ memcpy( image + hdr.text_offset, ib->data, hdr.text_len );
+ if (tokens.len > 0) memcpy( image + hdr.tokens_offset, tokens.data, tokens.len );
+ if (strings.len > 0) memcpy( image + hdr.strings_offset, strings.data, strings.len );
+ if (markups.len > 0) memcpy( image + hdr.markups_offset, markups.data, markups.len );
+ free( word );
+ free( tokens.data );
+ free( strings.data );
+ free( markups.data );
+ return image;
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Federal Return Snapshot - The 1040 writes its results both as text		*/
+/*  (xxx_out.txt) and as a binary snapshot beside it (xxx_out.otsf), which	*/
+/*  holds every line of the text already split into its label and the rest,	*/
+/*  with the value after the label converted, so that the state solvers can	*/
+/*  map it instead of re-reading and re-parsing the text.  The 1040 records	*/
+/*  the snapshot as it writes the text:  each line is split as it is	*/
+/*  finished, and a value that format_amount wrote (as showline does) is	*/
+/*  taken from the amount computed, rather than converted back from the	*/
+/*  text.  The snapshot also records the length and FNV-1a hash of the text.	*/
+/*  When there is no snapshot, or the text no longer has that length and	*/
+/*  hash, the text itself is read into the same records, so each importer	*/
+/*  has just one format to handle.  As with compiled returns, the layout is	*/
+/*  that of the writing machine.						*/
+/*------------------------------------------------------------------------------*/
+#define FED_SNAPSHOT_MAGIC	"OTSFED\r\n"
+#define FED_SNAPSHOT_VERSION	2
+
+#define FED_HAS_EQUALS		1	/* The rest of the line holds " = ". */
+#define FED_HAS_WORD		2	/* A word follows the label, */
+#define FED_HAS_VALUE		4	/*  and it reads as a number. */
+#define FED_HAS_LINE		8	/* The label begins with a letter and a line number. */
+#define FED_STD_DEDUCTION	16	/* The line says "Use standard deduction." */
+#define FED_NOT_LIMITED		32	/* The line says "Deductions not limited". */
+#define FED_LINE_6		64	/* The line mentions "line 6". */
+
+struct fed_snapshot_header
+ {
+  char magic[OTSB_MAGIC_LEN];
+  unsigned int byteorder, version, record_size;
+  unsigned int records_offset, nrecords;
+  unsigned int text_offset, text_len;
+  long long source_size;			/* Of the text, as read in text-mode, */
+  unsigned long long source_hash;	/*  and its FNV-1a hash. */
+ };
+
+struct fed_record
+ {
+  double value;		/* The word after the label, as read by sscanf "%lf". */
+  int line;		/* The number after the label's first letter, as "L15" gives 15. */
+  unsigned int flags;
+  unsigned int label, rest;	/* Offsets in the text of the label, and of what follows it. */
+ };
+
+struct fed_snapshot
+ {
+  struct fed_record *records;
+  int nrecords;
+  char *text;
+  char *base;		/* The mapping, or allocation, holding the above. */
+  long baselen;
+  int mapped;
+ };
+
+
+void release_fed_snapshot( struct fed_snapshot *snap )
+{
+ if (snap->base != 0)
+  {
+  #ifndef __MINGW32__
+   if (snap->mapped)
+    munmap( snap->base, snap->baselen );
+   else
+  #endif
+    free( snap->base );
+  }
+ memset( snap, 0, sizeof(struct fed_snapshot) );
+}
+
+
+/* The snapshot's file-name:  xxx_out.txt -> xxx_out.otsf */
+void fed_snapshot_name( char *fedlogfile, char *snapname )
+{
+ int j;
+
+ strcpy( snapname, fedlogfile );
+ j = strlen( snapname ) - 1;
+ while ((j >= 0) && (snapname[j] != '.') && (snapname[j] != '/') && (snapname[j] != '\\')) j--;
+ if ((j < 0) || (snapname[j] != '.')) j = strlen( snapname );
+ strcpy( &(snapname[j]), ".otsf" );
+}
+
+
+/* Split one line of a federal return into record r, whose label and rest are copied */
+/* into text at *tlen, with their terminators.  Word must be as long as the line.    */
+/* When the word after the label is amount, its value is amount_value, unconverted.  */
+/* Returns zero for a blank line, which has no record.				     */
+int split_fed_line( char *line, struct fed_record *r, char *text, long *tlen, char *word, char *amount, double amount_value )
+{
+ char *rest;
+
+ if (strstr( line, "Use standard deduction." ) != 0) r->flags |= FED_STD_DEDUCTION;
+ if (strstr( line, "Deductions not limited" ) != 0) r->flags |= FED_NOT_LIMITED;
+ if (strstr( line, "line 6" ) != 0) r->flags |= FED_LINE_6;
+ rest = scan_word( line, word, " \t=" );
+ if ((word[0] == '\0') && (r->flags == 0))
+  return 0;	/* Blank. */
+ r->label = *tlen;
+ strcpy( &(text[*tlen]), word );
+ *tlen = *tlen + strlen( word ) + 1;
+ if ((word[0] != '\0') && (sscanf( &(word[1]), "%d", &(r->line) ) == 1)) r->flags |= FED_HAS_LINE;
+ r->rest = *tlen;
+ strcpy( &(text[*tlen]), rest );
+ *tlen = *tlen + strlen( rest ) + 1;
+ if (strstr( rest, " = " ) != 0) r->flags |= FED_HAS_EQUALS;
+ scan_word( rest, word, " \t=" );
+ if (word[0] != '\0')
+  {
+   r->flags |= FED_HAS_WORD;
+   if ((amount != 0) && (strcmp( word, amount ) == 0))
+    {
+     r->value = amount_value;
+     r->flags |= FED_HAS_VALUE;
+    }
+   else
+   if (sscanf( word, "%lf", &(r->value) ) == 1) r->flags |= FED_HAS_VALUE;
+  }
+ return 1;
+}
+
+
+/* Split the text of a federal return into records, laid-out as in a snapshot file. */
+/* Like the line-by-line readers before it, skips a last line with no newline.	     */
+int read_fed_text( char *fedlogfile, struct fed_snapshot *snap )
+{
+ struct fed_snapshot_header *hdr;
+ FILE *fp;
+ char *text, *line, *word;
+ long len, j, k, nlines=0, tlen=0, nrec=0;
+
+ memset( snap, 0, sizeof(struct fed_snapshot) );
+ fp = taxsolve_fopen( fedlogfile, "r" );
+ if (fp == 0)
+  return 0;
+ fseek( fp, 0, SEEK_END );
+ len = ftell( fp );
+ fseek( fp, 0, SEEK_SET );
+ text = (char *)malloc( len + 1 );
+ len = fread( text, 1, len, fp );	/* Text-mode may shorten it. */
+ text[len] = '\0';
+ fclose( fp );
+ for (j=0; j < len; j++)
+  if (text[j] == '\n') nlines++;
+
+ /* Each line's label and rest are copied into the text section, with their terminators. */
+ snap->baselen = sizeof(struct fed_snapshot_header) + nlines * sizeof(struct fed_record) + len + 2 * nlines;
+ snap->base = (char *)calloc( 1, snap->baselen );
+ hdr = (struct fed_snapshot_header *)snap->base;
+ snap->records = (struct fed_record *)(snap->base + sizeof(struct fed_snapshot_header));
+ snap->text = (char *)(snap->records + nlines);
+ line = (char *)malloc( len + 1 );
+ word = (char *)malloc( len + 1 );
+ for (j=0; j < len; j = k + 1)
+  {
+   for (k=j; text[k] != '\n'; k++)
+    if (k == len) break;
+   if (k == len) break;
+   memcpy( line, &(text[j]), k - j );
+   line[k - j] = '\0';
+   if (split_fed_line( line, &(snap->records[nrec]), snap->text, &tlen, word, 0, 0.0 ))
+    nrec++;
+  }
+ free( word );
+ free( line );
+ free( text );
+
+ memcpy( hdr->magic, FED_SNAPSHOT_MAGIC, OTSB_MAGIC_LEN );
+ hdr->byteorder = OTSB_BYTEORDER;
+ hdr->version = FED_SNAPSHOT_VERSION;
+ hdr->record_size = sizeof(struct fed_record);
+ hdr->records_offset = sizeof(struct fed_snapshot_header);
+ hdr->nrecords = nrec;
+ hdr->text_offset = (char *)snap->text - snap->base;
+ hdr->text_len = tlen;
+ snap->nrecords = nrec;
+ snap->baselen = hdr->text_offset + tlen;
+ return 1;
+}
+
+
+/* The snapshot being recorded, as the 1040 writes its results. */
+THREAD_LOCAL struct fed_snapshot_writer
+ {
+  char *line;			/* The line being written, */
+  long linelen, linesz;
+  char *word;			/*  and scratch as large. */
+  long wordsz;
+  struct fed_record *records;
+  long nrecords, recsz;
+  char *text;
+  long textlen, textsz;
+  char amount[32];		/* The amount format_amount wrote last, */
+  double amount_value;		/*  and its value. */
+  long long size;		/* Of all the text written, */
+  unsigned long long hash;	/*  and its hash. */
+ } fed_writer;
+
+void release_fed_writer( void )
+{
+ free( fed_writer.line );
+ free( fed_writer.word );
+ free( fed_writer.records );
+ free( fed_writer.text );
+ memset( &fed_writer, 0, sizeof(fed_writer) );
+ recording_fed_snapshot = 0;
+}
+
+
+/* Start recording the snapshot of the results written to outfile from now on. */
+void start_fed_snapshot( void )
+{
+ release_fed_writer();
+ fed_writer.hash = FNV_BASIS;
+ recording_fed_snapshot = 1;
+}
+
+
+/* Called by format_amount.  Text is the amount, without its padding, and value is   */
+/* what it reads as.  (So a stale note still gives the right value for its text.)    */
+void note_fed_amount( char *text, double value )
+{
+ strncpy( fed_writer.amount, text, sizeof(fed_writer.amount) - 1 );
+ fed_writer.amount_value = value;
+}
+
+
+/* Grow a buffer of *sz bytes to hold at least needed bytes. */
+void *grow_fed_buffer( void *buf, long *sz, long needed )
+{
+ if (needed <= *sz)
+  return buf;
+ *sz = 2 * needed + 4096;
+ buf = realloc( buf, *sz );
+ if (buf == 0)
+  { console_printf("ERROR: Out of memory recording the federal snapshot.\n");  taxsolve_exit(1); }
+ return buf;
+}
+
+
+void record_fed_line( char *line )
+{
+ struct fed_record *r;
+ long len=strlen( line ), sz;
+
+ sz = fed_writer.recsz * sizeof(struct fed_record);
+ fed_writer.records = (struct fed_record *)grow_fed_buffer( fed_writer.records, &sz, (fed_writer.nrecords + 1) * sizeof(struct fed_record) );
+ fed_writer.recsz = sz / sizeof(struct fed_record);
+ fed_writer.text = (char *)grow_fed_buffer( fed_writer.text, &(fed_writer.textsz), fed_writer.textlen + len + 2 );
+ r = &(fed_writer.records[ fed_writer.nrecords ]);
+ memset( r, 0, sizeof(struct fed_record) );
+ if (split_fed_line( line, r, fed_writer.text, &(fed_writer.textlen), fed_writer.word, fed_writer.amount, fed_writer.amount_value ))
+  fed_writer.nrecords++;
+}
+
+
+/* Write results to fp, as results_fprintf does, and record each line as it is finished. */
+int record_fed_results( FILE *fp, const char *fmt, va_list ap )
+{
+ va_list ap2;
+ char *pt;
+ long start, j;
+ int n;
+
+ va_copy( ap2, ap );
+ fed_writer.line = (char *)grow_fed_buffer( fed_writer.line, &(fed_writer.linesz), fed_writer.linelen + 256 );
+ n = vsnprintf( fed_writer.line + fed_writer.linelen, fed_writer.linesz - fed_writer.linelen, fmt, ap );
+ if ((n >= 0) && (fed_writer.linelen + n >= fed_writer.linesz))
+  {
+   fed_writer.line = (char *)grow_fed_buffer( fed_writer.line, &(fed_writer.linesz), fed_writer.linelen + n + 1 );
+   n = vsnprintf( fed_writer.line + fed_writer.linelen, fed_writer.linesz - fed_writer.linelen, fmt, ap2 );
+  }
+ va_end( ap2 );
+ if (n <= 0)
+  return n;
+ pt = fed_writer.line + fed_writer.linelen;
+ fwrite( pt, 1, n, fp );
+ fed_writer.size = fed_writer.size + n;
+ fed_writer.hash = fnv_hash( fed_writer.hash, pt, n );
+ fed_writer.word = (char *)grow_fed_buffer( fed_writer.word, &(fed_writer.wordsz), fed_writer.linesz );
+ start = 0;
+ for (j = fed_writer.linelen; j < fed_writer.linelen + n; j++)
+  if (fed_writer.line[j] == '\n')
+   {
+    fed_writer.line[j] = '\0';
+    record_fed_line( fed_writer.line + start );
+    start = j + 1;
+   }
+ fed_writer.linelen = fed_writer.linelen + n - start;
+ memmove( fed_writer.line, fed_writer.line + start, fed_writer.linelen );
+ return n;
+}
+
+
+/* Write the snapshot recorded since start_fed_snapshot beside the text, fedlogfile,	*/
+/* once that is closed.  (A last line with no newline is left out, as when reading.)	*/
+/* Zero on failure.									*/
+int write_fed_snapshot( char *fedlogfile )
+{
+ struct fed_snapshot_header hdr;
+ char snapname[4096];
+ FILE *fp;
+ int ok;
+
+ if ((!recording_fed_snapshot) || (strlen( fedlogfile ) + 6 > sizeof(snapname)))
+  { release_fed_writer();  return 0; }
+ memset( &hdr, 0, sizeof(hdr) );
+ memcpy( hdr.magic, FED_SNAPSHOT_MAGIC, OTSB_MAGIC_LEN );
+ hdr.byteorder = OTSB_BYTEORDER;
+ hdr.version = FED_SNAPSHOT_VERSION;
+ hdr.record_size = sizeof(struct fed_record);
+ hdr.records_offset = sizeof(struct fed_snapshot_header);
+ hdr.nrecords = fed_writer.nrecords;
+ hdr.text_offset = hdr.records_offset + fed_writer.nrecords * sizeof(struct fed_record);
+ hdr.text_len = fed_writer.textlen;
+ hdr.source_size = fed_writer.size;
+ hdr.source_hash = fed_writer.hash;
+ fed_snapshot_name( fedlogfile, snapname );
+ fp = taxsolve_fopen( snapname, "wb" );
+ ok = (fp != 0) && (fwrite( &hdr, 1, sizeof(hdr), fp ) == sizeof(hdr))
+	&& (fwrite( fed_writer.records, sizeof(struct fed_record), fed_writer.nrecords, fp ) == fed_writer.nrecords)
+	&& (fwrite( fed_writer.text, 1, fed_writer.textlen, fp ) == fed_writer.textlen);
+ if ((fp != 0) && (fclose( fp ) != 0)) ok = 0;
+ release_fed_writer();
+ return ok;
+}
+
+
+/* Attach a snapshot file, if it is valid. */
+int map_fed_snapshot( char *snapname, struct fed_snapshot *snap )
+{
+ struct fed_snapshot_header *hdr;
+ struct stat st;
+ FILE *fp;
+ unsigned long sz;
+
+ memset( snap, 0, sizeof(struct fed_snapshot) );
+ fp = taxsolve_fopen( snapname, "rb" );
+ if (fp == 0)
+  return 0;
+ if ((fstat( fileno( fp ), &st ) != 0) || (st.st_size < (long)sizeof(struct fed_snapshot_header)))
+  { fclose( fp );  return 0; }
+ sz = st.st_size;
+ #ifndef __MINGW32__
+  snap->base = (char *)mmap( 0, sz, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+  if (snap->base == MAP_FAILED)
+   snap->base = 0;
+  else
+   snap->mapped = 1;
+ #else
+  snap->base = (char *)malloc( sz );
+  if (fread( snap->base, 1, sz, fp ) != sz)
+   { free( snap->base );  snap->base = 0; }
+ #endif
+ fclose( fp );
+ if (snap->base == 0)
+  return 0;
+ snap->baselen = sz;
+ hdr = (struct fed_snapshot_header *)snap->base;
+ if ((memcmp( hdr->magic, FED_SNAPSHOT_MAGIC, OTSB_MAGIC_LEN ) != 0) || (hdr->byteorder != OTSB_BYTEORDER)
+     || (hdr->version != FED_SNAPSHOT_VERSION) || (hdr->record_size != sizeof(struct fed_record))
+     || (hdr->records_offset > sz) || (hdr->nrecords > (sz - hdr->records_offset) / sizeof(struct fed_record))
+     || (hdr->text_offset > sz) || (hdr->text_len > sz - hdr->text_offset)
+     || ((hdr->text_len > 0) && (snap->base[hdr->text_offset + hdr->text_len - 1] != '\0')))
+  { release_fed_snapshot( snap );  return 0; }
+ snap->records = (struct fed_record *)(snap->base + hdr->records_offset);
+ snap->nrecords = hdr->nrecords;
+ snap->text = snap->base + hdr->text_offset;
+ return 1;
+}
+
+
+/* True when the text of a federal return still has the length and hash in its snapshot. */
+int fed_text_unchanged( char *fedlogfile, struct fed_snapshot_header *hdr )
+{
+ FILE *fp;
+ char buf[65536];
+ unsigned long long h=FNV_BASIS;
+ long long size=0;
+ long n;
+
+ fp = taxsolve_fopen( fedlogfile, "r" );	/* (Text-mode, as it was written.) */
+ if (fp == 0)
+  return 0;
+ while ((n = fread( buf, 1, sizeof(buf), fp )) > 0)
+  {
+   h = fnv_hash( h, buf, n );
+   size = size + n;
+  }
+ fclose( fp );
+ return (size == hdr->source_size) && (h == hdr->source_hash);
+}
+
+
+/* Get the records of a federal return, from its snapshot when current, else from its text. */
+/* Returns zero when the federal return cannot be read.					      */
+int load_fed_snapshot( char *fedlogfile, struct fed_snapshot *snap )
+{
+ struct fed_snapshot_header *hdr;
+ char snapname[4096];
+ int j;
+
+ memset( snap, 0, sizeof(struct fed_snapshot) );
+ if (strlen( fedlogfile ) + 6 <= sizeof(snapname))
+  {
+   fed_snapshot_name( fedlogfile, snapname );
+   if (map_fed_snapshot( snapname, snap ))
+    {
+     hdr = (struct fed_snapshot_header *)snap->base;
+     for (j=0; j < snap->nrecords; j++)	/* Offsets must stay within the text. */
+      if ((snap->records[j].label >= hdr->text_len) || (snap->records[j].rest >= hdr->text_len))
+       break;
+     if ((j == snap->nrecords) && (fed_text_unchanged( fedlogfile, hdr )))
+      return 1;
+     release_fed_snapshot( snap );
+    }
+  }
+ return read_fed_text( fedlogfile, snap );
+}
+
+
+char *fed_label( struct fed_snapshot *snap, struct fed_record *r )
+{ return snap->text + r->label; }
+
+
+/* Copy what follows a record's label into line (of maxlen bytes), for next_word to take apart. */
+char *fed_rest( struct fed_snapshot *snap, struct fed_record *r, char *line, int maxlen )
+{
+ strncpy( line, snap->text + r->rest, maxlen - 1 );
+ line[maxlen - 1] = '\0';
+ return line;
+}
+
+
+/* Copy a whole record, label and rest, as its line appeared in the text. */
+char *fed_line( struct fed_snapshot *snap, struct fed_record *r, char *line, int maxlen )
+{
+ char *label=snap->text + r->label;
+ int n;
+
+ n = strlen( label );
+ if (n > maxlen - 1) n = maxlen - 1;
+ memcpy( line, label, n );
+ fed_rest( snap, r, &(line[n]), maxlen - n );
+ return line;
+}
+
+
+
+/*------------------------------------------------------------------------------*/
+/* Label Tables - An importer may declare the labels it reads, and where each	*/
+/*  goes, as a table of struct label_field.  At build time, make_label_hash	*/
+/*  reads the table from the importer's source and writes a perfect hash of	*/
+/*  its labels, so find_label locates a label with one pass over it and one	*/
+/*  string compare.  A label ending in "%c" stands for the 26 labels ending	*/
+/*  in 'a' through 'z', which go to successive elements of an array.		*/
+/*------------------------------------------------------------------------------*/
+#define LABEL_VALUE	1	/* A number, into a double. */
+#define LABEL_LETTER	2	/* A number, into element 'a'..'z' of a double array. */
+#define LABEL_STRING	3	/* Words up to ';', into a char array. */
+#define LABEL_ALLOC	4	/* Words up to ';', into a newly allocated string. */
+
+struct label_field
+ {
+  char *label;
+  int kind;
+  long offset;		/* Of the field, within the importer's structure, */
+  char **string;	/*  or the string variable to set. */
+ };
+
+
+struct label_slot *find_label( char *label, struct label_slot *slots, int nslots, unsigned short *disp, int nbuckets )
+{
+ unsigned long long h=fnv_hash( FNV_BASIS, label, strlen( label ) );
+ struct label_slot *slot;
+
+ slot = &(slots[LABEL_SLOT( h, disp[LABEL_BUCKET( h, nbuckets )], nslots )]);
+ if ((slot->key == 0) || (strcmp( slot->key, label ) != 0))
+  return 0;
+ return slot;
+}
+
+
+
+/*------------------------------------------------------------------------------*/
+/* Reset_Return_State - Put the state that a return computes back to its	*/
+/*  initial values, so that the next return on this thread starts-out as it	*/
+/*  would in a new process.  What a caller sets-up for the return it is about	*/
+/*  to run (quiet, discard_results, preloaded_input, and the input override	*/
+/*  and presets) is left alone.  A solver that keeps state of its own sets	*/
+/*  reset_solver_state to the routine that resets it.			*/
+/*------------------------------------------------------------------------------*/
+void (*reset_solver_state)( void )=0;
+
+void reset_return_state( void )
+{
+ memset( L, 0, sizeof(L) );
+ verbose = 0;
+ notappvalue = 0;
+ single_line_entry = 0;
+ whole_line_entry = 0;
+ round_to_whole_dollars = 0;
+ labels_any_order = 0;
+ validate_input = 0;
+ input_override_hits = 0;
+ num_input_additions = 0;
+ last_compiled_token = 0;
+ last_compiled_text = 0;
+ last_compiled_word = 0;
+ memset( &yourDOB, 0, sizeof(yourDOB) );
+ memset( &spouseDOB, 0, sizeof(spouseDOB) );
+ memset( &DL, 0, sizeof(DL) );
+ do_all_caps = 0;
+ writeout_line = 1;
+ pdf_markup_list = 0;
+ if (reset_solver_state != 0)
+  reset_solver_state();
+}
+
+
+/*------------------------------------------------------------------------------*/
+/* Run_Return - Compute one return on the calling thread, by calling a		*/
+/*  solver's entry-point as though it were main( argc, argv ).  Errors that	*/
+/*  would otherwise exit the process end only this return, and its non-zero	*/
+/*  status is returned.  Since each thread has its own copy of the return's	*/
+/*  state, several threads may each run a return at the same time.  The state	*/
+/*  is reset before each return, so a thread may also run several returns,	*/
+/*  one after another.  Memory from return_alloc is released when the return	*/
+/*  finishes, so a long-running process does not grow.  Each solver's main	*/
+/*  runs its return this way too, and returns the status as the exit status.	*/
+/*------------------------------------------------------------------------------*/
+int run_return( int (*solver)( int argc, char *argv[] ), int argc, char *argv[] )
+{
+ jmp_buf abort_point;
+ int result, j;
+
+ reset_return_state();
+ return_abort = &abort_point;
+ result = setjmp( abort_point );
+ if (result == 0)
+  result = solver( argc, argv );
+ else
+  { /* Aborted.  Close what the solver left open. */
+   if (infile != 0) fclose( infile );
+   if (outfile != 0) fclose( outfile );
+  }
+ return_abort = 0;
+ infile = 0;
+ outfile = 0;
+ if (num_input_errors > 0)
+  {
+   print_input_errors();
+   result = 1;
+  }
+ for (j=0; j < MAX_INPUT_BUFFERS; j++)
+  release_input_buffer( &(input_buffers[j]) );
+ free( token_scratch );
+ token_scratch = 0;
+ token_scratch_sz = 0;
+ release_fed_writer();
+ free( output_buffer );		/* (The output file was closed, by the solver or above.) */
+ output_buffer = 0;
+ pdf_markup_list = 0;
+ pool_release( &return_pool );
+ return result;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/************************************************************************/
+/* taxsolve_tax_schedules_2021.c - Federal and California rate		*/
+/*  schedules, and the rows of the tax tables built from them.		*/
+/*  Included by the solvers that use these schedules, and by		*/
+/*  make_tax_tables.c, which generates taxsolve_tax_tables_2021.h	*/
+/*  at build time.  Change the schedules here, never in the .h file.	*/
+/************************************************************************/
+
+			/* Following values taken from 1040-Instructions pg 110. */	/* Updated for 2021. */
+THREAD_LOCAL struct tax_schedule fed_tax_schedules[4]={
+ { 7, 0, TAX_BASES_COMPUTED,	/* Single */
+   { DOLLARS(0), DOLLARS(9950), DOLLARS(40525), DOLLARS(86375), DOLLARS(164925), DOLLARS(209425), DOLLARS(523600) },
+   { RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) } },
+ { 7, 0, TAX_BASES_COMPUTED,	/* Married, filing jointly. */
+   { DOLLARS(0), DOLLARS(19900), DOLLARS(81050), DOLLARS(172750), DOLLARS(329850), DOLLARS(418850), DOLLARS(628300) },
+   { RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) } },
+ { 7, 0, TAX_BASES_COMPUTED,	/* Married, filing separate. */
+   { DOLLARS(0), DOLLARS(9950), DOLLARS(40525), DOLLARS(86375), DOLLARS(164925), DOLLARS(209425), DOLLARS(314150) },
+   { RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) } },
+ { 7, 0, TAX_BASES_COMPUTED,	/* Head of Household. */
+   { DOLLARS(0), DOLLARS(14200), DOLLARS(54200), DOLLARS(86350), DOLLARS(164900), DOLLARS(209400), DOLLARS(523600) },
+   { RATE(0.1), RATE(0.12), RATE(0.22), RATE(0.24), RATE(0.32), RATE(0.35), RATE(0.37) } },
+		     };
+
+
+			/* From the California 540 instructions. */	/* Updated for 2021. */
+THREAD_LOCAL struct tax_schedule ca_tax_schedules[3]={
+ { 9, 1, TAX_BASES_GIVEN,	/* Single, Married/sep */
+   { DOLLARS(0), DOLLARS(9325), DOLLARS(22107), DOLLARS(34892), DOLLARS(48435), DOLLARS(61214), DOLLARS(312686), DOLLARS(375221), DOLLARS(625369) },
+   { RATE(0.01), RATE(0.02), RATE(0.04), RATE(0.06), RATE(0.08), RATE(0.093), RATE(0.103), RATE(0.113), RATE(0.123) },
+   { 0, MONEY(93.25), MONEY(348.89), MONEY(860.29), MONEY(1672.87), MONEY(2695.19), MONEY(26082.09), MONEY(32523.20), MONEY(60789.92) } },
+ { 9, 1, TAX_BASES_GIVEN,	/* Married/Joint, widow(er) */
+   { DOLLARS(0), DOLLARS(18650), DOLLARS(44214), DOLLARS(69784), DOLLARS(96870), DOLLARS(122428), DOLLARS(625372), DOLLARS(750442), DOLLARS(1250738) },
+   { RATE(0.01), RATE(0.02), RATE(0.04), RATE(0.06), RATE(0.08), RATE(0.093), RATE(0.103), RATE(0.113), RATE(0.123) },
+   { 0, MONEY(186.50), MONEY(697.78), MONEY(1720.58), MONEY(3345.74), MONEY(5390.38), MONEY(52164.17), MONEY(65046.38), MONEY(121579.83) } },
+ { 9, 1, TAX_BASES_GIVEN,	/* Head of Household */
+   { DOLLARS(0), DOLLARS(18663), DOLLARS(44217), DOLLARS(56999), DOLLARS(70542), DOLLARS(83324), DOLLARS(425251), DOLLARS(510303), DOLLARS(850503) },
+   { RATE(0.01), RATE(0.02), RATE(0.04), RATE(0.06), RATE(0.08), RATE(0.093), RATE(0.103), RATE(0.113), RATE(0.123) },
+   { 0, MONEY(186.63), MONEY(697.71), MONEY(1208.99), MONEY(2021.57), MONEY(3044.13), MONEY(34843.34), MONEY(43603.70), MONEY(82046.30) } },
+		     };
+
+
+/* The federal tax table covers incomes under $100,000 in rows $5 wide below $25,	*/
+/* $25 wide below $3,000, and $50 wide above.  Each row holds the schedule tax at	*/
+/* its midpoint, rounded to whole dollars.						*/
+#define FED_TAX_TABLE_LIMIT	100000.0
+#define FED_TAX_TABLE_ROWS	(5 + 119 + 1940)
+
+int fed_tax_table_row( double income )	/* Row holding income, or -1 when off the table. */
+{
+ if ((income < 0.0) || (income >= FED_TAX_TABLE_LIMIT)) return -1;
+ if (income < 25.0) return (int)(income / 5.0);
+ if (income < 3000.0) return 5 + (int)(income / 25.0) - 1;
+ return 5 + 119 + (int)(income / 50.0) - 60;
+}
+
+void fed_tax_table_bounds( int row, double *lo, double *hi )
+{
+ if (row < 5) { *lo = 5.0 * row;  *hi = *lo + 5.0; } else
+ if (row < 5 + 119) { *lo = 25.0 * (row - 5 + 1);  *hi = *lo + 25.0; }
+ else { *lo = 50.0 * (row - 5 - 119 + 60);  *hi = *lo + 50.0; }
+}
+
+
+/* The California table covers incomes under $100,000 in $100 rows, each holding	*/
+/* the tax at the row's round-hundred midpoint; the last row holds $99,975.		*/
+#define CA_TAX_TABLE_LIMIT	100000.0
+#define CA_TAX_TABLE_ROWS	1001
+
+int ca_tax_table_row( double income )	/* Row holding income, or -1 when off the table. */
+{
+ if ((income < 0.0) || (income >= CA_TAX_TABLE_LIMIT)) return -1;
+ if (income < 99951.0) return (int)((income + 49) / 100);
+ return CA_TAX_TABLE_ROWS - 1;
+}
+
+double ca_tax_table_midpoint( int row )
+{
+ if (row < CA_TAX_TABLE_ROWS - 1) return 100.0 * row;
+ return 99975.0;
+}
+
+void ca_tax_table_bounds( int row, double *lo, double *hi )
+{
+ if (row == 0) { *lo = 0.0;  *hi = 51.0; } else
+ if (row < CA_TAX_TABLE_ROWS - 1) { *lo = 100.0 * row - 49.0;  *hi = *lo + 100.0; }
+ else { *lo = 99951.0;  *hi = CA_TAX_TABLE_LIMIT; }
+}
@@ -0,0 +1,208 @@
+/************************************************************************/
+/* tokenizer_bench.c - Checks and times the input-buffer tokenizer.	*/
+/*  Writes a synthetic 1040 input holding many CapGains lots, then	*/
+/*  reads every word of that one file three ways:  with the get_word	*/
+/*  every file took before (a copy of it, calling getc, ungetc and	*/
+/*  feof on each byte), and with get_word and get_token on the file	*/
+/*  mapped into memory.  The words must come out the same each way.	*/
+/*  Build and run with "make bench", or:				*/
+/*	tokenizer_bench  [lots  [runs]]					*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+#include "taxsolve_routines.c"
+
+char *bench_file="tokenizer_bench_input.txt";
+
+
+double now()
+{
+ struct timespec ts;
+ clock_gettime( CLOCK_MONOTONIC, &ts );
+ return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+/* Lots as the brokers' exports give them:  comments, quoted strings, $ and , in amounts. */
+long write_input( char *fname, int nlots )
+{
+ FILE *fp;
+ long size;
+ int j;
+
+ fp = taxsolve_fopen( fname, "w" );
+ if (fp == 0)
+  { console_printf("Error: Could not write '%s'.\n", fname);  exit(1); }
+ results_fprintf(fp,"Title:  Tokenizer benchmark, %d lots\n\nStatus\tSingle\n\n", nlots);
+ results_fprintf(fp,"L1\t\t75,000.00\t{ Wages }\n;\n");
+ results_fprintf(fp,"CapGains-A/D\t{ Capital Gains/Losses, 1099-B. }\n");
+ for (j=0; j < nlots; j++)
+  {
+   results_fprintf(fp,"\t-$%d.%02d\t%d-%d-2021\t{ %d Shares \"LOT%06d\" }\n", 100 + j % 90000, j % 100,
+	   1 + j % 12, 1 + j % 28, 1 + j % 500, j );
+   results_fprintf(fp,"\t%d,%03d.%02d\t%d-%d-2021\n", 1 + j % 97, j % 1000, (j * 7) % 100, 1 + (j + 3) % 12, 1 + (j + 5) % 28 );
+   if (j % 10 == 0)
+    results_fprintf(fp,"\tW\t%d.%02d\t{ Wash sale }\n", j % 500, j % 100 );
+   else
+    results_fprintf(fp,"\t~\t\t~\n");
+  }
+ results_fprintf(fp,";\n\nL2a\t\t0.0\n");
+ size = ftell( fp );
+ fclose( fp );
+ return size;
+}
+
+
+/* The get_word of before, verbatim but for its name:  stdio on each byte. */
+void stdio_get_word( FILE *infile, char *word )	/* Absorb comments. */
+{
+ int j=0;
+ char ltc='\n';	 /* Line termination character. */
+ char spc=' ';
+
+ if (single_line_entry)
+  ltc = ' ';
+ if (whole_line_entry)
+  spc='\n';
+ do
+  {  /*Absorb any leading white-space.*/
+     word[j]=getc(infile); 
+     if (word[j]=='{') 
+      { 
+       do word[j]=getc(infile); while ((word[j]!='}') && (!feof(infile)));
+       word[j]=getc(infile);
+      }
+  } 
+ while ((!feof(infile)) && ((word[j]==' ') || (word[j]=='\t') || (word[j]==ltc) || (word[j]=='\r')));
+ if (word[j]=='$')
+  word[j]=getc(infile);
+ if (word[j]==';') 
+  j++;
+ else
+ if (word[j]=='\n')
+  word[j] = '\0';	/* Terminate empty single-line entries. */
+ else
+ if (word[j]=='"')
+  { /* Get quoted string. */
+    j = 0;
+    do
+     word[j++] = getc(infile);
+    while ((word[j-1] != '"') && (!feof(infile)));
+    if (word[j-1] == '"') j--;	/* Remove trailing quote. */
+  }
+ else
+  { /* Normal case. */
+   do {	/*Get word until white-space or ;.*/
+        j++;  word[j] = getc(infile);
+        if (word[j]=='{') do word[j] = getc(infile); while ((!feof(infile)) && (word[j]!='}'));
+	if (word[j]==',') word[j] = getc(infile);
+      } 
+   while ((!feof(infile)) && ((word[j]!=spc) && (word[j]!='\t') && (word[j]!='\n') && (word[j]!=';')));
+   if (word[j]==';') ungetc(word[j],infile);
+  }
+ word[j] = '\0';	/* Add termination character. */
+ if (verbose) printf("Read: '%s'\n", word);
+ intercept_any_pragmas( infile, word );	/* Intercept any pragmas. */
+}
+
+
+enum { READ_STDIO, READ_COPIES, READ_VIEWS };
+
+/* Reads every word of fp, returning their number, and a checksum of their text in sum. */
+long read_words( FILE *fp, unsigned long long *sum, int how )
+{
+ char word[4096];
+ struct token_view tok;
+ unsigned long long h=FNV_BASIS;
+ long nwords=0;
+
+ do
+  {
+   if (how == READ_VIEWS)
+    get_token( fp, &tok );
+   else
+    {
+     if (how == READ_STDIO)
+      stdio_get_word( fp, word );
+     else
+      get_word( fp, word );
+     tok.text = word;
+     tok.len = strlen( word );
+    }
+   h = fnv_hash( h, tok.text, tok.len );
+   h = fnv_hash( h, " ", 1 );
+   nwords++;
+  }
+ while ((how == READ_STDIO) ? !feof( fp ) : !input_eof( fp ));
+ *sum = h;
+ return nwords;
+}
+
+
+double time_reads( int how, int runs, long *nwords, unsigned long long *sum )
+{
+ double start, best=1e30, t;
+ int k;
+ FILE *fp;
+
+ for (k=0; k < runs; k++)
+  {
+   if (how == READ_STDIO)
+    fp = fopen( bench_file, "r" );	/* (Not taxsolve_fopen, which maps it.) */
+   else
+    fp = taxsolve_fopen( bench_file, "r" );
+   if (fp == 0)
+    { console_printf("Error: Could not read '%s'.\n", bench_file);  exit(1); }
+   start = now();
+   *nwords = read_words( fp, sum, how );
+   t = now() - start;
+   if (how != READ_STDIO)
+    release_input_file( fp );
+   fclose( fp );
+   if (t < best)
+    best = t;
+  }
+ return best;
+}
+
+
+int main( int argc, char *argv[] )
+{
+ char *names[]={ "get_word before (stdio):", "get_word (copies):", "get_token (views):" };
+ int nlots=100000, runs=5, how, bad=0;
+ long size, nwords[3];
+ unsigned long long sum[3];
+ double t[3];
+
+ if (argc > 1) nlots = atoi( argv[1] );
+ if (argc > 2) runs = atoi( argv[2] );
+ if ((nlots < 1) || (runs < 1))
+  { console_printf("Usage:  tokenizer_bench  [lots  [runs]]\n");  exit(1); }
+
+ size = write_input( bench_file, nlots );
+ console_printf("%d lots, %ld bytes.  Best of %d runs each, on the same file.\n\n", nlots, size, runs );
+ for (how=READ_STDIO; how <= READ_VIEWS; how++)
+  {
+   t[how] = time_reads( how, runs, &(nwords[how]), &(sum[how]) );
+   if (how == READ_STDIO)
+    console_printf("%-28s %7.1f ms   %ld words\n", names[how], 1e3 * t[how], nwords[how] );
+   else
+    console_printf("%-28s %7.1f ms   %5.1fx\n", names[how], 1e3 * t[how], t[READ_STDIO] / t[how] );
+   if ((nwords[how] != nwords[READ_STDIO]) || (sum[how] != sum[READ_STDIO]))
+    {
+     console_printf("   Words differ:  %ld before, %ld now.\n", nwords[READ_STDIO], nwords[how] );
+     bad++;
+    }
+  }
+ remove( bench_file );
+ if (bad)
+  console_printf("\nThe tokenizer reads different words from before.\n");
+ else
+  console_printf("\nEach way reads the same words.\n");
+ return bad != 0;
+}
@@ -36,6 +36,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include "string_routines.c"
 
 #define MaxPages 100
 #define MAXLINE 2048
@@ -52,32 +53,7 @@ int ck_sz_w=0, ck_sz_h=0, ckfntsz=16;
 char cksymb[99]="*";
 int showdpt=1;	/* Controls whether to show decimals in space-stretched numbers. */
 int enter00afterdecimals=0;	/* Controls whether to force ".00" after rounded values. */
-
-
-void next_word( char *line, char *word, char *delim )
-{
- int j=0, k=0, m=0, flag=1;
- while ((line[k]!='\0') && (flag))
-  {                     /* Consume any preceding delimiters. */
-   j = 0;
-   while ((delim[j] != '\0') && (line[k] != delim[j])) j++;
-   if (line[k] != delim[j]) flag = 0; else { k++; }
-  }
- while ((line[k] != '\0') && (!flag))
-  {                     /* Copy word until next delimiter. */
-   word[m++] = line[k++];
-   if (line[k] != '\0')
-    {
-     j = 0;
-     while ((delim[j] != '\0') && (line[k] != delim[j])) j++;
-     if (line[k] == delim[j]) flag = 1;
-    }
-  }
- j = 0;                 /* Shorten line. */
- while (line[k] != '\0') line[j++] = line[k++];
- line[j] = '\0';        /* Terminate the char-strings. */
- word[m] = '\0';
-}
+struct mem_pool form_pool;	/* Holds the metadata and result records, which last until the PDF is written. */
 
 
 /* ------------------------------------------------------------ */
@@ -100,8 +76,8 @@ struct showzero_rec
 void add_showifzero( char *label )
 {
  struct showzero_rec *new;
- new = (struct showzero_rec *)malloc( sizeof( struct showzero_rec ) );
- new->label = strdup( label );
+ new = (struct showzero_rec *)pool_alloc( &form_pool, sizeof( struct showzero_rec ) );
+ new->label = pool_strdup( &form_pool, label );
  new->nxt = showevenifzerolist;
  showevenifzerolist = new;
 }
@@ -123,9 +99,9 @@ int checknzoveride( char *label )
 struct nvpair *new_item( char *label, char *value )
 {
  struct nvpair *item;
- item = (struct nvpair *)calloc( 1, sizeof( struct nvpair ) );
- item->label = strdup( label );
- item->value = strdup( value );
+ item = (struct nvpair *)pool_alloc( &form_pool, sizeof( struct nvpair ) );
+ item->label = pool_strdup( &form_pool, label );
+ item->value = pool_strdup( &form_pool, value );
  item->used = 0;
  item->pagenumber = current_page;
  return item;
@@ -185,23 +161,6 @@ int m_round( double x )
 }
 
 
-void consume_leading_trailing_whitespace( char *line )
-{ int j, k;
-  while (isspace( line[0] ))    /* Consume any leading white-spaces. */
-   {
-    j = 0;
-    do { line[j] = line[j+1];  j++; }
-    while (line[j-1] != '\0');
-   }
- k = strlen( line ) - 1;        /* Consume any trailing white-spaces. */
- while ((k >= 0) && (isspace( line[k] )))
-  {
-   line[k] = '\0';
-   k--;
-  }
-}
-
-
 void right_justify( char *wrd, int k )
 {
  int j;
@@ -231,7 +190,7 @@ void queue_optional_page( int form_page, int page_order )
   struct optional_print_rec *prv=0, *ptr, *new;
 
   num_pages_to_print++;
-  new = (struct optional_print_rec *)calloc( 1, sizeof(struct optional_print_rec) );
+  new = (struct optional_print_rec *)pool_alloc( &form_pool, sizeof(struct optional_print_rec) );
   new->form_page = form_page;
   new->priority = page_order;
   optional_print_page = new;
@@ -312,7 +271,7 @@ void get_remainder_of_quoted_string( char *line, char *word )
 void read_replacement_text( char *fname )
 {
  int idinfo, pageorder;
- char line[MAXLINE], word1[MAXLINE], word2[MAXLINE];
+ char line[MAXLINE], word1[MAXLINE], word2[MAXLINE], *pt, *args;
  double x;
  struct nvpair *orig_results_list=0;
  FILE *infile;
@@ -323,13 +282,13 @@ void read_replacement_text( char *fname )
  while (!feof(infile))
   { /*not_eof*/
    idinfo = 0;
-   next_word( line, word1, " \t=\n\r" );
+   pt = scan_word( line, word1, " \t=\n\r" );
    if (strcmp( word1, "PDFpage:" ) == 0)
     {
-      next_word( line, word1, " \t=\n\r" );
+      pt = scan_word( pt, word1, " \t=\n\r" );
       if (sscanf( word1, "%d", &current_page) != 1)
        printf("Error reading PDFpage: current_page '%s'\n", word1 );
-      next_word( line, word1, " \t=\n\r" );
+      pt = scan_word( pt, word1, " \t=\n\r" );
       if (sscanf( word1, "%d", &pageorder) != 1)
        printf("Error reading PDFpage: page-order '%s'\n", word1 );
       queue_optional_page( current_page, pageorder );
@@ -356,42 +315,42 @@ void read_replacement_text( char *fname )
    else
    if (strstr( word1, ":" ) != 0)
     {
-     consume_leading_trailing_whitespace( line );
-     strcpy( word2, line );
+     pt = trim_whitespace( pt );
+     strcpy( word2, pt );
      idinfo = 1;
     }
    else
    if (strcmp( word1, "NewPDFMarkup(" ) == 0)	/* Expect:  NewPDFMarkup( pg, x, y ) label_name	 */
     { int pg=0, txtcol=0, font=FontSz;
       float xpos, ypos, tred=txtred, tgrn=txtgrn, tblu=txtblu;
-     next_word( line, word1, ")" );		/*  Or:     NewPDFMarkup( pg, x, y, fontsz, r, g, b ) label_name  */
-     next_word( word1, word2, " \t,(" );
+     pt = scan_word( pt, word1, ")" );		/*  Or:     NewPDFMarkup( pg, x, y, fontsz, r, g, b ) label_name  */
+     args = scan_word( word1, word2, " \t,(" );
      if (sscanf( word2, "%d", &pg ) != 1)
 	printf("Error reading PDFMarkup page '%s'\n", word2 );
-     next_word( word1, word2, " \t," );
+     args = scan_word( args, word2, " \t," );
      if (sscanf( word2, "%f", &xpos ) != 1)
 	printf("Error reading PDFMarkup Xpos '%s'\n", word2 );
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if (sscanf( word2, "%f", &ypos ) != 1)
 	printf("Error reading PDFMarkup Ypos '%s'\n", word2 );
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if ((word2[0] != '\0') && (sscanf( word2, "%d", &font ) != 1))
 	printf("Error reading PDFMarkup FontSz '%s'\n", word2 );
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if ((word2[0] != '\0') && (sscanf( word2, "%d", &txtcol ) != 1))
 	printf("Error reading PDFMarkup setcol '%s'\n", word2 );
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if ((word2[0] != '\0') && (sscanf( word2, "%g", &tred ) != 1))
 	printf("Error reading PDFMarkup TxtRed '%s'\n", word2 );
      else
       txtcol = 1;
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if ((word2[0] != '\0') && (sscanf( word2, "%g", &tgrn ) != 1))
 	printf("Error reading PDFMarkup TxtGreen '%s'\n", word2 );
-     next_word( word1, word2, " \t,)" );
+     args = scan_word( args, word2, " \t,)" );
      if ((word2[0] != '\0') && (sscanf( word2, "%g", &tblu ) != 1))
 	printf("Error reading PDFMarkup TxtBlue '%s'\n", word2 );
-     next_word( line, word2, " \t)\r\n" );
+     pt = scan_word( pt, word2, " \t)\r\n" );
      new_metadata_item( pg - 1, word2, xpos, ypos, font, txtcol, tred, tgrn, tblu, add_commas, 0, 0.0 );
      word2[0] = '\0';
     }
@@ -400,7 +359,7 @@ void read_replacement_text( char *fname )
      if (word2[0] == '!')		/* Comment character. Lines beginning with '!" are ignored. */
       word2[0] = '\0';
      else
-      next_word( line, word2, " \t=\n\r" );
+      pt = scan_word( pt, word2, " \t=\n\r" );
     }
    if (word2[0] != '\0')
     {
@@ -429,7 +388,7 @@ void read_replacement_text( char *fname )
  	filter_text( word2 );
 	if (word2[0] == '"')
 	 { /* Quoted string */
-	   get_remainder_of_quoted_string( line, word2 );
+	   get_remainder_of_quoted_string( pt, word2 );
 	 }
 	else
 	if ( (!idinfo) && round_to_whole_numbers && ( isdigit(word2[0]) || ( (word2[0] == '-') && isdigit(word2[1]) ) ) )
@@ -507,10 +466,10 @@ void new_metadata_item( int pg, char *label, int xpos, int ypos, int FontSz, int
 	float txtred, float txtgrn, float txtblu, int add_commas, int padlen, float dx )
 {
  struct metadata_rec *newitem;
- newitem = (struct metadata_rec *)calloc( 1, sizeof(struct metadata_rec) );
+ newitem = (struct metadata_rec *)pool_alloc( &form_pool, sizeof(struct metadata_rec) );
  newitem->nxt = metadata[pg]->fields;
  metadata[pg]->fields = newitem;
- newitem->label = strdup( label );
+ newitem->label = pool_strdup( &form_pool, label );
  newitem->fsz = FontSz;
  newitem->txtcolor = txtcolor;
  newitem->txtred = txtred;
@@ -535,22 +494,22 @@ void new_metadata_item( int pg, char *label, int xpos, int ypos, int FontSz, int
 void read_metadata( char *fname )
 {
  int pg=-1, k, nparamsrd;
- char line[MAXLINE], wrd[MAXLINE], wrd2[MAXLINE];
+ char line[MAXLINE], wrd[MAXLINE], wrd2[MAXLINE], *pt;
  FILE *infile;
  infile = fopen( fname, "rb" );
  if (infile == 0) { printf("Could not open '%s'\n", fname );  exit(1); }
  fgets( line, 1024, infile );
  while (!feof(infile))
   {
-   next_word( line, wrd, " \t\n\r" );
+   pt = scan_word( line, wrd, " \t\n\r" );
    if ((wrd[0] != '\0') && (wrd[0] != '!'))	/* Comment lines begin with "!" to be ignored. */
     {
      if (strcmp( wrd, "Page" ) == 0)
       {
        pg++;	num_defined_pages++;	num_main_pages++;  num_pages_to_print++;
        // printf("READING INTO metadata[%d] from '%s'\n", pg, fname );
-       metadata[pg] = (struct metapage_rec *)calloc( 1, sizeof(struct metapage_rec) );
-       next_word( line, wrd, " \t\n\r" );
+       metadata[pg] = (struct metapage_rec *)pool_alloc( &form_pool, sizeof(struct metapage_rec) );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        nparamsrd = sscanf( wrd, "%d", &k );
        // printf("Reading Form Page %d\n", pg + 1 );
        // printf("	nparamsrd = %d, k = %d, pg = %d\n", nparamsrd, k, pg );
@@ -562,9 +521,9 @@ void read_metadata( char *fname )
       {
        pg++;	num_defined_pages++;
        // printf("READING OPTIONAL INTO metadata[%d] from '%s'\n", pg, fname );
-       metadata[pg] = (struct metapage_rec *)calloc( 1, sizeof(struct metapage_rec) );
+       metadata[pg] = (struct metapage_rec *)pool_alloc( &form_pool, sizeof(struct metapage_rec) );
        metadata[pg]->optional = 1;
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        nparamsrd = sscanf( wrd, "%d", &k );
        // printf("Reading Optional Form Page %d\n", pg + 1 );
        // printf("	nparamsrd = %d, k = %d, pg = %d\n", nparamsrd, k, pg );
@@ -574,7 +533,7 @@ void read_metadata( char *fname )
      else
      if (strcmp( wrd, "FontSz" ) == 0)
       {
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        sscanf( wrd, "%d", &FontSz );
       }
      else
@@ -600,7 +559,7 @@ void read_metadata( char *fname )
      else
      if (strcmp( wrd, "showevenifzero" ) == 0)
       {
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        add_showifzero( wrd );
       }
      else
@@ -636,50 +595,50 @@ void read_metadata( char *fname )
      else
      if (strcmp( wrd, "right_justify") == 0)
       {
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        sscanf( wrd, "%d", &rjustify );
       }
      else
      if (strcmp( wrd, "solid_status_check") == 0)
       {
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        sscanf( wrd, "%d", &ck_sz_w );
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        sscanf( wrd, "%d", &ck_sz_h );
-       next_word( line, wrd, " \t\n\r" );
+       pt = scan_word( pt, wrd, " \t\n\r" );
        sscanf( wrd, "%d", &ckfntsz );
-       next_word( line, cksymb, " \t\n\r" );
+       pt = scan_word( pt, cksymb, " \t\n\r" );
       }
      else
      if (strcmp( wrd, "TxtColor:") == 0)	/* Set Text-color in R, G, B. */
       {
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &txtred );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &txtgrn );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &txtblu );
        txtcolor = 1;
       }
      else
      if (strcmp( wrd, "CoordReference:") == 0)	/* Changes coordinates from 1/72-Pts to Pixels. */
       {
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refptX0 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refptY0 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refpixX0 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refpixY0 );
        fgets( line, 1024, infile );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( line, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refptX1 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refptY1 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        sscanf( wrd, "%f", &refpixX1 );
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        if (sscanf( wrd, "%f", &refpixY1 ) != 1) printf("Error reading CoordReference: '%s'\n", wrd );
        pixCoords = 1;
       }
@@ -691,11 +650,11 @@ void read_metadata( char *fname )
      else
      if (strcmp( wrd, "MediaBox") == 0)
       { float fval;
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        if (sscanf( wrd, "%f", &fval ) != 1)
 	printf("Error reading MediaBox x '%s'\n", wrd );
        mediabox_x = (int)(fval + 0.5);
-       next_word( line, wrd, " \t,\n\r" );
+       pt = scan_word( pt, wrd, " \t,\n\r" );
        if (sscanf( wrd, "%f", &fval ) != 1)
 	printf("Error reading MediaBox y '%s'\n", wrd );
        mediabox_y = (int)(fval + 0.5);
@@ -712,14 +671,14 @@ void read_metadata( char *fname )
 	int xpos, ypos, padlen=0;
         float dx=0.0;
 	if (pg < 0) { printf("Error: Missing 'Page' tag before field tag.\n");  exit(1); }
-	next_word( line, wrd2, " \t\n\r," );
+	pt = scan_word( pt, wrd2, " \t\n\r," );
 	sscanf( wrd2, "%d", &xpos );
-	next_word( line, wrd2, " \t\n\r," );
+	pt = scan_word( pt, wrd2, " \t\n\r," );
 	sscanf( wrd2, "%d", &ypos );
-	next_word( line, wrd2, " \t\n\r," );
+	pt = scan_word( pt, wrd2, " \t\n\r," );
 	if (wrd2[0] != '\0')
 	 sscanf( wrd2, "%d", &padlen );
-	next_word( line, wrd2, " \t\n\r," );
+	pt = scan_word( pt, wrd2, " \t\n\r," );
 	if (wrd2[0] != '\0')
 	 sscanf( wrd2, "%f", &dx );
 	new_metadata_item( pg, wrd, xpos, ypos, FontSz, txtcolor, txtred, txtgrn, txtblu, 
@@ -1238,7 +1197,7 @@ int main( int argc, char *argv[] )
        if (k == argc)
 	{ printf("Missing file-name after '-o'\n");  exit(1); }
        else
-	outfname = strdup( argv[k] );
+	outfname = pool_strdup( &form_pool, argv[k] );
       }
      else
      if (strncmp( argv[k], "-help", 2 ) == 0)
@@ -1288,5 +1247,6 @@ int main( int argc, char *argv[] )
   } /*k-loop*/
 
  printf(" Wrote: '%s'\n", outfname );
+ pool_release( &form_pool );
  return 0;
 }
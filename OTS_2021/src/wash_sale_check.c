@@ -0,0 +1,268 @@
+/************************************************************************/
+/* wash_sale_check.c - Checks the wash-sale sweep of the 1040 against	*/
+/*  a brute-force search.  Makes 3,000 lots of 40 securities, most	*/
+/*  with share counts, some without, and some already coded W.  Then	*/
+/*  compares the adjustments and codes find_wash_sales gives each lot	*/
+/*  with those of a pairwise search:  each loss in turn, in order of	*/
+/*  sale, against every lot, for the earliest purchase in its window	*/
+/*  with shares left.  Also checks one case by hand.  Run by		*/
+/*  "make check", or:							*/
+/*	wash_sale_check  [lots  [seed]]					*/
+/************************************************************************/
+
+#define main solver_main
+#include "taxsolve_US_1040_2021.c"
+#undef main
+
+int nchecked=0, bad=0;
+
+
+/* Every lot of the six stores, as one array, in store order. */
+struct ref_lot
+ {
+  int store, k;
+  char *security;
+  double shares, left;	/* Its count, and those not yet used as a replacement. */
+  int buy_day, sell_day;
+  int is_loss, done;	/* A loss find_wash_sales takes, and whether it was taken yet. */
+  money adj;
+  char *adj_code;
+ };
+
+struct ref_lot *ref;
+int nref=0;
+
+
+void check( int ok, char *what )
+{
+ nchecked++;
+ if (!ok)
+  {
+   if (bad < 10)
+    console_printf("   %s\n", what );
+   bad++;
+  }
+}
+
+
+void clear_lots()
+{
+ memset( short_trades, 0, sizeof(short_trades) );
+ memset( long_trades, 0, sizeof(long_trades) );
+}
+
+
+money ref_gain( int i )
+{
+ struct lot_store *lots=wash_store( ref[i].store );
+ return to_money( lots->sell_amnt[ ref[i].k ] ) + to_money( lots->buy_amnt[ ref[i].k ] ) + ref[i].adj;
+}
+
+
+/* Copy the lots, as they are before find_wash_sales. */
+void load_reference()
+{
+ struct lot_store *lots;
+ int store, k;
+
+ nref = 0;
+ for (store=0; store < 6; store++)
+  nref = nref + wash_store( store )->n;
+ ref = (struct ref_lot *)calloc( nref + 1, sizeof(struct ref_lot) );
+ nref = 0;
+ for (store=0; store < 6; store++)
+  {
+   lots = wash_store( store );
+   for (k=0; k < lots->n; k++)
+    {
+     ref[nref].store = store;
+     ref[nref].k = k;
+     ref[nref].security = security_of( lots->comment[k] );
+     ref[nref].shares = ref[nref].left = shares_of( lots->comment[k] );
+     ref[nref].buy_day = lots->buy_day[k];
+     ref[nref].sell_day = lots->sell_day[k];
+     ref[nref].adj = to_money( lots->adj_amnt[k] );
+     ref[nref].adj_code = lots->adj_code[k];
+     nref++;
+     ref[nref-1].is_loss = (ref[nref-1].sell_day > 0) && (ref_gain( nref - 1 ) < 0) && (strchr( lots->adj_code[k], 'W' ) == 0);
+    }
+  }
+}
+
+
+/* Is lot a taken before lot b?  By security, then day, then store and index. */
+int ref_before( struct ref_lot *a, int aday, struct ref_lot *b, int bday )
+{
+ if (a->security != b->security)
+  return a->security < b->security;
+ if (aday != bday)
+  return aday < bday;
+ if (a->store != b->store)
+  return a->store < b->store;
+ return a->k < b->k;
+}
+
+
+/* The wash sales, found pairwise.  Returns the number of losses disallowed. */
+int reference_wash_sales( int *nwhole )
+{
+ int i, j, m, nwash=0, nmatched;
+ money loss, disallowed, part;
+ double matched, q;
+
+ for (;;)
+  {
+   for (i=-1, m=0; m < nref; m++)	/* The next loss, in order of sale. */
+    if (ref[m].is_loss && !ref[m].done && ((i < 0) || ref_before( &(ref[m]), ref[m].sell_day, &(ref[i]), ref[i].sell_day )))
+     i = m;
+   if (i < 0)
+    break;
+   ref[i].done = 1;
+   loss = -ref_gain( i );
+   disallowed = 0;
+   matched = 0.0;
+   nmatched = 0;
+   for (;;)
+    {
+     for (j=-1, m=0; m < nref; m++)	/* The earliest purchase in its window with shares left. */
+      if ((m != i) && (ref[m].buy_day > 0) && (ref[m].security == ref[i].security)
+	  && (ref[m].buy_day >= ref[i].sell_day - 30) && (ref[m].buy_day <= ref[i].sell_day + 30)
+	  && ((ref[m].left >= WASH_SHARES_EPSILON) || ((ref[m].shares == 0.0) && (ref[m].left == 0.0)))
+	  && ((j < 0) || ref_before( &(ref[m]), ref[m].buy_day, &(ref[j]), ref[j].buy_day )))
+       j = m;
+     if (j < 0)
+      break;
+     if ((ref[i].shares > 0.0) && (ref[j].shares > 0.0))
+      {
+       q = ref[i].shares - matched;
+       if (ref[j].left < q)
+        q = ref[j].left;
+       matched = matched + q;
+       ref[j].left = ref[j].left - q;
+       if (matched > ref[i].shares - WASH_SHARES_EPSILON)
+        part = loss - disallowed;
+       else
+        part = to_money( money_to_dollars( loss ) * matched / ref[i].shares ) - disallowed;
+      }
+     else
+      {
+       matched = ref[i].shares;
+       ref[j].left = -1.0;	/* Used whole. */
+       part = loss - disallowed;
+       (*nwhole)++;
+      }
+     disallowed = disallowed + part;
+     nmatched++;
+     ref[j].adj = ref[j].adj - part;
+     ref[j].adj_code = with_adj_code( ref[j].adj_code, 'B' );
+     if (ref[j].left < WASH_SHARES_EPSILON)
+      ref[j].left = -1.0;
+     if (matched > ref[i].shares - WASH_SHARES_EPSILON)
+      break;
+    }
+   if (nmatched == 0)
+    continue;
+   ref[i].adj = ref[i].adj + disallowed;
+   ref[i].adj_code = with_adj_code( ref[i].adj_code, 'W' );
+   nwash++;
+  }
+ return nwash;
+}
+
+
+/* Compare each lot's adjustment and codes with the reference's. */
+void compare_with_reference()
+{
+ struct lot_store *lots;
+ char mssg[4096];
+ int i;
+
+ for (i=0; i < nref; i++)
+  {
+   lots = wash_store( ref[i].store );
+   sprintf( mssg, "Lot %d of store %d, '%s':  find_wash_sales gives %s %1.2f, the pairwise search %s %1.2f.",
+	ref[i].k, ref[i].store, lots->comment[ ref[i].k ], lots->adj_code[ ref[i].k ], lots->adj_amnt[ ref[i].k ],
+	ref[i].adj_code, money_to_dollars( ref[i].adj ) );
+   check( (to_money( lots->adj_amnt[ ref[i].k ] ) == ref[i].adj) && (strcmp( lots->adj_code[ ref[i].k ], ref[i].adj_code ) == 0), mssg );
+  }
+}
+
+
+void check_random_lots( int n )
+{
+ char *names[]={ "ACME", "GLOBEX", "INITECH", "UMBRELLA", "HOOLI", "VEHEMENT", "STARK", "WAYNE" };
+ char descr[100], name[20];
+ double sell, cost;
+ int j, store, buy_day, sell_day, nwash, nwhole=0, nw=0, nb=0;
+
+ clear_lots();
+ for (j=0; j < n; j++)
+  {
+   sprintf( name, "%s %c", names[ rand() % 8 ], 'A' + rand() % 5 );	/* (Sparse enough that some windows are empty.) */
+   switch (rand() % 10)
+    {
+     case 0:  strcpy( descr, name );  break;	/* No count. */
+     case 1:  sprintf( descr, "%d.%d SH %s", 1 + rand() % 300, rand() % 10, name );  break;
+     case 2:  sprintf( descr, "1,%03d shares of %s", rand() % 1000, name );  break;
+     default: sprintf( descr, "%d SH %s", 1 + rand() % 300, name );
+    }
+   buy_day = 738000 + rand() % 400;
+   sell_day = buy_day + rand() % 200;
+   if (rand() % 20 == 0)
+    buy_day = 0;	/* "Various". */
+   store = rand() % 6;
+   sell = 100.0 + (rand() % 1000000) / 100.0;
+   cost = sell * (0.5 + (rand() % 1000) / 1000.0);
+   if (rand() % 30 == 0)
+    new_capgain( wash_store( store ), descr, -cost, "01-01-2021", buy_day, sell, "02-01-2021", sell_day, "W", 12.34 );
+   else
+    new_capgain( wash_store( store ), descr, -cost, "01-01-2021", buy_day, sell, "02-01-2021", sell_day, "~", 0.0 );
+  }
+ load_reference();
+ nwash = reference_wash_sales( &nwhole );
+ find_wash_sales();
+ compare_with_reference();
+ for (j=0; j < nref; j++)
+  {
+   if (strchr( ref[j].adj_code, 'W' ) != 0) nw++;
+   if (strchr( ref[j].adj_code, 'B' ) != 0) nb++;
+  }
+ console_printf("Wash sales:  %d lots, %d losses disallowed (%d matched whole), %d lots coded W and %d coded B,\n"
+		" each lot as the pairwise search finds it.\n", nref, nwash, nwhole, nw, nb );
+ check( (nwash > n / 20) && (nwhole > 0), "The lots gave too few wash sales to check." );
+ free( ref );
+}
+
+
+/* 100 shares sold at a loss of 1,000, and 40 bought 10 days later:  60% of the loss is allowed. */
+void check_by_hand()
+{
+ struct lot_store *lots=wash_store( 0 );
+
+ clear_lots();
+ new_capgain( lots, "100 SH ACME", -5000.0, "01-04-2021", 738160, 4000.0, "03-01-2021", 738215, "~", 0.0 );
+ new_capgain( lots, "40 SH ACME", -1600.0, "03-11-2021", 738225, 1800.0, "06-01-2021", 738307, "~", 0.0 );
+ find_wash_sales();
+ check( (strcmp( lots->adj_code[0], "W" ) == 0) && (to_money( lots->adj_amnt[0] ) == to_money( 400.0 )),
+	"Selling 100 shares at a loss of 1,000 and buying 40 should disallow 400." );
+ check( (strcmp( lots->adj_code[1], "B" ) == 0) && (to_money( lots->adj_amnt[1] ) == to_money( -400.0 )),
+	"The 40 shares bought should have 400 added to their basis." );
+}
+
+
+int main( int argc, char *argv[] )
+{
+ int n=3000, seed=2021;
+
+ if (argc > 1) n = atoi( argv[1] );
+ if (argc > 2) seed = atoi( argv[2] );
+ srand( seed );
+ outfile = fopen( NULL_DEVICE, "w" );	/* (For find_wash_sales' summary.) */
+ check_by_hand();
+ check_random_lots( n );
+ if (bad)
+  console_printf("Wash sales:  %d of %d checks failed.\n", bad, nchecked );
+ else
+  console_printf("Wash sales:  All %d checks pass.\n", nchecked );
+ return bad != 0;
+}